@@ -15,11 +15,45 @@
 //
 #include "draco/attributes/attribute_quantization_transform.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "draco/attributes/attribute_transform_type.h"
 #include "draco/core/quantization_utils.h"
 
 namespace draco {
 
+namespace {
+
+// Number of entries that are quantized at once when the values of the source
+// attribute need to be gathered.
+constexpr int kQuantizationBlockSize = 256;
+
+// Quantizes values of |attribute| for |num_entries| points returned by
+// |get_point_id| into |out_values|.
+template <typename PointIdFunctorT>
+void QuantizeAttributeValues(const PointAttribute &attribute, int num_entries,
+                             PointIdFunctorT get_point_id,
+                             const Quantizer &quantizer,
+                             const float *min_values, int32_t *out_values) {
+  const int num_components = attribute.num_components();
+  std::vector<float> block(kQuantizationBlockSize * num_components);
+  for (int start = 0; start < num_entries; start += kQuantizationBlockSize) {
+    const int block_entries =
+        std::min(kQuantizationBlockSize, num_entries - start);
+    for (int i = 0; i < block_entries; ++i) {
+      const AttributeValueIndex att_val_id =
+          attribute.mapped_index(get_point_id(start + i));
+      attribute.GetValue(att_val_id, &block[i * num_components]);
+    }
+    quantizer.QuantizeFloats(block.data(), block_entries, num_components,
+                             min_values,
+                             out_values + start * num_components);
+  }
+}
+
+}  // namespace
+
 bool AttributeQuantizationTransform::InitFromAttribute(
     const PointAttribute &attribute) {
   const AttributeTransformData *const transform_data =
@@ -87,6 +121,9 @@ bool AttributeQuantizationTransform::ComputeParameters(
     }
   }
   for (int c = 0; c < num_components; ++c) {
+    // Values that are not finite can't be quantized.
+    if (!std::isfinite(min_values_[c]) || !std::isfinite(max_values[c]))
+      return false;
     const float dif = max_values[c] - min_values_[c];
     if (dif > range_)
       range_ = dif;
@@ -129,16 +166,18 @@ AttributeQuantizationTransform::GeneratePortableAttribute(
   const uint32_t max_quantized_value = (1 << (quantization_bits_)) - 1;
   Quantizer quantizer;
   quantizer.Init(range(), max_quantized_value);
-  int32_t dst_index = 0;
-  const std::unique_ptr<float[]> att_val(new float[num_components]);
-  for (PointIndex i(0); i < num_points; ++i) {
-    const AttributeValueIndex att_val_id = attribute.mapped_index(i);
-    attribute.GetValue(att_val_id, att_val.get());
-    for (int c = 0; c < num_components; ++c) {
-      const float value = (att_val[c] - min_values()[c]);
-      const int32_t q_val = quantizer.QuantizeFloat(value);
-      portable_attribute_data[dst_index++] = q_val;
-    }
+  if (attribute.is_mapping_identity() &&
+      attribute.byte_stride() == sizeof(float) * num_components &&
+      attribute.size() >= static_cast<size_t>(num_points)) {
+    // The values can be quantized directly from the attribute buffer.
+    quantizer.QuantizeFloats(reinterpret_cast<const float *>(
+                                 attribute.GetAddress(AttributeValueIndex(0))),
+                             num_points, num_components, min_values_.data(),
+                             portable_attribute_data);
+  } else {
+    QuantizeAttributeValues(
+        attribute, num_points, [](int i) { return PointIndex(i); }, quantizer,
+        min_values_.data(), portable_attribute_data);
   }
   return portable_attribute;
 }
@@ -161,18 +200,24 @@ AttributeQuantizationTransform::GeneratePortableAttribute(
   const uint32_t max_quantized_value = (1 << (quantization_bits_)) - 1;
   Quantizer quantizer;
   quantizer.Init(range(), max_quantized_value);
-  int32_t dst_index = 0;
-  const std::unique_ptr<float[]> att_val(new float[num_components]);
-  for (uint32_t i = 0; i < point_ids.size(); ++i) {
-    const AttributeValueIndex att_val_id = attribute.mapped_index(point_ids[i]);
-    attribute.GetValue(att_val_id, att_val.get());
-    for (int c = 0; c < num_components; ++c) {
-      const float value = (att_val[c] - min_values()[c]);
-      const int32_t q_val = quantizer.QuantizeFloat(value);
-      portable_attribute_data[dst_index++] = q_val;
-    }
-  }
+  QuantizeAttributeValues(
+      attribute, num_entries, [&point_ids](int i) { return point_ids[i]; },
+      quantizer, min_values_.data(), portable_attribute_data);
   return portable_attribute;
 }
 
+bool AttributeQuantizationTransform::DequantizeValues(
+    const int32_t *quantized_values, size_t num_values,
+    float *out_values) const {
+  const int32_t max_quantized_value =
+      (1u << static_cast<uint32_t>(quantization_bits_)) - 1;
+  Dequantizer dequantizer;
+  if (!dequantizer.Init(range_, max_quantized_value))
+    return false;
+  dequantizer.DequantizeFloats(quantized_values, num_values,
+                               static_cast<int>(min_values_.size()),
+                               min_values_.data(), out_values);
+  return true;
+}
+
 }  // namespace draco
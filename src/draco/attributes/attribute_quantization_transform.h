@@ -63,6 +63,12 @@ class AttributeQuantizationTransform : public AttributeTransform {
       const PointAttribute &attribute, const std::vector<PointIndex> &point_ids,
       int num_points) const;
 
+  // Dequantizes |num_values| entries of |quantized_values| with all
+  // components of the attribute into |out_values|. Returns false when the
+  // transform parameters are not valid.
+  bool DequantizeValues(const int32_t *quantized_values, size_t num_values,
+                        float *out_values) const;
+
  private:
   int32_t quantization_bits_;
 
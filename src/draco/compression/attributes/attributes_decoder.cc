@@ -78,7 +78,8 @@ bool AttributesDecoder::DecodeAttributesDecoderData(DecoderBuffer *in_buffer) {
     } else
 #endif
     {
-      DecodeVarint(&unique_id, in_buffer);
+      if (!DecodeVarint(&unique_id, in_buffer))
+        return false;
       ga.set_unique_id(unique_id);
     }
     const int att_id = pc->AddAttribute(
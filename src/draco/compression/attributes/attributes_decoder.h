@@ -54,15 +54,23 @@ class AttributesDecoder : public AttributesDecoderInterface {
 
   // Decodes attribute data from the source buffer.
   bool DecodeAttributes(DecoderBuffer *in_buffer) override {
+    if (!DecodeAttributesWithoutTransform(in_buffer))
+      return false;
+    if (!TransformAttributesToOriginalFormat())
+      return false;
+    return true;
+  }
+
+  bool DecodeAttributesWithoutTransform(DecoderBuffer *in_buffer) override {
     if (!DecodePortableAttributes(in_buffer))
       return false;
     if (!DecodeDataNeededByPortableTransforms(in_buffer))
       return false;
-    if (!TransformAttributesToOriginalFormat())
-      return false;
     return true;
   }
 
+  bool TransformAttributesToOriginalFormat() override { return true; }
+
  protected:
   int32_t GetLocalIdForPointAttribute(int32_t point_attribute_id) const {
     const int id_map_size =
@@ -75,7 +83,6 @@ class AttributesDecoder : public AttributesDecoderInterface {
   virtual bool DecodeDataNeededByPortableTransforms(DecoderBuffer *in_buffer) {
     return true;
   }
-  virtual bool TransformAttributesToOriginalFormat() { return true; }
 
  private:
   // List of attribute ids that need to be decoded with this decoder.
@@ -44,6 +44,20 @@ class AttributesDecoderInterface {
   // the derived classes.
   virtual bool DecodeAttributes(DecoderBuffer *in_buffer) = 0;
 
+  // Decodes attribute data from the source buffer, but it does not revert any
+  // attribute transform (such as dequantization) of the decoded attributes.
+  // The transform must be reverted by a subsequent call to
+  // TransformAttributesToOriginalFormat(). The second step does not access the
+  // source buffer and it can be executed in parallel for different attribute
+  // decoders. By default, all attribute data is decoded in this step.
+  virtual bool DecodeAttributesWithoutTransform(DecoderBuffer *in_buffer) {
+    return DecodeAttributes(in_buffer);
+  }
+
+  // Reverts the attribute transforms of all attributes decoded by
+  // DecodeAttributesWithoutTransform().
+  virtual bool TransformAttributesToOriginalFormat() { return true; }
+
   virtual int32_t GetAttributeId(int i) const = 0;
   virtual int32_t GetNumAttributes() const = 0;
   virtual PointCloudDecoder *GetDecoder() const = 0;
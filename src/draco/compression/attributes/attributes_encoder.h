@@ -48,8 +48,22 @@ class AttributesEncoder {
 
   // Encode attribute data to the target buffer.
   virtual bool EncodeAttributes(EncoderBuffer *out_buffer) {
-    if (!TransformAttributesToPortableFormat())
+    if (!TransformAttributes())
       return false;
+    return EncodeTransformedAttributes(out_buffer);
+  }
+
+  // Transforms all attributes into their portable format. This is the first
+  // step of EncodeAttributes() that can be called separately when the portable
+  // attributes of all encoders need to be available before any attribute data
+  // is encoded (e.g. when multiple encoders run in parallel).
+  bool TransformAttributes() { return TransformAttributesToPortableFormat(); }
+
+  // Encodes attributes that were already transformed by TransformAttributes().
+  // The encoded data doesn't depend on the state of any other attribute
+  // encoder as long as the portable attributes of all parent attributes are
+  // available.
+  bool EncodeTransformedAttributes(EncoderBuffer *out_buffer) {
     if (!EncodePortableAttributes(out_buffer))
       return false;
     // Encode data needed by portable transforms after the attribute is encoded.
@@ -13,6 +13,10 @@
 // limitations under the License.
 //
 #include "draco/compression/attributes/kd_tree_attributes_decoder.h"
+
+#include <cmath>
+#include <limits>
+
 #include "draco/compression/attributes/kd_tree_attributes_shared.h"
 #include "draco/compression/point_cloud/algorithms/dynamic_integer_points_kd_tree_decoder.h"
 #include "draco/compression/point_cloud/algorithms/float_points_tree_decoder.h"
@@ -32,8 +36,10 @@ using AttributeTuple =
 // the size of the data for efficiency, not the type.  DataType is conveyed in
 // but is an unused field populated for any future logic/special casing.
 // DT_UINT32 and all other 4-byte types are naturally supported from the size of
-// data in the kd tree encoder.  DT_UINT16 and DT_UINT8 are supported by way
-// of byte copies into a temporary memory buffer.
+// data in the kd tree encoder.  DT_UINT16 and DT_UINT8 are supported by
+// copying the least significant bytes of each component.
+// All attributes must use identity mapping and they must be already allocated
+// for all decoded points.
 template <class CoeffT>
 class PointAttributeVectorOutputIterator {
   typedef PointAttributeVectorOutputIterator<CoeffT> Self;
@@ -46,14 +52,21 @@ class PointAttributeVectorOutputIterator {
       const std::vector<AttributeTuple> &atts)
       : attributes_(atts), point_id_(0) {
     DRACO_DCHECK_GE(atts.size(), 1);
-    uint32_t required_decode_bytes = 0;
-    for (auto index = 0; index < attributes_.size(); index++) {
+    // Cache the destination of the values of each attribute so that the
+    // decoded points can be written straight to the attribute buffers.
+    outputs_.resize(attributes_.size());
+    for (size_t index = 0; index < attributes_.size(); index++) {
       const AttributeTuple &att = attributes_[index];
-      required_decode_bytes = (std::max)(required_decode_bytes,
-                                         std::get<3>(att) * std::get<4>(att));
+      PointAttribute *const attribute = std::get<0>(att);
+      AttributeOutput &output = outputs_[index];
+      output.num_values = attribute->size();
+      output.data =
+          output.num_values > 0 ? attribute->buffer()->data() : nullptr;
+      output.byte_stride = attribute->byte_stride();
+      output.offset = std::get<1>(att);
+      output.data_size = std::get<3>(att);
+      output.num_components = std::get<4>(att);
     }
-    memory_.resize(required_decode_bytes);
-    data_ = memory_.data();
   }
 
   const Self &operator++() {
@@ -83,38 +96,39 @@ class PointAttributeVectorOutputIterator {
                                  &val[0] + offset);
     return *this;
   }
-  // Additional operator taking std::vector as argument.
-  const Self &operator=(const std::vector<CoeffT> &val) {
-    for (auto index = 0; index < attributes_.size(); index++) {
-      AttributeTuple &att = attributes_[index];
-      PointAttribute *attribute = std::get<0>(att);
-      const uint32_t &offset = std::get<1>(att);
-      const uint32_t &data_size = std::get<3>(att);
-      const uint32_t &num_components = std::get<4>(att);
-      const uint32_t *data_source = val.data() + offset;
-      if (data_size != 4) {  // handle uint16_t, uint8_t
+  // Additional operator taking a pointer to the values of all attributes of
+  // a point as argument.
+  const Self &operator=(const CoeffT *val) {
+    for (const AttributeOutput &output : outputs_) {
+      if (point_id_.value() >= output.num_values)
+        return *this;
+      uint8_t *const dst = output.data + output.byte_stride * point_id_.value();
+      const CoeffT *const src = val + output.offset;
+      if (output.data_size == sizeof(CoeffT)) {
+        memcpy(dst, src, sizeof(CoeffT) * output.num_components);
+      } else {  // handle uint16_t, uint8_t
         // selectively copy data bytes
-        uint8_t *data_counter = data_;
-        for (uint32_t index = 0; index < num_components;
-             index += 1, data_counter += data_size) {
-          std::memcpy(data_counter, data_source + index, data_size);
+        for (uint32_t c = 0; c < output.num_components; ++c) {
+          memcpy(dst + c * output.data_size, src + c, output.data_size);
         }
-        // redirect to copied data
-        data_source = reinterpret_cast<uint32_t *>(data_);
       }
-      const AttributeValueIndex avi = attribute->mapped_index(point_id_);
-      if (avi >= static_cast<uint32_t>(attribute->size()))
-        return *this;
-      attribute->SetAttributeValue(avi, data_source);
     }
     return *this;
   }
 
  private:
-  // preallocated memory for buffering different data sizes.  Never reallocated.
-  std::vector<uint8_t> memory_;
-  uint8_t *data_;
+  // Destination of the decoded values of a single attribute.
+  struct AttributeOutput {
+    uint8_t *data;
+    int64_t byte_stride;
+    size_t num_values;
+    uint32_t offset;
+    uint32_t data_size;
+    uint32_t num_components;
+  };
+
   std::vector<AttributeTuple> attributes_;
+  std::vector<AttributeOutput> outputs_;
   PointIndex point_id_;
 
   // NO COPY
@@ -124,7 +138,141 @@ class PointAttributeVectorOutputIterator {
       PointAttributeVectorOutputIterator const &) = delete;
 };
 
-KdTreeAttributesDecoder::KdTreeAttributesDecoder() {}
+namespace {
+
+// Parameters of the kd-tree decoding of the portable attributes.
+struct KdTreeDecodingParams {
+  KdTreeDecodingParams()
+      : dimension(0),
+        subtree_depth(0),
+        thread_pool(nullptr),
+        query_box_min(nullptr),
+        query_box_max(nullptr) {}
+
+  uint32_t dimension;
+  int subtree_depth;
+  ThreadPool *thread_pool;
+  // Optional query box. Only points inside of the box are decoded.
+  const std::vector<uint32_t> *query_box_min;
+  const std::vector<uint32_t> *query_box_max;
+};
+
+// Decodes points encoded by the kd-tree encoder with the given compression
+// level. When |oit| is nullptr, the points are skipped. |num_output_points|
+// is set to the number of points written to |oit|.
+template <int compression_level_t>
+bool DecodePointsWithKdTree(DecoderBuffer *in_buffer,
+                            const KdTreeDecodingParams &params,
+                            PointAttributeVectorOutputIterator<uint32_t> *oit,
+                            uint32_t *num_output_points) {
+  DynamicIntegerPointsKdTreeDecoder<compression_level_t> decoder(
+      params.dimension);
+  decoder.set_subtree_depth(params.subtree_depth);
+  decoder.set_thread_pool(params.thread_pool);
+  if (oit == nullptr)
+    return decoder.SkipPoints(in_buffer);
+  if (params.query_box_min != nullptr) {
+    decoder.set_query_box(*params.query_box_min, *params.query_box_max);
+  }
+  if (!decoder.DecodePoints(in_buffer, *oit))
+    return false;
+  *num_output_points = decoder.num_output_points();
+  return true;
+}
+
+bool DecodePointsWithKdTree(DecoderBuffer *in_buffer, int compression_level,
+                            const KdTreeDecodingParams &params,
+                            PointAttributeVectorOutputIterator<uint32_t> *oit,
+                            uint32_t *num_output_points) {
+  switch (compression_level) {
+    case 0:
+      return DecodePointsWithKdTree<0>(in_buffer, params, oit,
+                                       num_output_points);
+    case 1:
+      return DecodePointsWithKdTree<1>(in_buffer, params, oit,
+                                       num_output_points);
+    case 2:
+      return DecodePointsWithKdTree<2>(in_buffer, params, oit,
+                                       num_output_points);
+    case 3:
+      return DecodePointsWithKdTree<3>(in_buffer, params, oit,
+                                       num_output_points);
+    case 4:
+      return DecodePointsWithKdTree<4>(in_buffer, params, oit,
+                                       num_output_points);
+    case 5:
+      return DecodePointsWithKdTree<5>(in_buffer, params, oit,
+                                       num_output_points);
+    case 6:
+      return DecodePointsWithKdTree<6>(in_buffer, params, oit,
+                                       num_output_points);
+    default:
+      return false;
+  }
+}
+
+// Converts the range [|min_value|, |max_value|] of real numbers to the range
+// of integers it contains. The result is clamped to the range of uint32_t.
+void ConvertToUnsignedRange(double min_value, double max_value,
+                            uint32_t *out_min, uint32_t *out_max) {
+  const double max_uint32 = std::numeric_limits<uint32_t>::max();
+  min_value = std::ceil(min_value);
+  max_value = std::floor(max_value);
+  if (!(min_value <= max_value) || max_value < 0 || min_value > max_uint32) {
+    // Empty range.
+    *out_min = 1;
+    *out_max = 0;
+    return;
+  }
+  *out_min = min_value <= 0 ? 0 : static_cast<uint32_t>(min_value);
+  *out_max =
+      max_value >= max_uint32 ? UINT32_MAX : static_cast<uint32_t>(max_value);
+}
+
+// Returns the smallest quantized value in [0, |max_quantized_value|] that is
+// dequantized to a value greater or equal to |value|. Returns
+// |max_quantized_value| + 1 when there is no such value.
+int64_t FindQuantizedLowerBound(const Dequantizer &dequantizer, float offset,
+                                int32_t max_quantized_value, float value) {
+  int64_t low = 0;
+  int64_t high = static_cast<int64_t>(max_quantized_value) + 1;
+  while (low < high) {
+    const int64_t mid = (low + high) / 2;
+    const float dequantized_value =
+        dequantizer.DequantizeFloat(static_cast<int32_t>(mid)) + offset;
+    if (dequantized_value < value) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+// Returns the largest quantized value in [0, |max_quantized_value|] that is
+// dequantized to a value less or equal to |value|. Returns -1 when there is no
+// such value.
+int64_t FindQuantizedUpperBound(const Dequantizer &dequantizer, float offset,
+                                int32_t max_quantized_value, float value) {
+  int64_t low = 0;
+  int64_t high = static_cast<int64_t>(max_quantized_value) + 1;
+  while (low < high) {
+    const int64_t mid = (low + high) / 2;
+    const float dequantized_value =
+        dequantizer.DequantizeFloat(static_cast<int32_t>(mid)) + offset;
+    if (dequantized_value <= value) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low - 1;
+}
+
+}  // namespace
+
+KdTreeAttributesDecoder::KdTreeAttributesDecoder()
+    : query_box_applied_(false) {}
 
 bool KdTreeAttributesDecoder::DecodePortableAttributes(
     DecoderBuffer *in_buffer) {
@@ -136,6 +284,11 @@ bool KdTreeAttributesDecoder::DecodePortableAttributes(
   uint8_t compression_level = 0;
   if (!in_buffer->Decode(&compression_level))
     return false;
+  uint8_t subtree_depth = 0;
+  if (in_buffer->bitstream_version() >= DRACO_BITSTREAM_VERSION(2, 5)) {
+    if (!in_buffer->Decode(&subtree_depth) || subtree_depth == 0)
+      return false;
+  }
   const int32_t num_points = GetDecoder()->point_cloud()->num_points();
 
   // Decode data using the kd tree decoding into integer (portable) attributes.
@@ -146,6 +299,11 @@ bool KdTreeAttributesDecoder::DecodePortableAttributes(
   const int num_attributes = GetNumAttributes();
   uint32_t total_dimensionality = 0;  // position is a required dimension
   std::vector<AttributeTuple> atts(num_attributes);
+  // Start from scratch in case the decoding is restarted.
+  min_signed_values_.clear();
+  quantized_portable_attributes_.clear();
+  portable_attributes_.clear();
+  query_box_applied_ = false;
 
   for (int i = 0; i < GetNumAttributes(); ++i) {
     const int att_id = GetAttributeId(i);
@@ -191,54 +349,38 @@ bool KdTreeAttributesDecoder::DecodePortableAttributes(
     atts[i] = std::make_tuple(target_att, total_dimensionality, data_type,
                               data_size, num_components);
     total_dimensionality += num_components;
+    portable_attributes_.push_back(target_att);
   }
   PointAttributeVectorOutputIterator<uint32_t> out_it(atts);
 
-  switch (compression_level) {
-    case 0: {
-      DynamicIntegerPointsKdTreeDecoder<0> decoder(total_dimensionality);
-      if (!decoder.DecodePoints(in_buffer, out_it))
-        return false;
-      break;
-    }
-    case 1: {
-      DynamicIntegerPointsKdTreeDecoder<1> decoder(total_dimensionality);
-      if (!decoder.DecodePoints(in_buffer, out_it))
-        return false;
-      break;
-    }
-    case 2: {
-      DynamicIntegerPointsKdTreeDecoder<2> decoder(total_dimensionality);
-      if (!decoder.DecodePoints(in_buffer, out_it))
-        return false;
-      break;
-    }
-    case 3: {
-      DynamicIntegerPointsKdTreeDecoder<3> decoder(total_dimensionality);
-      if (!decoder.DecodePoints(in_buffer, out_it))
-        return false;
-      break;
-    }
-    case 4: {
-      DynamicIntegerPointsKdTreeDecoder<4> decoder(total_dimensionality);
-      if (!decoder.DecodePoints(in_buffer, out_it))
-        return false;
-      break;
-    }
-    case 5: {
-      DynamicIntegerPointsKdTreeDecoder<5> decoder(total_dimensionality);
-      if (!decoder.DecodePoints(in_buffer, out_it))
-        return false;
-      break;
-    }
-    case 6: {
-      DynamicIntegerPointsKdTreeDecoder<6> decoder(total_dimensionality);
-      if (!decoder.DecodePoints(in_buffer, out_it))
-        return false;
-      break;
-    }
-    default:
+  KdTreeDecodingParams params;
+  params.dimension = total_dimensionality;
+  params.subtree_depth = subtree_depth;
+  params.thread_pool = GetDecoder()->thread_pool();
+  std::vector<uint32_t> query_box_min, query_box_max;
+  if (subtree_depth > 0 && HasQueryBox()) {
+    // The query box can be converted to the portable values only with the
+    // data needed by the portable transforms that is stored after the points.
+    // Skip the points in a copy of the buffer to get to the data. Only the top
+    // of the tree needs to be decoded for that. The points are restricted to
+    // the box while they are decoded, so they must not be filtered again.
+    query_box_applied_ = true;
+    DecoderBuffer lookahead_buffer = *in_buffer;
+    if (!DecodePointsWithKdTree(&lookahead_buffer, compression_level, params,
+                                nullptr, nullptr))
       return false;
+    if (!DecodeDataNeededByPortableTransforms(&lookahead_buffer))
+      return false;
+    ComputeQueryBox(&query_box_min, &query_box_max);
+    params.query_box_min = &query_box_min;
+    params.query_box_max = &query_box_max;
+  }
+  uint32_t num_output_points = 0;
+  if (!DecodePointsWithKdTree(in_buffer, compression_level, params, &out_it,
+                              &num_output_points))
+    return false;
+  if (params.query_box_min != nullptr) {
+    ResizeDecodedAttributes(num_output_points);
   }
   return true;
 }
@@ -248,6 +390,7 @@ bool KdTreeAttributesDecoder::DecodeDataNeededByPortableTransforms(
   if (in_buffer->bitstream_version() >= DRACO_BITSTREAM_VERSION(2, 3)) {
     // Decode quantization data for each attribute that need it.
     // TODO(ostava): This should be moved to AttributeQuantizationTransform.
+    attribute_quantization_transforms_.clear();
     std::vector<float> min_value;
     for (int i = 0; i < GetNumAttributes(); ++i) {
       const int att_id = GetAttributeId(i);
@@ -279,9 +422,14 @@ bool KdTreeAttributesDecoder::DecodeDataNeededByPortableTransforms(
     // Decode transform data for signed integer attributes.
     for (int i = 0; i < min_signed_values_.size(); ++i) {
       int32_t val;
-      DecodeVarint(&val, in_buffer);
+      if (!DecodeVarint(&val, in_buffer))
+        return false;
       min_signed_values_[i] = val;
     }
+    if (!query_box_applied_ && HasQueryBox()) {
+      FilterPointsInQueryBox();
+      query_box_applied_ = true;
+    }
     return true;
   }
 #ifdef DRACO_BACKWARDS_COMPATIBILITY_SUPPORTED
@@ -406,6 +554,133 @@ bool KdTreeAttributesDecoder::DecodeDataNeededByPortableTransforms(
 #endif
 }
 
+bool KdTreeAttributesDecoder::HasQueryBox() const {
+  for (int i = 0; i < GetNumAttributes(); ++i) {
+    const PointAttribute *const att =
+        GetDecoder()->point_cloud()->attribute(GetAttributeId(i));
+    if (GetDecoder()->options()->IsAttributeOptionSet(att->attribute_type(),
+                                                      "query_box_min") ||
+        GetDecoder()->options()->IsAttributeOptionSet(att->attribute_type(),
+                                                      "query_box_max"))
+      return true;
+  }
+  return false;
+}
+
+void KdTreeAttributesDecoder::ComputeQueryBox(
+    std::vector<uint32_t> *box_min, std::vector<uint32_t> *box_max) const {
+  box_min->clear();
+  box_max->clear();
+  int num_processed_quantized_attributes = 0;
+  int num_processed_signed_components = 0;
+  for (int i = 0; i < GetNumAttributes(); ++i) {
+    const PointAttribute *const att =
+        GetDecoder()->point_cloud()->attribute(GetAttributeId(i));
+    const int num_components = att->num_components();
+    // Missing components of the box are not restricted.
+    std::vector<float> min_value(num_components,
+                                 -std::numeric_limits<float>::infinity());
+    std::vector<float> max_value(num_components,
+                                 std::numeric_limits<float>::infinity());
+    GetDecoder()->options()->GetAttributeVector(
+        att->attribute_type(), "query_box_min", num_components, &min_value[0]);
+    GetDecoder()->options()->GetAttributeVector(
+        att->attribute_type(), "query_box_max", num_components, &max_value[0]);
+    for (int c = 0; c < num_components; ++c) {
+      uint32_t component_min = 0;
+      uint32_t component_max = 0;
+      if (att->data_type() == DT_FLOAT32) {
+        // Find the range of quantized values that are dequantized to values
+        // inside of the box.
+        const AttributeQuantizationTransform &transform =
+            attribute_quantization_transforms_
+                [num_processed_quantized_attributes];
+        const int32_t max_quantized_value =
+            (1u << static_cast<uint32_t>(transform.quantization_bits())) - 1;
+        Dequantizer dequantizer;
+        if (!dequantizer.Init(transform.range(), max_quantized_value)) {
+          component_min = 0;
+          component_max = UINT32_MAX;
+        } else {
+          const int64_t low =
+              FindQuantizedLowerBound(dequantizer, transform.min_value(c),
+                                      max_quantized_value, min_value[c]);
+          const int64_t high =
+              FindQuantizedUpperBound(dequantizer, transform.min_value(c),
+                                      max_quantized_value, max_value[c]);
+          ConvertToUnsignedRange(static_cast<double>(low),
+                                 static_cast<double>(high), &component_min,
+                                 &component_max);
+        }
+      } else if (att->data_type() == DT_INT32 || att->data_type() == DT_INT16 ||
+                 att->data_type() == DT_INT8) {
+        // Signed values are stored relative to the minimum value.
+        const double offset =
+            min_signed_values_[num_processed_signed_components + c];
+        ConvertToUnsignedRange(min_value[c] - offset, max_value[c] - offset,
+                               &component_min, &component_max);
+      } else {
+        ConvertToUnsignedRange(min_value[c], max_value[c], &component_min,
+                               &component_max);
+      }
+      box_min->push_back(component_min);
+      box_max->push_back(component_max);
+    }
+    if (att->data_type() == DT_FLOAT32) {
+      num_processed_quantized_attributes++;
+    } else if (att->data_type() == DT_INT32 || att->data_type() == DT_INT16 ||
+               att->data_type() == DT_INT8) {
+      num_processed_signed_components += num_components;
+    }
+  }
+}
+
+void KdTreeAttributesDecoder::FilterPointsInQueryBox() {
+  std::vector<uint32_t> box_min, box_max;
+  ComputeQueryBox(&box_min, &box_max);
+  const uint32_t num_points = GetDecoder()->point_cloud()->num_points();
+  uint32_t num_output_points = 0;
+  for (uint32_t p = 0; p < num_points; ++p) {
+    bool inside = true;
+    int component = 0;
+    for (const PointAttribute *const att : portable_attributes_) {
+      const int data_size = DataTypeLength(att->data_type());
+      const uint8_t *const data = att->GetAddress(AttributeValueIndex(p));
+      for (int c = 0; c < att->num_components() && inside; ++c, ++component) {
+        // Values are stored in the low bytes of the decoded components.
+        uint32_t value = 0;
+        memcpy(&value, data + c * data_size, data_size);
+        inside = value >= box_min[component] && value <= box_max[component];
+      }
+      if (!inside)
+        break;
+    }
+    if (!inside)
+      continue;
+    if (num_output_points != p) {
+      // Move the point to its final position.
+      for (PointAttribute *const att : portable_attributes_) {
+        att->buffer()->Write(
+            att->byte_stride() * num_output_points,
+            att->GetAddress(AttributeValueIndex(p)), att->byte_stride());
+      }
+    }
+    ++num_output_points;
+  }
+  ResizeDecodedAttributes(num_output_points);
+}
+
+void KdTreeAttributesDecoder::ResizeDecodedAttributes(uint32_t num_points) {
+  for (int i = 0; i < GetNumAttributes(); ++i) {
+    GetDecoder()->point_cloud()->attribute(GetAttributeId(i))->Resize(
+        num_points);
+  }
+  for (const auto &att : quantized_portable_attributes_) {
+    att->Resize(num_points);
+  }
+  GetDecoder()->point_cloud()->set_num_points(num_points);
+}
+
 template <typename SignedDataTypeT>
 bool KdTreeAttributesDecoder::TransformAttributeBackToSignedType(
     PointAttribute *att, int num_processed_signed_components) {
@@ -458,9 +733,6 @@ bool KdTreeAttributesDecoder::TransformAttributesToOriginalFormat() {
       }
       num_processed_signed_components += att->num_components();
     } else if (att->data_type() == DT_FLOAT32) {
-      // TODO(ostava): This code should be probably moved out to attribute
-      // transform and shared with the SequentialQuantizationAttributeDecoder.
-
       const PointAttribute *const src_att =
           quantized_portable_attributes_[num_processed_quantized_attributes]
               .get();
@@ -471,7 +743,8 @@ bool KdTreeAttributesDecoder::TransformAttributesToOriginalFormat() {
 
       num_processed_quantized_attributes++;
 
-      if (GetDecoder()->options()->GetAttributeBool(
+      if (GetDecoder()->IsPortableOnlyAttribute(att_id) ||
+          GetDecoder()->options()->GetAttributeBool(
               att->attribute_type(), "skip_attribute_transform", false)) {
         // Attribute transform should not be performed. In this case, we replace
         // the output geometry attribute with the portable attribute.
@@ -483,30 +756,15 @@ bool KdTreeAttributesDecoder::TransformAttributesToOriginalFormat() {
       }
 
       // Convert all quantized values back to floats.
-      const int32_t max_quantized_value =
-          (1u << static_cast<uint32_t>(transform.quantization_bits())) - 1;
-      const int num_components = att->num_components();
-      const int entry_size = sizeof(float) * num_components;
-      const std::unique_ptr<float[]> att_val(new float[num_components]);
-      int quant_val_id = 0;
-      int out_byte_pos = 0;
-      Dequantizer dequantizer;
-      if (!dequantizer.Init(transform.range(), max_quantized_value))
-        return false;
-      const uint32_t *const portable_attribute_data =
-          reinterpret_cast<const uint32_t *>(
+      if (src_att->size() == 0)
+        continue;
+      const int32_t *const portable_attribute_data =
+          reinterpret_cast<const int32_t *>(
               src_att->GetAddress(AttributeValueIndex(0)));
-      for (uint32_t i = 0; i < src_att->size(); ++i) {
-        for (int c = 0; c < num_components; ++c) {
-          float value = dequantizer.DequantizeFloat(
-              portable_attribute_data[quant_val_id++]);
-          value = value + transform.min_value(c);
-          att_val[c] = value;
-        }
-        // Store the floating point value into the attribute buffer.
-        att->buffer()->Write(out_byte_pos, att_val.get(), entry_size);
-        out_byte_pos += entry_size;
-      }
+      if (!transform.DequantizeValues(
+              portable_attribute_data, src_att->size(),
+              reinterpret_cast<float *>(att->buffer()->data())))
+        return false;
     }
   }
   return true;
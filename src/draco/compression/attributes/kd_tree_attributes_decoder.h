@@ -21,6 +21,13 @@
 namespace draco {
 
 // Decodes attributes encoded with the KdTreeAttributesEncoder.
+//
+// The decoded points can be restricted to an axis-aligned box using the
+// "query_box_min" and "query_box_max" attribute options of the decoder (see
+// Decoder::SetAttributeQueryBox()). When the data was encoded with subtree
+// streams, subtrees outside of the box are skipped without decoding. Otherwise
+// all points are decoded but only the points inside of the box are stored in
+// the attributes and transformed to their original format.
 class KdTreeAttributesDecoder : public AttributesDecoder {
  public:
   KdTreeAttributesDecoder();
@@ -35,10 +42,30 @@ class KdTreeAttributesDecoder : public AttributesDecoder {
   bool TransformAttributeBackToSignedType(PointAttribute *att,
                                           int num_processed_signed_components);
 
+  // Returns true when a query box was set for any of the decoded attributes.
+  bool HasQueryBox() const;
+
+  // Computes the query box in the space of the portable attribute values.
+  // Must be called after the data needed by the portable transforms is
+  // decoded.
+  void ComputeQueryBox(std::vector<uint32_t> *box_min,
+                       std::vector<uint32_t> *box_max) const;
+
+  // Removes all points outside of the query box from the portable attributes.
+  void FilterPointsInQueryBox();
+
+  // Sets the number of decoded points to |num_points|.
+  void ResizeDecodedAttributes(uint32_t num_points);
+
   std::vector<AttributeQuantizationTransform>
       attribute_quantization_transforms_;
   std::vector<int32_t> min_signed_values_;
   std::vector<std::unique_ptr<PointAttribute>> quantized_portable_attributes_;
+  // Attributes that store the portable values of the decoded attributes.
+  std::vector<PointAttribute *> portable_attributes_;
+  // Set when the points were already restricted to the query box while they
+  // were decoded.
+  bool query_box_applied_;
 };
 
 }  // namespace draco
@@ -22,6 +22,26 @@
 
 namespace draco {
 
+namespace {
+
+// Encodes all points of |point_vector| using the kd-tree encoder with the
+// given compression level.
+template <int compression_level_t>
+bool EncodePointsWithKdTree(PointDVector<uint32_t> *point_vector,
+                            int num_components, uint32_t num_bits,
+                            int subtree_depth, ThreadPool *thread_pool,
+                            EncoderBuffer *out_buffer) {
+  DynamicIntegerPointsKdTreeEncoder<compression_level_t> points_encoder(
+      num_components);
+  points_encoder.set_subtree_depth(subtree_depth);
+  points_encoder.set_thread_pool(thread_pool);
+  return points_encoder.EncodePoints(point_vector->begin(),
+                                     point_vector->end(), num_bits,
+                                     out_buffer);
+}
+
+}  // namespace
+
 KdTreeAttributesEncoder::KdTreeAttributesEncoder() : num_components_(0) {}
 
 KdTreeAttributesEncoder::KdTreeAttributesEncoder(int att_id)
@@ -69,8 +89,9 @@ bool KdTreeAttributesEncoder::TransformAttributesToPortableFormat() {
             att->num_components(), range);
       } else {
         // Compute quantization settings from the attribute values.
-        attribute_quantization_transform.ComputeParameters(*att,
-                                                           quantization_bits);
+        if (!attribute_quantization_transform.ComputeParameters(
+                *att, quantization_bits))
+          return false;
       }
       attribute_quantization_transforms_.push_back(
           attribute_quantization_transform);
@@ -137,6 +158,13 @@ bool KdTreeAttributesEncoder::EncodePortableAttributes(
 
   out_buffer->Encode(compression_level);
 
+  // The subtree depth is stored only when the subtree streams are used. The
+  // encoder uses the point cloud bit-stream version 2.5 exactly in that case.
+  const int subtree_depth = encoder()->GetKdTreeSubtreeDepth();
+  if (subtree_depth > 0) {
+    out_buffer->Encode(static_cast<uint8_t>(subtree_depth));
+  }
+
   // Init PointDVector. The number of dimensions is equal to the total number
   // of dimensions across all attributes.
   const int num_points = encoder()->point_cloud()->num_points();
@@ -230,60 +258,38 @@ bool KdTreeAttributesEncoder::EncodePortableAttributes(
   }
 
   switch (compression_level) {
-    case 6: {
-      DynamicIntegerPointsKdTreeEncoder<6> points_encoder(num_components_);
-      if (!points_encoder.EncodePoints(point_vector.begin(), point_vector.end(),
-                                       num_bits, out_buffer))
-        return false;
-      break;
-    }
-    case 5: {
-      DynamicIntegerPointsKdTreeEncoder<5> points_encoder(num_components_);
-      if (!points_encoder.EncodePoints(point_vector.begin(), point_vector.end(),
-                                       num_bits, out_buffer))
-        return false;
-      break;
-    }
-    case 4: {
-      DynamicIntegerPointsKdTreeEncoder<4> points_encoder(num_components_);
-      if (!points_encoder.EncodePoints(point_vector.begin(), point_vector.end(),
-                                       num_bits, out_buffer))
-        return false;
-      break;
-    }
-    case 3: {
-      DynamicIntegerPointsKdTreeEncoder<3> points_encoder(num_components_);
-      if (!points_encoder.EncodePoints(point_vector.begin(), point_vector.end(),
-                                       num_bits, out_buffer))
-        return false;
-      break;
-    }
-    case 2: {
-      DynamicIntegerPointsKdTreeEncoder<2> points_encoder(num_components_);
-      if (!points_encoder.EncodePoints(point_vector.begin(), point_vector.end(),
-                                       num_bits, out_buffer))
-        return false;
-      break;
-    }
-    case 1: {
-      DynamicIntegerPointsKdTreeEncoder<1> points_encoder(num_components_);
-      if (!points_encoder.EncodePoints(point_vector.begin(), point_vector.end(),
-                                       num_bits, out_buffer))
-        return false;
-      break;
-    }
-    case 0: {
-      DynamicIntegerPointsKdTreeEncoder<0> points_encoder(num_components_);
-      if (!points_encoder.EncodePoints(point_vector.begin(), point_vector.end(),
-                                       num_bits, out_buffer))
-        return false;
-      break;
-    }
+    case 6:
+      return EncodePointsWithKdTree<6>(&point_vector, num_components_, num_bits,
+                                       subtree_depth, encoder()->thread_pool(),
+                                       out_buffer);
+    case 5:
+      return EncodePointsWithKdTree<5>(&point_vector, num_components_, num_bits,
+                                       subtree_depth, encoder()->thread_pool(),
+                                       out_buffer);
+    case 4:
+      return EncodePointsWithKdTree<4>(&point_vector, num_components_, num_bits,
+                                       subtree_depth, encoder()->thread_pool(),
+                                       out_buffer);
+    case 3:
+      return EncodePointsWithKdTree<3>(&point_vector, num_components_, num_bits,
+                                       subtree_depth, encoder()->thread_pool(),
+                                       out_buffer);
+    case 2:
+      return EncodePointsWithKdTree<2>(&point_vector, num_components_, num_bits,
+                                       subtree_depth, encoder()->thread_pool(),
+                                       out_buffer);
+    case 1:
+      return EncodePointsWithKdTree<1>(&point_vector, num_components_, num_bits,
+                                       subtree_depth, encoder()->thread_pool(),
+                                       out_buffer);
+    case 0:
+      return EncodePointsWithKdTree<0>(&point_vector, num_components_, num_bits,
+                                       subtree_depth, encoder()->thread_pool(),
+                                       out_buffer);
     // Compression level and/or encoding speed seem wrong.
     default:
       return false;
   }
-  return true;
 }
 
 }  // namespace draco
@@ -31,7 +31,17 @@ struct MeshAttributeIndicesEncodingData {
     vertex_to_encoded_attribute_value_index_map.resize(num_vertices);
 
     // We expect to store one value for each vertex.
+    encoded_attribute_value_index_to_corner_map.clear();
     encoded_attribute_value_index_to_corner_map.reserve(num_vertices);
+    num_values = 0;
+  }
+
+  // Returns the number of bytes reserved by the encoding data.
+  size_t ComputeAllocatedSize() const {
+    return encoded_attribute_value_index_to_corner_map.capacity() *
+               sizeof(CornerIndex) +
+           vertex_to_encoded_attribute_value_index_map.capacity() *
+               sizeof(int32_t);
   }
 
   // Array for storing the corner ids in the order their associated attribute
@@ -0,0 +1,408 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/attributes/normal_compression_utils.h"
+
+// The batch functions process four values at once with SSE2 which is always
+// available on x86-64. Other platforms use the per-value functions.
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DRACO_NORMAL_COMPRESSION_SSE2
+#endif
+
+namespace draco {
+
+namespace {
+
+// Returns the number of quarter turns that rotate point (|s|, |t|) to the
+// bottom left quadrant. See the canonicalized normal octahedron transform.
+int32_t GetRotationCount(int32_t s, int32_t t) {
+  if (s == 0) {
+    if (t == 0)
+      return 0;
+    return t > 0 ? 3 : 1;
+  }
+  if (s > 0)
+    return t >= 0 ? 2 : 1;
+  return t <= 0 ? 0 : 3;
+}
+
+void RotatePoint(int32_t rotation_count, int32_t *s, int32_t *t) {
+  const int32_t in_s = *s;
+  const int32_t in_t = *t;
+  switch (rotation_count) {
+    case 1:
+      *s = in_t;
+      *t = -in_s;
+      break;
+    case 2:
+      *s = -in_s;
+      *t = -in_t;
+      break;
+    case 3:
+      *s = -in_t;
+      *t = in_s;
+      break;
+    default:
+      break;
+  }
+}
+
+// Per-value version of OctahedronToolBox::ComputeOriginalOctahedralCoords().
+void ComputeOriginalOctahedralCoord(const OctahedronToolBox &tool_box,
+                                    const int32_t *pred_coords,
+                                    const int32_t *corr_coords,
+                                    bool canonicalized, int32_t *out_coords) {
+  const int32_t center_value = tool_box.center_value();
+  int32_t s = pred_coords[0] - center_value;
+  int32_t t = pred_coords[1] - center_value;
+  const bool pred_is_in_diamond = tool_box.IsInDiamond(s, t);
+  if (!pred_is_in_diamond) {
+    tool_box.InvertDiamond(&s, &t);
+  }
+  // Predictions in the bottom left quadrant have zero rotation count.
+  const int32_t rotation_count = canonicalized ? GetRotationCount(s, t) : 0;
+  RotatePoint(rotation_count, &s, &t);
+  s = tool_box.ModMax(s + corr_coords[0]);
+  t = tool_box.ModMax(t + corr_coords[1]);
+  RotatePoint((4 - rotation_count) % 4, &s, &t);
+  if (!pred_is_in_diamond) {
+    tool_box.InvertDiamond(&s, &t);
+  }
+  out_coords[0] = s + center_value;
+  out_coords[1] = t + center_value;
+}
+
+#ifdef DRACO_NORMAL_COMPRESSION_SSE2
+// Helpers for branch-free processing of four values. Masks are represented by
+// lanes with all bits set.
+
+// Returns lanes of |a| where |mask| is set and lanes of |b| elsewhere.
+inline __m128i Select(__m128i mask, __m128i a, __m128i b) {
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+inline __m128i Not(__m128i mask) {
+  return _mm_xor_si128(mask, _mm_set1_epi32(-1));
+}
+
+inline __m128i Abs(__m128i x) {
+  const __m128i sign = _mm_srai_epi32(x, 31);
+  return _mm_sub_epi32(_mm_xor_si128(x, sign), sign);
+}
+
+// Negates lanes of |x| where |mask| is set.
+inline __m128i NegateIf(__m128i mask, __m128i x) {
+  return _mm_sub_epi32(_mm_xor_si128(x, mask), mask);
+}
+
+// Divides |x| by two rounding towards zero like the integer division.
+inline __m128i HalveTowardsZero(__m128i x) {
+  return _mm_srai_epi32(_mm_add_epi32(x, _mm_srli_epi32(x, 31)), 1);
+}
+
+// Constants of the OctahedronToolBox broadcast to all lanes.
+struct OctahedronConstantsSse2 {
+  explicit OctahedronConstantsSse2(const OctahedronToolBox &tool_box)
+      : center_value(_mm_set1_epi32(tool_box.center_value())),
+        neg_center_value(_mm_set1_epi32(-tool_box.center_value())),
+        max_value(_mm_set1_epi32(tool_box.max_value())),
+        max_quantized_value(_mm_set1_epi32(tool_box.max_quantized_value())) {}
+  __m128i center_value;
+  __m128i neg_center_value;
+  __m128i max_value;
+  __m128i max_quantized_value;
+};
+
+// See OctahedronToolBox::CanonicalizeOctahedralCoords().
+void CanonicalizeOctahedralCoordsSse2(const OctahedronConstantsSse2 &k,
+                                      __m128i *s, __m128i *t) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i s_is_zero = _mm_cmpeq_epi32(*s, zero);
+  const __m128i s_is_max = _mm_cmpeq_epi32(*s, k.max_value);
+  const __m128i t_is_zero = _mm_cmpeq_epi32(*t, zero);
+  const __m128i t_is_max = _mm_cmpeq_epi32(*t, k.max_value);
+  const __m128i is_corner = _mm_or_si128(
+      _mm_and_si128(s_is_zero, _mm_or_si128(t_is_zero, t_is_max)),
+      _mm_and_si128(s_is_max, t_is_zero));
+  // Apart from the corners, at most one of the coordinates lies on an edge
+  // and it is mirrored around the center.
+  const __m128i mirror_t = _mm_andnot_si128(
+      is_corner,
+      _mm_or_si128(
+          _mm_and_si128(s_is_zero, _mm_cmpgt_epi32(*t, k.center_value)),
+          _mm_and_si128(s_is_max, _mm_cmplt_epi32(*t, k.center_value))));
+  const __m128i mirror_s = _mm_andnot_si128(
+      is_corner,
+      _mm_or_si128(
+          _mm_and_si128(t_is_max, _mm_cmplt_epi32(*s, k.center_value)),
+          _mm_and_si128(t_is_zero, _mm_cmpgt_epi32(*s, k.center_value))));
+  const __m128i twice_center = _mm_add_epi32(k.center_value, k.center_value);
+  *s = Select(is_corner, k.max_value,
+              Select(mirror_s, _mm_sub_epi32(twice_center, *s), *s));
+  *t = Select(is_corner, k.max_value,
+              Select(mirror_t, _mm_sub_epi32(twice_center, *t), *t));
+}
+
+// See OctahedronToolBox::InvertDiamond().
+void InvertDiamondSse2(const OctahedronConstantsSse2 &k, __m128i *s,
+                       __m128i *t) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i both_non_negative = Not(_mm_or_si128(
+      _mm_cmplt_epi32(*s, zero), _mm_cmplt_epi32(*t, zero)));
+  const __m128i sign_s_positive =
+      _mm_or_si128(both_non_negative, _mm_cmpgt_epi32(*s, zero));
+  const __m128i sign_t_positive =
+      _mm_or_si128(both_non_negative, _mm_cmpgt_epi32(*t, zero));
+  const __m128i corner_point_s =
+      Select(sign_s_positive, k.center_value, k.neg_center_value);
+  const __m128i corner_point_t =
+      Select(sign_t_positive, k.center_value, k.neg_center_value);
+  const __m128i s2 = _mm_sub_epi32(_mm_add_epi32(*s, *s), corner_point_s);
+  const __m128i t2 = _mm_sub_epi32(_mm_add_epi32(*t, *t), corner_point_t);
+  // The coordinates are swapped and negated when both signs are equal.
+  const __m128i same_sign = _mm_cmpeq_epi32(sign_s_positive, sign_t_positive);
+  *s = HalveTowardsZero(
+      _mm_add_epi32(NegateIf(same_sign, t2), corner_point_s));
+  *t = HalveTowardsZero(
+      _mm_add_epi32(NegateIf(same_sign, s2), corner_point_t));
+}
+
+// See OctahedronToolBox::ModMax().
+inline __m128i ModMaxSse2(const OctahedronConstantsSse2 &k, __m128i x) {
+  x = _mm_sub_epi32(x, _mm_and_si128(_mm_cmpgt_epi32(x, k.center_value),
+                                     k.max_quantized_value));
+  return _mm_add_epi32(x, _mm_and_si128(_mm_cmplt_epi32(x, k.neg_center_value),
+                                        k.max_quantized_value));
+}
+
+// Rotates the points by one, two or three quarter turns in lanes where
+// |rotate_1|, |rotate_2| or |rotate_3| is set, respectively.
+void RotatePointsSse2(__m128i rotate_1, __m128i rotate_2, __m128i rotate_3,
+                      __m128i *s, __m128i *t) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i neg_s = _mm_sub_epi32(zero, *s);
+  const __m128i neg_t = _mm_sub_epi32(zero, *t);
+  const __m128i out_s = Select(
+      rotate_1, *t, Select(rotate_2, neg_s, Select(rotate_3, neg_t, *s)));
+  *t = Select(rotate_1, neg_s,
+              Select(rotate_2, neg_t, Select(rotate_3, *s, *t)));
+  *s = out_s;
+}
+
+// Stores four s, t pairs to |out_coords|.
+inline void StoreOctahedralCoordsSse2(__m128i s, __m128i t,
+                                      int32_t *out_coords) {
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(out_coords),
+                   _mm_unpacklo_epi32(s, t));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(out_coords + 4),
+                   _mm_unpackhi_epi32(s, t));
+}
+
+// Loads four s, t pairs from |in_coords|.
+inline void LoadOctahedralCoordsSse2(const int32_t *in_coords, __m128i *s,
+                                     __m128i *t) {
+  const __m128 a = _mm_castsi128_ps(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(in_coords)));
+  const __m128 b = _mm_castsi128_ps(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(in_coords + 4)));
+  *s = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+  *t = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+#endif  // DRACO_NORMAL_COMPRESSION_SSE2
+
+}  // namespace
+
+void OctahedronToolBox::IntegerVectorsToQuantizedOctahedralCoords(
+    const int32_t *int_vecs, int num_vectors, int32_t *out_coords) const {
+  int i = 0;
+#ifdef DRACO_NORMAL_COMPRESSION_SSE2
+  const OctahedronConstantsSse2 k(*this);
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 4 <= num_vectors; i += 4) {
+    const int32_t *const v = int_vecs + 3 * i;
+    const __m128i x = _mm_setr_epi32(v[0], v[3], v[6], v[9]);
+    const __m128i y = _mm_setr_epi32(v[1], v[4], v[7], v[10]);
+    const __m128i z = _mm_setr_epi32(v[2], v[5], v[8], v[11]);
+    const __m128i abs_y = Abs(y);
+    const __m128i abs_z = Abs(z);
+    const __m128i right_hemisphere = Not(_mm_cmplt_epi32(x, zero));
+    const __m128i left_s = Select(_mm_cmplt_epi32(y, zero), abs_z,
+                                  _mm_sub_epi32(k.max_value, abs_z));
+    const __m128i left_t = Select(_mm_cmplt_epi32(z, zero), abs_y,
+                                  _mm_sub_epi32(k.max_value, abs_y));
+    __m128i s =
+        Select(right_hemisphere, _mm_add_epi32(y, k.center_value), left_s);
+    __m128i t =
+        Select(right_hemisphere, _mm_add_epi32(z, k.center_value), left_t);
+    CanonicalizeOctahedralCoordsSse2(k, &s, &t);
+    StoreOctahedralCoordsSse2(s, t, out_coords + 2 * i);
+  }
+#endif
+  for (; i < num_vectors; ++i) {
+    IntegerVectorToQuantizedOctahedralCoords(
+        int_vecs + 3 * i, out_coords + 2 * i, out_coords + 2 * i + 1);
+  }
+}
+
+void OctahedronToolBox::QuantizedOctahedralCoordsToUnitVectors(
+    const int32_t *in_coords, int num_values, float *out_vectors) const {
+  int i = 0;
+#ifdef DRACO_NORMAL_COMPRESSION_SSE2
+  // All operations below are evaluated in single precision in the same order
+  // as in OctaherdalCoordsToUnitVector(). The double precision operations of
+  // the per-value function round to the same results.
+  const float scale = 1.0 / static_cast<float>(max_value_);
+  // The squared norm is compared to 1e-6 in double precision, which is
+  // equivalent to a comparison with the smallest float above 1e-6.
+  float min_norm_squared = 1e-6f;
+  if (min_norm_squared < 1e-6)
+    min_norm_squared = std::nextafter(min_norm_squared, 1.f);
+  const __m128 scale_v = _mm_set1_ps(scale);
+  const __m128 min_norm_squared_v = _mm_set1_ps(min_norm_squared);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 neg_half = _mm_set1_ps(-0.5f);
+  const __m128 one_and_half = _mm_set1_ps(1.5f);
+  const __m128 one = _mm_set1_ps(1.f);
+  const __m128 two = _mm_set1_ps(2.f);
+  const __m128 three = _mm_set1_ps(3.f);
+  const __m128 sign_bit = _mm_set1_ps(-0.f);
+  // Each block stores four floats per vector so the last vector is always
+  // processed by the per-value function.
+  for (; i + 4 < num_values; i += 4) {
+    __m128i in_s_int, in_t_int;
+    LoadOctahedralCoordsSse2(in_coords + 2 * i, &in_s_int, &in_t_int);
+    const __m128 in_s = _mm_mul_ps(_mm_cvtepi32_ps(in_s_int), scale_v);
+    const __m128 in_t = _mm_mul_ps(_mm_cvtepi32_ps(in_t_int), scale_v);
+    __m128 spt = _mm_add_ps(in_s, in_t);
+    __m128 smt = _mm_sub_ps(in_s, in_t);
+    const __m128 right_hemisphere =
+        _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(spt, half),
+                              _mm_cmple_ps(spt, one_and_half)),
+                   _mm_and_ps(_mm_cmpge_ps(smt, neg_half),
+                              _mm_cmple_ps(smt, half)));
+    // Points on the left hemisphere are flipped to the right one.
+    const __m128 case_1 = _mm_cmple_ps(spt, half);
+    const __m128 case_2 =
+        _mm_andnot_ps(case_1, _mm_cmpge_ps(spt, one_and_half));
+    const __m128 case_3 = _mm_andnot_ps(_mm_or_ps(case_1, case_2),
+                                        _mm_cmple_ps(smt, neg_half));
+    const __m128 left_s = Select(
+        case_1, _mm_sub_ps(half, in_t),
+        Select(case_2, _mm_sub_ps(one_and_half, in_t),
+               Select(case_3, _mm_sub_ps(in_t, half), _mm_add_ps(in_t, half))));
+    const __m128 left_t = Select(
+        case_1, _mm_sub_ps(half, in_s),
+        Select(case_2, _mm_sub_ps(one_and_half, in_s),
+               Select(case_3, _mm_add_ps(in_s, half), _mm_sub_ps(in_s, half))));
+    const __m128 s = Select(right_hemisphere, in_s, left_s);
+    const __m128 t = Select(right_hemisphere, in_t, left_t);
+    spt = _mm_add_ps(s, t);
+    smt = _mm_sub_ps(s, t);
+    const __m128 y = _mm_sub_ps(_mm_mul_ps(two, s), one);
+    const __m128 z = _mm_sub_ps(_mm_mul_ps(two, t), one);
+    const __m128 twice_spt = _mm_mul_ps(two, spt);
+    const __m128 twice_smt = _mm_mul_ps(two, smt);
+    __m128 x = _mm_min_ps(
+        _mm_min_ps(_mm_sub_ps(twice_spt, one), _mm_sub_ps(three, twice_spt)),
+        _mm_min_ps(_mm_add_ps(twice_smt, one), _mm_sub_ps(one, twice_smt)));
+    x = _mm_xor_ps(x, _mm_andnot_ps(right_hemisphere, sign_bit));
+    // Normalize the computed vectors. Vectors with too small norm are zero.
+    const __m128 norm_squared = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+    const __m128 is_valid = _mm_cmpge_ps(norm_squared, min_norm_squared_v);
+    const __m128 d = _mm_div_ps(one, _mm_sqrt_ps(norm_squared));
+    __m128 out_x = _mm_and_ps(is_valid, _mm_mul_ps(x, d));
+    __m128 out_y = _mm_and_ps(is_valid, _mm_mul_ps(y, d));
+    __m128 out_z = _mm_and_ps(is_valid, _mm_mul_ps(z, d));
+    __m128 out_w = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(out_x, out_y, out_z, out_w);
+    float *const out = out_vectors + 3 * i;
+    _mm_storeu_ps(out, out_x);
+    _mm_storeu_ps(out + 3, out_y);
+    _mm_storeu_ps(out + 6, out_z);
+    _mm_storeu_ps(out + 9, out_w);
+  }
+#endif
+  for (; i < num_values; ++i) {
+    QuantizedOctaherdalCoordsToUnitVector(in_coords[2 * i],
+                                          in_coords[2 * i + 1],
+                                          out_vectors + 3 * i);
+  }
+}
+
+void OctahedronToolBox::ComputeOriginalOctahedralCoords(
+    const int32_t *pred_coords, const int32_t *corr_coords, int num_values,
+    bool canonicalized, int32_t *out_coords) const {
+  int i = 0;
+#ifdef DRACO_NORMAL_COMPRESSION_SSE2
+  const OctahedronConstantsSse2 k(*this);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i no_rotation = zero;
+  for (; i + 4 <= num_values; i += 4) {
+    __m128i s, t, corr_s, corr_t;
+    LoadOctahedralCoordsSse2(pred_coords + 2 * i, &s, &t);
+    LoadOctahedralCoordsSse2(corr_coords + 2 * i, &corr_s, &corr_t);
+    s = _mm_sub_epi32(s, k.center_value);
+    t = _mm_sub_epi32(t, k.center_value);
+    const __m128i pred_is_outside_diamond =
+        _mm_cmpgt_epi32(_mm_add_epi32(Abs(s), Abs(t)), k.center_value);
+    __m128i inverted_s = s, inverted_t = t;
+    InvertDiamondSse2(k, &inverted_s, &inverted_t);
+    s = Select(pred_is_outside_diamond, inverted_s, s);
+    t = Select(pred_is_outside_diamond, inverted_t, t);
+
+    // Rotation of the prediction to the bottom left quadrant. See
+    // GetRotationCount() for the individual cases.
+    __m128i rotate_1 = no_rotation, rotate_2 = no_rotation,
+            rotate_3 = no_rotation;
+    if (canonicalized) {
+      const __m128i s_is_positive = _mm_cmpgt_epi32(s, zero);
+      const __m128i s_is_negative = _mm_cmplt_epi32(s, zero);
+      const __m128i t_is_positive = _mm_cmpgt_epi32(t, zero);
+      const __m128i t_is_negative = _mm_cmplt_epi32(t, zero);
+      rotate_1 = _mm_andnot_si128(s_is_negative, t_is_negative);
+      rotate_2 = _mm_andnot_si128(t_is_negative, s_is_positive);
+      rotate_3 = _mm_andnot_si128(s_is_positive, t_is_positive);
+      RotatePointsSse2(rotate_1, rotate_2, rotate_3, &s, &t);
+    }
+    s = ModMaxSse2(k, _mm_add_epi32(s, corr_s));
+    t = ModMaxSse2(k, _mm_add_epi32(t, corr_t));
+    if (canonicalized) {
+      RotatePointsSse2(rotate_3, rotate_2, rotate_1, &s, &t);
+    }
+
+    inverted_s = s;
+    inverted_t = t;
+    InvertDiamondSse2(k, &inverted_s, &inverted_t);
+    s = Select(pred_is_outside_diamond, inverted_s, s);
+    t = Select(pred_is_outside_diamond, inverted_t, t);
+    StoreOctahedralCoordsSse2(_mm_add_epi32(s, k.center_value),
+                              _mm_add_epi32(t, k.center_value),
+                              out_coords + 2 * i);
+  }
+#endif
+  for (; i < num_values; ++i) {
+    ComputeOriginalOctahedralCoord(*this, pred_coords + 2 * i,
+                                   corr_coords + 2 * i, canonicalized,
+                                   out_coords + 2 * i);
+  }
+}
+
+}  // namespace draco
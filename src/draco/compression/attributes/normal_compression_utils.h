@@ -247,6 +247,30 @@ class OctahedronToolBox {
     OctaherdalCoordsToUnitVector(in_s * scale, in_t * scale, out_vector);
   }
 
+  // Batch version of IntegerVectorToQuantizedOctahedralCoords(). Converts
+  // |num_vectors| integer vectors stored in |int_vecs| as x, y, z triplets to
+  // octahedral coordinates stored in |out_coords| as s, t pairs.
+  void IntegerVectorsToQuantizedOctahedralCoords(const int32_t *int_vecs,
+                                                 int num_vectors,
+                                                 int32_t *out_coords) const;
+
+  // Batch version of QuantizedOctaherdalCoordsToUnitVector<float>(). Converts
+  // |num_values| s, t pairs from |in_coords| to unit vectors stored in
+  // |out_vectors| as x, y, z triplets. The output is bit-identical to the
+  // per-value conversion.
+  void QuantizedOctahedralCoordsToUnitVectors(const int32_t *in_coords,
+                                              int num_values,
+                                              float *out_vectors) const;
+
+  // Computes original octahedral coordinates from predicted coordinates
+  // |pred_coords| and corrections |corr_coords| for |num_values| s, t pairs.
+  // This is the inverse of the normal octahedron prediction scheme transform,
+  // or of the canonicalized transform when |canonicalized| is true.
+  void ComputeOriginalOctahedralCoords(const int32_t *pred_coords,
+                                       const int32_t *corr_coords,
+                                       int num_values, bool canonicalized,
+                                       int32_t *out_coords) const;
+
   // |s| and |t| are expected to be signed values.
   inline bool IsInDiamond(const int32_t &s, const int32_t &t) const {
     // Expect center already at origin.
@@ -0,0 +1,162 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/attributes/normal_compression_utils.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "draco/compression/attributes/prediction_schemes/prediction_scheme_normal_octahedron_canonicalized_decoding_transform.h"
+#include "draco/compression/attributes/prediction_schemes/prediction_scheme_normal_octahedron_decoding_transform.h"
+#include "draco/core/draco_test_base.h"
+#include "draco/core/encoder_buffer.h"
+
+namespace draco {
+
+class NormalCompressionUtilsTest : public ::testing::Test {
+ protected:
+  // Initializes a decoding |transform| for |quantization_bits|.
+  template <class TransformT>
+  bool InitTransform(int quantization_bits, TransformT *transform) const {
+    const int32_t max_quantized_value = (1 << quantization_bits) - 1;
+    const int32_t center_value = (max_quantized_value - 1) / 2;
+    EncoderBuffer buffer;
+    buffer.Encode(max_quantized_value);
+    buffer.Encode(center_value);
+    DecoderBuffer dec_buffer;
+    dec_buffer.Init(buffer.data(), buffer.size());
+    return transform->DecodeTransformData(&dec_buffer);
+  }
+
+  // Verifies that the batch transform produces the same values as the
+  // per-value transform for all valid predictions and corrections.
+  template <class TransformT>
+  void TestTransform(int quantization_bits) {
+    TransformT transform;
+    ASSERT_TRUE(InitTransform(quantization_bits, &transform));
+    const int32_t max_value = transform.max_quantized_value() - 1;
+    std::vector<int32_t> pred_vals, corr_vals;
+    for (int32_t ps = 0; ps <= max_value; ++ps) {
+      for (int32_t pt = 0; pt <= max_value; ++pt) {
+        for (int32_t cs = 0; cs <= max_value; ++cs) {
+          for (int32_t ct = 0; ct <= max_value; ++ct) {
+            pred_vals.insert(pred_vals.end(), {ps, pt});
+            corr_vals.insert(corr_vals.end(), {cs, ct});
+          }
+        }
+      }
+    }
+    const int num_values = static_cast<int>(pred_vals.size() / 2);
+    // Odd number of values to test the processing of the remaining values.
+    std::vector<int32_t> out_vals(2 * num_values);
+    transform.ComputeOriginalValues(pred_vals.data(), corr_vals.data(),
+                                    num_values - 1, out_vals.data());
+    transform.ComputeOriginalValues(
+        pred_vals.data() + 2 * (num_values - 1),
+        corr_vals.data() + 2 * (num_values - 1), 1,
+        out_vals.data() + 2 * (num_values - 1));
+    for (int i = 0; i < 2 * num_values; i += 2) {
+      int32_t expected_vals[2];
+      transform.ComputeOriginalValue(&pred_vals[i], &corr_vals[i],
+                                     expected_vals);
+      ASSERT_EQ(out_vals[i], expected_vals[0]);
+      ASSERT_EQ(out_vals[i + 1], expected_vals[1]);
+    }
+  }
+};
+
+TEST_F(NormalCompressionUtilsTest, TestIntegerVectorsToOctahedralCoords) {
+  for (int quantization_bits : {2, 3, 4, 8}) {
+    OctahedronToolBox tool_box;
+    ASSERT_TRUE(tool_box.SetQuantizationBits(quantization_bits));
+    const int32_t center_value = tool_box.center_value();
+    // All integer vectors with abs sum equal to the center value.
+    std::vector<int32_t> int_vecs;
+    for (int32_t x = -center_value; x <= center_value; ++x) {
+      const int32_t max_y = center_value - std::abs(x);
+      for (int32_t y = -max_y; y <= max_y; ++y) {
+        const int32_t z = max_y - std::abs(y);
+        int_vecs.insert(int_vecs.end(), {x, y, z});
+        if (z != 0) {
+          int_vecs.insert(int_vecs.end(), {x, y, -z});
+        }
+      }
+    }
+    const int num_vectors = static_cast<int>(int_vecs.size() / 3);
+    std::vector<int32_t> coords(2 * num_vectors);
+    tool_box.IntegerVectorsToQuantizedOctahedralCoords(
+        int_vecs.data(), num_vectors, coords.data());
+    for (int i = 0; i < num_vectors; ++i) {
+      int32_t s, t;
+      tool_box.IntegerVectorToQuantizedOctahedralCoords(&int_vecs[3 * i], &s,
+                                                        &t);
+      ASSERT_EQ(coords[2 * i], s);
+      ASSERT_EQ(coords[2 * i + 1], t);
+    }
+  }
+}
+
+TEST_F(NormalCompressionUtilsTest, TestOctahedralCoordsToUnitVectors) {
+  std::mt19937 gen(7);
+  for (int quantization_bits : {2, 3, 8, 12, 20, 30}) {
+    OctahedronToolBox tool_box;
+    ASSERT_TRUE(tool_box.SetQuantizationBits(quantization_bits));
+    const int32_t max_value = tool_box.max_value();
+    std::vector<int32_t> coords;
+    if (quantization_bits <= 8) {
+      for (int32_t s = 0; s <= max_value; ++s) {
+        for (int32_t t = 0; t <= max_value; ++t) {
+          coords.insert(coords.end(), {s, t});
+        }
+      }
+    } else {
+      std::uniform_int_distribution<int32_t> dist(0, max_value);
+      for (int i = 0; i < 100001; ++i) {
+        coords.insert(coords.end(), {dist(gen), dist(gen)});
+      }
+      // Points on the edges of the diamond.
+      const int32_t center_value = tool_box.center_value();
+      for (int32_t v : {0, 1, center_value - 1, center_value, center_value + 1,
+                        max_value - 1, max_value}) {
+        coords.insert(coords.end(), {v, 0, v, max_value, 0, v, max_value, v,
+                                     v, center_value, center_value, v});
+      }
+    }
+    const int num_values = static_cast<int>(coords.size() / 2);
+    std::vector<float> vectors(3 * num_values);
+    tool_box.QuantizedOctahedralCoordsToUnitVectors(coords.data(), num_values,
+                                                    vectors.data());
+    for (int i = 0; i < num_values; ++i) {
+      float expected_vector[3];
+      tool_box.QuantizedOctaherdalCoordsToUnitVector(
+          coords[2 * i], coords[2 * i + 1], expected_vector);
+      // The values must be bit-identical.
+      ASSERT_EQ(memcmp(&vectors[3 * i], expected_vector, sizeof(float) * 3), 0)
+          << "s: " << coords[2 * i] << " t: " << coords[2 * i + 1];
+    }
+  }
+}
+
+TEST_F(NormalCompressionUtilsTest, TestBatchTransforms) {
+  TestTransform<PredictionSchemeNormalOctahedronDecodingTransform<int32_t>>(4);
+  TestTransform<
+      PredictionSchemeNormalOctahedronCanonicalizedDecodingTransform<int32_t>>(
+      4);
+  TestTransform<
+      PredictionSchemeNormalOctahedronCanonicalizedDecodingTransform<int32_t>>(
+      5);
+}
+
+}  // namespace draco
@@ -15,6 +15,10 @@
 #ifndef DRACO_COMPRESSION_ATTRIBUTES_PREDICTION_SCHEMES_MESH_PREDICTION_SCHEME_GEOMETRIC_NORMAL_DECODER_H_
 #define DRACO_COMPRESSION_ATTRIBUTES_PREDICTION_SCHEMES_MESH_PREDICTION_SCHEME_GEOMETRIC_NORMAL_DECODER_H_
 
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
 #include "draco/draco_features.h"
 
 #include "draco/compression/attributes/prediction_schemes/mesh_prediction_scheme_decoder.h"
@@ -82,6 +86,27 @@ class MeshPredictionSchemeGeometricNormalDecoder
   }
 
  private:
+  // Normal octahedron transforms have a batch version of
+  // ComputeOriginalValue().
+  typedef std::integral_constant<
+      bool, TransformT::GetType() == PREDICTION_TRANSFORM_NORMAL_OCTAHEDRON ||
+                TransformT::GetType() ==
+                    PREDICTION_TRANSFORM_NORMAL_OCTAHEDRON_CANONICALIZED>
+      HasBatchTransform;
+
+  void TransformValues(const int32_t *pred_vals, const CorrType *in_corr,
+                       int num_values, DataTypeT *out_data, std::true_type) {
+    this->transform().ComputeOriginalValues(pred_vals, in_corr, num_values,
+                                            out_data);
+  }
+  void TransformValues(const int32_t *pred_vals, const CorrType *in_corr,
+                       int num_values, DataTypeT *out_data, std::false_type) {
+    for (int i = 0; i < 2 * num_values; i += 2) {
+      this->transform().ComputeOriginalValue(pred_vals + i, in_corr + i,
+                                             out_data + i);
+    }
+  }
+
   MeshPredictionSchemeGeometricNormalPredictorArea<DataTypeT, TransformT,
                                                    MeshDataT>
       predictor_;
@@ -107,7 +132,7 @@ bool MeshPredictionSchemeGeometricNormalDecoder<
       static_cast<int>(this->mesh_data().data_to_corner_map()->size());
 
   VectorD<int32_t, 3> pred_normal_3d;
-  int32_t pred_normal_oct[2];
+  std::vector<int32_t> pred_normals(3 * corner_map_size);
 
   for (int data_id = 0; data_id < corner_map_size; ++data_id) {
     const CornerIndex corner_id =
@@ -121,14 +146,18 @@ bool MeshPredictionSchemeGeometricNormalDecoder<
     if (flip_normal_bit_decoder_.DecodeNextBit()) {
       pred_normal_3d = -pred_normal_3d;
     }
-    octahedron_tool_box_.IntegerVectorToQuantizedOctahedralCoords(
-        pred_normal_3d.data(), pred_normal_oct, pred_normal_oct + 1);
-
-    const int data_offset = data_id * 2;
-    this->transform().ComputeOriginalValue(
-        pred_normal_oct, in_corr + data_offset, out_data + data_offset);
+    std::copy(pred_normal_3d.data(), pred_normal_3d.data() + 3,
+              &pred_normals[3 * data_id]);
   }
   flip_normal_bit_decoder_.EndDecoding();
+
+  // The predictions do not depend on the decoded values so all of them are
+  // converted to octahedral coordinates and corrected at once.
+  std::vector<int32_t> pred_normals_oct(2 * corner_map_size);
+  octahedron_tool_box_.IntegerVectorsToQuantizedOctahedralCoords(
+      pred_normals.data(), corner_map_size, pred_normals_oct.data());
+  TransformValues(pred_normals_oct.data(), in_corr, corner_map_size, out_data,
+                  HasBatchTransform());
   return true;
 }
 
@@ -143,7 +172,8 @@ bool MeshPredictionSchemeGeometricNormalDecoder<
 #ifdef DRACO_BACKWARDS_COMPATIBILITY_SUPPORTED
   if (buffer->bitstream_version() < DRACO_BITSTREAM_VERSION(2, 2)) {
     uint8_t prediction_mode;
-    buffer->Decode(&prediction_mode);
+    if (!buffer->Decode(&prediction_mode))
+      return false;
 
     if (!predictor_.SetNormalPredictionMode(
             NormalPredictionMode(prediction_mode)))
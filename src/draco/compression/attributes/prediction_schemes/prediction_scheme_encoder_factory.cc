@@ -57,6 +57,26 @@ PredictionSchemeMethod SelectPredictionMethod(
   return PREDICTION_DIFFERENCE;
 }
 
+std::vector<PredictionSchemeMethod> GetPredictionMethodCandidates(
+    int att_id, const PointCloudEncoder *encoder) {
+  std::vector<PredictionSchemeMethod> methods;
+  methods.push_back(PREDICTION_DIFFERENCE);
+  if (encoder->GetGeometryType() != TRIANGULAR_MESH)
+    return methods;  // Other methods require mesh connectivity.
+  const PointAttribute *const att = encoder->point_cloud()->attribute(att_id);
+  if (att->attribute_type() == GeometryAttribute::NORMAL) {
+#ifdef DRACO_NORMAL_ENCODING_SUPPORTED
+    methods.push_back(MESH_PREDICTION_GEOMETRIC_NORMAL);
+#endif
+    return methods;
+  }
+  methods.push_back(MESH_PREDICTION_PARALLELOGRAM);
+  methods.push_back(MESH_PREDICTION_CONSTRAINED_MULTI_PARALLELOGRAM);
+  if (att->attribute_type() == GeometryAttribute::TEX_COORD)
+    methods.push_back(MESH_PREDICTION_TEX_COORDS_PORTABLE);
+  return methods;
+}
+
 // Returns the preferred prediction scheme based on the encoder options.
 PredictionSchemeMethod GetPredictionMethodFromOptions(
     int att_id, const EncoderOptions &options) {
@@ -38,6 +38,12 @@ namespace draco {
 PredictionSchemeMethod SelectPredictionMethod(int att_id,
                                               const PointCloudEncoder *encoder);
 
+// Returns all prediction methods that can be reasonably used for a given
+// attribute. Used when the prediction method is selected by comparing the
+// estimated entropy of the corrections produced by each of the methods.
+std::vector<PredictionSchemeMethod> GetPredictionMethodCandidates(
+    int att_id, const PointCloudEncoder *encoder);
+
 // Factory class for creating mesh prediction schemes.
 template <typename DataTypeT>
 struct MeshPredictionSchemeEncoderFactory {
@@ -16,6 +16,7 @@
 #define DRACO_COMPRESSION_ATTRIBUTES_PREDICTION_SCHEMES_PREDICTION_SCHEME_NORMAL_OCTAHEDRON_CANONICALIZED_DECODING_TRANSFORM_H_
 
 #include <cmath>
+#include <type_traits>
 
 #include "draco/compression/attributes/normal_compression_utils.h"
 #include "draco/compression/attributes/prediction_schemes/prediction_scheme_normal_octahedron_canonicalized_transform_base.h"
@@ -80,6 +81,17 @@ class PredictionSchemeNormalOctahedronCanonicalizedDecodingTransform
     out_orig_vals[1] = orig[1];
   }
 
+  // Computes original values of |num_values| entries at once. The result is
+  // the same as when ComputeOriginalValue() is called for each entry.
+  void ComputeOriginalValues(const DataType *pred_vals,
+                             const CorrType *corr_vals, int num_values,
+                             DataType *out_orig_vals) const {
+    static_assert(std::is_same<DataType, int32_t>::value,
+                  "Batch transform requires int32_t data.");
+    this->octahedron_tool_box().ComputeOriginalOctahedralCoords(
+        pred_vals, corr_vals, num_values, true, out_orig_vals);
+  }
+
  private:
   Point2 ComputeOriginalValue(Point2 pred, Point2 corr) const {
     const Point2 t(this->center_value(), this->center_value());
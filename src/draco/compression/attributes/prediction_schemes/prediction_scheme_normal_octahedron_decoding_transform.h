@@ -17,6 +17,7 @@
 #define DRACO_COMPRESSION_ATTRIBUTES_PREDICTION_SCHEMES_PREDICTION_SCHEME_NORMAL_OCTAHEDRON_DECODING_TRANSFORM_H_
 
 #include <cmath>
+#include <type_traits>
 
 #include "draco/draco_features.h"
 
@@ -76,6 +77,17 @@ class PredictionSchemeNormalOctahedronDecodingTransform
     out_orig_vals[1] = orig[1];
   }
 
+  // Computes original values of |num_values| entries at once. The result is
+  // the same as when ComputeOriginalValue() is called for each entry.
+  void ComputeOriginalValues(const DataType *pred_vals,
+                             const CorrType *corr_vals, int num_values,
+                             DataType *out_orig_vals) const {
+    static_assert(std::is_same<DataType, int32_t>::value,
+                  "Batch transform requires int32_t data.");
+    this->octahedron_tool_box().ComputeOriginalOctahedralCoords(
+        pred_vals, corr_vals, num_values, false, out_orig_vals);
+  }
+
  private:
   Point2 ComputeOriginalValue(Point2 pred, const Point2 &corr) const {
     const Point2 t(this->center_value(), this->center_value());
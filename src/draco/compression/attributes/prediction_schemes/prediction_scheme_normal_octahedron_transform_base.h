@@ -75,6 +75,10 @@ class PredictionSchemeNormalOctahedronTransformBase {
 
   int32_t ModMax(int32_t x) const { return octahedron_tool_box_.ModMax(x); }
 
+  const OctahedronToolBox &octahedron_tool_box() const {
+    return octahedron_tool_box_;
+  }
+
   // For correction values.
   int32_t MakePositive(int32_t x) const {
     return octahedron_tool_box_.MakePositive(x);
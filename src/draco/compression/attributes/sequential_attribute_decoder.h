@@ -56,6 +56,12 @@ class SequentialAttributeDecoder {
   int attribute_id() const { return attribute_id_; }
   PointCloudDecoder *decoder() const { return decoder_; }
 
+  // Returns the tracer of the parent decoder or nullptr when tracing is
+  // disabled.
+  Tracer *tracer() const {
+    return decoder_ == nullptr ? nullptr : decoder_->tracer();
+  }
+
  protected:
   // Should be used to initialize newly created prediction scheme.
   // Returns false when the initialization failed (in which case the scheme
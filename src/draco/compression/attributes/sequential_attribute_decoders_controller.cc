@@ -18,6 +18,8 @@
 #endif
 #include "draco/compression/attributes/sequential_quantization_attribute_decoder.h"
 #include "draco/compression/config/compression_shared.h"
+#include "draco/core/thread_pool.h"
+#include "draco/core/tracer.h"
 
 namespace draco {
 
@@ -46,10 +48,13 @@ bool SequentialAttributeDecodersController::DecodeAttributesDecoderData(
   return true;
 }
 
-bool SequentialAttributeDecodersController::DecodeAttributes(
-    DecoderBuffer *buffer) {
-  if (!sequencer_ || !sequencer_->GenerateSequence(&point_ids_))
-    return false;
+bool SequentialAttributeDecodersController::DecodePortableAttributes(
+    DecoderBuffer *in_buffer) {
+  {
+    TraceScope trace(GetDecoder()->tracer(), "GenerateSequence");
+    if (!sequencer_ || !sequencer_->GenerateSequence(&point_ids_))
+      return false;
+  }
   // Initialize point to attribute value mapping for all decoded attributes.
   const int32_t num_attributes = GetNumAttributes();
   for (int i = 0; i < num_attributes; ++i) {
@@ -58,12 +63,6 @@ bool SequentialAttributeDecodersController::DecodeAttributes(
     if (!sequencer_->UpdatePointToAttributeIndexMapping(pa))
       return false;
   }
-  return AttributesDecoder::DecodeAttributes(buffer);
-}
-
-bool SequentialAttributeDecodersController::DecodePortableAttributes(
-    DecoderBuffer *in_buffer) {
-  const int32_t num_attributes = GetNumAttributes();
   for (int i = 0; i < num_attributes; ++i) {
     if (!sequential_decoders_[i]->DecodePortableAttribute(point_ids_,
                                                           in_buffer))
@@ -85,31 +84,39 @@ bool SequentialAttributeDecodersController::
 
 bool SequentialAttributeDecodersController::
     TransformAttributesToOriginalFormat() {
-  const int32_t num_attributes = GetNumAttributes();
-  for (int i = 0; i < num_attributes; ++i) {
-    // Check whether the attribute transform should be skipped.
-    if (GetDecoder()->options()) {
-      const PointAttribute *const attribute =
-          sequential_decoders_[i]->attribute();
-      const PointAttribute *const portable_attribute =
-          sequential_decoders_[i]->GetPortableAttribute();
-      if (portable_attribute &&
-          GetDecoder()->options()->GetAttributeBool(
-              attribute->attribute_type(), "skip_attribute_transform", false)) {
-        // Attribute transform should not be performed. In this case, we replace
-        // the output geometry attribute with the portable attribute.
-        // TODO(ostava): We can potentially avoid this copy by introducing a new
-        // mechanism that would allow to use the final attributes as portable
-        // attributes for predictors that may need them.
-        sequential_decoders_[i]->attribute()->CopyFrom(*portable_attribute);
-        continue;
-      }
+  // Each attribute is transformed using only its own portable data so all
+  // attributes can be processed in parallel.
+  return ParallelFor(GetDecoder()->thread_pool(), GetNumAttributes(),
+                     [this](int i) { return TransformAttribute(i); });
+}
+
+bool SequentialAttributeDecodersController::TransformAttribute(int i) {
+  TraceScope trace(GetDecoder()->tracer(), "TransformAttribute");
+  const PointAttribute *const portable_attribute =
+      sequential_decoders_[i]->GetPortableAttribute();
+  if (portable_attribute && portable_attribute->GetAttributeTransformData() &&
+      GetDecoder()->IsPortableOnlyAttribute(GetAttributeId(i))) {
+    // The values are read directly from the portable attribute.
+    return true;
+  }
+  // Check whether the attribute transform should be skipped.
+  if (GetDecoder()->options()) {
+    const PointAttribute *const attribute =
+        sequential_decoders_[i]->attribute();
+    if (portable_attribute &&
+        GetDecoder()->options()->GetAttributeBool(
+            attribute->attribute_type(), "skip_attribute_transform", false)) {
+      // Attribute transform should not be performed. In this case, we replace
+      // the output geometry attribute with the portable attribute.
+      // TODO(ostava): We can potentially avoid this copy by introducing a new
+      // mechanism that would allow to use the final attributes as portable
+      // attributes for predictors that may need them.
+      sequential_decoders_[i]->attribute()->CopyFrom(*portable_attribute);
+      return true;
     }
-    if (!sequential_decoders_[i]->TransformAttributeToOriginalFormat(
-            point_ids_))
-      return false;
   }
-  return true;
+  return sequential_decoders_[i]->TransformAttributeToOriginalFormat(
+      point_ids_);
 }
 
 std::unique_ptr<SequentialAttributeDecoder>
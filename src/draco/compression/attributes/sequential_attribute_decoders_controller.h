@@ -33,7 +33,7 @@ class SequentialAttributeDecodersController : public AttributesDecoder {
       std::unique_ptr<PointsSequencer> sequencer);
 
   bool DecodeAttributesDecoderData(DecoderBuffer *buffer) override;
-  bool DecodeAttributes(DecoderBuffer *buffer) override;
+  bool TransformAttributesToOriginalFormat() override;
   const PointAttribute *GetPortableAttribute(
       int32_t point_attribute_id) override {
     const int32_t loc_id = GetLocalIdForPointAttribute(point_attribute_id);
@@ -45,11 +45,13 @@ class SequentialAttributeDecodersController : public AttributesDecoder {
  protected:
   bool DecodePortableAttributes(DecoderBuffer *in_buffer) override;
   bool DecodeDataNeededByPortableTransforms(DecoderBuffer *in_buffer) override;
-  bool TransformAttributesToOriginalFormat() override;
   virtual std::unique_ptr<SequentialAttributeDecoder> CreateSequentialDecoder(
       uint8_t decoder_type);
 
  private:
+  // Reverts the transform of the i-th attribute of this decoder.
+  bool TransformAttribute(int i);
+
   std::vector<std::unique_ptr<SequentialAttributeDecoder>> sequential_decoders_;
   std::vector<PointIndex> point_ids_;
   std::unique_ptr<PointsSequencer> sequencer_;
@@ -48,6 +48,10 @@ bool SequentialAttributeEncoder::EncodePortableAttribute(
   // Lossless encoding of the input values.
   if (!EncodeValues(point_ids, out_buffer))
     return false;
+  // The portable values are not needed anymore unless they are used to
+  // predict values of other attributes.
+  if (!is_parent_encoder_)
+    portable_attribute_.reset();
   return true;
 }
 
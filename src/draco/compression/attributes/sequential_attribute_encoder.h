@@ -81,6 +81,12 @@ class SequentialAttributeEncoder {
   int attribute_id() const { return attribute_id_; }
   PointCloudEncoder *encoder() const { return encoder_; }
 
+  // Returns the tracer of the parent encoder or nullptr when tracing is
+  // disabled.
+  Tracer *tracer() const {
+    return encoder_ == nullptr ? nullptr : encoder_->tracer();
+  }
+
  protected:
   // Should be used to initialize newly created prediction scheme.
   // Returns false when the initialization failed (in which case the scheme
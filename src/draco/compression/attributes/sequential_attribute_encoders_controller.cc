@@ -55,15 +55,10 @@ bool SequentialAttributeEncodersController::EncodeAttributesEncoderData(
   return true;
 }
 
-bool SequentialAttributeEncodersController::EncodeAttributes(
-    EncoderBuffer *buffer) {
-  if (!sequencer_ || !sequencer_->GenerateSequence(&point_ids_))
-    return false;
-  return AttributesEncoder::EncodeAttributes(buffer);
-}
-
 bool SequentialAttributeEncodersController::
     TransformAttributesToPortableFormat() {
+  if (!sequencer_ || !sequencer_->GenerateSequence(&point_ids_))
+    return false;
   for (uint32_t i = 0; i < sequential_encoders_.size(); ++i) {
     if (!sequential_encoders_[i]->TransformAttributeToPortableFormat(
             point_ids_))
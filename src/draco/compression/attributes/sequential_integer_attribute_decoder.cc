@@ -43,10 +43,12 @@ bool SequentialIntegerAttributeDecoder::DecodeValues(
     const std::vector<PointIndex> &point_ids, DecoderBuffer *in_buffer) {
   // Decode prediction scheme.
   int8_t prediction_scheme_method;
-  in_buffer->Decode(&prediction_scheme_method);
+  if (!in_buffer->Decode(&prediction_scheme_method))
+    return false;
   if (prediction_scheme_method != PREDICTION_NONE) {
     int8_t prediction_transform_type;
-    in_buffer->Decode(&prediction_transform_type);
+    if (!in_buffer->Decode(&prediction_transform_type))
+      return false;
     prediction_scheme_ = CreateIntPredictionScheme(
         static_cast<PredictionSchemeMethod>(prediction_scheme_method),
         static_cast<PredictionSchemeTransformType>(prediction_transform_type));
@@ -99,9 +101,14 @@ bool SequentialIntegerAttributeDecoder::DecodeIntegerValues(
     return false;
   if (compressed > 0) {
     // Decode compressed values.
-    if (!DecodeSymbols(static_cast<uint32_t>(num_values), num_components,
-                       in_buffer,
-                       reinterpret_cast<uint32_t *>(portable_attribute_data)))
+    TraceScope trace(tracer(), "DecodeSymbols", in_buffer);
+    // Standalone decoders have no parent decoder and follow the mesh versions.
+    const EncodedGeometryType geometry_type =
+        decoder() ? decoder()->GetGeometryType() : TRIANGULAR_MESH;
+    if (!DecodeSymbols(
+            static_cast<uint32_t>(num_values), num_components,
+            InterleavedSymbolCodingBitstreamVersion(geometry_type), in_buffer,
+            reinterpret_cast<uint32_t *>(portable_attribute_data)))
       return false;
   } else {
     // Decode the integer data directly.
@@ -138,6 +145,7 @@ bool SequentialIntegerAttributeDecoder::DecodeIntegerValues(
 
   // If the data was encoded with a prediction scheme, we must revert it.
   if (prediction_scheme_) {
+    TraceScope trace(tracer(), "ComputeOriginalValues", in_buffer);
     if (!prediction_scheme_->DecodePredictionData(in_buffer))
       return false;
 
@@ -14,13 +14,47 @@
 //
 #include "draco/compression/attributes/sequential_integer_attribute_encoder.h"
 
+#include <algorithm>
+
 #include "draco/compression/attributes/prediction_schemes/prediction_scheme_encoder_factory.h"
 #include "draco/compression/attributes/prediction_schemes/prediction_scheme_wrap_encoding_transform.h"
+#include "draco/compression/entropy/shannon_entropy.h"
 #include "draco/compression/entropy/symbol_encoding.h"
 #include "draco/core/bit_utils.h"
 
 namespace draco {
 
+namespace {
+
+// Returns the estimated number of bits needed to entropy encode |symbols|.
+int64_t EstimateNumSymbolBits(const std::vector<uint32_t> &symbols) {
+  uint32_t max_symbol = 0;
+  for (const uint32_t symbol : symbols) {
+    max_symbol = std::max(max_symbol, symbol);
+  }
+  const int num_symbols = static_cast<int>(symbols.size());
+  // Limits the size of the frequency table used by the estimate.
+  const uint32_t kMaxDirectSymbol = 1 << 18;
+  if (max_symbol < kMaxDirectSymbol) {
+    ShannonEntropyTracker tracker;
+    tracker.Push(symbols.data(), num_symbols);
+    return tracker.GetNumberOfDataBits() + tracker.GetNumberOfRAnsTableBits();
+  }
+  // Large symbols are estimated similarly to the tagged symbol coding, i.e.,
+  // the bit lengths are entropy coded and the remaining bits are stored raw.
+  std::vector<uint32_t> bit_lengths(symbols.size());
+  int64_t num_raw_bits = 0;
+  for (int i = 0; i < num_symbols; ++i) {
+    bit_lengths[i] =
+        symbols[i] == 0 ? 0 : MostSignificantBit(symbols[i]) + 1;
+    num_raw_bits += bit_lengths[i];
+  }
+  return ComputeShannonEntropy(bit_lengths.data(), num_symbols, 32, nullptr) +
+         num_raw_bits;
+}
+
+}  // namespace
+
 SequentialIntegerAttributeEncoder::SequentialIntegerAttributeEncoder() {}
 
 bool SequentialIntegerAttributeEncoder::Init(PointCloudEncoder *encoder,
@@ -52,11 +86,32 @@ bool SequentialIntegerAttributeEncoder::Init(PointCloudEncoder *encoder,
     prediction_scheme_ = nullptr;
   }
 
+  if (prediction_scheme_method == PREDICTION_UNDEFINED &&
+      encoder->options()->GetGlobalBool("estimate_prediction_schemes",
+                                        false)) {
+    // Create all other applicable prediction schemes. The best one is selected
+    // when the values are encoded.
+    for (const PredictionSchemeMethod method :
+         GetPredictionMethodCandidates(attribute_id, encoder)) {
+      if (prediction_scheme_ &&
+          prediction_scheme_->GetPredictionMethod() == method)
+        continue;
+      std::unique_ptr<PredictionSchemeTypedEncoderInterface<int32_t>> ps =
+          CreateIntPredictionScheme(method);
+      // Skip schemes that can't be used for the attribute.
+      if (ps == nullptr || ps->GetPredictionMethod() != method ||
+          !InitPredictionScheme(ps.get()))
+        continue;
+      candidate_prediction_schemes_.push_back(std::move(ps));
+    }
+  }
+
   return true;
 }
 
 bool SequentialIntegerAttributeEncoder::TransformAttributeToPortableFormat(
     const std::vector<PointIndex> &point_ids) {
+  TraceScope trace(tracer(), "TransformAttributeToPortableFormat");
   if (encoder()) {
     if (!PrepareValues(point_ids, encoder()->point_cloud()->num_points()))
       return false;
@@ -103,6 +158,28 @@ bool SequentialIntegerAttributeEncoder::EncodeValues(
   if (attrib->size() == 0)
     return true;
 
+  const int num_components = portable_attribute()->num_components();
+  const int num_values =
+      static_cast<int>(num_components * portable_attribute()->size());
+  const int32_t *const portable_attribute_data = GetPortableAttributeData();
+
+  // We need to keep the portable data intact, but several encoding steps can
+  // result in changes of this data, e.g., by applying prediction schemes that
+  // change the data in place. To preserve the portable data we store and
+  // process all encoded data in a separate array.
+  std::vector<int32_t> encoded_data(num_values);
+
+  // Set when the correction values and the prediction data were computed
+  // during the selection of the prediction scheme. Note that the prediction
+  // data can't be generally encoded more than once.
+  bool has_corrections = false;
+  EncoderBuffer prediction_data;
+  if (!candidate_prediction_schemes_.empty()) {
+    if (!SelectPredictionScheme(point_ids, &encoded_data, &prediction_data))
+      return false;
+    has_corrections = prediction_scheme_ != nullptr;
+  }
+
   int8_t prediction_scheme_method = PREDICTION_NONE;
   if (prediction_scheme_) {
     if (!SetPredictionSchemeParentAttributes(prediction_scheme_.get())) {
@@ -117,20 +194,10 @@ bool SequentialIntegerAttributeEncoder::EncodeValues(
         static_cast<int8_t>(prediction_scheme_->GetTransformType()));
   }
 
-  const int num_components = portable_attribute()->num_components();
-  const int num_values =
-      static_cast<int>(num_components * portable_attribute()->size());
-  const int32_t *const portable_attribute_data = GetPortableAttributeData();
-
-  // We need to keep the portable data intact, but several encoding steps can
-  // result in changes of this data, e.g., by applying prediction schemes that
-  // change the data in place. To preserve the portable data we store and
-  // process all encoded data in a separate array.
-  std::vector<int32_t> encoded_data(num_values);
-
   // All integer values are initialized. Process them using the prediction
   // scheme if we have one.
-  if (prediction_scheme_) {
+  if (prediction_scheme_ && !has_corrections) {
+    TraceScope trace(tracer(), "ComputeCorrectionValues");
     prediction_scheme_->ComputeCorrectionValues(
         portable_attribute_data, &encoded_data[0], num_values, num_components,
         point_ids.data());
@@ -151,7 +218,10 @@ bool SequentialIntegerAttributeEncoder::EncodeValues(
     if (encoder() != nullptr) {
       SetSymbolEncodingCompressionLevel(&symbol_encoding_options,
                                         10 - encoder()->options()->GetSpeed());
+      SetSymbolEncodingInterleaved(&symbol_encoding_options,
+                                   encoder()->UseInterleavedSymbolCoding());
     }
+    TraceScope trace(tracer(), "EncodeSymbols", out_buffer);
     if (!EncodeSymbols(reinterpret_cast<uint32_t *>(encoded_data.data()),
                        static_cast<int>(point_ids.size()) * num_components,
                        num_components, &symbol_encoding_options, out_buffer)) {
@@ -184,12 +254,65 @@ bool SequentialIntegerAttributeEncoder::EncodeValues(
       }
     }
   }
-  if (prediction_scheme_) {
+  if (has_corrections) {
+    out_buffer->Encode(prediction_data.data(), prediction_data.size());
+  } else if (prediction_scheme_) {
     prediction_scheme_->EncodePredictionData(out_buffer);
   }
   return true;
 }
 
+bool SequentialIntegerAttributeEncoder::SelectPredictionScheme(
+    const std::vector<PointIndex> &point_ids,
+    std::vector<int32_t> *out_corrections,
+    EncoderBuffer *out_prediction_data) {
+  TraceScope trace(tracer(), "SelectPredictionScheme");
+  std::vector<std::unique_ptr<PredictionSchemeTypedEncoderInterface<int32_t>>>
+      schemes = std::move(candidate_prediction_schemes_);
+  candidate_prediction_schemes_.clear();
+  if (prediction_scheme_)
+    schemes.push_back(std::move(prediction_scheme_));
+
+  const int num_components = portable_attribute()->num_components();
+  const int num_values =
+      static_cast<int>(num_components * portable_attribute()->size());
+  const int32_t *const portable_attribute_data = GetPortableAttributeData();
+  std::vector<int32_t> corrections(num_values);
+  std::vector<uint32_t> symbols(num_values);
+  int64_t best_num_bits = -1;
+  for (auto &ps : schemes) {
+    if (!SetPredictionSchemeParentAttributes(ps.get()))
+      continue;
+    ps->ComputeCorrectionValues(portable_attribute_data, corrections.data(),
+                                num_values, num_components, point_ids.data());
+    if (ps->AreCorrectionsPositive()) {
+      for (int i = 0; i < num_values; ++i) {
+        symbols[i] = corrections[i];
+      }
+    } else {
+      ConvertSignedIntsToSymbols(corrections.data(), num_values,
+                                 symbols.data());
+    }
+    // Data encoded by the scheme itself, such as the crease edges of the
+    // constrained multi-parallelogram prediction.
+    EncoderBuffer prediction_data;
+    if (!ps->EncodePredictionData(&prediction_data))
+      continue;
+    const int64_t num_bits = EstimateNumSymbolBits(symbols) +
+                             8 * static_cast<int64_t>(prediction_data.size());
+    if (best_num_bits < 0 || num_bits < best_num_bits) {
+      best_num_bits = num_bits;
+      prediction_scheme_ = std::move(ps);
+      out_corrections->swap(corrections);
+      corrections.resize(num_values);
+      out_prediction_data->Clear();
+      out_prediction_data->Encode(prediction_data.data(),
+                                  prediction_data.size());
+    }
+  }
+  return true;
+}
+
 bool SequentialIntegerAttributeEncoder::PrepareValues(
     const std::vector<PointIndex> &point_ids, int num_points) {
   // Convert all values to int32_t format.
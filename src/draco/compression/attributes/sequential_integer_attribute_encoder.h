@@ -43,6 +43,14 @@ class SequentialIntegerAttributeEncoder : public SequentialAttributeEncoder {
   virtual std::unique_ptr<PredictionSchemeTypedEncoderInterface<int32_t>>
   CreateIntPredictionScheme(PredictionSchemeMethod method);
 
+  // Replaces the current prediction scheme with the candidate scheme whose
+  // corrections have the lowest estimated entropy. Corrections and encoded
+  // prediction data of the selected scheme are stored in |out_corrections| and
+  // |out_prediction_data|.
+  bool SelectPredictionScheme(const std::vector<PointIndex> &point_ids,
+                              std::vector<int32_t> *out_corrections,
+                              EncoderBuffer *out_prediction_data);
+
   // Prepares the integer values that are going to be encoded.
   virtual bool PrepareValues(const std::vector<PointIndex> &point_ids,
                              int num_points);
@@ -60,6 +68,12 @@ class SequentialIntegerAttributeEncoder : public SequentialAttributeEncoder {
   // order to make them easier to compress.
   std::unique_ptr<PredictionSchemeTypedEncoderInterface<int32_t>>
       prediction_scheme_;
+
+  // Alternative prediction schemes that are compared with |prediction_scheme_|
+  // before the values are encoded. Used only when the prediction scheme is
+  // selected by the estimated entropy of the corrections.
+  std::vector<std::unique_ptr<PredictionSchemeTypedEncoderInterface<int32_t>>>
+      candidate_prediction_schemes_;
 };
 
 }  // namespace draco
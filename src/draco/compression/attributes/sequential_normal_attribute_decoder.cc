@@ -65,6 +65,7 @@ bool SequentialNormalAttributeDecoder::DecodeDataNeededByPortableTransform(
 }
 
 bool SequentialNormalAttributeDecoder::StoreValues(uint32_t num_points) {
+  TraceScope trace(tracer(), "OctahedronToUnitVectors");
   // Convert all quantized values back to floats.
   const int num_components = attribute()->num_components();
   const int entry_size = sizeof(float) * num_components;
@@ -75,6 +76,14 @@ bool SequentialNormalAttributeDecoder::StoreValues(uint32_t num_points) {
   OctahedronToolBox octahedron_tool_box;
   if (!octahedron_tool_box.SetQuantizationBits(quantization_bits_))
     return false;
+  if (num_components == 3 && num_points > 0) {
+    // Convert all values directly into the attribute buffer.
+    octahedron_tool_box.QuantizedOctahedralCoordsToUnitVectors(
+        portable_attribute_data, num_points,
+        reinterpret_cast<float *>(attribute()->buffer()->data()));
+    trace.set_num_bytes(static_cast<int64_t>(entry_size) * num_points);
+    return true;
+  }
   for (uint32_t i = 0; i < num_points; ++i) {
     const int32_t s = portable_attribute_data[quant_val_id++];
     const int32_t t = portable_attribute_data[quant_val_id++];
@@ -83,6 +92,7 @@ bool SequentialNormalAttributeDecoder::StoreValues(uint32_t num_points) {
     attribute()->buffer()->Write(out_byte_pos, att_val, entry_size);
     out_byte_pos += entry_size;
   }
+  trace.set_num_bytes(out_byte_pos);
   return true;
 }
 
@@ -52,8 +52,9 @@ bool SequentialQuantizationAttributeEncoder::Init(PointCloudEncoder *encoder,
         attribute->num_components(), range);
   } else {
     // Compute quantization settings from the attribute values.
-    attribute_quantization_transform_.ComputeParameters(*attribute,
-                                                        quantization_bits);
+    if (!attribute_quantization_transform_.ComputeParameters(
+            *attribute, quantization_bits))
+      return false;
   }
   return true;
 }
@@ -0,0 +1,70 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/batch_decode.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace draco {
+
+BatchDecoder::BatchDecoder(int num_threads)
+    : owned_pool_(new ThreadPool(num_threads > 1 ? num_threads - 1 : 0)),
+      pool_(owned_pool_.get()) {}
+
+BatchDecoder::BatchDecoder(ThreadPool *pool) : pool_(pool) {}
+
+std::vector<StatusOr<std::unique_ptr<Mesh>>> BatchDecoder::DecodeMeshes(
+    DecoderBuffer *buffers, size_t num_buffers) {
+  std::vector<StatusOr<std::unique_ptr<Mesh>>> meshes(num_buffers);
+  DecodeItems(num_buffers, [&](size_t i, Decoder *decoder) {
+    meshes[i] = decoder->DecodeMeshFromBuffer(&buffers[i]);
+  });
+  return meshes;
+}
+
+std::vector<StatusOr<std::unique_ptr<PointCloud>>>
+BatchDecoder::DecodePointClouds(DecoderBuffer *buffers, size_t num_buffers) {
+  std::vector<StatusOr<std::unique_ptr<PointCloud>>> point_clouds(num_buffers);
+  DecodeItems(num_buffers, [&](size_t i, Decoder *decoder) {
+    point_clouds[i] = decoder->DecodePointCloudFromBuffer(&buffers[i]);
+  });
+  return point_clouds;
+}
+
+void BatchDecoder::DecodeItems(
+    size_t num_items,
+    const std::function<void(size_t, Decoder *)> &decode_item) {
+  const int num_workers = static_cast<int>(
+      std::min(static_cast<size_t>(num_threads()), num_items));
+  while (static_cast<int>(decoders_.size()) < num_workers) {
+    scratches_.push_back(std::unique_ptr<DecoderScratch>(new DecoderScratch()));
+    decoders_.emplace_back();
+    decoders_.back().SetScratch(scratches_.back().get());
+  }
+  // Items are claimed one by one so that a worker that got a large item does
+  // not delay the rest of the batch.
+  std::atomic<size_t> next_item(0);
+  ParallelFor(pool_, num_workers, [&](int worker_id) {
+    Decoder *const decoder = &decoders_[worker_id];
+    *decoder->options() = options_;
+    size_t item;
+    while ((item = next_item.fetch_add(1)) < num_items) {
+      decode_item(item, decoder);
+    }
+    return true;
+  });
+}
+
+}  // namespace draco
@@ -0,0 +1,88 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_COMPRESSION_BATCH_DECODE_H_
+#define DRACO_COMPRESSION_BATCH_DECODE_H_
+
+#include <functional>
+#include <vector>
+
+#include "draco/compression/decode.h"
+#include "draco/core/thread_pool.h"
+
+namespace draco {
+
+// Class for decoding many independent Draco buffers at once. The buffers are
+// distributed between worker threads and each worker keeps its own instance
+// of the Decoder and DecoderScratch that are reused for all buffers processed
+// by the worker.
+//
+// Example:
+//
+//   BatchDecoder batch_decoder(8);
+//   std::vector<StatusOr<std::unique_ptr<Mesh>>> meshes =
+//       batch_decoder.DecodeMeshes(buffers.data(), buffers.size());
+//   for (auto &mesh_or : meshes) {
+//     if (!mesh_or.ok())
+//       ...  // Handle error of a single item.
+//   }
+//
+class BatchDecoder {
+ public:
+  // Creates a batch decoder that uses |num_threads| threads for decoding
+  // (including the thread that calls the decoding methods).
+  explicit BatchDecoder(int num_threads);
+
+  // Creates a batch decoder that uses worker threads of an external |pool|
+  // together with the calling thread. The |pool| must outlive the decoder.
+  explicit BatchDecoder(ThreadPool *pool);
+
+  // Decodes |num_buffers| meshes from the input |buffers|. The returned vector
+  // contains either the decoded mesh or the error status for each input
+  // buffer. The input buffers are advanced past the decoded data.
+  std::vector<StatusOr<std::unique_ptr<Mesh>>> DecodeMeshes(
+      DecoderBuffer *buffers, size_t num_buffers);
+
+  // Same as DecodeMeshes() but for point clouds. Buffers containing a mesh are
+  // decoded into a Mesh instance that is returned as PointCloud.
+  std::vector<StatusOr<std::unique_ptr<PointCloud>>> DecodePointClouds(
+      DecoderBuffer *buffers, size_t num_buffers);
+
+  // Options used for decoding of all buffers.
+  DecoderOptions *options() { return &options_; }
+
+  int num_threads() const {
+    return pool_ == nullptr ? 1 : pool_->num_threads() + 1;
+  }
+
+ private:
+  // Calls |decode_item| for all items in range [0, |num_items|) using the
+  // worker threads. The second argument of |decode_item| is the Decoder owned
+  // by the worker that processes the item.
+  void DecodeItems(size_t num_items,
+                   const std::function<void(size_t, Decoder *)> &decode_item);
+
+  DecoderOptions options_;
+
+  // One decoder and scratch for each thread.
+  std::vector<Decoder> decoders_;
+  std::vector<std::unique_ptr<DecoderScratch>> scratches_;
+
+  std::unique_ptr<ThreadPool> owned_pool_;
+  ThreadPool *pool_;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_BATCH_DECODE_H_
@@ -0,0 +1,148 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/batch_decode.h"
+
+#include "draco/compression/encode.h"
+#include "draco/core/draco_test_base.h"
+#include "draco/core/draco_test_utils.h"
+#include "draco/core/vector_d.h"
+#include "draco/mesh/mesh_are_equivalent.h"
+#include "draco/mesh/triangle_soup_mesh_builder.h"
+
+namespace {
+
+class BatchDecodeTest : public ::testing::Test {
+ protected:
+  // Creates a small regular grid mesh with |grid_size| x |grid_size| quads.
+  // The |offset| is used to make the individual tiles different.
+  std::unique_ptr<draco::Mesh> CreateTile(int grid_size, float offset) const {
+    draco::TriangleSoupMeshBuilder mesh_builder;
+    mesh_builder.Start(grid_size * grid_size * 2);
+    const int pos_att_id = mesh_builder.AddAttribute(
+        draco::GeometryAttribute::POSITION, 3, draco::DT_FLOAT32);
+    const int tex_att_id = mesh_builder.AddAttribute(
+        draco::GeometryAttribute::TEX_COORD, 2, draco::DT_FLOAT32);
+    draco::FaceIndex face(0);
+    for (int y = 0; y < grid_size; ++y) {
+      for (int x = 0; x < grid_size; ++x) {
+        const float x0 = static_cast<float>(x);
+        const float y0 = static_cast<float>(y);
+        const float h = offset + 0.1f * ((x * 7 + y * 3) % 5);
+        draco::Vector3f p00(x0, y0, h), p10(x0 + 1.f, y0, h),
+            p01(x0, y0 + 1.f, h), p11(x0 + 1.f, y0 + 1.f, h);
+        draco::Vector2f t00(x0 / grid_size, y0 / grid_size),
+            t10((x0 + 1.f) / grid_size, y0 / grid_size),
+            t01(x0 / grid_size, (y0 + 1.f) / grid_size),
+            t11((x0 + 1.f) / grid_size, (y0 + 1.f) / grid_size);
+        mesh_builder.SetAttributeValuesForFace(pos_att_id, face, p00.data(),
+                                               p10.data(), p11.data());
+        mesh_builder.SetAttributeValuesForFace(tex_att_id, face, t00.data(),
+                                               t10.data(), t11.data());
+        ++face;
+        mesh_builder.SetAttributeValuesForFace(pos_att_id, face, p00.data(),
+                                               p11.data(), p01.data());
+        mesh_builder.SetAttributeValuesForFace(tex_att_id, face, t00.data(),
+                                               t11.data(), t01.data());
+        ++face;
+      }
+    }
+    return mesh_builder.Finalize();
+  }
+
+  // Encodes |num_tiles| different tiles into |encoded_tiles|.
+  void EncodeTiles(int num_tiles,
+                   std::vector<draco::EncoderBuffer> *encoded_tiles) const {
+    draco::Encoder encoder;
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 11);
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::TEX_COORD, 10);
+    encoded_tiles->resize(num_tiles);
+    for (int i = 0; i < num_tiles; ++i) {
+      const std::unique_ptr<draco::Mesh> tile =
+          CreateTile(4 + i % 5, static_cast<float>(i));
+      ASSERT_NE(tile, nullptr);
+      ASSERT_TRUE(
+          encoder.EncodeMeshToBuffer(*tile, &(*encoded_tiles)[i]).ok());
+    }
+  }
+
+  std::vector<draco::DecoderBuffer> CreateDecoderBuffers(
+      const std::vector<draco::EncoderBuffer> &encoded_tiles) const {
+    std::vector<draco::DecoderBuffer> buffers(encoded_tiles.size());
+    for (size_t i = 0; i < encoded_tiles.size(); ++i) {
+      buffers[i].Init(encoded_tiles[i].data(), encoded_tiles[i].size());
+    }
+    return buffers;
+  }
+};
+
+TEST_F(BatchDecodeTest, TestDecodeMeshes) {
+  // Tests that the batch decoder produces the same meshes as the basic
+  // decoder and that errors are reported per item.
+  std::vector<draco::EncoderBuffer> encoded_tiles;
+  EncodeTiles(50, &encoded_tiles);
+  // Replace one of the tiles with invalid data.
+  encoded_tiles[7].Clear();
+  encoded_tiles[7].Encode("DRACO", 5);
+
+  std::vector<draco::DecoderBuffer> buffers =
+      CreateDecoderBuffers(encoded_tiles);
+  draco::BatchDecoder batch_decoder(4);
+  std::vector<draco::StatusOr<std::unique_ptr<draco::Mesh>>> meshes =
+      batch_decoder.DecodeMeshes(buffers.data(), buffers.size());
+  ASSERT_EQ(meshes.size(), encoded_tiles.size());
+
+  draco::MeshAreEquivalent equiv;
+  for (size_t i = 0; i < encoded_tiles.size(); ++i) {
+    draco::DecoderBuffer buffer;
+    buffer.Init(encoded_tiles[i].data(), encoded_tiles[i].size());
+    draco::Decoder decoder;
+    auto mesh_or = decoder.DecodeMeshFromBuffer(&buffer);
+    ASSERT_EQ(mesh_or.ok(), meshes[i].ok());
+    if (i == 7) {
+      ASSERT_FALSE(meshes[i].ok());
+      continue;
+    }
+    ASSERT_TRUE(equiv(*mesh_or.value(), *meshes[i].value()));
+  }
+}
+
+TEST_F(BatchDecodeTest, TestDecodePointClouds) {
+  // Tests that meshes can be decoded as point clouds by the batch decoder
+  // with any number of threads.
+  std::vector<draco::EncoderBuffer> encoded_tiles;
+  EncodeTiles(10, &encoded_tiles);
+  for (int num_threads : {1, 3}) {
+    std::vector<draco::DecoderBuffer> buffers =
+        CreateDecoderBuffers(encoded_tiles);
+    draco::BatchDecoder batch_decoder(num_threads);
+    const auto point_clouds =
+        batch_decoder.DecodePointClouds(buffers.data(), buffers.size());
+    ASSERT_EQ(point_clouds.size(), encoded_tiles.size());
+    for (size_t i = 0; i < point_clouds.size(); ++i) {
+      ASSERT_TRUE(point_clouds[i].ok());
+      draco::DecoderBuffer buffer;
+      buffer.Init(encoded_tiles[i].data(), encoded_tiles[i].size());
+      draco::Decoder decoder;
+      auto pc_or = decoder.DecodePointCloudFromBuffer(&buffer);
+      ASSERT_TRUE(pc_or.ok());
+      ASSERT_EQ(pc_or.value()->num_points(),
+                point_clouds[i].value()->num_points());
+      ASSERT_EQ(pc_or.value()->num_attributes(),
+                point_clouds[i].value()->num_attributes());
+    }
+  }
+}
+
+}  // namespace
@@ -0,0 +1,185 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/chunked_decode.h"
+
+#include <array>
+#include <cstring>
+#include <limits>
+
+#include "draco/core/varint_decoding.h"
+
+namespace draco {
+
+ChunkedPointCloudDecoder::ChunkedPointCloudDecoder(int num_threads)
+    : batch_decoder_(num_threads), chunk_data_(nullptr), chunk_data_size_(0) {}
+
+ChunkedPointCloudDecoder::ChunkedPointCloudDecoder(ThreadPool *pool)
+    : batch_decoder_(pool), chunk_data_(nullptr), chunk_data_size_(0) {}
+
+Status ChunkedPointCloudDecoder::DecodeChunkIndex(DecoderBuffer *in_buffer) {
+  chunks_.clear();
+  chunk_data_ = nullptr;
+  chunk_data_size_ = 0;
+
+  char magic[kChunkedPointCloudMagicLength];
+  if (!in_buffer->Decode(magic, kChunkedPointCloudMagicLength) ||
+      memcmp(magic, kChunkedPointCloudMagic, kChunkedPointCloudMagicLength) !=
+          0) {
+    return Status(Status::DRACO_ERROR, "Not a chunked Draco point cloud.");
+  }
+  uint8_t version_major, version_minor;
+  uint16_t flags;
+  if (!in_buffer->Decode(&version_major) ||
+      !in_buffer->Decode(&version_minor) || !in_buffer->Decode(&flags)) {
+    return Status(Status::IO_ERROR,
+                  "Failed to parse chunked point cloud header.");
+  }
+  if (version_major != kChunkedPointCloudVersionMajor) {
+    return Status(Status::UNSUPPORTED_VERSION,
+                  "Unsupported chunked point cloud version.");
+  }
+  uint32_t num_chunks;
+  if (!DecodeVarint(&num_chunks, in_buffer)) {
+    return Status(Status::IO_ERROR, "Failed to parse chunk index.");
+  }
+  // Each index entry takes at least 26 bytes.
+  if (num_chunks > in_buffer->remaining_size() / 26) {
+    return Status(Status::IO_ERROR, "Invalid number of chunks.");
+  }
+  chunks_.resize(num_chunks);
+  uint64_t offset = 0;
+  for (uint32_t i = 0; i < num_chunks; ++i) {
+    float box[6];
+    for (int c = 0; c < 6; ++c) {
+      if (!in_buffer->Decode(&box[c])) {
+        return Status(Status::IO_ERROR, "Failed to parse chunk index.");
+      }
+    }
+    ChunkedPointCloudChunkInfo &chunk = chunks_[i];
+    chunk.bounding_box = BoundingBox(Vector3f(box[0], box[1], box[2]),
+                                     Vector3f(box[3], box[4], box[5]));
+    if (!DecodeVarint(&chunk.num_points, in_buffer) ||
+        !DecodeVarint(&chunk.size, in_buffer)) {
+      return Status(Status::IO_ERROR, "Failed to parse chunk index.");
+    }
+    if (chunk.size > static_cast<uint64_t>(in_buffer->remaining_size())) {
+      return Status(Status::IO_ERROR, "Invalid chunk size.");
+    }
+    chunk.offset = offset;
+    offset += chunk.size;
+  }
+  if (offset > static_cast<uint64_t>(in_buffer->remaining_size())) {
+    return Status(Status::IO_ERROR, "Chunked point cloud data is truncated.");
+  }
+  chunk_data_ = in_buffer->data_head();
+  chunk_data_size_ = offset;
+  in_buffer->Advance(offset);
+  return OkStatus();
+}
+
+std::vector<int> ChunkedPointCloudDecoder::FindChunks(
+    const BoundingBox &box) const {
+  std::vector<int> chunk_ids;
+  for (int i = 0; i < num_chunks(); ++i) {
+    const BoundingBox &chunk_box = chunks_[i].bounding_box;
+    bool intersects = true;
+    for (int c = 0; c < 3; ++c) {
+      if (chunk_box.min_point()[c] > box.max_point()[c] ||
+          chunk_box.max_point()[c] < box.min_point()[c]) {
+        intersects = false;
+        break;
+      }
+    }
+    if (intersects) {
+      chunk_ids.push_back(i);
+    }
+  }
+  return chunk_ids;
+}
+
+std::vector<StatusOr<std::unique_ptr<PointCloud>>>
+ChunkedPointCloudDecoder::DecodeChunks(const std::vector<int> &chunk_ids) {
+  std::vector<StatusOr<std::unique_ptr<PointCloud>>> point_clouds(
+      chunk_ids.size());
+  // Only valid chunks are passed to the batch decoder. |buffer_items| maps the
+  // buffers back to the requested chunks.
+  std::vector<DecoderBuffer> buffers;
+  std::vector<size_t> buffer_items;
+  buffers.reserve(chunk_ids.size());
+  for (size_t i = 0; i < chunk_ids.size(); ++i) {
+    const int chunk_id = chunk_ids[i];
+    if (chunk_id < 0 || chunk_id >= num_chunks()) {
+      point_clouds[i] = Status(Status::INVALID_PARAMETER, "Invalid chunk id.");
+      continue;
+    }
+    const ChunkedPointCloudChunkInfo &chunk = chunks_[chunk_id];
+    buffers.emplace_back();
+    buffers.back().Init(chunk_data_ + chunk.offset, chunk.size);
+    buffer_items.push_back(i);
+  }
+  std::vector<StatusOr<std::unique_ptr<PointCloud>>> decoded_point_clouds =
+      batch_decoder_.DecodePointClouds(buffers.data(), buffers.size());
+  for (size_t i = 0; i < decoded_point_clouds.size(); ++i) {
+    point_clouds[buffer_items[i]] = std::move(decoded_point_clouds[i]);
+  }
+  return point_clouds;
+}
+
+StatusOr<std::unique_ptr<PointCloud>>
+ChunkedPointCloudDecoder::DecodePointCloud() {
+  std::vector<int> chunk_ids(num_chunks());
+  uint64_t num_points = 0;
+  for (int i = 0; i < num_chunks(); ++i) {
+    chunk_ids[i] = i;
+    num_points += chunks_[i].num_points;
+  }
+  if (num_points > std::numeric_limits<PointIndex::ValueType>::max()) {
+    return Status(Status::DRACO_ERROR,
+                  "Too many points to be decoded into a single point cloud.");
+  }
+  std::vector<StatusOr<std::unique_ptr<PointCloud>>> point_clouds =
+      DecodeChunks(chunk_ids);
+
+  // Concatenate the positions of all chunks.
+  std::unique_ptr<PointCloud> pc(new PointCloud());
+  pc->set_num_points(static_cast<PointIndex::ValueType>(num_points));
+  GeometryAttribute ga;
+  ga.Init(GeometryAttribute::POSITION, nullptr, 3, DT_FLOAT32, false,
+          3 * sizeof(float), 0);
+  PointAttribute *const pos_att = pc->attribute(
+      pc->AddAttribute(ga, true, static_cast<uint32_t>(num_points)));
+  AttributeValueIndex avi(0);
+  std::array<float, 3> pos;
+  for (size_t i = 0; i < point_clouds.size(); ++i) {
+    DRACO_RETURN_IF_ERROR(point_clouds[i].status());
+    const PointCloud &chunk_pc = *point_clouds[i].value();
+    const PointAttribute *const chunk_pos_att =
+        chunk_pc.GetNamedAttribute(GeometryAttribute::POSITION);
+    if (chunk_pos_att == nullptr ||
+        chunk_pc.num_points() != chunks_[i].num_points) {
+      return Status(Status::DRACO_ERROR, "Invalid chunk.");
+    }
+    for (PointIndex p(0); p < chunk_pc.num_points(); ++p, ++avi) {
+      if (!chunk_pos_att->ConvertValue<float>(chunk_pos_att->mapped_index(p),
+                                              3, &pos[0])) {
+        return Status(Status::DRACO_ERROR, "Invalid chunk.");
+      }
+      pos_att->SetAttributeValue(avi, &pos[0]);
+    }
+  }
+  return std::move(pc);
+}
+
+}  // namespace draco
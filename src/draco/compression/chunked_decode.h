@@ -0,0 +1,78 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_COMPRESSION_CHUNKED_DECODE_H_
+#define DRACO_COMPRESSION_CHUNKED_DECODE_H_
+
+#include <vector>
+
+#include "draco/compression/batch_decode.h"
+#include "draco/compression/chunked_point_cloud_shared.h"
+
+namespace draco {
+
+// Decoder for point clouds encoded with ChunkedPointCloudEncoder. The chunk
+// index is parsed first and the chunks can then be decoded individually, e.g.,
+// only those that intersect a region of interest. Chunks are decoded in
+// parallel by a BatchDecoder.
+//
+// Example:
+//
+//   ChunkedPointCloudDecoder decoder(8);
+//   DRACO_RETURN_IF_ERROR(decoder.DecodeChunkIndex(&buffer));
+//   auto chunks = decoder.DecodeChunks(decoder.FindChunks(region));
+//
+class ChunkedPointCloudDecoder {
+ public:
+  // Creates a decoder that uses |num_threads| threads for decoding of chunks.
+  explicit ChunkedPointCloudDecoder(int num_threads);
+
+  // Creates a decoder that uses worker threads of an external |pool|. The
+  // |pool| must outlive the decoder.
+  explicit ChunkedPointCloudDecoder(ThreadPool *pool);
+
+  // Parses the header and the chunk index of the chunked point cloud stored
+  // in |in_buffer|. The buffer is advanced past the whole container. The data
+  // of |in_buffer| must stay valid until all chunks are decoded.
+  Status DecodeChunkIndex(DecoderBuffer *in_buffer);
+
+  int num_chunks() const { return static_cast<int>(chunks_.size()); }
+  const ChunkedPointCloudChunkInfo &chunk(int i) const { return chunks_[i]; }
+
+  // Returns ids of all chunks whose bounding box intersects |box|.
+  std::vector<int> FindChunks(const BoundingBox &box) const;
+
+  // Decodes chunks |chunk_ids| into separate point clouds. The returned vector
+  // contains either the decoded point cloud or the error status for each
+  // chunk.
+  std::vector<StatusOr<std::unique_ptr<PointCloud>>> DecodeChunks(
+      const std::vector<int> &chunk_ids);
+
+  // Decodes all chunks and merges them into a single point cloud.
+  StatusOr<std::unique_ptr<PointCloud>> DecodePointCloud();
+
+  // Options used for decoding of all chunks.
+  DecoderOptions *options() { return batch_decoder_.options(); }
+
+ private:
+  BatchDecoder batch_decoder_;
+  std::vector<ChunkedPointCloudChunkInfo> chunks_;
+  // Start of the encoded data of the chunks in the input buffer.
+  const char *chunk_data_;
+  size_t chunk_data_size_;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_CHUNKED_DECODE_H_
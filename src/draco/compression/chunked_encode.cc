@@ -0,0 +1,505 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/chunked_encode.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+#include "draco/core/tracer.h"
+#include "draco/core/varint_encoding.h"
+#include "draco/point_cloud/point_cloud_builder.h"
+
+namespace draco {
+
+namespace {
+
+// Estimated peak memory needed for the encoding of a single point of a chunk,
+// including the input positions, the point cloud and the encoder data.
+constexpr int64_t kEncodingBytesPerPoint = 64;
+
+// Memory limit below which the encoder can't work efficiently.
+constexpr int64_t kMinMemoryLimit = 1 << 20;
+
+// Maximum number of buckets created by a single split. Bounds the number of
+// temporary files that exist at the same time.
+constexpr int kMaxBucketsPerSplit = 512;
+
+// Maximum number of recursive splits of a bucket. Buckets that are still too
+// large at this depth are encoded into multiple chunks in the input order.
+constexpr int kMaxSplitDepth = 16;
+
+constexpr int64_t kPositionSize = 3 * sizeof(float);
+
+// Temporary file that is removed when the instance is destroyed.
+class TemporaryFile {
+ public:
+  explicit TemporaryFile(const std::string &directory) {
+    static std::atomic<uint64_t> next_file_id(0);
+    path_ = directory + "/draco_chunked_" +
+            std::to_string(static_cast<uint64_t>(
+                std::chrono::steady_clock::now().time_since_epoch().count())) +
+            "_" + std::to_string(next_file_id.fetch_add(1)) + ".tmp";
+  }
+  ~TemporaryFile() { std::remove(path_.c_str()); }
+
+  // Appends |size| bytes of |data| to the file.
+  Status Append(const void *data, size_t size) {
+    FILE *const file = fopen(path_.c_str(), "ab");
+    if (file == nullptr) {
+      return Status(Status::IO_ERROR, "Failed to open a temporary file.");
+    }
+    const bool ok = fwrite(data, 1, size, file) == size;
+    if (fclose(file) != 0 || !ok) {
+      return Status(Status::IO_ERROR, "Failed to write a temporary file.");
+    }
+    return OkStatus();
+  }
+
+  const std::string &path() const { return path_; }
+
+ private:
+  std::string path_;
+};
+
+// Reader of positions stored in a temporary file as raw floats.
+class TemporaryFileChunkReader : public PointCloudChunkReader {
+ public:
+  explicit TemporaryFileChunkReader(const std::string &path)
+      : file_(fopen(path.c_str(), "rb")) {}
+  ~TemporaryFileChunkReader() override {
+    if (file_ != nullptr) {
+      fclose(file_);
+    }
+  }
+
+  StatusOr<int64_t> ReadChunk(int64_t max_points,
+                              std::vector<float> *out_positions) override {
+    if (file_ == nullptr) {
+      return Status(Status::IO_ERROR, "Failed to open a temporary file.");
+    }
+    const size_t offset = out_positions->size();
+    out_positions->resize(offset + 3 * max_points);
+    const size_t num_points =
+        fread(&(*out_positions)[offset], kPositionSize, max_points, file_);
+    out_positions->resize(offset + 3 * num_points);
+    if (ferror(file_)) {
+      return Status(Status::IO_ERROR, "Failed to read a temporary file.");
+    }
+    return static_cast<int64_t>(num_points);
+  }
+
+  Status Rewind() override {
+    if (file_ == nullptr || fseek(file_, 0, SEEK_SET) != 0) {
+      return Status(Status::IO_ERROR, "Failed to rewind a temporary file.");
+    }
+    return OkStatus();
+  }
+
+ private:
+  FILE *file_;
+};
+
+// Reader of positions of a point cloud held in memory.
+class PointCloudPositionsChunkReader : public PointCloudChunkReader {
+ public:
+  explicit PointCloudPositionsChunkReader(const PointAttribute *pos_att,
+                                          PointIndex::ValueType num_points)
+      : pos_att_(pos_att), num_points_(num_points), next_point_(0) {}
+
+  StatusOr<int64_t> ReadChunk(int64_t max_points,
+                              std::vector<float> *out_positions) override {
+    int64_t num_read_points = 0;
+    std::array<float, 3> pos;
+    for (; num_read_points < max_points && next_point_ < num_points_;
+         ++num_read_points, ++next_point_) {
+      if (!pos_att_->ConvertValue<float>(
+              pos_att_->mapped_index(PointIndex(next_point_)), 3, &pos[0])) {
+        return Status(Status::DRACO_ERROR, "Failed to read point positions.");
+      }
+      out_positions->insert(out_positions->end(), pos.begin(), pos.end());
+    }
+    return num_read_points;
+  }
+
+  Status Rewind() override {
+    next_point_ = 0;
+    return OkStatus();
+  }
+
+ private:
+  const PointAttribute *pos_att_;
+  PointIndex::ValueType num_points_;
+  PointIndex::ValueType next_point_;
+};
+
+// Set of points stored in a temporary file.
+struct Bucket {
+  Bucket()
+      : box(Vector3f(0.f, 0.f, 0.f), Vector3f(0.f, 0.f, 0.f)),
+        num_points(0),
+        depth(0) {}
+
+  // Stored points. The input reader is used when not set.
+  std::unique_ptr<TemporaryFile> file;
+  // Bounding box of the positions of all points.
+  BoundingBox box;
+  int64_t num_points;
+  // Number of splits that created the bucket.
+  int depth;
+};
+
+// Extends |box| with |num_points| |positions|. |box_empty| is set to false
+// once any point was added.
+void UpdateBoundingBox(const float *positions, int64_t num_points,
+                       BoundingBox *box, bool *box_empty) {
+  for (int64_t i = 0; i < num_points; ++i) {
+    const Vector3f pos(positions[3 * i], positions[3 * i + 1],
+                       positions[3 * i + 2]);
+    if (*box_empty) {
+      *box = BoundingBox(pos, pos);
+      *box_empty = false;
+    } else {
+      box->update_bounding_box(pos);
+    }
+  }
+}
+
+// Splits the points of |bucket| read by |reader| into a grid of new buckets.
+// Empty buckets are not returned.
+Status SplitBucket(const Bucket &bucket, PointCloudChunkReader *reader,
+                   int64_t max_points_per_bucket, int64_t read_chunk_points,
+                   int64_t buffer_size, const std::string &directory,
+                   std::vector<Bucket> *out_buckets) {
+  // Split the longest axes of the cells until there are enough cells for
+  // about two times the number of needed buckets, so that buckets of
+  // unevenly distributed points don't need to be split again.
+  const int64_t num_needed_buckets =
+      (bucket.num_points + max_points_per_bucket - 1) / max_points_per_bucket;
+  const int64_t num_cells = std::min<int64_t>(
+      kMaxBucketsPerSplit, std::max<int64_t>(2, 2 * num_needed_buckets));
+  const Vector3f extent = bucket.box.max_point() - bucket.box.min_point();
+  std::array<int, 3> grid_size = {{1, 1, 1}};
+  while (2 * grid_size[0] * grid_size[1] * grid_size[2] <= num_cells) {
+    int axis = 0;
+    for (int c = 1; c < 3; ++c) {
+      if (extent[c] / grid_size[c] > extent[axis] / grid_size[axis]) {
+        axis = c;
+      }
+    }
+    if (extent[axis] <= 0.f) {
+      break;
+    }
+    grid_size[axis] *= 2;
+  }
+
+  const int num_buckets = grid_size[0] * grid_size[1] * grid_size[2];
+  std::vector<Bucket> buckets(num_buckets);
+  std::vector<std::vector<float>> buffers(num_buckets);
+  int64_t num_buffered_bytes = 0;
+  const auto flush_buffers = [&]() -> Status {
+    for (int i = 0; i < num_buckets; ++i) {
+      if (buffers[i].empty()) {
+        continue;
+      }
+      if (buckets[i].file == nullptr) {
+        buckets[i].file.reset(new TemporaryFile(directory));
+      }
+      DRACO_RETURN_IF_ERROR(buckets[i].file->Append(
+          buffers[i].data(), buffers[i].size() * sizeof(float)));
+      // Release the memory of the buffer.
+      std::vector<float>().swap(buffers[i]);
+    }
+    num_buffered_bytes = 0;
+    return OkStatus();
+  };
+
+  DRACO_RETURN_IF_ERROR(reader->Rewind());
+  std::vector<float> positions;
+  while (true) {
+    positions.clear();
+    DRACO_ASSIGN_OR_RETURN(const int64_t num_points,
+                           reader->ReadChunk(read_chunk_points, &positions));
+    if (num_points == 0) {
+      break;
+    }
+    for (int64_t p = 0; p < num_points; ++p) {
+      const float *const pos = &positions[3 * p];
+      int bucket_id = 0;
+      for (int c = 2; c >= 0; --c) {
+        int cell = 0;
+        if (extent[c] > 0.f) {
+          const double t = (static_cast<double>(pos[c]) -
+                            bucket.box.min_point()[c]) /
+                           extent[c] * grid_size[c];
+          cell = std::max(0, std::min(grid_size[c] - 1, static_cast<int>(t)));
+        }
+        bucket_id = bucket_id * grid_size[c] + cell;
+      }
+      const size_t capacity = buffers[bucket_id].capacity();
+      buffers[bucket_id].insert(buffers[bucket_id].end(), pos, pos + 3);
+      num_buffered_bytes +=
+          (buffers[bucket_id].capacity() - capacity) * sizeof(float);
+      bool box_empty = buckets[bucket_id].num_points == 0;
+      UpdateBoundingBox(pos, 1, &buckets[bucket_id].box, &box_empty);
+      ++buckets[bucket_id].num_points;
+      if (num_buffered_bytes >= buffer_size) {
+        DRACO_RETURN_IF_ERROR(flush_buffers());
+      }
+    }
+  }
+  DRACO_RETURN_IF_ERROR(flush_buffers());
+  for (int i = 0; i < num_buckets; ++i) {
+    if (buckets[i].num_points > 0) {
+      buckets[i].depth = bucket.depth + 1;
+      out_buckets->push_back(std::move(buckets[i]));
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+ChunkedPointCloudEncoder::ChunkedPointCloudEncoder()
+    : memory_limit_(int64_t(512) << 20), max_points_per_chunk_(1 << 20) {}
+
+int64_t ChunkedPointCloudEncoder::GetMaxPointsPerChunk() const {
+  // Half of the memory can be used for the encoding of a chunk.
+  return std::min(max_points_per_chunk_,
+                  memory_limit_ / 2 / kEncodingBytesPerPoint);
+}
+
+Status ChunkedPointCloudEncoder::EncodePointCloudToBuffer(
+    const PointCloud &pc, EncoderBuffer *out_buffer) {
+  const PointAttribute *const pos_att =
+      pc.GetNamedAttribute(GeometryAttribute::POSITION);
+  if (pc.num_attributes() != 1 || pos_att == nullptr ||
+      pos_att->num_components() != 3) {
+    return Status(Status::DRACO_ERROR,
+                  "Chunked encoding supports only a single 3D position "
+                  "attribute.");
+  }
+  PointCloudPositionsChunkReader reader(pos_att, pc.num_points());
+  return EncodeToBuffer(&reader, out_buffer);
+}
+
+Status ChunkedPointCloudEncoder::EncodeMeshToBuffer(const Mesh &m,
+                                                    EncoderBuffer *out_buffer) {
+  return Status(Status::DRACO_ERROR,
+                "Only point clouds can be encoded into chunks.");
+}
+
+Status ChunkedPointCloudEncoder::EncodeToBuffer(PointCloudChunkReader *reader,
+                                                EncoderBuffer *out_buffer) {
+  if (memory_limit_ < kMinMemoryLimit) {
+    return Status(Status::INVALID_PARAMETER, "Memory limit is too small.");
+  }
+  const int64_t max_points_per_chunk = GetMaxPointsPerChunk();
+  if (max_points_per_chunk < 1) {
+    return Status(Status::INVALID_PARAMETER,
+                  "Invalid number of points per chunk.");
+  }
+  set_num_encoded_points(0);
+  set_num_encoded_faces(0);
+  chunks_.clear();
+
+  // The rest of the memory is split between the chunks read from the input
+  // and the buffers of the buckets.
+  const int64_t read_chunk_points =
+      std::max<int64_t>(1, memory_limit_ / 8 / kPositionSize);
+  const int64_t bucket_buffer_size = memory_limit_ / 4;
+  std::string directory = temporary_directory_;
+  if (directory.empty()) {
+    const char *const tmp_dir = std::getenv("TMPDIR");
+    directory = tmp_dir != nullptr ? tmp_dir : "/tmp";
+  }
+
+  // Compute the bounding box of all points.
+  Bucket root;
+  {
+    TraceScope trace(options().GetTracer(),
+                     "ChunkedPointCloudEncoder::ComputeBounds");
+    bool box_empty = true;
+    std::vector<float> positions;
+    DRACO_RETURN_IF_ERROR(reader->Rewind());
+    while (true) {
+      positions.clear();
+      DRACO_ASSIGN_OR_RETURN(const int64_t num_points,
+                             reader->ReadChunk(read_chunk_points, &positions));
+      if (num_points == 0) {
+        break;
+      }
+      UpdateBoundingBox(positions.data(), num_points, &root.box, &box_empty);
+      root.num_points += num_points;
+    }
+  }
+
+  // Quantize all chunks in the bounding box of the whole point cloud, so that
+  // the chunks can be combined without any seams.
+  EncoderOptionsBase<GeometryAttribute::Type> chunk_options = options();
+  if (options().GetAttributeInt(GeometryAttribute::POSITION,
+                                "quantization_bits", -1) > 0 &&
+      !chunk_options.IsAttributeOptionSet(GeometryAttribute::POSITION,
+                                          "quantization_origin")) {
+    const Vector3f extent = root.box.max_point() - root.box.min_point();
+    float range = std::max(extent[0], std::max(extent[1], extent[2]));
+    if (range == 0.f) {
+      range = 1.f;
+    }
+    Vector3f origin = root.box.min_point();
+    chunk_options.SetAttributeVector(GeometryAttribute::POSITION,
+                                     "quantization_origin", 3, origin.data());
+    chunk_options.SetAttributeFloat(GeometryAttribute::POSITION,
+                                    "quantization_range", range);
+  }
+
+  // Split the points into buckets and encode each bucket that fits into a
+  // chunk. Buckets are processed in depth-first order so that neighboring
+  // chunks are stored next to each other and only the buckets along a single
+  // path of the split hierarchy exist at the same time.
+  TemporaryFile chunk_data(directory);
+  uint64_t chunk_data_size = 0;
+  std::vector<Bucket> buckets;
+  buckets.push_back(std::move(root));
+  std::vector<float> positions;
+  while (!buckets.empty()) {
+    Bucket bucket = std::move(buckets.back());
+    buckets.pop_back();
+    std::unique_ptr<TemporaryFileChunkReader> file_reader;
+    PointCloudChunkReader *bucket_reader = reader;
+    if (bucket.file != nullptr) {
+      file_reader.reset(new TemporaryFileChunkReader(bucket.file->path()));
+      bucket_reader = file_reader.get();
+    }
+    if (bucket.num_points > max_points_per_chunk &&
+        bucket.depth < kMaxSplitDepth) {
+      TraceScope trace(options().GetTracer(),
+                       "ChunkedPointCloudEncoder::SplitBucket");
+      std::vector<Bucket> split_buckets;
+      DRACO_RETURN_IF_ERROR(SplitBucket(
+          bucket, bucket_reader, max_points_per_chunk, read_chunk_points,
+          bucket_buffer_size, directory, &split_buckets));
+      // Buckets that can't be split any further are encoded into multiple
+      // chunks in the input order.
+      if (split_buckets.size() > 1) {
+        for (auto it = split_buckets.rbegin(); it != split_buckets.rend();
+             ++it) {
+          buckets.push_back(std::move(*it));
+        }
+        continue;
+      }
+    }
+
+    // Encode the points of the bucket into chunks.
+    TraceScope trace(options().GetTracer(),
+                     "ChunkedPointCloudEncoder::EncodeChunks");
+    DRACO_RETURN_IF_ERROR(bucket_reader->Rewind());
+    while (true) {
+      positions.clear();
+      int64_t num_points = 0;
+      while (num_points < max_points_per_chunk) {
+        DRACO_ASSIGN_OR_RETURN(
+            const int64_t num_read_points,
+            bucket_reader->ReadChunk(
+                std::min(read_chunk_points, max_points_per_chunk - num_points),
+                &positions));
+        if (num_read_points == 0) {
+          break;
+        }
+        num_points += num_read_points;
+      }
+      if (num_points == 0) {
+        break;
+      }
+      PointCloudBuilder builder;
+      builder.Start(static_cast<PointIndex::ValueType>(num_points));
+      const int pos_att_id =
+          builder.AddAttribute(GeometryAttribute::POSITION, 3, DT_FLOAT32);
+      builder.SetAttributeValuesForAllPoints(pos_att_id, positions.data(), 0);
+      std::unique_ptr<PointCloud> chunk_pc = builder.Finalize(false);
+      if (chunk_pc == nullptr) {
+        return Status(Status::DRACO_ERROR, "Failed to create a chunk.");
+      }
+      Encoder encoder;
+      encoder.Reset(chunk_options);
+      EncoderBuffer chunk_buffer;
+      DRACO_RETURN_IF_ERROR(
+          encoder.EncodePointCloudToBuffer(*chunk_pc, &chunk_buffer));
+      DRACO_RETURN_IF_ERROR(
+          chunk_data.Append(chunk_buffer.data(), chunk_buffer.size()));
+
+      ChunkedPointCloudChunkInfo chunk;
+      bool box_empty = true;
+      UpdateBoundingBox(positions.data(), num_points, &chunk.bounding_box,
+                        &box_empty);
+      chunk.num_points = static_cast<uint32_t>(num_points);
+      chunk.offset = chunk_data_size;
+      chunk.size = chunk_buffer.size();
+      chunk_data_size += chunk.size;
+      chunks_.push_back(chunk);
+      set_num_encoded_points(num_encoded_points() +
+                             encoder.num_encoded_points());
+    }
+  }
+
+  // Write the container header and the chunk index.
+  out_buffer->Encode(kChunkedPointCloudMagic, kChunkedPointCloudMagicLength);
+  out_buffer->Encode(kChunkedPointCloudVersionMajor);
+  out_buffer->Encode(kChunkedPointCloudVersionMinor);
+  const uint16_t flags = 0;
+  out_buffer->Encode(flags);
+  EncodeVarint(static_cast<uint32_t>(chunks_.size()), out_buffer);
+  for (const ChunkedPointCloudChunkInfo &chunk : chunks_) {
+    for (int c = 0; c < 3; ++c) {
+      out_buffer->Encode(chunk.bounding_box.min_point()[c]);
+    }
+    for (int c = 0; c < 3; ++c) {
+      out_buffer->Encode(chunk.bounding_box.max_point()[c]);
+    }
+    EncodeVarint(chunk.num_points, out_buffer);
+    EncodeVarint(chunk.size, out_buffer);
+  }
+
+  // Copy the encoded chunks in blocks that fit into the memory limit.
+  FILE *const file = fopen(chunk_data.path().c_str(), "rb");
+  if (file == nullptr && chunk_data_size > 0) {
+    return Status(Status::IO_ERROR, "Failed to open a temporary file.");
+  }
+  std::vector<char> block(
+      std::min<uint64_t>(chunk_data_size, memory_limit_ / 8));
+  uint64_t num_copied_bytes = 0;
+  bool copy_failed = false;
+  while (num_copied_bytes < chunk_data_size) {
+    const size_t size = fread(block.data(), 1, block.size(), file);
+    if (size == 0 || !out_buffer->Encode(block.data(), size)) {
+      copy_failed = true;
+      break;
+    }
+    num_copied_bytes += size;
+  }
+  if (file != nullptr) {
+    fclose(file);
+  }
+  if (copy_failed) {
+    return Status(Status::IO_ERROR, "Failed to write the encoded chunks.");
+  }
+  return OkStatus();
+}
+
+}  // namespace draco
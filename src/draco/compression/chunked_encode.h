@@ -0,0 +1,117 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_COMPRESSION_CHUNKED_ENCODE_H_
+#define DRACO_COMPRESSION_CHUNKED_ENCODE_H_
+
+#include <string>
+#include <vector>
+
+#include "draco/compression/chunked_point_cloud_shared.h"
+#include "draco/compression/encode.h"
+#include "draco/io/point_cloud_chunk_reader.h"
+
+namespace draco {
+
+// Encoder of point clouds that are too large to be held in memory, such as
+// aerial scans with billions of points. The points are read in bounded chunks
+// from a PointCloudChunkReader and distributed into spatial buckets stored in
+// temporary files. Buckets that hold too many points are split again until
+// each of them fits into the memory limit. Each bucket is then encoded as an
+// independent Draco point cloud with the options of this encoder (e.g., with
+// the kd-tree or the sequential method) and stored in the chunked point cloud
+// container described in chunked_point_cloud_shared.h. The container can be
+// decoded with ChunkedPointCloudDecoder.
+//
+// Only the positions of the points are encoded. When position quantization
+// is used without an explicitly set quantization box, all chunks are
+// quantized in the bounding box of the whole point cloud.
+//
+// The memory used by the encoder stays below the limit set by
+// SetMemoryLimit() regardless of the size of the input, except for the
+// memory of |out_buffer| that can be bounded by setting a sink to the buffer
+// (see EncoderBuffer::SetSink()). The disk space needed for the temporary
+// files is about twice the size of the positions of all points.
+//
+// Example:
+//
+//   ChunkedPointCloudEncoder encoder;
+//   encoder.SetAttributeQuantization(GeometryAttribute::POSITION, 16);
+//   encoder.SetMemoryLimit(int64_t(1) << 30);
+//   auto reader = CreatePointCloudChunkReader("scan.ply").value();
+//   std::ofstream file("scan.drcc", std::ios::binary);
+//   StreamEncoderBufferSink sink(&file);
+//   EncoderBuffer buffer;
+//   buffer.SetSink(&sink);
+//   DRACO_RETURN_IF_ERROR(encoder.EncodeToBuffer(reader.get(), &buffer));
+//   buffer.Flush();
+//
+class ChunkedPointCloudEncoder : public Encoder {
+ public:
+  ChunkedPointCloudEncoder();
+
+  // Encodes all points provided by |reader| into the chunked point cloud
+  // container stored in |out_buffer|. The |reader| is read twice, first to
+  // compute the bounding box of the points and then to bucket them.
+  Status EncodeToBuffer(PointCloudChunkReader *reader,
+                        EncoderBuffer *out_buffer);
+
+  // Encodes the point cloud |pc| into the chunked point cloud container. The
+  // point cloud must contain only a single 3D position attribute.
+  Status EncodePointCloudToBuffer(const PointCloud &pc,
+                                  EncoderBuffer *out_buffer) override;
+
+  // Meshes can't be encoded into chunks. Always returns an error.
+  Status EncodeMeshToBuffer(const Mesh &m, EncoderBuffer *out_buffer) override;
+
+  // Sets the maximum number of bytes of memory used by the encoder (default =
+  // 512 MiB). The limit determines the size of the chunks read from the input,
+  // the memory used for buffering of the buckets and the maximum number of
+  // points of an encoded chunk.
+  void SetMemoryLimit(int64_t memory_limit) { memory_limit_ = memory_limit; }
+  int64_t memory_limit() const { return memory_limit_; }
+
+  // Sets the maximum number of points stored in a single chunk (default =
+  // 1048576). The number is further limited by the memory limit. Smaller
+  // chunks allow finer region queries, but they decrease the compression
+  // efficiency.
+  void SetMaxPointsPerChunk(int64_t max_points_per_chunk) {
+    max_points_per_chunk_ = max_points_per_chunk;
+  }
+
+  // Sets the directory used for the temporary files. By default, the
+  // directory given by the TMPDIR environment variable or "/tmp" is used.
+  void SetTemporaryDirectory(const std::string &directory) {
+    temporary_directory_ = directory;
+  }
+
+  // Returns the chunk index of the last encoded point cloud.
+  const std::vector<ChunkedPointCloudChunkInfo> &chunks() const {
+    return chunks_;
+  }
+
+  // Returns the maximum number of points stored in a chunk for the current
+  // settings.
+  int64_t GetMaxPointsPerChunk() const;
+
+ private:
+  int64_t memory_limit_;
+  int64_t max_points_per_chunk_;
+  std::string temporary_directory_;
+  std::vector<ChunkedPointCloudChunkInfo> chunks_;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_CHUNKED_ENCODE_H_
@@ -0,0 +1,62 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_COMPRESSION_CHUNKED_POINT_CLOUD_SHARED_H_
+#define DRACO_COMPRESSION_CHUNKED_POINT_CLOUD_SHARED_H_
+
+#include <cstdint>
+
+#include "draco/core/bounding_box.h"
+
+namespace draco {
+
+// Layout of the chunked point cloud container produced by
+// ChunkedPointCloudEncoder. The point cloud is split into spatially coherent
+// chunks and each chunk is stored as a regular, independently decodable Draco
+// point cloud. The container is defined as:
+//
+//   "DCHNK"                        5 bytes
+//   version major, version minor   2 x uint8_t
+//   flags (reserved)               uint16_t
+//   number of chunks               varint
+//   for each chunk:
+//     bounding box min, max        6 x float
+//     number of points             varint
+//     size of the encoded chunk    varint
+//   encoded data of all chunks in the order of the chunk index
+//
+static constexpr char kChunkedPointCloudMagic[] = "DCHNK";
+static constexpr int kChunkedPointCloudMagicLength = 5;
+static constexpr uint8_t kChunkedPointCloudVersionMajor = 1;
+static constexpr uint8_t kChunkedPointCloudVersionMinor = 0;
+
+// Entry of the chunk index.
+struct ChunkedPointCloudChunkInfo {
+  ChunkedPointCloudChunkInfo()
+      : bounding_box(Vector3f(0.f, 0.f, 0.f), Vector3f(0.f, 0.f, 0.f)),
+        num_points(0),
+        offset(0),
+        size(0) {}
+
+  // Bounding box of the positions of all points of the chunk.
+  BoundingBox bounding_box;
+  uint32_t num_points;
+  // Location of the encoded chunk relative to the end of the chunk index.
+  uint64_t offset;
+  uint64_t size;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_CHUNKED_POINT_CLOUD_SHARED_H_
@@ -0,0 +1,210 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/chunked_decode.h"
+#include "draco/compression/chunked_encode.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+
+#include "draco/core/draco_test_base.h"
+#include "draco/core/draco_test_utils.h"
+#include "draco/point_cloud/point_cloud_builder.h"
+
+namespace {
+
+class ChunkedPointCloudTest : public ::testing::Test {
+ protected:
+  // Creates a point cloud with |num_points| random points in a 100x100x10
+  // box on a grid with a step of 0.01. A quarter of the points is concentrated
+  // in a small cluster and another quarter consists of copies of a single
+  // point so that the buckets need to be split repeatedly.
+  std::unique_ptr<draco::PointCloud> CreatePointCloud(int num_points) const {
+    std::mt19937 gen(17);
+    // Returns a random value from [0, max_value] on the grid.
+    const auto random_value = [&gen](int max_value) {
+      return std::uniform_int_distribution<int>(0, 100 * max_value)(gen) /
+             100.f;
+    };
+    std::vector<float> positions;
+    for (int i = 0; i < num_points; ++i) {
+      if (i % 4 == 1) {
+        positions.push_back(40.f + random_value(1));
+        positions.push_back(60.f + random_value(1));
+        positions.push_back(5.f + random_value(1));
+      } else if (i % 4 == 2) {
+        positions.push_back(10.f);
+        positions.push_back(20.f);
+        positions.push_back(3.f);
+      } else {
+        positions.push_back(random_value(100));
+        positions.push_back(random_value(100));
+        positions.push_back(random_value(10));
+      }
+    }
+    draco::PointCloudBuilder builder;
+    builder.Start(num_points);
+    const int pos_att_id = builder.AddAttribute(
+        draco::GeometryAttribute::POSITION, 3, draco::DT_FLOAT32);
+    builder.SetAttributeValuesForAllPoints(pos_att_id, positions.data(), 0);
+    return builder.Finalize(false);
+  }
+
+  // Returns sorted positions of all points of |pc| rounded to the grid used
+  // in CreatePointCloud().
+  std::vector<std::array<float, 3>> GetSortedPositions(
+      const draco::PointCloud &pc) const {
+    const draco::PointAttribute *const att =
+        pc.GetNamedAttribute(draco::GeometryAttribute::POSITION);
+    std::vector<std::array<float, 3>> positions(pc.num_points());
+    for (draco::PointIndex i(0); i < pc.num_points(); ++i) {
+      att->ConvertValue<float>(att->mapped_index(i), 3,
+                               &positions[i.value()][0]);
+      for (int c = 0; c < 3; ++c) {
+        positions[i.value()][c] = std::round(positions[i.value()][c] * 100.f);
+      }
+    }
+    std::sort(positions.begin(), positions.end());
+    return positions;
+  }
+
+  void EncodeChunked(const draco::PointCloud &pc, int max_points_per_chunk,
+                     draco::EncoderBuffer *buffer) const {
+    draco::ChunkedPointCloudEncoder encoder;
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 16);
+    encoder.SetSpeedOptions(6, 6);
+    encoder.SetMemoryLimit(1 << 20);
+    encoder.SetMaxPointsPerChunk(max_points_per_chunk);
+    encoder.SetTemporaryDirectory(draco::GetTestTempFileFullPath(""));
+    ASSERT_TRUE(encoder.EncodePointCloudToBuffer(pc, buffer).ok());
+    ASSERT_GT(encoder.chunks().size(), 1u);
+    uint32_t num_points = 0;
+    for (const draco::ChunkedPointCloudChunkInfo &chunk : encoder.chunks()) {
+      ASSERT_GT(chunk.num_points, 0u);
+      ASSERT_LE(chunk.num_points, static_cast<uint32_t>(max_points_per_chunk));
+      num_points += chunk.num_points;
+    }
+    ASSERT_EQ(num_points, pc.num_points());
+  }
+};
+
+TEST_F(ChunkedPointCloudTest, TestDecodePointCloud) {
+  const std::unique_ptr<draco::PointCloud> pc = CreatePointCloud(20000);
+  ASSERT_NE(pc, nullptr);
+  draco::EncoderBuffer buffer;
+  EncodeChunked(*pc, 1000, &buffer);
+
+  draco::DecoderBuffer dec_buffer;
+  dec_buffer.Init(buffer.data(), buffer.size());
+  draco::ChunkedPointCloudDecoder decoder(4);
+  ASSERT_TRUE(decoder.DecodeChunkIndex(&dec_buffer).ok());
+  ASSERT_EQ(dec_buffer.remaining_size(), 0);
+  auto pc_or = decoder.DecodePointCloud();
+  ASSERT_TRUE(pc_or.ok()) << pc_or.status().error_msg();
+  const std::unique_ptr<draco::PointCloud> decoded_pc =
+      std::move(pc_or).value();
+  ASSERT_EQ(decoded_pc->num_points(), pc->num_points());
+
+  // All chunks are quantized in the same grid with a step of 100 / 2^16 so
+  // all points are recovered after rounding to the input grid.
+  ASSERT_EQ(GetSortedPositions(*pc), GetSortedPositions(*decoded_pc));
+}
+
+TEST_F(ChunkedPointCloudTest, TestDecodeChunksInBox) {
+  const std::unique_ptr<draco::PointCloud> pc = CreatePointCloud(20000);
+  ASSERT_NE(pc, nullptr);
+  draco::EncoderBuffer buffer;
+  EncodeChunked(*pc, 500, &buffer);
+
+  draco::DecoderBuffer dec_buffer;
+  dec_buffer.Init(buffer.data(), buffer.size());
+  draco::ChunkedPointCloudDecoder decoder(2);
+  ASSERT_TRUE(decoder.DecodeChunkIndex(&dec_buffer).ok());
+  const draco::BoundingBox box(draco::Vector3f(0.f, 0.f, 0.f),
+                               draco::Vector3f(20.f, 20.f, 10.f));
+  const std::vector<int> chunk_ids = decoder.FindChunks(box);
+  ASSERT_FALSE(chunk_ids.empty());
+  ASSERT_LT(chunk_ids.size(), static_cast<size_t>(decoder.num_chunks()));
+
+  // Invalid chunk ids are reported for each chunk separately.
+  std::vector<int> requested_ids = chunk_ids;
+  requested_ids.push_back(decoder.num_chunks());
+  auto chunks = decoder.DecodeChunks(requested_ids);
+  ASSERT_EQ(chunks.size(), requested_ids.size());
+  ASSERT_FALSE(chunks.back().ok());
+  for (size_t i = 0; i < chunk_ids.size(); ++i) {
+    ASSERT_TRUE(chunks[i].ok()) << chunks[i].status().error_msg();
+    const draco::ChunkedPointCloudChunkInfo &info =
+        decoder.chunk(chunk_ids[i]);
+    ASSERT_EQ(chunks[i].value()->num_points(), info.num_points);
+    // Decoded points lie within the bounding box of the chunk up to the
+    // quantization error.
+    for (const std::array<float, 3> &pos :
+         GetSortedPositions(*chunks[i].value())) {
+      for (int c = 0; c < 3; ++c) {
+        ASSERT_GE(pos[c], std::round(info.bounding_box.min_point()[c] * 100.f));
+        ASSERT_LE(pos[c], std::round(info.bounding_box.max_point()[c] * 100.f));
+      }
+    }
+  }
+}
+
+TEST_F(ChunkedPointCloudTest, TestEncodeFromFile) {
+  draco::ChunkedPointCloudEncoder encoder;
+  encoder.SetMaxPointsPerChunk(2000);
+  encoder.SetTemporaryDirectory(draco::GetTestTempFileFullPath(""));
+  auto reader_or = draco::CreatePointCloudChunkReader(
+      draco::GetTestFileFullPath("bun_zipper.ply"));
+  ASSERT_TRUE(reader_or.ok()) << reader_or.status();
+  draco::EncoderBuffer buffer;
+  ASSERT_TRUE(encoder.EncodeToBuffer(reader_or.value().get(), &buffer).ok());
+
+  draco::DecoderBuffer dec_buffer;
+  dec_buffer.Init(buffer.data(), buffer.size());
+  draco::ChunkedPointCloudDecoder decoder(4);
+  ASSERT_TRUE(decoder.DecodeChunkIndex(&dec_buffer).ok());
+  ASSERT_EQ(decoder.num_chunks(), static_cast<int>(encoder.chunks().size()));
+  auto pc_or = decoder.DecodePointCloud();
+  ASSERT_TRUE(pc_or.ok()) << pc_or.status().error_msg();
+  ASSERT_EQ(pc_or.value()->num_points(), 35947u);
+}
+
+TEST_F(ChunkedPointCloudTest, TestInvalidInput) {
+  draco::ChunkedPointCloudEncoder encoder;
+  draco::EncoderBuffer buffer;
+  // Only point clouds with a single position attribute are supported.
+  std::unique_ptr<draco::PointCloud> pc(
+      draco::ReadPointCloudFromTestFile("point_cloud_test_pos_norm.ply"));
+  ASSERT_NE(pc, nullptr);
+  ASSERT_FALSE(encoder.EncodePointCloudToBuffer(*pc, &buffer).ok());
+  std::unique_ptr<draco::Mesh> mesh(
+      draco::ReadMeshFromTestFile("cube_att.ply"));
+  ASSERT_NE(mesh, nullptr);
+  ASSERT_FALSE(encoder.EncodeMeshToBuffer(*mesh, &buffer).ok());
+
+  // Regular Draco stream is not a chunked point cloud.
+  pc = draco::ReadPointCloudFromTestFile("point_cloud_test_pos.ply");
+  ASSERT_NE(pc, nullptr);
+  draco::Encoder regular_encoder;
+  buffer.Clear();
+  ASSERT_TRUE(regular_encoder.EncodePointCloudToBuffer(*pc, &buffer).ok());
+  draco::DecoderBuffer dec_buffer;
+  dec_buffer.Init(buffer.data(), buffer.size());
+  draco::ChunkedPointCloudDecoder decoder(1);
+  ASSERT_FALSE(decoder.DecodeChunkIndex(&dec_buffer).ok());
+}
+
+}  // namespace
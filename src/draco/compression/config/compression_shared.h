@@ -25,9 +25,21 @@ namespace draco {
 
 // Latest Draco bit-stream version.
 static constexpr uint8_t kDracoPointCloudBitstreamVersionMajor = 2;
-static constexpr uint8_t kDracoPointCloudBitstreamVersionMinor = 3;
+static constexpr uint8_t kDracoPointCloudBitstreamVersionMinor = 5;
 static constexpr uint8_t kDracoMeshBitstreamVersionMajor = 2;
-static constexpr uint8_t kDracoMeshBitstreamVersionMinor = 2;
+static constexpr uint8_t kDracoMeshBitstreamVersionMinor = 3;
+
+// Bit-stream versions written when the interleaved symbol coding is not used
+// (see SYMBOL_CODING_RAW_INTERLEAVED). Such data can still be decoded by
+// decoders that do not support the latest bit-stream version.
+static constexpr uint8_t kDracoPointCloudNonInterleavedBitstreamVersionMinor =
+    3;
+static constexpr uint8_t kDracoMeshNonInterleavedBitstreamVersionMinor = 2;
+
+// Point cloud bit-stream version written when the kd-tree subtree streams are
+// not used (see EncoderBase::SetKdTreeSubtreeDepth()).
+static constexpr uint8_t kDracoPointCloudNonKdTreeSubtreeBitstreamVersionMinor =
+    4;
 
 // Concatenated latest bit-stream version.
 static constexpr uint16_t kDracoPointCloudBitstreamVersion =
@@ -45,6 +57,14 @@ enum EncodedGeometryType {
   TRIANGULAR_MESH,
 };
 
+// Returns the first bit-stream version of |geometry_type| that supports the
+// interleaved symbol coding (SYMBOL_CODING_RAW_INTERLEAVED).
+inline uint16_t InterleavedSymbolCodingBitstreamVersion(
+    EncodedGeometryType geometry_type) {
+  return geometry_type == TRIANGULAR_MESH ? DRACO_BITSTREAM_VERSION(2, 3)
+                                          : DRACO_BITSTREAM_VERSION(2, 4);
+}
+
 // List of encoding methods for point clouds.
 enum PointCloudEncodingMethod {
   POINT_CLOUD_SEQUENTIAL_ENCODING = 0,
@@ -142,6 +162,11 @@ enum NormalPredictionMode {
 enum SymbolCodingMethod {
   SYMBOL_CODING_TAGGED = 0,
   SYMBOL_CODING_RAW = 1,
+  // Same as SYMBOL_CODING_RAW but the symbols are encoded using multiple
+  // interleaved rANS states, which makes the decoding faster. Supported since
+  // mesh bit-stream version 2.3 and point cloud bit-stream version 2.4, and
+  // only for attribute values and sequential mesh indices.
+  SYMBOL_CODING_RAW_INTERLEAVED = 2,
   NUM_SYMBOL_CODING_METHODS,
 };
 
@@ -22,6 +22,8 @@
 
 namespace draco {
 
+class Tracer;
+
 // Base option class used to control encoding and decoding. The geometry coding
 // can be controlled through the following options:
 //   1. Global options - Options specific to overall geometry or options common
@@ -53,6 +55,8 @@ class DracoOptions {
  public:
   typedef AttributeKeyT AttributeKey;
 
+  DracoOptions() : tracer_(nullptr) {}
+
   // Get an option for a specific attribute key. If the option is not found in
   // an attribute specific storage, the implementation will return a global
   // option of the given name (if available). If the option is not found, the
@@ -123,6 +127,18 @@ class DracoOptions {
   const Options *FindAttributeOptions(const AttributeKeyT &att_key) const;
   const Options &GetGlobalOptions() const { return global_options_; }
 
+  // Returns options of all attributes sorted by the attribute keys.
+  const std::map<AttributeKey, Options> &GetAllAttributeOptions() const {
+    return attribute_options_;
+  }
+
+  // Sets a tracer that receives events about the individual encoding or
+  // decoding stages (see core/tracer.h). The tracer is not owned by the options
+  // and it must outlive all encoding and decoding calls that use the options.
+  // Tracing is disabled by default.
+  void SetTracer(Tracer *tracer) { tracer_ = tracer; }
+  Tracer *GetTracer() const { return tracer_; }
+
  private:
   Options *GetAttributeOptions(const AttributeKeyT &att_key);
 
@@ -130,6 +146,8 @@ class DracoOptions {
 
   // Storage for options related to geometry attributes.
   std::map<AttributeKey, Options> attribute_options_;
+
+  Tracer *tracer_;
 };
 
 template <typename AttributeKeyT>
@@ -52,6 +52,38 @@ StatusOr<std::unique_ptr<MeshDecoder>> CreateMeshDecoder(uint8_t method) {
 }
 #endif
 
+namespace {
+
+// Creates a decoder for the geometry described by |header| and starts the
+// incremental decoding of the geometry into |out_geometry|.
+StatusOr<std::unique_ptr<PointCloudDecoder>> StartGeometryDecoding(
+    const DracoHeader &header, const DecoderOptions &options,
+    DecoderBuffer *buffer, std::unique_ptr<PointCloud> *out_geometry) {
+  if (header.encoder_type == POINT_CLOUD) {
+#ifdef DRACO_POINT_CLOUD_COMPRESSION_SUPPORTED
+    DRACO_ASSIGN_OR_RETURN(std::unique_ptr<PointCloudDecoder> decoder,
+                           CreatePointCloudDecoder(header.encoder_method))
+    *out_geometry = std::unique_ptr<PointCloud>(new PointCloud());
+    decoder->StartDecoding(options, buffer, out_geometry->get());
+    return std::move(decoder);
+#endif
+  } else if (header.encoder_type == TRIANGULAR_MESH) {
+#ifdef DRACO_MESH_COMPRESSION_SUPPORTED
+    DRACO_ASSIGN_OR_RETURN(std::unique_ptr<MeshDecoder> decoder,
+                           CreateMeshDecoder(header.encoder_method))
+    std::unique_ptr<Mesh> mesh(new Mesh());
+    decoder->StartDecoding(options, buffer, mesh.get());
+    *out_geometry = std::move(mesh);
+    return std::unique_ptr<PointCloudDecoder>(std::move(decoder));
+#endif
+  }
+  return Status(Status::DRACO_ERROR, "Unsupported geometry type.");
+}
+
+}  // namespace
+
+Decoder::Decoder() : thread_pool_(nullptr), scratch_(nullptr) {}
+
 StatusOr<EncodedGeometryType> Decoder::GetEncodedGeometryType(
     DecoderBuffer *in_buffer) {
   DecoderBuffer temp_buffer(*in_buffer);
@@ -60,6 +92,49 @@ StatusOr<EncodedGeometryType> Decoder::GetEncodedGeometryType(
   return static_cast<EncodedGeometryType>(header.encoder_type);
 }
 
+StatusOr<GeometryInfo> Decoder::ProbeGeometryInfo(DecoderBuffer *in_buffer) {
+  DecoderBuffer buffer(*in_buffer);
+  DracoHeader header;
+  {
+    DecoderBuffer temp_buffer(*in_buffer);
+    DRACO_RETURN_IF_ERROR(
+        PointCloudDecoder::DecodeHeader(&temp_buffer, &header))
+  }
+  std::unique_ptr<PointCloud> geometry;
+  DRACO_ASSIGN_OR_RETURN(
+      std::unique_ptr<PointCloudDecoder> decoder,
+      StartGeometryDecoding(header, options_, &buffer, &geometry))
+  decoder->set_scratch(scratch_);
+  // Decode everything up to the attribute values.
+  while (!decoder->IsAttributeLayoutDecoded()) {
+    DRACO_RETURN_IF_ERROR(decoder->DecodeNextStage())
+  }
+
+  GeometryInfo info;
+  info.geometry_type = static_cast<EncodedGeometryType>(header.encoder_type);
+  info.encoder_method = header.encoder_method;
+  info.version_major = header.version_major;
+  info.version_minor = header.version_minor;
+  info.has_metadata = geometry->GetMetadata() != nullptr;
+  info.num_points = geometry->num_points();
+  info.num_faces = 0;
+  if (header.encoder_type == TRIANGULAR_MESH) {
+    info.num_faces = static_cast<const Mesh *>(geometry.get())->num_faces();
+  }
+  info.attributes.resize(geometry->num_attributes());
+  for (int i = 0; i < geometry->num_attributes(); ++i) {
+    const PointAttribute *const att = geometry->attribute(i);
+    GeometryInfo::AttributeInfo &att_info = info.attributes[i];
+    att_info.attribute_type = att->attribute_type();
+    att_info.num_components = att->num_components();
+    att_info.data_type = att->data_type();
+    att_info.normalized = att->normalized();
+    att_info.unique_id = att->unique_id();
+  }
+  info.num_probed_bytes = buffer.decoded_size();
+  return info;
+}
+
 StatusOr<std::unique_ptr<PointCloud>> Decoder::DecodePointCloudFromBuffer(
     DecoderBuffer *in_buffer) {
   DRACO_ASSIGN_OR_RETURN(EncodedGeometryType type,
@@ -99,6 +174,8 @@ Status Decoder::DecodeBufferToGeometry(DecoderBuffer *in_buffer,
   DRACO_ASSIGN_OR_RETURN(std::unique_ptr<PointCloudDecoder> decoder,
                          CreatePointCloudDecoder(header.encoder_method))
 
+  decoder->set_thread_pool(thread_pool_);
+  decoder->set_scratch(scratch_);
   DRACO_RETURN_IF_ERROR(decoder->Decode(options_, in_buffer, out_geometry))
   return OkStatus();
 #else
@@ -118,6 +195,8 @@ Status Decoder::DecodeBufferToGeometry(DecoderBuffer *in_buffer,
   DRACO_ASSIGN_OR_RETURN(std::unique_ptr<MeshDecoder> decoder,
                          CreateMeshDecoder(header.encoder_method))
 
+  decoder->set_thread_pool(thread_pool_);
+  decoder->set_scratch(scratch_);
   DRACO_RETURN_IF_ERROR(decoder->Decode(options_, in_buffer, out_geometry))
   return OkStatus();
 #else
@@ -125,8 +204,75 @@ Status Decoder::DecodeBufferToGeometry(DecoderBuffer *in_buffer,
 #endif
 }
 
+Status Decoder::DecodeBufferToVertexBuffers(
+    DecoderBuffer *in_buffer, const VertexLayout &layout, void *out_vertices,
+    size_t out_vertices_size, DataType index_type, void *out_indices,
+    size_t out_indices_size) {
+  DracoHeader header;
+  {
+    DecoderBuffer temp_buffer(*in_buffer);
+    DRACO_RETURN_IF_ERROR(
+        PointCloudDecoder::DecodeHeader(&temp_buffer, &header))
+  }
+  std::unique_ptr<PointCloud> geometry;
+  DRACO_ASSIGN_OR_RETURN(
+      std::unique_ptr<PointCloudDecoder> decoder,
+      StartGeometryDecoding(header, options_, in_buffer, &geometry))
+  decoder->set_thread_pool(thread_pool_);
+  decoder->set_scratch(scratch_);
+  while (!decoder->IsAttributeLayoutDecoded()) {
+    DRACO_RETURN_IF_ERROR(decoder->DecodeNextStage())
+  }
+  // Keep the selected attributes in their portable form. Their transform is
+  // applied when the values are written to the vertex buffer.
+  std::vector<int32_t> att_ids;
+  for (const VertexElement &element : layout.elements) {
+    if (element.attribute_id < 0 ||
+        element.attribute_id >= geometry->num_attributes())
+      return Status(Status::DRACO_ERROR, "Invalid vertex element.");
+    att_ids.push_back(element.attribute_id);
+  }
+  decoder->set_portable_only_attribute_ids(att_ids);
+  while (!decoder->IsDecodingDone()) {
+    DRACO_RETURN_IF_ERROR(decoder->DecodeNextStage())
+  }
+  // Transformed values are read directly from the portable attributes when
+  // the decoder keeps them, otherwise from the decoded geometry.
+  std::vector<const PointAttribute *> attributes;
+  for (const int32_t att_id : att_ids) {
+    const PointAttribute *att = decoder->GetPortableAttribute(att_id);
+    if (att == nullptr || att->GetAttributeTransformData() == nullptr)
+      att = geometry->attribute(att_id);
+    attributes.push_back(att);
+  }
+  DRACO_RETURN_IF_ERROR(WriteVertexBuffer(geometry->num_points(), layout,
+                                          attributes, out_vertices,
+                                          out_vertices_size))
+  if (header.encoder_type == TRIANGULAR_MESH) {
+    DRACO_RETURN_IF_ERROR(
+        WriteIndexBuffer(*static_cast<const Mesh *>(geometry.get()),
+                         index_type, out_indices, out_indices_size))
+  }
+  return OkStatus();
+}
+
 void Decoder::SetSkipAttributeTransform(GeometryAttribute::Type att_type) {
   options_.SetAttributeBool(att_type, "skip_attribute_transform", true);
 }
 
+void Decoder::SetAttributeQueryBox(GeometryAttribute::Type att_type,
+                                   const std::vector<float> &box_min,
+                                   const std::vector<float> &box_max) {
+  options_.SetAttributeVector(att_type, "query_box_min",
+                              static_cast<int>(box_min.size()),
+                              box_min.data());
+  options_.SetAttributeVector(att_type, "query_box_max",
+                              static_cast<int>(box_max.size()),
+                              box_max.data());
+}
+
+void Decoder::SetNumThreads(int num_threads) {
+  options_.SetGlobalInt("num_threads", num_threads);
+}
+
 }  // namespace draco
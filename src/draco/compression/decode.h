@@ -19,16 +19,48 @@
 
 #include "draco/compression/config/compression_shared.h"
 #include "draco/compression/config/decoder_options.h"
+#include "draco/compression/decoder_scratch.h"
+#include "draco/compression/vertex_layout.h"
 #include "draco/core/decoder_buffer.h"
 #include "draco/core/status_or.h"
+#include "draco/core/thread_pool.h"
 #include "draco/mesh/mesh.h"
 
 namespace draco {
 
+// Basic properties of an encoded geometry returned by
+// Decoder::ProbeGeometryInfo().
+struct GeometryInfo {
+  struct AttributeInfo {
+    GeometryAttribute::Type attribute_type;
+    int num_components;
+    DataType data_type;
+    bool normalized;
+    uint32_t unique_id;
+  };
+
+  EncodedGeometryType geometry_type;
+  // One of MeshEncoderMethod or PointCloudEncodingMethod values depending on
+  // the |geometry_type|.
+  int encoder_method;
+  uint8_t version_major;
+  uint8_t version_minor;
+  bool has_metadata;
+  int32_t num_points;
+  // Always zero for point clouds.
+  int32_t num_faces;
+  std::vector<AttributeInfo> attributes;
+  // Number of bytes at the start of the input that contain all the data
+  // needed by the probe. Decoding of the remaining data is skipped.
+  int64_t num_probed_bytes;
+};
+
 // Class responsible for decoding of meshes and point clouds that were
 // compressed by a Draco encoder.
 class Decoder {
  public:
+  Decoder();
+
   // Returns the geometry type encoded in the input |in_buffer|.
   // The return value is one of POINT_CLOUD, MESH or INVALID_GEOMETRY in case
   // the input data is invalid.
@@ -37,6 +69,15 @@ class Decoder {
   static StatusOr<EncodedGeometryType> GetEncodedGeometryType(
       DecoderBuffer *in_buffer);
 
+  // Returns the number of points and faces and the layout of all attributes of
+  // the geometry encoded in |in_buffer| without decoding any attribute values.
+  // The buffer is not advanced. For point clouds, only the headers of the
+  // encoded data are parsed. For meshes, the connectivity needs to be decoded
+  // because the number of points and the attribute headers are not known
+  // before that, but the attribute values that usually make most of the data
+  // are skipped.
+  StatusOr<GeometryInfo> ProbeGeometryInfo(DecoderBuffer *in_buffer);
+
   // Decodes point cloud from the provided buffer. The buffer must be filled
   // with data that was encoded with either the EncodePointCloudToBuffer or
   // EncodeMeshToBuffer methods in encode.h. In case the input buffer contains
@@ -59,6 +100,24 @@ class Decoder {
                                 PointCloud *out_geometry);
   Status DecodeBufferToGeometry(DecoderBuffer *in_buffer, Mesh *out_geometry);
 
+  // Decodes the geometry from |in_buffer| directly into caller-provided
+  // buffers, e.g., mapped GPU memory. Values of the attributes selected by
+  // |layout| are written for every point into |out_vertices| and, for meshes,
+  // the point indices of all faces are written into |out_indices| using
+  // |index_type| (DT_UINT16 or DT_UINT32). |out_indices| is ignored for point
+  // clouds. The required buffer sizes can be computed from the number of
+  // points and faces returned by ProbeGeometryInfo().
+  // Attribute transforms of the selected attributes are not applied to the
+  // decoded geometry. Instead, the dequantization or octahedral decoding is
+  // done while the values are written to |out_vertices|, which avoids storing
+  // the final values in an intermediate attribute.
+  Status DecodeBufferToVertexBuffers(DecoderBuffer *in_buffer,
+                                     const VertexLayout &layout,
+                                     void *out_vertices,
+                                     size_t out_vertices_size,
+                                     DataType index_type, void *out_indices,
+                                     size_t out_indices_size);
+
   // When set, the decoder is going to skip attribute transform for a given
   // attribute type. For example for quantized attributes, the decoder would
   // skip the dequantization step and the returned geometry would contain an
@@ -68,12 +127,44 @@ class Decoder {
   // transform manually.
   void SetSkipAttributeTransform(GeometryAttribute::Type att_type);
 
+  // Restricts decoded point clouds to the points whose attribute of type
+  // |att_type| lies inside of the axis-aligned box given by |box_min| and
+  // |box_max| (inclusive). Missing components of the box are not restricted.
+  // Boxes of multiple attribute types can be combined. Only point clouds
+  // encoded with the kd-tree method support the query. Other geometries are
+  // decoded whole. Points are decoded faster when the point cloud was encoded
+  // with subtree streams (see Encoder::SetKdTreeSubtreeDepth()), because
+  // subtrees outside of the box are skipped.
+  void SetAttributeQueryBox(GeometryAttribute::Type att_type,
+                            const std::vector<float> &box_min,
+                            const std::vector<float> &box_max);
+
+  // Sets the number of threads that can be used to decode independent
+  // attributes of the input geometry in parallel. The threads are created for
+  // each decoded geometry. Use SetThreadPool() to share threads between
+  // multiple decoding calls.
+  void SetNumThreads(int num_threads);
+
+  // Sets a thread pool that is used for parallel decoding of all subsequently
+  // decoded geometries. The |pool| is not owned by the decoder and it must
+  // outlive all decoding calls. Overrides the value set in SetNumThreads().
+  void SetThreadPool(ThreadPool *pool) { thread_pool_ = pool; }
+
+  // Sets scratch memory that is reused by all subsequent decoding calls. When
+  // decoding many meshes of a similar size, the scratch removes most of the
+  // memory allocations of the connectivity decoder. The |scratch| is not owned
+  // by the decoder and it must outlive all decoding calls. One scratch must not
+  // be used by multiple decoders at the same time.
+  void SetScratch(DecoderScratch *scratch) { scratch_ = scratch; }
+
   // Returns the options instance used by the decoder that can be used by users
   // to control the decoding process.
   DecoderOptions *options() { return &options_; }
 
  private:
   DecoderOptions options_;
+  ThreadPool *thread_pool_;
+  DecoderScratch *scratch_;
 };
 
 }  // namespace draco
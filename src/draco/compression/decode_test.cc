@@ -14,12 +14,21 @@
 //
 #include "draco/compression/decode.h"
 
+#include <algorithm>
 #include <cinttypes>
+#include <cmath>
+#include <cstring>
 #include <fstream>
+#include <map>
+#include <set>
 #include <sstream>
 
+#include "draco/compression/expert_encode.h"
+#include "draco/core/chrome_trace_recorder.h"
 #include "draco/core/draco_test_base.h"
 #include "draco/core/draco_test_utils.h"
+#include "draco/mesh/mesh_are_equivalent.h"
+#include "draco/point_cloud/point_cloud_builder.h"
 
 namespace {
 
@@ -193,4 +202,577 @@ TEST_F(DecodeTest, TestSkipAttributeTransformWithNoQuantization) {
   ASSERT_EQ(pos_att->GetAttributeTransformData(), nullptr);
 }
 
+void TestParallelDecoding(const std::string &file_name, int method) {
+  const std::unique_ptr<draco::Mesh> mesh =
+      draco::ReadMeshFromTestFile(file_name);
+  ASSERT_NE(mesh, nullptr);
+  draco::ExpertEncoder encoder(*mesh);
+  encoder.SetEncodingMethod(method);
+  for (int i = 0; i < mesh->num_attributes(); ++i) {
+    encoder.SetAttributeQuantization(i, 10);
+  }
+  draco::EncoderBuffer encoder_buffer;
+  ASSERT_TRUE(encoder.EncodeToBuffer(&encoder_buffer).ok());
+
+  draco::DecoderBuffer buffer;
+  buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+  draco::Decoder decoder;
+  const std::unique_ptr<draco::Mesh> serial_mesh =
+      decoder.DecodeMeshFromBuffer(&buffer).value();
+  ASSERT_NE(serial_mesh, nullptr);
+
+  // Decode the same data using both an external thread pool and threads
+  // created by the decoder.
+  draco::ThreadPool pool(3);
+  for (int use_pool = 0; use_pool < 2; ++use_pool) {
+    buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+    draco::Decoder parallel_decoder;
+    if (use_pool) {
+      parallel_decoder.SetThreadPool(&pool);
+    } else {
+      parallel_decoder.SetNumThreads(4);
+    }
+    const std::unique_ptr<draco::Mesh> parallel_mesh =
+        parallel_decoder.DecodeMeshFromBuffer(&buffer).value();
+    ASSERT_NE(parallel_mesh, nullptr);
+
+    // The decoded data must be exactly the same as for the serial decoding.
+    ASSERT_EQ(serial_mesh->num_faces(), parallel_mesh->num_faces());
+    ASSERT_EQ(serial_mesh->num_attributes(), parallel_mesh->num_attributes());
+    for (int i = 0; i < serial_mesh->num_attributes(); ++i) {
+      const draco::PointAttribute *const att = serial_mesh->attribute(i);
+      const draco::PointAttribute *const parallel_att =
+          parallel_mesh->attribute(i);
+      ASSERT_EQ(att->size(), parallel_att->size());
+      ASSERT_EQ(att->buffer()->data_size(),
+                parallel_att->buffer()->data_size());
+      ASSERT_EQ(std::memcmp(att->buffer()->data(),
+                            parallel_att->buffer()->data(),
+                            att->buffer()->data_size()),
+                0);
+    }
+  }
+}
+
+TEST_F(DecodeTest, TestParallelDecoding) {
+  // Tests that attributes decoded in parallel are the same as attributes
+  // decoded on a single thread.
+  TestParallelDecoding("test_nm.obj", draco::MESH_EDGEBREAKER_ENCODING);
+  TestParallelDecoding("test_nm.obj", draco::MESH_SEQUENTIAL_ENCODING);
+  TestParallelDecoding("cube_att.obj", draco::MESH_EDGEBREAKER_ENCODING);
+  TestParallelDecoding("cube_att.obj", draco::MESH_SEQUENTIAL_ENCODING);
+}
+
+TEST_F(DecodeTest, TestDecoderScratch) {
+  // Tests that the decoder scratch can be reused for decoding of multiple
+  // meshes and that the scratch buffers do not grow once the scratch is warmed
+  // up.
+  std::vector<draco::EncoderBuffer> encoded_meshes;
+  const std::string file_names[] = {"test_nm.obj", "cube_att.obj"};
+  for (const std::string &file_name : file_names) {
+    const std::unique_ptr<draco::Mesh> mesh =
+        draco::ReadMeshFromTestFile(file_name);
+    ASSERT_NE(mesh, nullptr);
+    // Encode the mesh with both the standard and the valence edgebreaker.
+    for (const int method : {draco::MESH_EDGEBREAKER_STANDARD_ENCODING,
+                             draco::MESH_EDGEBREAKER_VALENCE_ENCODING}) {
+      draco::ExpertEncoder encoder(*mesh);
+      encoder.SetEncodingMethod(draco::MESH_EDGEBREAKER_ENCODING);
+      encoder.options().SetGlobalInt("edgebreaker_method", method);
+      encoded_meshes.emplace_back();
+      ASSERT_TRUE(encoder.EncodeToBuffer(&encoded_meshes.back()).ok());
+    }
+  }
+
+  draco::DecoderScratch scratch;
+  draco::Decoder decoder;
+  decoder.SetScratch(&scratch);
+  draco::MeshAreEquivalent equiv;
+  int64_t num_scratch_growths = 0;
+  size_t allocated_size = 0;
+  for (int pass = 0; pass < 3; ++pass) {
+    for (const draco::EncoderBuffer &encoded_mesh : encoded_meshes) {
+      draco::DecoderBuffer buffer;
+      buffer.Init(encoded_mesh.data(), encoded_mesh.size());
+      const std::unique_ptr<draco::Mesh> mesh =
+          decoder.DecodeMeshFromBuffer(&buffer).value();
+      ASSERT_NE(mesh, nullptr);
+
+      // Compare against a mesh decoded without the scratch.
+      buffer.Init(encoded_mesh.data(), encoded_mesh.size());
+      draco::Decoder reference_decoder;
+      const std::unique_ptr<draco::Mesh> reference_mesh =
+          reference_decoder.DecodeMeshFromBuffer(&buffer).value();
+      ASSERT_NE(reference_mesh, nullptr);
+      ASSERT_TRUE(equiv(*mesh, *reference_mesh));
+    }
+    ASSERT_EQ(scratch.num_decodes(),
+              static_cast<int64_t>((pass + 1) * encoded_meshes.size()));
+    if (pass == 0) {
+      // All meshes needed to be decoded at least once to warm up the scratch.
+      ASSERT_GT(scratch.num_scratch_growths(), 0);
+      num_scratch_growths = scratch.num_scratch_growths();
+      allocated_size = scratch.ComputeAllocatedSize();
+      ASSERT_GT(allocated_size, 0);
+    } else {
+      ASSERT_EQ(scratch.num_scratch_growths(), num_scratch_growths);
+      ASSERT_EQ(scratch.ComputeAllocatedSize(), allocated_size);
+    }
+  }
+  scratch.Clear();
+  ASSERT_EQ(scratch.ComputeAllocatedSize(), 0);
+}
+
+// Verifies that all begin and end events recorded by the |recorder| are
+// properly nested on each thread and returns the names of all stages through
+// |out_stages| together with the number of bytes reported for each stage.
+// The total number of bytes of all top-level stages is returned in
+// |out_top_level_bytes|.
+void CheckTraceEvents(const draco::ChromeTraceRecorder &recorder,
+                      std::multimap<std::string, int64_t> *out_stages,
+                      int64_t *out_top_level_bytes) {
+  std::map<int, std::vector<std::string>> stacks;
+  *out_top_level_bytes = 0;
+  for (const auto &event : recorder.GetEvents()) {
+    std::vector<std::string> &stack = stacks[event.thread_id];
+    if (event.phase == 'B') {
+      stack.push_back(event.name);
+    } else {
+      ASSERT_EQ(event.phase, 'E');
+      ASSERT_FALSE(stack.empty());
+      ASSERT_EQ(stack.back(), event.name);
+      stack.pop_back();
+      out_stages->insert(std::make_pair(event.name, event.num_bytes));
+      if (stack.empty())
+        *out_top_level_bytes += std::max<int64_t>(event.num_bytes, 0);
+    }
+  }
+  for (const auto &stack : stacks) {
+    ASSERT_TRUE(stack.second.empty());
+  }
+}
+
+TEST_F(DecodeTest, TestTracing) {
+  // Tests that the encoding and decoding stages are reported to the tracer.
+  const std::unique_ptr<draco::Mesh> mesh =
+      draco::ReadMeshFromTestFile("test_nm.obj");
+  ASSERT_NE(mesh, nullptr);
+  draco::ChromeTraceRecorder encoder_recorder;
+  draco::ExpertEncoder encoder(*mesh);
+  for (int i = 0; i < mesh->num_attributes(); ++i) {
+    encoder.SetAttributeQuantization(i, 10);
+  }
+  encoder.options().SetTracer(&encoder_recorder);
+  draco::EncoderBuffer encoder_buffer;
+  ASSERT_TRUE(encoder.EncodeToBuffer(&encoder_buffer).ok());
+
+  std::multimap<std::string, int64_t> stages;
+  int64_t top_level_bytes;
+  CheckTraceEvents(encoder_recorder, &stages, &top_level_bytes);
+  for (const char *name : {"EncodeHeader", "EncodeGeometryData",
+                           "EncodePointAttributes", "EncodeSymbols"}) {
+    ASSERT_GT(stages.count(name), 0) << name;
+  }
+
+  draco::ChromeTraceRecorder recorder;
+  draco::DecoderBuffer buffer;
+  buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+  draco::Decoder decoder;
+  decoder.SetNumThreads(2);
+  decoder.options()->SetTracer(&recorder);
+  ASSERT_NE(decoder.DecodeMeshFromBuffer(&buffer).value(), nullptr);
+
+  stages.clear();
+  CheckTraceEvents(recorder, &stages, &top_level_bytes);
+  for (const char *name :
+       {"DecodeHeader", "DecodeGeometryData", "DecodeTopologySplitEvents",
+        "StartTraversalDecoding", "DecodeEdgebreakerConnectivity",
+        "DecodeAttributeSeams", "AssignPointsToCorners",
+        "DecodeAttributesDecoders", "GenerateSequence", "DecodeSymbols",
+        "ComputeOriginalValues", "TransformAttribute", "DequantizeValues"}) {
+    ASSERT_GT(stages.count(name), 0) << name;
+  }
+  // Header is always 11 bytes long.
+  ASSERT_EQ(stages.find("DecodeHeader")->second, 11);
+  // All data except for the edgebreaker traversal decoder type (1 byte) is
+  // consumed by the top-level decoding stages.
+  ASSERT_EQ(1 + top_level_bytes, static_cast<int64_t>(encoder_buffer.size()));
+
+  const std::string json = recorder.ToJson();
+  ASSERT_EQ(json.compare(0, 15, "{\"traceEvents\":"), 0);
+  ASSERT_NE(json.find("\"name\":\"DecodeHeader\""), std::string::npos);
+  ASSERT_NE(json.find("\"args\":{\"bytes\":11}"), std::string::npos);
+
+  // Nothing is recorded once the tracer is removed.
+  recorder.Clear();
+  decoder.options()->SetTracer(nullptr);
+  buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+  ASSERT_NE(decoder.DecodeMeshFromBuffer(&buffer).value(), nullptr);
+  ASSERT_TRUE(recorder.GetEvents().empty());
+}
+
+// Verifies that the geometry info returned by Decoder::ProbeGeometryInfo()
+// matches the fully decoded geometry.
+void CheckGeometryInfo(const std::vector<char> &data) {
+  draco::DecoderBuffer buffer;
+  buffer.Init(data.data(), data.size());
+  draco::Decoder decoder;
+  const draco::StatusOr<draco::GeometryInfo> info_or =
+      decoder.ProbeGeometryInfo(&buffer);
+  ASSERT_TRUE(info_or.ok()) << info_or.status().error_msg();
+  const draco::GeometryInfo &info = info_or.value();
+  // The probe must not advance the input buffer.
+  ASSERT_EQ(buffer.decoded_size(), 0);
+  ASSERT_GT(info.num_probed_bytes, 0);
+  ASSERT_LT(info.num_probed_bytes, static_cast<int64_t>(data.size()));
+
+  const std::unique_ptr<draco::PointCloud> pc =
+      decoder.DecodePointCloudFromBuffer(&buffer).value();
+  ASSERT_NE(pc, nullptr);
+  ASSERT_EQ(info.num_points, pc->num_points());
+  const draco::Mesh *const mesh = dynamic_cast<draco::Mesh *>(pc.get());
+  ASSERT_EQ(info.geometry_type,
+            mesh ? draco::TRIANGULAR_MESH : draco::POINT_CLOUD);
+  ASSERT_EQ(info.num_faces, mesh ? mesh->num_faces() : 0);
+  ASSERT_EQ(info.has_metadata, pc->GetMetadata() != nullptr);
+  ASSERT_EQ(info.attributes.size(), pc->num_attributes());
+  for (int i = 0; i < pc->num_attributes(); ++i) {
+    const draco::PointAttribute *const att = pc->attribute(i);
+    ASSERT_EQ(info.attributes[i].attribute_type, att->attribute_type());
+    ASSERT_EQ(info.attributes[i].num_components, att->num_components());
+    ASSERT_EQ(info.attributes[i].data_type, att->data_type());
+    ASSERT_EQ(info.attributes[i].normalized, att->normalized());
+    ASSERT_EQ(info.attributes[i].unique_id, att->unique_id());
+  }
+
+  // Only the probed part of the data is needed by the probe.
+  draco::DecoderBuffer probed_buffer;
+  probed_buffer.Init(data.data(), info.num_probed_bytes);
+  const draco::StatusOr<draco::GeometryInfo> probed_info_or =
+      decoder.ProbeGeometryInfo(&probed_buffer);
+  ASSERT_TRUE(probed_info_or.ok());
+  ASSERT_EQ(probed_info_or.value().num_points, info.num_points);
+  ASSERT_EQ(probed_info_or.value().attributes.size(), info.attributes.size());
+}
+
+TEST_F(DecodeTest, TestProbeGeometryInfo) {
+  const std::unique_ptr<draco::Mesh> mesh =
+      draco::ReadMeshFromTestFile("test_nm.obj");
+  ASSERT_NE(mesh, nullptr);
+  for (int method :
+       {draco::MESH_EDGEBREAKER_ENCODING, draco::MESH_SEQUENTIAL_ENCODING}) {
+    SCOPED_TRACE(method);
+    draco::ExpertEncoder encoder(*mesh);
+    encoder.SetEncodingMethod(method);
+    for (int i = 0; i < mesh->num_attributes(); ++i) {
+      encoder.SetAttributeQuantization(i, 10);
+    }
+    draco::EncoderBuffer encoder_buffer;
+    ASSERT_TRUE(encoder.EncodeToBuffer(&encoder_buffer).ok());
+    CheckGeometryInfo(*encoder_buffer.buffer());
+  }
+
+  const std::unique_ptr<draco::PointCloud> pc =
+      draco::ReadPointCloudFromTestFile("point_cloud_test_pos_norm.ply");
+  ASSERT_NE(pc, nullptr);
+  for (int method : {draco::POINT_CLOUD_SEQUENTIAL_ENCODING,
+                     draco::POINT_CLOUD_KD_TREE_ENCODING}) {
+    SCOPED_TRACE(method);
+    draco::ExpertEncoder encoder(*pc);
+    encoder.SetEncodingMethod(method);
+    for (int i = 0; i < pc->num_attributes(); ++i) {
+      encoder.SetAttributeQuantization(i, 10);
+    }
+    draco::EncoderBuffer encoder_buffer;
+    ASSERT_TRUE(encoder.EncodeToBuffer(&encoder_buffer).ok());
+    CheckGeometryInfo(*encoder_buffer.buffer());
+  }
+
+  // Files with older bitstream versions and metadata.
+  for (const char *file_name :
+       {"cube_att_sub_o_2.drc", "pc_kd_color.drc",
+        "test_nm.obj.edgebreaker.0.9.1.drc",
+        "test_nm.obj.sequential.1.2.0.drc"}) {
+    SCOPED_TRACE(file_name);
+    std::ifstream input_file(draco::GetTestFileFullPath(file_name),
+                             std::ios::binary);
+    ASSERT_TRUE(input_file);
+    const std::vector<char> data((std::istreambuf_iterator<char>(input_file)),
+                                 std::istreambuf_iterator<char>());
+    CheckGeometryInfo(data);
+  }
+}
+
+// Decodes |data| into interleaved vertex and index buffers with all attributes
+// stored as floats and verifies that the values match the regular decoding.
+void CheckVertexBuffers(const std::vector<char> &data) {
+  draco::DecoderBuffer buffer;
+  buffer.Init(data.data(), data.size());
+  draco::Decoder decoder;
+  const draco::GeometryInfo info = decoder.ProbeGeometryInfo(&buffer).value();
+  const std::unique_ptr<draco::PointCloud> pc =
+      decoder.DecodePointCloudFromBuffer(&buffer).value();
+  ASSERT_NE(pc, nullptr);
+
+  draco::VertexLayout layout;
+  for (int i = 0; i < static_cast<int>(info.attributes.size()); ++i) {
+    const int num_components = info.attributes[i].num_components;
+    layout.elements.push_back(draco::VertexElement(
+        i, layout.stride, num_components, draco::VERTEX_COMPONENT_FLOAT32,
+        false));
+    layout.stride += num_components * sizeof(float);
+  }
+  std::vector<uint8_t> vertices(info.num_points * layout.stride);
+  std::vector<uint32_t> indices(info.num_faces * 3);
+  buffer.Init(data.data(), data.size());
+  const draco::Status status = decoder.DecodeBufferToVertexBuffers(
+      &buffer, layout, vertices.data(), vertices.size(), draco::DT_UINT32,
+      indices.data(), indices.size() * sizeof(uint32_t));
+  ASSERT_TRUE(status.ok()) << status.error_msg();
+
+  std::vector<float> expected_value;
+  for (draco::PointIndex p(0); p < pc->num_points(); ++p) {
+    for (const draco::VertexElement &element : layout.elements) {
+      const draco::PointAttribute *const att =
+          pc->attribute(element.attribute_id);
+      expected_value.resize(element.num_components);
+      ASSERT_TRUE(att->ConvertValue<float>(att->mapped_index(p),
+                                           element.num_components,
+                                           expected_value.data()));
+      ASSERT_EQ(memcmp(expected_value.data(),
+                       &vertices[p.value() * layout.stride + element.offset],
+                       element.num_components * sizeof(float)),
+                0);
+    }
+  }
+  const draco::Mesh *const mesh = dynamic_cast<draco::Mesh *>(pc.get());
+  if (mesh) {
+    for (draco::FaceIndex f(0); f < mesh->num_faces(); ++f) {
+      for (int c = 0; c < 3; ++c) {
+        ASSERT_EQ(indices[3 * f.value() + c], mesh->face(f)[c].value());
+      }
+    }
+  }
+}
+
+TEST_F(DecodeTest, TestDecodeToVertexBuffers) {
+  const std::unique_ptr<draco::Mesh> mesh =
+      draco::ReadMeshFromTestFile("test_nm.obj");
+  ASSERT_NE(mesh, nullptr);
+  for (int method :
+       {draco::MESH_EDGEBREAKER_ENCODING, draco::MESH_SEQUENTIAL_ENCODING}) {
+    SCOPED_TRACE(method);
+    draco::ExpertEncoder encoder(*mesh);
+    encoder.SetEncodingMethod(method);
+    for (int i = 0; i < mesh->num_attributes(); ++i) {
+      encoder.SetAttributeQuantization(i, 10);
+    }
+    draco::EncoderBuffer encoder_buffer;
+    ASSERT_TRUE(encoder.EncodeToBuffer(&encoder_buffer).ok());
+    CheckVertexBuffers(*encoder_buffer.buffer());
+  }
+
+  const std::unique_ptr<draco::PointCloud> pc =
+      draco::ReadPointCloudFromTestFile("point_cloud_test_pos_norm.ply");
+  ASSERT_NE(pc, nullptr);
+  for (int method : {draco::POINT_CLOUD_SEQUENTIAL_ENCODING,
+                     draco::POINT_CLOUD_KD_TREE_ENCODING}) {
+    SCOPED_TRACE(method);
+    draco::ExpertEncoder encoder(*pc);
+    encoder.SetEncodingMethod(method);
+    for (int i = 0; i < pc->num_attributes(); ++i) {
+      encoder.SetAttributeQuantization(i, 10);
+    }
+    draco::EncoderBuffer encoder_buffer;
+    ASSERT_TRUE(encoder.EncodeToBuffer(&encoder_buffer).ok());
+    CheckVertexBuffers(*encoder_buffer.buffer());
+  }
+
+  // Files with older bitstream versions and non-quantized attributes.
+  for (const char *file_name :
+       {"pc_kd_color.drc", "test_nm.obj.edgebreaker.0.9.1.drc",
+        "test_nm.obj.sequential.1.2.0.drc"}) {
+    SCOPED_TRACE(file_name);
+    std::ifstream input_file(draco::GetTestFileFullPath(file_name),
+                             std::ios::binary);
+    ASSERT_TRUE(input_file);
+    const std::vector<char> data((std::istreambuf_iterator<char>(input_file)),
+                                 std::istreambuf_iterator<char>());
+    CheckVertexBuffers(data);
+  }
+}
+
+TEST_F(DecodeTest, TestDecodeToVertexBuffersSameAttributeTypes) {
+  // Only one of two attributes with the same type is written to the vertex
+  // buffer.
+  const int num_points = 100;
+  draco::PointCloudBuilder builder;
+  builder.Start(num_points);
+  const int att_ids[2] = {
+      builder.AddAttribute(draco::GeometryAttribute::GENERIC, 3,
+                           draco::DT_FLOAT32),
+      builder.AddAttribute(draco::GeometryAttribute::GENERIC, 3,
+                           draco::DT_FLOAT32)};
+  for (draco::PointIndex i(0); i < num_points; ++i) {
+    for (int a = 0; a < 2; ++a) {
+      const float value[3] = {i.value() / 10.f, (a + 1) * 2.f,
+                              (a + 1) * i.value() / 50.f};
+      builder.SetAttributeValueForPoint(att_ids[a], i, value);
+    }
+  }
+  const std::unique_ptr<draco::PointCloud> pc = builder.Finalize(false);
+  ASSERT_NE(pc, nullptr);
+  for (int method : {draco::POINT_CLOUD_SEQUENTIAL_ENCODING,
+                     draco::POINT_CLOUD_KD_TREE_ENCODING}) {
+    SCOPED_TRACE(method);
+    draco::ExpertEncoder encoder(*pc);
+    encoder.SetEncodingMethod(method);
+    encoder.SetAttributeQuantization(att_ids[0], 10);
+    encoder.SetAttributeQuantization(att_ids[1], 12);
+    draco::EncoderBuffer encoder_buffer;
+    ASSERT_TRUE(encoder.EncodeToBuffer(&encoder_buffer).ok());
+
+    draco::DecoderBuffer buffer;
+    buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+    draco::Decoder decoder;
+    const std::unique_ptr<draco::PointCloud> decoded_pc =
+        decoder.DecodePointCloudFromBuffer(&buffer).value();
+    ASSERT_NE(decoded_pc, nullptr);
+
+    draco::VertexLayout layout;
+    layout.stride = 3 * sizeof(float);
+    layout.elements.push_back(draco::VertexElement(
+        att_ids[1], 0, 3, draco::VERTEX_COMPONENT_FLOAT32, false));
+    std::vector<float> vertices(num_points * 3);
+    buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+    ASSERT_TRUE(decoder
+                    .DecodeBufferToVertexBuffers(
+                        &buffer, layout, vertices.data(),
+                        vertices.size() * sizeof(float), draco::DT_UINT32,
+                        nullptr, 0)
+                    .ok());
+    const draco::PointAttribute *const att =
+        decoded_pc->attribute(att_ids[1]);
+    for (draco::PointIndex p(0); p < num_points; ++p) {
+      float expected_value[3];
+      ASSERT_TRUE(att->ConvertValue<float>(att->mapped_index(p),
+                                           expected_value));
+      ASSERT_EQ(memcmp(expected_value, &vertices[3 * p.value()],
+                       sizeof(expected_value)),
+                0);
+    }
+  }
+}
+
+// Converts an IEEE 754 half-precision float to a float.
+float HalfToFloat(uint16_t half) {
+  const int exponent = (half >> 10) & 0x1f;
+  const int mantissa = half & 0x3ff;
+  float value;
+  if (exponent == 0) {
+    value = std::ldexp(static_cast<float>(mantissa), -24);
+  } else {
+    value = std::ldexp(static_cast<float>(mantissa | 0x400), exponent - 25);
+  }
+  return (half & 0x8000) ? -value : value;
+}
+
+TEST_F(DecodeTest, TestDecodeToCompactVertexBuffers) {
+  // Tests decoding into half-float and normalized integer components with
+  // 16-bit indices.
+  const std::unique_ptr<draco::Mesh> mesh =
+      draco::ReadMeshFromTestFile("test_nm.obj");
+  ASSERT_NE(mesh, nullptr);
+  draco::ExpertEncoder encoder(*mesh);
+  encoder.SetAttributeQuantization(
+      mesh->GetNamedAttributeId(draco::GeometryAttribute::POSITION), 14);
+  encoder.SetAttributeQuantization(
+      mesh->GetNamedAttributeId(draco::GeometryAttribute::NORMAL), 10);
+  draco::EncoderBuffer encoder_buffer;
+  ASSERT_TRUE(encoder.EncodeToBuffer(&encoder_buffer).ok());
+
+  draco::DecoderBuffer buffer;
+  buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+  draco::Decoder decoder;
+  const std::unique_ptr<draco::Mesh> decoded_mesh =
+      decoder.DecodeMeshFromBuffer(&buffer).value();
+  ASSERT_NE(decoded_mesh, nullptr);
+  const draco::PointAttribute *const pos_att =
+      decoded_mesh->GetNamedAttribute(draco::GeometryAttribute::POSITION);
+  const draco::PointAttribute *const norm_att =
+      decoded_mesh->GetNamedAttribute(draco::GeometryAttribute::NORMAL);
+  ASSERT_NE(pos_att, nullptr);
+  ASSERT_NE(norm_att, nullptr);
+
+  // Half-float positions padded to four components followed by normalized
+  // int16 normals padded to four components.
+  draco::VertexLayout layout;
+  layout.stride = 16;
+  layout.elements.push_back(
+      draco::VertexElement(decoded_mesh->GetNamedAttributeId(
+                               draco::GeometryAttribute::POSITION),
+                           0, 4, draco::VERTEX_COMPONENT_FLOAT16, false));
+  layout.elements.push_back(draco::VertexElement(
+      decoded_mesh->GetNamedAttributeId(draco::GeometryAttribute::NORMAL), 8,
+      4, draco::VERTEX_COMPONENT_INT16, true));
+  const int num_points = decoded_mesh->num_points();
+  std::vector<uint8_t> vertices(num_points * layout.stride);
+  std::vector<uint16_t> indices(decoded_mesh->num_faces() * 3);
+  buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+  ASSERT_TRUE(decoder
+                  .DecodeBufferToVertexBuffers(
+                      &buffer, layout, vertices.data(), vertices.size(),
+                      draco::DT_UINT16, indices.data(),
+                      indices.size() * sizeof(uint16_t))
+                  .ok());
+
+  for (draco::PointIndex p(0); p < num_points; ++p) {
+    const uint8_t *const vertex = &vertices[p.value() * layout.stride];
+    float pos[3], norm[3];
+    ASSERT_TRUE(pos_att->ConvertValue<float>(pos_att->mapped_index(p), pos));
+    ASSERT_TRUE(
+        norm_att->ConvertValue<float>(norm_att->mapped_index(p), norm));
+    uint16_t half_pos[4];
+    int16_t int_norm[4];
+    memcpy(half_pos, vertex, sizeof(half_pos));
+    memcpy(int_norm, vertex + 8, sizeof(int_norm));
+    for (int c = 0; c < 3; ++c) {
+      ASSERT_NEAR(HalfToFloat(half_pos[c]), pos[c],
+                  std::abs(pos[c]) / 1024.f + 1e-6f);
+      ASSERT_NEAR(int_norm[c] / 32767.f, norm[c], 1.f / 32767.f);
+    }
+    ASSERT_EQ(half_pos[3], 0);
+    ASSERT_EQ(int_norm[3], 0);
+  }
+  for (draco::FaceIndex f(0); f < decoded_mesh->num_faces(); ++f) {
+    for (int c = 0; c < 3; ++c) {
+      ASSERT_EQ(indices[3 * f.value() + c], decoded_mesh->face(f)[c].value());
+    }
+  }
+
+  // Buffers that are too small and invalid elements are rejected.
+  buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+  ASSERT_FALSE(decoder
+                   .DecodeBufferToVertexBuffers(
+                       &buffer, layout, vertices.data(), vertices.size() - 1,
+                       draco::DT_UINT16, indices.data(),
+                       indices.size() * sizeof(uint16_t))
+                   .ok());
+  buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+  ASSERT_FALSE(decoder
+                   .DecodeBufferToVertexBuffers(
+                       &buffer, layout, vertices.data(), vertices.size(),
+                       draco::DT_UINT16, indices.data(),
+                       indices.size() * sizeof(uint16_t) - 1)
+                   .ok());
+  layout.elements[1].offset = 12;
+  buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+  ASSERT_FALSE(decoder
+                   .DecodeBufferToVertexBuffers(
+                       &buffer, layout, vertices.data(), vertices.size(),
+                       draco::DT_UINT16, indices.data(),
+                       indices.size() * sizeof(uint16_t))
+                   .ok());
+}
+
 }  // namespace
@@ -0,0 +1,56 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/decoder_scratch.h"
+
+namespace draco {
+
+DecoderScratch::DecoderScratch()
+    : num_decodes_(0), num_scratch_growths_(0) {}
+
+DecoderScratch::~DecoderScratch() = default;
+
+size_t DecoderScratch::ComputeAllocatedSize() const {
+  size_t size = 0;
+  for (int i = 0; i < kNumEdgebreakerDecoderImpls; ++i) {
+    if (edgebreaker_impls_[i])
+      size += edgebreaker_impls_[i]->ComputeAllocatedSize();
+  }
+  return size;
+}
+
+void DecoderScratch::Clear() {
+  for (int i = 0; i < kNumEdgebreakerDecoderImpls; ++i) {
+    edgebreaker_impls_[i] = nullptr;
+  }
+}
+
+MeshEdgebreakerDecoderImplInterface *DecoderScratch::GetEdgebreakerDecoderImpl(
+    int traversal_decoder_type) const {
+  if (traversal_decoder_type < 0 ||
+      traversal_decoder_type >= kNumEdgebreakerDecoderImpls)
+    return nullptr;
+  return edgebreaker_impls_[traversal_decoder_type].get();
+}
+
+void DecoderScratch::SetEdgebreakerDecoderImpl(
+    int traversal_decoder_type,
+    std::unique_ptr<MeshEdgebreakerDecoderImplInterface> impl) {
+  if (traversal_decoder_type < 0 ||
+      traversal_decoder_type >= kNumEdgebreakerDecoderImpls)
+    return;
+  edgebreaker_impls_[traversal_decoder_type] = std::move(impl);
+}
+
+}  // namespace draco
@@ -0,0 +1,91 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_COMPRESSION_DECODER_SCRATCH_H_
+#define DRACO_COMPRESSION_DECODER_SCRATCH_H_
+
+#include <inttypes.h>
+
+#include <memory>
+
+#include "draco/compression/mesh/mesh_edgebreaker_decoder_impl_interface.h"
+#include "draco/core/macros.h"
+
+namespace draco {
+
+// Scratch memory that can be reused by the decoder between multiple decoding
+// calls. The scratch keeps the temporary buffers of the edgebreaker
+// connectivity decoder (corner tables, traversal stacks, valence context
+// symbols, vertex and corner maps, ...) so that repeated decoding of similarly
+// sized meshes does not need to allocate them again.
+//
+// The scratch is not thread safe. When decoding on multiple threads, each
+// thread should use its own instance (see Decoder::SetScratch()).
+class DecoderScratch {
+ public:
+  DecoderScratch();
+  ~DecoderScratch();
+
+  // Number of decoding calls that used the scratch.
+  int64_t num_decodes() const { return num_decodes_; }
+
+  // Number of decoding calls in which any of the scratch buffers had to grow
+  // because it was not large enough. After a warm-up, decoding of meshes that
+  // are not larger than the ones decoded before does not increase this
+  // counter. Note that this is not a heap allocation counter: the entropy
+  // decoders, the attribute decoders and the decoded geometry still allocate
+  // memory on every decoding call.
+  int64_t num_scratch_growths() const { return num_scratch_growths_; }
+
+  // Returns the number of bytes currently reserved by all scratch buffers.
+  size_t ComputeAllocatedSize() const;
+
+  // Releases all memory held by the scratch.
+  void Clear();
+
+  // Returns the edgebreaker decoder implementation stored for the given
+  // |traversal_decoder_type| or nullptr if there is none. Used internally by
+  // MeshEdgebreakerDecoder.
+  MeshEdgebreakerDecoderImplInterface *GetEdgebreakerDecoderImpl(
+      int traversal_decoder_type) const;
+
+  // Stores the edgebreaker decoder implementation for the given
+  // |traversal_decoder_type|. Used internally by MeshEdgebreakerDecoder.
+  void SetEdgebreakerDecoderImpl(
+      int traversal_decoder_type,
+      std::unique_ptr<MeshEdgebreakerDecoderImplInterface> impl);
+
+  // Called by the decoder after each decoding call. |grown| should be set to
+  // true when any of the scratch buffers had to be allocated or grown.
+  void RecordDecode(bool grown) {
+    num_decodes_++;
+    if (grown)
+      num_scratch_growths_++;
+  }
+
+ private:
+  // One edgebreaker implementation for each traversal decoder type.
+  static constexpr int kNumEdgebreakerDecoderImpls = 3;
+  std::unique_ptr<MeshEdgebreakerDecoderImplInterface>
+      edgebreaker_impls_[kNumEdgebreakerDecoderImpls];
+
+  int64_t num_decodes_;
+  int64_t num_scratch_growths_;
+
+  DISALLOW_COPY_AND_ASSIGN(DecoderScratch);
+};
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_DECODER_SCRATCH_H_
@@ -40,6 +40,7 @@ EncoderOptions Encoder::CreateExpertEncoderOptions(const PointCloud &pc) const {
   EncoderOptions ret_options = EncoderOptions::CreateEmptyOptions();
   ret_options.SetGlobalOptions(options().GetGlobalOptions());
   ret_options.SetFeatureOptions(options().GetFeaturelOptions());
+  ret_options.SetTracer(options().GetTracer());
   // Convert type-based attribute options to specific attributes in the provided
   // point cloud.
   for (int i = 0; i < pc.num_attributes(); ++i) {
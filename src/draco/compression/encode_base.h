@@ -43,6 +43,33 @@ class EncoderBase {
   // Note that this can slow down encoding for certain encoders.
   void SetTrackEncodedProperties(bool flag);
 
+  // If enabled, the encoder can use an interleaved entropy coding of attribute
+  // values that is faster to decode. The encoded data then requires a decoder
+  // supporting mesh bit-stream version 2.3 or point cloud bit-stream version
+  // 2.4. The interleaved coding is never used unless it is enabled here,
+  // regardless of the speed options.
+  void SetUseInterleavedSymbolCoding(bool flag);
+
+  // Sets the number of threads that can be used to encode independent
+  // attributes of the input geometry in parallel (default = 1). The encoded
+  // data is the same for any number of threads.
+  void SetNumThreads(int num_threads);
+
+  // If enabled, the encoder selects prediction schemes of attributes that
+  // don't have an explicitly requested scheme by comparing the estimated
+  // entropy of corrections produced by all applicable schemes (default =
+  // false). This is slower than the default selection based on the encoding
+  // speed, but it usually results in smaller encoded data.
+  void SetEstimatePredictionSchemes(bool flag);
+
+  // Sets the depth of the kd-tree at which the subtrees of point clouds
+  // encoded with the kd-tree method are encoded into independent streams
+  // (default = 0, disabled). The subtrees are encoded and decoded in parallel
+  // when multiple threads are used. Larger depths allow more parallelism at
+  // the cost of a slightly larger encoded data. The encoded data requires a
+  // decoder supporting point cloud bit-stream version 2.5.
+  void SetKdTreeSubtreeDepth(int depth);
+
   // Returns the number of encoded points and faces during the last encoding
   // operation. Returns 0 if SetTrackEncodedProperties() was not set.
   size_t num_encoded_points() const { return num_encoded_points_; }
@@ -121,6 +148,26 @@ void EncoderBase<EncoderOptionsT>::SetTrackEncodedProperties(bool flag) {
   options_.SetGlobalBool("store_number_of_encoded_faces", flag);
 }
 
+template <class EncoderOptionsT>
+void EncoderBase<EncoderOptionsT>::SetUseInterleavedSymbolCoding(bool flag) {
+  options_.SetGlobalBool("use_interleaved_symbol_coding", flag);
+}
+
+template <class EncoderOptionsT>
+void EncoderBase<EncoderOptionsT>::SetNumThreads(int num_threads) {
+  options_.SetGlobalInt("num_threads", num_threads);
+}
+
+template <class EncoderOptionsT>
+void EncoderBase<EncoderOptionsT>::SetEstimatePredictionSchemes(bool flag) {
+  options_.SetGlobalBool("estimate_prediction_schemes", flag);
+}
+
+template <class EncoderOptionsT>
+void EncoderBase<EncoderOptionsT>::SetKdTreeSubtreeDepth(int depth) {
+  options_.SetGlobalInt("kd_tree_subtree_depth", depth);
+}
+
 }  // namespace draco
 
 #endif  // DRACO_SRC_DRACO_COMPRESSION_ENCODE_BASE_H_
@@ -0,0 +1,269 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/encode_cache.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "draco/compression/config/compression_shared.h"
+#include "draco/core/hash_utils.h"
+#include "draco/metadata/metadata_encoder.h"
+
+namespace draco {
+
+namespace {
+
+// Version of the key computation. Must be increased whenever the content of
+// the key changes.
+constexpr uint32_t kEncodeCacheKeyVersion = 1;
+
+void FingerprintOptions(const Options &options, Fingerprinter *fingerprinter) {
+  const std::map<std::string, std::string> &entries = options.GetAllOptions();
+  uint64_t num_entries = 0;
+  for (const auto &entry : entries) {
+    // The number of threads does not change the encoded data.
+    if (entry.first != "num_threads") {
+      ++num_entries;
+    }
+  }
+  fingerprinter->UpdateValue(num_entries);
+  for (const auto &entry : entries) {
+    if (entry.first != "num_threads") {
+      fingerprinter->UpdateString(entry.first);
+      fingerprinter->UpdateString(entry.second);
+    }
+  }
+}
+
+// Computes the cache key of |pc| encoded with |options|. |mesh| is the same
+// geometry as |pc| when it is encoded as a mesh or nullptr otherwise.
+std::string ComputeKey(
+    const PointCloud &pc, const Mesh *mesh,
+    const EncoderOptionsBase<GeometryAttribute::Type> &options) {
+  Fingerprinter fingerprinter;
+  fingerprinter.UpdateValue(kEncodeCacheKeyVersion);
+  fingerprinter.UpdateValue(kDracoPointCloudBitstreamVersion);
+  fingerprinter.UpdateValue(kDracoMeshBitstreamVersion);
+  fingerprinter.UpdateValue(static_cast<uint8_t>(mesh != nullptr));
+
+  // Encoder options.
+  FingerprintOptions(options.GetGlobalOptions(), &fingerprinter);
+  FingerprintOptions(options.GetFeaturelOptions(), &fingerprinter);
+  const auto &attribute_options = options.GetAllAttributeOptions();
+  fingerprinter.UpdateValue(static_cast<uint64_t>(attribute_options.size()));
+  for (const auto &entry : attribute_options) {
+    fingerprinter.UpdateValue(static_cast<int32_t>(entry.first));
+    FingerprintOptions(entry.second, &fingerprinter);
+  }
+
+  // Attributes.
+  fingerprinter.UpdateValue(pc.num_points());
+  fingerprinter.UpdateValue(pc.num_attributes());
+  std::vector<uint32_t> point_mapping;
+  for (int i = 0; i < pc.num_attributes(); ++i) {
+    const PointAttribute *const att = pc.attribute(i);
+    fingerprinter.UpdateValue(static_cast<int32_t>(att->attribute_type()));
+    fingerprinter.UpdateValue(static_cast<int32_t>(att->data_type()));
+    fingerprinter.UpdateValue(att->num_components());
+    fingerprinter.UpdateValue(static_cast<uint8_t>(att->normalized()));
+    fingerprinter.UpdateValue(att->unique_id());
+    if (mesh != nullptr) {
+      fingerprinter.UpdateValue(
+          static_cast<int32_t>(mesh->GetAttributeElementType(i)));
+    }
+    // Attribute values.
+    const int64_t value_size =
+        DataTypeLength(att->data_type()) * att->num_components();
+    fingerprinter.UpdateValue(static_cast<uint32_t>(att->size()));
+    if (att->byte_stride() == value_size && att->byte_offset() == 0) {
+      if (att->size() > 0) {
+        fingerprinter.Update(att->GetAddress(AttributeValueIndex(0)),
+                             att->size() * value_size);
+      }
+    } else {
+      for (AttributeValueIndex avi(0); avi < att->size(); ++avi) {
+        fingerprinter.Update(att->GetAddress(avi), value_size);
+      }
+    }
+    // Mapping between points and attribute values.
+    fingerprinter.UpdateValue(static_cast<uint8_t>(att->is_mapping_identity()));
+    if (!att->is_mapping_identity()) {
+      point_mapping.resize(pc.num_points());
+      for (PointIndex p(0); p < pc.num_points(); ++p) {
+        point_mapping[p.value()] = att->mapped_index(p).value();
+      }
+      fingerprinter.Update(point_mapping.data(),
+                           point_mapping.size() * sizeof(uint32_t));
+    }
+  }
+
+  // Connectivity.
+  if (mesh != nullptr) {
+    fingerprinter.UpdateValue(mesh->num_faces());
+    if (mesh->num_faces() > 0) {
+      fingerprinter.Update(&mesh->face(FaceIndex(0)),
+                           mesh->num_faces() * sizeof(Mesh::Face));
+    }
+  }
+
+  // Metadata is fingerprinted in its encoded form.
+  const GeometryMetadata *const metadata = pc.GetMetadata();
+  fingerprinter.UpdateValue(static_cast<uint8_t>(metadata != nullptr));
+  if (metadata != nullptr) {
+    EncoderBuffer metadata_buffer;
+    MetadataEncoder metadata_encoder;
+    if (metadata_encoder.EncodeGeometryMetadata(&metadata_buffer, metadata)) {
+      fingerprinter.Update(metadata_buffer.data(), metadata_buffer.size());
+    }
+  }
+  return fingerprinter.HexDigest();
+}
+
+}  // namespace
+
+EncodeCache::EncodeCache(const std::string &directory)
+    : directory_(directory),
+      num_hits_(0),
+      num_misses_(0),
+      num_failed_stores_(0) {}
+
+Status EncodeCache::EncodePointCloudToBuffer(
+    const EncoderOptionsBase<GeometryAttribute::Type> &options,
+    const PointCloud &pc, EncoderBuffer *out_buffer) {
+  return EncodeWithCache(
+      ComputePointCloudKey(pc, options),
+      [&](Encoder *encoder, EncoderBuffer *buffer) {
+        return encoder->EncodePointCloudToBuffer(pc, buffer);
+      },
+      options, out_buffer);
+}
+
+Status EncodeCache::EncodeMeshToBuffer(
+    const EncoderOptionsBase<GeometryAttribute::Type> &options,
+    const Mesh &m, EncoderBuffer *out_buffer) {
+  return EncodeWithCache(
+      ComputeMeshKey(m, options),
+      [&](Encoder *encoder, EncoderBuffer *buffer) {
+        return encoder->EncodeMeshToBuffer(m, buffer);
+      },
+      options, out_buffer);
+}
+
+std::string EncodeCache::ComputePointCloudKey(
+    const PointCloud &pc,
+    const EncoderOptionsBase<GeometryAttribute::Type> &options) {
+  return ComputeKey(pc, nullptr, options);
+}
+
+std::string EncodeCache::ComputeMeshKey(
+    const Mesh &m,
+    const EncoderOptionsBase<GeometryAttribute::Type> &options) {
+  return ComputeKey(m, &m, options);
+}
+
+bool EncodeCache::Lookup(const std::string &key,
+                         EncoderBuffer *out_buffer) const {
+  std::ifstream file(GetEntryPath(key), std::ios::binary | std::ios::ate);
+  if (!file) {
+    return false;
+  }
+  const std::streamoff file_size = file.tellg();
+  if (file_size < 5) {
+    return false;
+  }
+  std::vector<char> data(static_cast<size_t>(file_size));
+  file.seekg(0);
+  if (!file.read(data.data(), data.size())) {
+    return false;
+  }
+  // Only Draco streams are stored in the cache.
+  if (memcmp(data.data(), "DRACO", 5) != 0) {
+    return false;
+  }
+  return out_buffer->Encode(data.data(), data.size());
+}
+
+Status EncodeCache::Store(const std::string &key, const char *data,
+                          size_t data_size) const {
+  // Write into a file with a unique name first so that concurrent writers of
+  // the same entry don't interfere and readers never see a partial entry.
+  static std::atomic<uint64_t> next_file_id(0);
+  const uint64_t unique_id =
+      HashCombine(static_cast<uint64_t>(std::hash<std::thread::id>()(
+                      std::this_thread::get_id())),
+                  static_cast<uint64_t>(
+                      std::chrono::steady_clock::now().time_since_epoch()
+                          .count())) ^
+      next_file_id.fetch_add(1);
+  const std::string path = GetEntryPath(key);
+  const std::string temp_path = path + "." + std::to_string(unique_id);
+  {
+    std::ofstream file(temp_path, std::ios::binary);
+    if (!file || !file.write(data, data_size)) {
+      file.close();
+      std::remove(temp_path.c_str());
+      return Status(Status::IO_ERROR, "Failed to write the cache entry.");
+    }
+  }
+  if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    std::remove(temp_path.c_str());
+    return Status(Status::IO_ERROR, "Failed to write the cache entry.");
+  }
+  return OkStatus();
+}
+
+EncodeCacheStats EncodeCache::stats() const {
+  EncodeCacheStats stats;
+  stats.num_hits = num_hits_;
+  stats.num_misses = num_misses_;
+  stats.num_failed_stores = num_failed_stores_;
+  return stats;
+}
+
+template <typename EncodeFunctionT>
+Status EncodeCache::EncodeWithCache(
+    const std::string &key, EncodeFunctionT encode,
+    const EncoderOptionsBase<GeometryAttribute::Type> &options,
+    EncoderBuffer *out_buffer) {
+  if (Lookup(key, out_buffer)) {
+    ++num_hits_;
+    return OkStatus();
+  }
+  ++num_misses_;
+  // The whole encoded data is needed for the cache entry, so the geometry
+  // can't be encoded directly into a buffer with a sink.
+  Encoder encoder;
+  encoder.Reset(options);
+  EncoderBuffer buffer;
+  DRACO_RETURN_IF_ERROR(encode(&encoder, &buffer));
+  if (!Store(key, buffer.data(), buffer.size()).ok()) {
+    ++num_failed_stores_;
+  }
+  if (!out_buffer->Encode(buffer.data(), buffer.size())) {
+    return Status(Status::IO_ERROR, "Failed to write the encoded data.");
+  }
+  return OkStatus();
+}
+
+std::string EncodeCache::GetEntryPath(const std::string &key) const {
+  return directory_ + "/" + key + ".drc";
+}
+
+}  // namespace draco
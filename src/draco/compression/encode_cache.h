@@ -0,0 +1,114 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_COMPRESSION_ENCODE_CACHE_H_
+#define DRACO_COMPRESSION_ENCODE_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "draco/compression/encode.h"
+
+namespace draco {
+
+// Statistics of an EncodeCache.
+struct EncodeCacheStats {
+  EncodeCacheStats() : num_hits(0), num_misses(0), num_failed_stores(0) {}
+
+  int64_t num_hits;
+  int64_t num_misses;
+  // Number of encoded geometries that could not be written to the cache.
+  int64_t num_failed_stores;
+};
+
+// Cache of encoded geometry stored in a local directory. Each entry is keyed
+// by a fingerprint of the content of the geometry (connectivity, attribute
+// values and metadata) and of the encoder options, so repeated encoding of the
+// same geometry with the same options becomes a file lookup. Options that do
+// not change the encoded data (such as "num_threads") are not part of the key.
+//
+// The key also includes the Draco bitstream version. The cache directory
+// should be cleared when the library is updated to a version that produces
+// different encoded data for the same bitstream version.
+//
+// All methods are thread safe and multiple processes can share the same
+// directory. Entries are written to a temporary file first and then renamed,
+// so a partially written entry is never visible.
+//
+// Example:
+//
+//   EncodeCache cache("/tmp/draco_cache");
+//   Encoder encoder;
+//   encoder.SetAttributeQuantization(GeometryAttribute::POSITION, 14);
+//   EncoderBuffer buffer;
+//   const Status status =
+//       cache.EncodeMeshToBuffer(encoder.options(), mesh, &buffer);
+//
+class EncodeCache {
+ public:
+  // Creates a cache stored in an existing |directory|.
+  explicit EncodeCache(const std::string &directory);
+
+  // Encodes the point cloud |pc| with the given |options| into |out_buffer|
+  // or copies the encoded data from the cache. On a miss, the geometry is
+  // encoded with draco::Encoder and the result is added to the cache. Failure
+  // to store the result is not an error (see EncodeCacheStats).
+  Status EncodePointCloudToBuffer(
+      const EncoderOptionsBase<GeometryAttribute::Type> &options,
+      const PointCloud &pc, EncoderBuffer *out_buffer);
+
+  // Same as EncodePointCloudToBuffer() but for meshes.
+  Status EncodeMeshToBuffer(
+      const EncoderOptionsBase<GeometryAttribute::Type> &options,
+      const Mesh &m, EncoderBuffer *out_buffer);
+
+  // Returns the cache keys of a point cloud or mesh encoded with |options|.
+  static std::string ComputePointCloudKey(
+      const PointCloud &pc,
+      const EncoderOptionsBase<GeometryAttribute::Type> &options);
+  static std::string ComputeMeshKey(
+      const Mesh &m,
+      const EncoderOptionsBase<GeometryAttribute::Type> &options);
+
+  // Appends the encoded data stored under |key| to |out_buffer|. Returns false
+  // when the entry does not exist or when it is not valid.
+  bool Lookup(const std::string &key, EncoderBuffer *out_buffer) const;
+
+  // Stores encoded |data| of |data_size| bytes under |key|.
+  Status Store(const std::string &key, const char *data,
+               size_t data_size) const;
+
+  EncodeCacheStats stats() const;
+  const std::string &directory() const { return directory_; }
+
+ private:
+  // Looks up |key| and encodes the geometry with |encode| on a miss.
+  template <typename EncodeFunctionT>
+  Status EncodeWithCache(
+      const std::string &key, EncodeFunctionT encode,
+      const EncoderOptionsBase<GeometryAttribute::Type> &options,
+      EncoderBuffer *out_buffer);
+
+  std::string GetEntryPath(const std::string &key) const;
+
+  std::string directory_;
+  std::atomic<int64_t> num_hits_;
+  std::atomic<int64_t> num_misses_;
+  std::atomic<int64_t> num_failed_stores_;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_ENCODE_CACHE_H_
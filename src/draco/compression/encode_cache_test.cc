@@ -0,0 +1,129 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/encode_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "draco/core/draco_test_base.h"
+#include "draco/core/draco_test_utils.h"
+#include "draco/core/hash_utils.h"
+
+namespace {
+
+class EncodeCacheTest : public ::testing::Test {
+ protected:
+  EncodeCacheTest() : cache_(draco::GetTestTempFileFullPath("")) {}
+
+  // Removes the cache entry of |key| left by a previous test run.
+  void RemoveEntry(const std::string &key) const {
+    std::remove((cache_.directory() + "/" + key + ".drc").c_str());
+  }
+
+  draco::EncodeCache cache_;
+};
+
+TEST_F(EncodeCacheTest, TestFingerprinter) {
+  // Reference value of MurmurHash3 x64 128 with zero seed.
+  const std::string text = "The quick brown fox jumps over the lazy dog";
+  draco::Fingerprinter fingerprinter;
+  fingerprinter.Update(text.data(), text.size());
+  ASSERT_EQ(fingerprinter.HexDigest(), "6c1b07bc7bbc4be347939ac4a93c437a");
+
+  // Splitting of the input into chunks doesn't change the result.
+  draco::Fingerprinter chunked_fingerprinter;
+  for (size_t i = 0; i < text.size(); i += 7) {
+    chunked_fingerprinter.Update(text.data() + i,
+                                 std::min<size_t>(7, text.size() - i));
+  }
+  ASSERT_EQ(chunked_fingerprinter.HexDigest(), fingerprinter.HexDigest());
+}
+
+TEST_F(EncodeCacheTest, TestHitAndMiss) {
+  const std::unique_ptr<draco::Mesh> mesh(
+      draco::ReadMeshFromTestFile("test_nm.obj"));
+  ASSERT_NE(mesh, nullptr);
+  draco::Encoder encoder;
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 12);
+  RemoveEntry(draco::EncodeCache::ComputeMeshKey(*mesh, encoder.options()));
+
+  draco::EncoderBuffer buffer;
+  ASSERT_TRUE(
+      cache_.EncodeMeshToBuffer(encoder.options(), *mesh, &buffer).ok());
+  ASSERT_EQ(cache_.stats().num_misses, 1);
+  ASSERT_EQ(cache_.stats().num_hits, 0);
+  ASSERT_EQ(cache_.stats().num_failed_stores, 0);
+
+  // The cached data is the same as the data of a regular encoder.
+  draco::EncoderBuffer expected_buffer;
+  ASSERT_TRUE(encoder.EncodeMeshToBuffer(*mesh, &expected_buffer).ok());
+  ASSERT_EQ(buffer.size(), expected_buffer.size());
+  ASSERT_EQ(memcmp(buffer.data(), expected_buffer.data(), buffer.size()), 0);
+
+  draco::EncoderBuffer cached_buffer;
+  ASSERT_TRUE(
+      cache_.EncodeMeshToBuffer(encoder.options(), *mesh, &cached_buffer)
+          .ok());
+  ASSERT_EQ(cache_.stats().num_hits, 1);
+  ASSERT_EQ(cached_buffer.size(), buffer.size());
+  ASSERT_EQ(memcmp(cached_buffer.data(), buffer.data(), buffer.size()), 0);
+}
+
+TEST_F(EncodeCacheTest, TestKeys) {
+  const std::unique_ptr<draco::Mesh> mesh(
+      draco::ReadMeshFromTestFile("test_nm.obj"));
+  ASSERT_NE(mesh, nullptr);
+  draco::Encoder encoder;
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 12);
+  const std::string key =
+      draco::EncodeCache::ComputeMeshKey(*mesh, encoder.options());
+
+  // The same content loaded again has the same key.
+  const std::unique_ptr<draco::Mesh> mesh_copy(
+      draco::ReadMeshFromTestFile("test_nm.obj"));
+  ASSERT_NE(mesh_copy, nullptr);
+  ASSERT_EQ(draco::EncodeCache::ComputeMeshKey(*mesh_copy, encoder.options()),
+            key);
+
+  // Encoding as a point cloud is a different entry.
+  ASSERT_NE(draco::EncodeCache::ComputePointCloudKey(*mesh, encoder.options()),
+            key);
+
+  // Number of threads doesn't affect the encoded data.
+  encoder.SetNumThreads(4);
+  ASSERT_EQ(draco::EncodeCache::ComputeMeshKey(*mesh, encoder.options()),
+            key);
+
+  // Other options do.
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 11);
+  ASSERT_NE(draco::EncodeCache::ComputeMeshKey(*mesh, encoder.options()),
+            key);
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 12);
+  ASSERT_EQ(draco::EncodeCache::ComputeMeshKey(*mesh, encoder.options()),
+            key);
+
+  // So does any change of the content.
+  draco::PointAttribute *const pos_att = mesh_copy->attribute(
+      mesh_copy->GetNamedAttributeId(draco::GeometryAttribute::POSITION));
+  float value[3];
+  pos_att->GetValue(draco::AttributeValueIndex(0), value);
+  value[0] += 1.f;
+  pos_att->SetAttributeValue(draco::AttributeValueIndex(0), value);
+  ASSERT_NE(draco::EncodeCache::ComputeMeshKey(*mesh_copy, encoder.options()),
+            key);
+}
+
+}  // namespace
@@ -25,6 +25,7 @@
 #include "draco/core/draco_test_utils.h"
 #include "draco/core/vector_d.h"
 #include "draco/io/obj_decoder.h"
+#include "draco/mesh/mesh_are_equivalent.h"
 #include "draco/mesh/triangle_soup_mesh_builder.h"
 #include "draco/point_cloud/point_cloud_builder.h"
 
@@ -290,4 +291,172 @@ TEST_F(EncodeTest, TestTrackingOfNumberOfEncodedEntriesNotSet) {
   ASSERT_EQ(encoder.num_encoded_faces(), 0);
 }
 
+TEST_F(EncodeTest, TestInterleavedSymbolCoding) {
+  // Tests that the interleaved symbol coding is used only when requested and
+  // that the bit-stream version is updated accordingly. The speed options must
+  // not enable it.
+  std::unique_ptr<draco::Mesh> mesh(
+      draco::ReadMeshFromTestFile("test_nm.obj"));
+  ASSERT_NE(mesh, nullptr);
+
+  for (int mode = 0; mode < 3; ++mode) {
+    draco::Encoder encoder;
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 14);
+    if (mode == 1) {
+      // Maximum decoding speed keeps the data compatible with older decoders.
+      encoder.SetSpeedOptions(10, 10);
+    } else if (mode == 2) {
+      encoder.SetUseInterleavedSymbolCoding(true);
+    }
+    draco::EncoderBuffer buffer;
+    ASSERT_TRUE(encoder.EncodeMeshToBuffer(*mesh, &buffer).ok());
+    // Minor version is stored right after the "DRACO" string and the major
+    // version.
+    const uint8_t expected_version_minor =
+        mode == 2 ? draco::kDracoMeshBitstreamVersionMinor
+                  : draco::kDracoMeshNonInterleavedBitstreamVersionMinor;
+    ASSERT_EQ(buffer.data()[6], expected_version_minor);
+
+    draco::DecoderBuffer dec_buffer;
+    dec_buffer.Init(buffer.data(), buffer.size());
+    draco::Decoder decoder;
+    auto decoded_mesh = decoder.DecodeMeshFromBuffer(&dec_buffer).value();
+    ASSERT_NE(decoded_mesh, nullptr);
+    ASSERT_EQ(decoded_mesh->num_faces(), mesh->num_faces());
+  }
+}
+
+TEST_F(EncodeTest, TestParallelEncoding) {
+  // Tests that the encoded data doesn't depend on the number of threads used
+  // by the encoder.
+  const std::vector<std::string> mesh_files = {"test_nm.obj", "cube_att.obj"};
+  for (const std::string &file_name : mesh_files) {
+    std::unique_ptr<draco::Mesh> mesh(draco::ReadMeshFromTestFile(file_name));
+    ASSERT_NE(mesh, nullptr);
+    for (int method : {draco::MESH_SEQUENTIAL_ENCODING,
+                       draco::MESH_EDGEBREAKER_ENCODING}) {
+      for (int speed : {0, 5, 10}) {
+        SCOPED_TRACE(file_name);
+        std::vector<char> encoded_data[2];
+        for (int i = 0; i < 2; ++i) {
+          draco::Encoder encoder;
+          encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION,
+                                           12);
+          encoder.SetAttributeQuantization(draco::GeometryAttribute::NORMAL, 8);
+          encoder.SetAttributeQuantization(draco::GeometryAttribute::TEX_COORD,
+                                           10);
+          encoder.SetEncodingMethod(method);
+          encoder.SetSpeedOptions(speed, speed);
+          encoder.SetNumThreads(i == 0 ? 1 : 3);
+          draco::EncoderBuffer buffer;
+          ASSERT_TRUE(encoder.EncodeMeshToBuffer(*mesh, &buffer).ok());
+          encoded_data[i] = *buffer.buffer();
+        }
+        ASSERT_EQ(encoded_data[0], encoded_data[1]);
+      }
+    }
+  }
+
+  std::unique_ptr<draco::PointCloud> pc(
+      draco::ReadPointCloudFromTestFile("point_cloud_test_pos_norm.ply"));
+  ASSERT_NE(pc, nullptr);
+  std::vector<char> encoded_data[2];
+  for (int i = 0; i < 2; ++i) {
+    draco::Encoder encoder;
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 12);
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::NORMAL, 8);
+    encoder.SetNumThreads(i == 0 ? 1 : 2);
+    draco::EncoderBuffer buffer;
+    ASSERT_TRUE(encoder.EncodePointCloudToBuffer(*pc, &buffer).ok());
+    encoded_data[i] = *buffer.buffer();
+  }
+  ASSERT_EQ(encoded_data[0], encoded_data[1]);
+}
+
+TEST_F(EncodeTest, TestEncodeToSink) {
+  // Tests that data encoded through a sink with a small staging area is the
+  // same as data encoded into a regular buffer.
+  std::unique_ptr<draco::Mesh> mesh(
+      draco::ReadMeshFromTestFile("cube_att.obj"));
+  ASSERT_NE(mesh, nullptr);
+  for (int method : {draco::MESH_SEQUENTIAL_ENCODING,
+                     draco::MESH_EDGEBREAKER_ENCODING}) {
+    for (int speed : {0, 10}) {
+      draco::Encoder encoder;
+      encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 12);
+      encoder.SetEncodingMethod(method);
+      encoder.SetSpeedOptions(speed, speed);
+      draco::EncoderBuffer buffer;
+      ASSERT_TRUE(encoder.EncodeMeshToBuffer(*mesh, &buffer).ok());
+
+      std::vector<char> sink_data;
+      int num_writes = 0;
+      draco::CallbackEncoderBufferSink sink(
+          [&](const char *data, size_t size) {
+            sink_data.insert(sink_data.end(), data, data + size);
+            ++num_writes;
+            return true;
+          });
+      draco::EncoderBuffer sink_buffer;
+      sink_buffer.SetSink(&sink, 16);
+      ASSERT_TRUE(encoder.EncodeMeshToBuffer(*mesh, &sink_buffer).ok());
+      ASSERT_LT(sink_buffer.size(), buffer.size());
+      ASSERT_TRUE(sink_buffer.Flush());
+      ASSERT_EQ(sink_buffer.size(), 0);
+      ASSERT_EQ(sink_buffer.encoded_size(), buffer.size());
+      ASSERT_GT(num_writes, 1);
+      ASSERT_EQ(sink_data, *buffer.buffer());
+    }
+  }
+
+  // Tests that errors of the sink are reported.
+  draco::CallbackEncoderBufferSink failing_sink(
+      [](const char *, size_t) { return false; });
+  draco::EncoderBuffer buffer;
+  buffer.SetSink(&failing_sink, 16);
+  draco::Encoder encoder;
+  encoder.EncodeMeshToBuffer(*mesh, &buffer);
+  ASSERT_FALSE(buffer.Flush());
+}
+
+TEST_F(EncodeTest, TestEstimatePredictionSchemes) {
+  // Tests that prediction schemes selected by the estimated entropy of their
+  // corrections don't change the decoded geometry.
+  for (const std::string file_name : {"test_nm.obj", "cube_att.obj"}) {
+    std::unique_ptr<draco::Mesh> mesh(draco::ReadMeshFromTestFile(file_name));
+    ASSERT_NE(mesh, nullptr);
+    for (int method : {draco::MESH_SEQUENTIAL_ENCODING,
+                       draco::MESH_EDGEBREAKER_ENCODING}) {
+      for (int speed : {3, 7}) {
+        std::unique_ptr<draco::Mesh> decoded_meshes[2];
+        size_t encoded_sizes[2];
+        for (int i = 0; i < 2; ++i) {
+          draco::Encoder encoder;
+          encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION,
+                                           12);
+          encoder.SetAttributeQuantization(draco::GeometryAttribute::TEX_COORD,
+                                           10);
+          encoder.SetAttributeQuantization(draco::GeometryAttribute::NORMAL,
+                                           8);
+          encoder.SetEncodingMethod(method);
+          encoder.SetSpeedOptions(speed, speed);
+          encoder.SetEstimatePredictionSchemes(i == 1);
+          draco::EncoderBuffer buffer;
+          ASSERT_TRUE(encoder.EncodeMeshToBuffer(*mesh, &buffer).ok());
+          draco::DecoderBuffer dec_buffer;
+          dec_buffer.Init(buffer.data(), buffer.size());
+          draco::Decoder decoder;
+          auto status_or = decoder.DecodeMeshFromBuffer(&dec_buffer);
+          ASSERT_TRUE(status_or.ok());
+          decoded_meshes[i] = std::move(status_or).value();
+          encoded_sizes[i] = buffer.size();
+        }
+        draco::MeshAreEquivalent equiv;
+        ASSERT_TRUE(equiv(*decoded_meshes[0], *decoded_meshes[1]));
+        ASSERT_LE(encoded_sizes[1], encoded_sizes[0]);
+      }
+    }
+  }
+}
+
 }  // namespace
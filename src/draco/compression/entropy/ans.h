@@ -466,6 +466,13 @@ class RAnsDecoder {
     return sym.val;
   }
 
+  // Decodes |num_symbols| symbols into |out_symbols|.
+  inline void rans_read_symbols(uint32_t *out_symbols, uint32_t num_symbols) {
+    for (uint32_t i = 0; i < num_symbols; ++i) {
+      out_symbols[i] = rans_read();
+    }
+  }
+
   // Construct a lookup table with |rans_precision| number of entries.
   // Returns false if the table couldn't be built (because of wrong input data).
   inline bool rans_build_look_up_table(const uint32_t token_probs[],
@@ -507,6 +514,230 @@ class RAnsDecoder {
   AnsDecoder ans_;
 };
 
+// Number of states used by RAnsInterleavedEncoder and RAnsInterleavedDecoder.
+static constexpr int kRAnsNumInterleavedStates = 4;
+
+// Variant of the RAnsEncoder that cycles through kRAnsNumInterleavedStates
+// independent rANS states. All states share the same output buffer. The n-th
+// symbol (in decoding order) is always encoded using the state n %
+// kRAnsNumInterleavedStates, which allows the decoder to process consecutive
+// symbols without waiting on the result of the previous one.
+// The symbols need to be encoded in the reverse order, same as with the
+// RAnsEncoder.
+template <int rans_precision_bits_t>
+class RAnsInterleavedEncoder {
+ public:
+  RAnsInterleavedEncoder() : buf_(nullptr), buf_offset_(0), num_symbols_(0) {}
+
+  // Provides the input buffer where the data is going to be stored.
+  inline void write_init(uint8_t *const buf) {
+    buf_ = buf;
+    buf_offset_ = 0;
+    num_symbols_ = 0;
+    for (int i = 0; i < kRAnsNumInterleavedStates; ++i) {
+      states_[i] = l_rans_base;
+    }
+  }
+
+  // Needs to be called after all symbols are encoded. The final states are
+  // stored in the order in which they are read by the decoder.
+  inline int write_end() {
+    for (int i = kRAnsNumInterleavedStates - 1; i >= 0; --i) {
+      // State that was used to encode the first symbol in decoding order that
+      // is assigned to the i-th decoder state.
+      const int state_id =
+          static_cast<int>((num_symbols_ + kRAnsNumInterleavedStates - 1 -
+                            static_cast<uint64_t>(i)) %
+                           kRAnsNumInterleavedStates);
+      const uint32_t state = states_[state_id];
+      DRACO_DCHECK_GE(state, l_rans_base);
+      DRACO_DCHECK_LT(state, l_rans_base * DRACO_ANS_IO_BASE);
+      if (!write_state(state - l_rans_base))
+        return buf_offset_;
+    }
+    return buf_offset_;
+  }
+
+  // rANS with normalization (see RAnsEncoder::rans_write()).
+  inline void rans_write(const struct rans_sym *const sym) {
+    uint32_t &state = states_[num_symbols_ % kRAnsNumInterleavedStates];
+    ++num_symbols_;
+    const uint32_t p = sym->prob;
+    while (state >= l_rans_base / rans_precision * DRACO_ANS_IO_BASE * p) {
+      buf_[buf_offset_++] = state % DRACO_ANS_IO_BASE;
+      state /= DRACO_ANS_IO_BASE;
+    }
+    state = (state / p) * rans_precision + state % p + sym->cum_prob;
+  }
+
+ private:
+  // Stores |state| using 1 - 4 bytes. The top two bits of the last byte
+  // encode the number of used bytes.
+  inline bool write_state(uint32_t state) {
+    if (state < (1 << 6)) {
+      buf_[buf_offset_] = (0x00 << 6) + state;
+      buf_offset_ += 1;
+    } else if (state < (1 << 14)) {
+      mem_put_le16(buf_ + buf_offset_, (0x01 << 14) + state);
+      buf_offset_ += 2;
+    } else if (state < (1 << 22)) {
+      mem_put_le24(buf_ + buf_offset_, (0x02 << 22) + state);
+      buf_offset_ += 3;
+    } else if (state < (1 << 30)) {
+      mem_put_le32(buf_ + buf_offset_, (0x03u << 30u) + state);
+      buf_offset_ += 4;
+    } else {
+      DRACO_DCHECK(0 && "State is too large to be serialized");
+      return false;
+    }
+    return true;
+  }
+
+  static constexpr int rans_precision = 1 << rans_precision_bits_t;
+  static constexpr int l_rans_base = rans_precision * 4;
+  uint8_t *buf_;
+  int buf_offset_;
+  uint64_t num_symbols_;
+  uint32_t states_[kRAnsNumInterleavedStates];
+};
+
+// Decoder for data encoded by the RAnsInterleavedEncoder. Unlike the
+// RAnsDecoder, the states are renormalized right after each symbol is decoded
+// because the input bytes are shared by all states.
+template <int rans_precision_bits_t>
+class RAnsInterleavedDecoder {
+ public:
+  RAnsInterleavedDecoder() : buf_(nullptr), buf_offset_(0), next_state_(0) {}
+
+  // Initializes the decoder from the input buffer. The |offset| specifies the
+  // number of bytes encoded by the encoder. A non zero return value is an
+  // error.
+  inline int read_init(const uint8_t *const buf, int offset) {
+    buf_ = buf;
+    next_state_ = 0;
+    for (int i = 0; i < kRAnsNumInterleavedStates; ++i) {
+      if (offset < 1)
+        return 1;
+      const unsigned x = buf[offset - 1] >> 6;
+      uint32_t state;
+      if (x == 0) {
+        offset -= 1;
+        state = buf[offset] & 0x3F;
+      } else if (x == 1) {
+        if (offset < 2)
+          return 1;
+        offset -= 2;
+        state = mem_get_le16(buf + offset) & 0x3FFF;
+      } else if (x == 2) {
+        if (offset < 3)
+          return 1;
+        offset -= 3;
+        state = mem_get_le24(buf + offset) & 0x3FFFFF;
+      } else {
+        if (offset < 4)
+          return 1;
+        offset -= 4;
+        state = mem_get_le32(buf + offset) & 0x3FFFFFFF;
+      }
+      state += l_rans_base;
+      if (state >= l_rans_base * DRACO_ANS_IO_BASE)
+        return 1;
+      states_[i] = state;
+    }
+    buf_offset_ = offset;
+    return 0;
+  }
+
+  inline int read_end() {
+    for (int i = 0; i < kRAnsNumInterleavedStates; ++i) {
+      if (states_[i] != l_rans_base)
+        return 0;
+    }
+    return 1;
+  }
+
+  inline int rans_read() {
+    const int state_id = next_state_;
+    next_state_ = (next_state_ + 1) % kRAnsNumInterleavedStates;
+    return read_symbol(&states_[state_id]);
+  }
+
+  // Decodes |num_symbols| symbols into |out_symbols|. Equivalent to calling
+  // rans_read() |num_symbols| times, but the states are kept in registers and
+  // the independent states are processed together.
+  inline void rans_read_symbols(uint32_t *out_symbols, uint32_t num_symbols) {
+    uint32_t i = 0;
+    if (next_state_ == 0) {
+      uint32_t states[kRAnsNumInterleavedStates];
+      for (int j = 0; j < kRAnsNumInterleavedStates; ++j) {
+        states[j] = states_[j];
+      }
+      for (; i + kRAnsNumInterleavedStates <= num_symbols;
+           i += kRAnsNumInterleavedStates) {
+        for (int j = 0; j < kRAnsNumInterleavedStates; ++j) {
+          out_symbols[i + j] = read_symbol(&states[j]);
+        }
+      }
+      for (int j = 0; j < kRAnsNumInterleavedStates; ++j) {
+        states_[j] = states[j];
+      }
+    }
+    for (; i < num_symbols; ++i) {
+      out_symbols[i] = rans_read();
+    }
+  }
+
+  // Construct a lookup table with |rans_precision| number of entries.
+  // Returns false if the table couldn't be built (because of wrong input data).
+  inline bool rans_build_look_up_table(const uint32_t token_probs[],
+                                       uint32_t num_symbols) {
+    lut_table_.resize(rans_precision);
+    uint32_t cum_prob = 0;
+    uint32_t act_prob = 0;
+    for (uint32_t i = 0; i < num_symbols; ++i) {
+      cum_prob += token_probs[i];
+      if (cum_prob > rans_precision) {
+        return false;
+      }
+      for (uint32_t j = act_prob; j < cum_prob; ++j) {
+        lut_table_[j].val = i;
+        lut_table_[j].prob = token_probs[i];
+        lut_table_[j].cum_prob = act_prob;
+      }
+      act_prob = cum_prob;
+    }
+    if (cum_prob != rans_precision) {
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  inline uint32_t read_symbol(uint32_t *state) {
+    // |rans_precision| is a power of two compile time constant, and the below
+    // division and modulo are going to be optimized by the compiler.
+    const uint32_t quo = *state / rans_precision;
+    const uint32_t rem = *state % rans_precision;
+    const rans_dec_sym &sym = lut_table_[rem];
+    uint32_t new_state = quo * sym.prob + rem - sym.cum_prob;
+    while (new_state < l_rans_base && buf_offset_ > 0) {
+      new_state = new_state * DRACO_ANS_IO_BASE + buf_[--buf_offset_];
+    }
+    *state = new_state;
+    return sym.val;
+  }
+
+  static constexpr int rans_precision = 1 << rans_precision_bits_t;
+  static constexpr int l_rans_base = rans_precision * 4;
+  // Lookup table that stores the decoded symbol together with its probability
+  // for each possible remainder of the state.
+  std::vector<rans_dec_sym> lut_table_;
+  const uint8_t *buf_;
+  int buf_offset_;
+  int next_state_;
+  uint32_t states_[kRAnsNumInterleavedStates];
+};
+
 #undef DRACO_ANS_DIVREM
 #undef DRACO_ANS_P8_PRECISION
 #undef DRACO_ANS_L_BASE
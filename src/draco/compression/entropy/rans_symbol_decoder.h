@@ -27,11 +27,14 @@ namespace draco {
 // A helper class for decoding symbols using the rANS algorithm (see ans.h).
 // The class can be used to decode the probability table and the data encoded
 // by the RAnsSymbolEncoder. |unique_symbols_bit_length_t| must be the same as
-// the one used for the corresponding RAnsSymbolEncoder.
-template <int unique_symbols_bit_length_t>
-class RAnsSymbolDecoder {
+// the one used for the corresponding RAnsSymbolEncoder. |RAnsDecoderT| is the
+// underlying rANS coder (RAnsDecoder or RAnsInterleavedDecoder). Use
+// RAnsSymbolDecoder or RAnsInterleavedSymbolDecoder defined below.
+template <int unique_symbols_bit_length_t,
+          template <int> class RAnsDecoderT>
+class RAnsSymbolDecoderBase {
  public:
-  RAnsSymbolDecoder() : num_symbols_(0) {}
+  RAnsSymbolDecoderBase() : num_symbols_(0) {}
 
   // Initialize the decoder and decode the probability table.
   bool Create(DecoderBuffer *buffer);
@@ -42,6 +45,10 @@ class RAnsSymbolDecoder {
   // encoded data after this call.
   bool StartDecoding(DecoderBuffer *buffer);
   uint32_t DecodeSymbol() { return ans_.rans_read(); }
+  // Decodes |num_values| symbols into |out_values|.
+  void DecodeSymbols(uint32_t num_values, uint32_t *out_values) {
+    ans_.rans_read_symbols(out_values, num_values);
+  }
   void EndDecoding();
 
  private:
@@ -52,11 +59,12 @@ class RAnsSymbolDecoder {
 
   std::vector<uint32_t> probability_table_;
   uint32_t num_symbols_;
-  RAnsDecoder<rans_precision_bits_> ans_;
+  RAnsDecoderT<rans_precision_bits_> ans_;
 };
 
-template <int unique_symbols_bit_length_t>
-bool RAnsSymbolDecoder<unique_symbols_bit_length_t>::Create(
+template <int unique_symbols_bit_length_t,
+          template <int> class RAnsDecoderT>
+bool RAnsSymbolDecoderBase<unique_symbols_bit_length_t, RAnsDecoderT>::Create(
     DecoderBuffer *buffer) {
   // Check that the DecoderBuffer version is set.
   if (buffer->bitstream_version() == 0)
@@ -116,8 +124,9 @@ bool RAnsSymbolDecoder<unique_symbols_bit_length_t>::Create(
   return true;
 }
 
-template <int unique_symbols_bit_length_t>
-bool RAnsSymbolDecoder<unique_symbols_bit_length_t>::StartDecoding(
+template <int unique_symbols_bit_length_t,
+          template <int> class RAnsDecoderT>
+bool RAnsSymbolDecoderBase<unique_symbols_bit_length_t, RAnsDecoderT>::StartDecoding(
     DecoderBuffer *buffer) {
   uint64_t bytes_encoded;
   // Decode the number of bytes encoded by the encoder.
@@ -143,11 +152,24 @@ bool RAnsSymbolDecoder<unique_symbols_bit_length_t>::StartDecoding(
   return true;
 }
 
-template <int unique_symbols_bit_length_t>
-void RAnsSymbolDecoder<unique_symbols_bit_length_t>::EndDecoding() {
+template <int unique_symbols_bit_length_t,
+          template <int> class RAnsDecoderT>
+void RAnsSymbolDecoderBase<unique_symbols_bit_length_t, RAnsDecoderT>::EndDecoding() {
   ans_.read_end();
 }
 
+// Symbol decoder for data encoded by the RAnsSymbolEncoder.
+template <int unique_symbols_bit_length_t>
+class RAnsSymbolDecoder
+    : public RAnsSymbolDecoderBase<unique_symbols_bit_length_t, RAnsDecoder> {
+};
+
+// Symbol decoder for data encoded by the RAnsInterleavedSymbolEncoder.
+template <int unique_symbols_bit_length_t>
+class RAnsInterleavedSymbolDecoder
+    : public RAnsSymbolDecoderBase<unique_symbols_bit_length_t,
+                                   RAnsInterleavedDecoder> {};
+
 }  // namespace draco
 
 #endif  // DRACO_COMPRESSION_ENTROPY_RANS_SYMBOL_DECODER_H_
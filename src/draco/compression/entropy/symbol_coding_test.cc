@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //
+#include <algorithm>
+#include <random>
+
 #include "draco/compression/config/compression_shared.h"
 #include "draco/compression/entropy/symbol_decoding.h"
 #include "draco/compression/entropy/symbol_encoding.h"
@@ -24,7 +27,10 @@ namespace draco {
 
 class SymbolCodingTest : public ::testing::Test {
  protected:
-  SymbolCodingTest() : bitstream_version_(kDracoMeshBitstreamVersion) {}
+  SymbolCodingTest()
+      : bitstream_version_(kDracoMeshBitstreamVersion),
+        min_interleaved_version_(
+            InterleavedSymbolCodingBitstreamVersion(TRIANGULAR_MESH)) {}
 
   template <class SignedIntTypeT>
   void TestConvertToSymbolAndBack(SignedIntTypeT x) {
@@ -35,6 +41,7 @@ class SymbolCodingTest : public ::testing::Test {
   }
 
   uint16_t bitstream_version_;
+  uint16_t min_interleaved_version_;
 };
 
 TEST_F(SymbolCodingTest, TestLargeNumbers) {
@@ -83,7 +90,8 @@ TEST_F(SymbolCodingTest, TestManyNumbers) {
     DecoderBuffer db;
     db.Init(eb.data(), eb.size());
     db.set_bitstream_version(bitstream_version_);
-    ASSERT_TRUE(DecodeSymbols(in_values.size(), 1, &db, &out_values[0]));
+    ASSERT_TRUE(DecodeSymbols(in_values.size(), 1, min_interleaved_version_,
+                              &db, &out_values[0]));
     for (uint32_t i = 0; i < in_values.size(); ++i) {
       ASSERT_EQ(in_values[i], out_values[i]);
     }
@@ -158,6 +166,127 @@ TEST_F(SymbolCodingTest, TestLargeNumberCondition) {
   }
 }
 
+TEST_F(SymbolCodingTest, TestInterleavedRawCoding) {
+  // This test verifies that the interleaved raw coding works for inputs of
+  // various sizes (not necessarily multiples of the number of rANS states) and
+  // various numbers of unique symbols.
+  std::mt19937 generator(42);
+  for (int max_value_bits = 0; max_value_bits <= 16; max_value_bits += 4) {
+    for (int num_values = 1; num_values < 300; num_values += 37) {
+      std::geometric_distribution<uint32_t> distribution(
+          1.0 / (1 << max_value_bits));
+      std::vector<uint32_t> in(num_values);
+      for (int i = 0; i < num_values; ++i) {
+        in[i] = distribution(generator) & ((1 << 18) - 1);
+      }
+      for (int compression_level = 0; compression_level <= 10;
+           compression_level += 5) {
+        Options options;
+        SetSymbolEncodingMethod(&options, SYMBOL_CODING_RAW_INTERLEAVED);
+        SetSymbolEncodingCompressionLevel(&options, compression_level);
+        EncoderBuffer eb;
+        ASSERT_TRUE(EncodeSymbols(in.data(), num_values, 1, &options, &eb));
+
+        std::vector<uint32_t> out(num_values);
+        DecoderBuffer db;
+        db.Init(eb.data(), eb.size());
+        db.set_bitstream_version(bitstream_version_);
+        ASSERT_TRUE(DecodeSymbols(num_values, 1, min_interleaved_version_, &db,
+                                  &out[0]));
+        ASSERT_EQ(db.remaining_size(), 0);
+        ASSERT_EQ(in, out);
+      }
+    }
+  }
+}
+
+TEST_F(SymbolCodingTest, TestInterleavedRawCodingVersions) {
+  // This test verifies that the interleaved coding is accepted only in mesh
+  // bit-streams 2.3+ and point cloud bit-streams 2.4+.
+  std::vector<uint32_t> in(1000);
+  for (size_t i = 0; i < in.size(); ++i) {
+    in[i] = (i * 7) % 13;
+  }
+  Options options;
+  SetSymbolEncodingMethod(&options, SYMBOL_CODING_RAW_INTERLEAVED);
+  EncoderBuffer eb;
+  ASSERT_TRUE(EncodeSymbols(in.data(), in.size(), 1, &options, &eb));
+  std::vector<uint32_t> out(in.size());
+  const struct {
+    EncodedGeometryType geometry_type;
+    uint8_t minor_version;
+    bool supported;
+  } cases[] = {{TRIANGULAR_MESH, 2, false},
+               {TRIANGULAR_MESH, 3, true},
+               {POINT_CLOUD, 3, false},
+               {POINT_CLOUD, 4, true}};
+  for (const auto &c : cases) {
+    DecoderBuffer db;
+    db.Init(eb.data(), eb.size());
+    db.set_bitstream_version(DRACO_BITSTREAM_VERSION(2, c.minor_version));
+    ASSERT_EQ(DecodeSymbols(in.size(), 1,
+                            InterleavedSymbolCodingBitstreamVersion(
+                                c.geometry_type),
+                            &db, &out[0]),
+              c.supported);
+  }
+
+  // The interleaved coding is never accepted without the minimum version.
+  DecoderBuffer db;
+  db.Init(eb.data(), eb.size());
+  db.set_bitstream_version(bitstream_version_);
+  ASSERT_FALSE(DecodeSymbols(in.size(), 1, &db, &out[0]));
+}
+
+TEST_F(SymbolCodingTest, TestInterleavedRawCodingSelection) {
+  // This test verifies that the interleaved coding is selected only when it is
+  // enabled and when there is enough input values.
+  std::vector<uint32_t> in(1000);
+  for (size_t i = 0; i < in.size(); ++i) {
+    in[i] = (i * 7) % 13;
+  }
+  for (int num_values : {10, 1000}) {
+    for (bool interleaved : {false, true}) {
+      Options options;
+      SetSymbolEncodingInterleaved(&options, interleaved);
+      EncoderBuffer eb;
+      ASSERT_TRUE(EncodeSymbols(in.data(), num_values, 1, &options, &eb));
+      const uint8_t method = eb.data()[0];
+      ASSERT_EQ(method == SYMBOL_CODING_RAW_INTERLEAVED,
+                interleaved && num_values == 1000);
+    }
+  }
+}
+
+TEST_F(SymbolCodingTest, TestRawCodingMethodsRoundTrip) {
+  // This test verifies that the raw and the interleaved raw coding decode the
+  // same values from a larger input with a skewed distribution.
+  constexpr int kNumValues = 10000;
+  std::mt19937 generator(42);
+  std::geometric_distribution<uint32_t> distribution(1.0 / 64);
+  std::vector<uint32_t> in(kNumValues);
+  for (int i = 0; i < kNumValues; ++i) {
+    in[i] = std::min<uint32_t>(distribution(generator), 4095);
+  }
+  const SymbolCodingMethod methods[] = {SYMBOL_CODING_RAW,
+                                        SYMBOL_CODING_RAW_INTERLEAVED};
+  for (const SymbolCodingMethod method : methods) {
+    Options options;
+    SetSymbolEncodingMethod(&options, method);
+    EncoderBuffer eb;
+    ASSERT_TRUE(EncodeSymbols(in.data(), kNumValues, 1, &options, &eb));
+    ASSERT_EQ(eb.data()[0], method);
+    std::vector<uint32_t> out(kNumValues);
+    DecoderBuffer db;
+    db.Init(eb.data(), eb.size());
+    db.set_bitstream_version(bitstream_version_);
+    ASSERT_TRUE(DecodeSymbols(kNumValues, 1, min_interleaved_version_, &db,
+                              &out[0]));
+    ASSERT_EQ(db.remaining_size(), 0);
+    ASSERT_EQ(in, out);
+  }
+}
+
 TEST_F(SymbolCodingTest, TestConversionFullRange) {
   TestConvertToSymbolAndBack(static_cast<int8_t>(-128));
   TestConvertToSymbolAndBack(static_cast<int8_t>(-127));
@@ -29,8 +29,12 @@ template <template <int> class SymbolDecoderT>
 bool DecodeRawSymbols(uint32_t num_values, DecoderBuffer *src_buffer,
                       uint32_t *out_values);
 
-bool DecodeSymbols(uint32_t num_values, int num_components,
-                   DecoderBuffer *src_buffer, uint32_t *out_values) {
+// Decodes the symbols. The interleaved coding is accepted only when
+// |allow_interleaved| is set.
+static bool DecodeSymbolsInternal(uint32_t num_values, int num_components,
+                                  bool allow_interleaved,
+                                  DecoderBuffer *src_buffer,
+                                  uint32_t *out_values) {
   if (num_values == 0)
     return true;
   // Decode which scheme to use.
@@ -43,10 +47,31 @@ bool DecodeSymbols(uint32_t num_values, int num_components,
   } else if (scheme == SYMBOL_CODING_RAW) {
     return DecodeRawSymbols<RAnsSymbolDecoder>(num_values, src_buffer,
                                                out_values);
+  } else if (scheme == SYMBOL_CODING_RAW_INTERLEAVED) {
+    if (!allow_interleaved)
+      return false;
+    return DecodeRawSymbols<RAnsInterleavedSymbolDecoder>(
+        num_values, src_buffer, out_values);
   }
   return false;
 }
 
+bool DecodeSymbols(uint32_t num_values, int num_components,
+                   DecoderBuffer *src_buffer, uint32_t *out_values) {
+  return DecodeSymbolsInternal(num_values, num_components, false, src_buffer,
+                               out_values);
+}
+
+bool DecodeSymbols(uint32_t num_values, int num_components,
+                   uint16_t min_interleaved_version, DecoderBuffer *src_buffer,
+                   uint32_t *out_values) {
+  // The interleaved coding is not allowed in older bit-streams.
+  return DecodeSymbolsInternal(
+      num_values, num_components,
+      src_buffer->bitstream_version() >= min_interleaved_version, src_buffer,
+      out_values);
+}
+
 template <template <int> class SymbolDecoderT>
 bool DecodeTaggedSymbols(uint32_t num_values, int num_components,
                          DecoderBuffer *src_buffer, uint32_t *out_values) {
@@ -93,11 +118,7 @@ bool DecodeRawSymbolsInternal(uint32_t num_values, DecoderBuffer *src_buffer,
 
   if (!decoder.StartDecoding(src_buffer))
     return false;
-  for (uint32_t i = 0; i < num_values; ++i) {
-    // Decode a symbol into the value.
-    const uint32_t value = decoder.DecodeSymbol();
-    out_values[i] = value;
-  }
+  decoder.DecodeSymbols(num_values, out_values);
   decoder.EndDecoding();
   return true;
 }
@@ -20,10 +20,18 @@
 namespace draco {
 
 // Decodes an array of symbols that was previously encoded with an entropy code.
+// Symbols encoded with SYMBOL_CODING_RAW_INTERLEAVED are rejected.
 // Returns false on error.
 bool DecodeSymbols(uint32_t num_values, int num_components,
                    DecoderBuffer *src_buffer, uint32_t *out_values);
 
+// Same as above but symbols encoded with SYMBOL_CODING_RAW_INTERLEAVED are
+// accepted when the bit-stream version of |src_buffer| is at least
+// |min_interleaved_version| (see InterleavedSymbolCodingBitstreamVersion()).
+bool DecodeSymbols(uint32_t num_values, int num_components,
+                   uint16_t min_interleaved_version, DecoderBuffer *src_buffer,
+                   uint32_t *out_values);
+
 }  // namespace draco
 
 #endif  // DRACO_COMPRESSION_ENTROPY_SYMBOL_DECODING_H_
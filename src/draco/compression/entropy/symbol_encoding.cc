@@ -27,6 +27,10 @@ namespace draco {
 constexpr int32_t kMaxTagSymbolBitLength = 32;
 constexpr int kMaxRawEncodingBitLength = 18;
 constexpr int kDefaultSymbolCodingCompressionLevel = 7;
+// Minimum number of values for which the interleaved raw encoding is used.
+// For fewer values, the extra rANS states would take more space than what
+// could be saved in decoding time.
+constexpr int kMinInterleavedRawEncodingNumValues = 64;
 
 typedef uint64_t TaggedBitLengthFrequencies[kMaxTagSymbolBitLength];
 
@@ -34,6 +38,10 @@ void SetSymbolEncodingMethod(Options *options, SymbolCodingMethod method) {
   options->SetInt("symbol_encoding_method", method);
 }
 
+void SetSymbolEncodingInterleaved(Options *options, bool interleaved) {
+  options->SetBool("symbol_encoding_interleaved", interleaved);
+}
+
 bool SetSymbolEncodingCompressionLevel(Options *options,
                                        int compression_level) {
   if (compression_level < 0 || compression_level > 10)
@@ -149,6 +157,11 @@ bool EncodeSymbols(const uint32_t *symbols, int num_values, int num_components,
       method = SYMBOL_CODING_TAGGED;
     } else {
       method = SYMBOL_CODING_RAW;
+      if (options != nullptr &&
+          options->GetBool("symbol_encoding_interleaved", false) &&
+          num_values >= kMinInterleavedRawEncodingNumValues) {
+        method = SYMBOL_CODING_RAW_INTERLEAVED;
+      }
     }
   }
   // Use the tagged scheme.
@@ -162,6 +175,11 @@ bool EncodeSymbols(const uint32_t *symbols, int num_values, int num_components,
                                                num_unique_symbols, options,
                                                target_buffer);
   }
+  if (method == SYMBOL_CODING_RAW_INTERLEAVED) {
+    return EncodeRawSymbols<RAnsInterleavedSymbolEncoder>(
+        symbols, num_values, max_value, num_unique_symbols, options,
+        target_buffer);
+  }
   // Unknown method selected.
   return false;
 }
@@ -36,6 +36,12 @@ bool EncodeSymbols(const uint32_t *symbols, int num_values, int num_components,
 // method.
 void SetSymbolEncodingMethod(Options *options, SymbolCodingMethod method);
 
+// Sets an option that allows the symbol encoder to use the interleaved rANS
+// coding (SYMBOL_CODING_RAW_INTERLEAVED) instead of SYMBOL_CODING_RAW. The
+// interleaved coding is faster to decode, but the decoder needs to support
+// the bit-stream version in which it was introduced.
+void SetSymbolEncodingInterleaved(Options *options, bool interleaved);
+
 // Sets the desired compression level for symbol encoding in range <0, 10> where
 // 0 is the worst but fastest compression and 10 is the best but slowest
 // compression. If the option is not set, default value of 7 is used.
@@ -24,6 +24,9 @@
 
 namespace draco {
 
+struct AutotuneOptions;
+struct AutotuneResult;
+
 // Advanced helper class for encoding geometry using the Draco compression
 // library. Unlike the basic Encoder (encode.h), this class allows users to
 // specify options for each attribute individually using provided attribute ids.
@@ -132,6 +135,20 @@ class ExpertEncoder : public EncoderBase<EncoderOptions> {
   Status SetAttributePredictionScheme(int32_t attribute_id,
                                       int prediction_scheme_method);
 
+  // Searches for the encoder settings that produce the smallest encoded data
+  // within the limits given by |autotune_options| (see
+  // expert_encode_autotune.h). Candidate configurations varying the encoding
+  // method, edgebreaker method and traversal, speed and prediction schemes of
+  // individual attributes are encoded in parallel and decoded to measure
+  // their actual decoding time. When only the size limit is set, the fastest
+  // decoding configuration that fits the limit is selected instead.
+  // The best encoded data is stored into |out_buffer| and the selected
+  // settings into |out_result|. The options of the encoder are replaced with
+  // the selected settings. Requires the decoder, i.e., the function is not
+  // available in the encoder-only libraries.
+  Status Autotune(const AutotuneOptions &autotune_options,
+                  EncoderBuffer *out_buffer, AutotuneResult *out_result);
+
  private:
   Status EncodePointCloudToBuffer(const PointCloud &pc,
                                   EncoderBuffer *out_buffer);
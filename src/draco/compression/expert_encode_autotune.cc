@@ -0,0 +1,375 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/expert_encode_autotune.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#include "draco/attributes/attribute_quantization_transform.h"
+#include "draco/compression/attributes/normal_compression_utils.h"
+#include "draco/compression/decode.h"
+#include "draco/compression/expert_encode.h"
+#include "draco/core/quantization_utils.h"
+#include "draco/core/thread_pool.h"
+
+namespace draco {
+
+namespace {
+
+// Returns the largest difference between the values of |att| and the values
+// reconstructed from the |quantization_bits| quantized values.
+float ComputeQuantizationError(const PointAttribute &att,
+                               int quantization_bits) {
+  const int num_components = att.num_components();
+  std::vector<float> value(num_components);
+  float max_error = 0.f;
+  if (att.attribute_type() == GeometryAttribute::NORMAL &&
+      num_components == 3) {
+    // Normals are encoded as octahedral coordinates.
+    OctahedronToolBox octahedron_tool_box;
+    if (!octahedron_tool_box.SetQuantizationBits(quantization_bits))
+      return std::numeric_limits<float>::infinity();
+    for (AttributeValueIndex i(0); i < static_cast<uint32_t>(att.size());
+         ++i) {
+      att.GetValue(i, value.data());
+      const float length = std::sqrt(value[0] * value[0] +
+                                     value[1] * value[1] + value[2] * value[2]);
+      if (!(length > 1e-6f))
+        continue;  // Zero length normals can't be reconstructed anyway.
+      int32_t s, t;
+      octahedron_tool_box.FloatVectorToQuantizedOctahedralCoords(value.data(),
+                                                                 &s, &t);
+      float decoded_value[3];
+      octahedron_tool_box.QuantizedOctaherdalCoordsToUnitVector(s, t,
+                                                                decoded_value);
+      for (int c = 0; c < 3; ++c) {
+        max_error = std::max(
+            max_error, std::abs(decoded_value[c] - value[c] / length));
+      }
+    }
+    return max_error;
+  }
+
+  AttributeQuantizationTransform transform;
+  if (!transform.ComputeParameters(att, quantization_bits))
+    return std::numeric_limits<float>::infinity();
+  const int32_t max_quantized_value = (1 << quantization_bits) - 1;
+  Quantizer quantizer;
+  quantizer.Init(transform.range(), max_quantized_value);
+  Dequantizer dequantizer;
+  if (!dequantizer.Init(transform.range(), max_quantized_value))
+    return std::numeric_limits<float>::infinity();
+  for (AttributeValueIndex i(0); i < static_cast<uint32_t>(att.size()); ++i) {
+    att.GetValue(i, value.data());
+    for (int c = 0; c < num_components; ++c) {
+      const float offset = value[c] - transform.min_value(c);
+      const float decoded_value =
+          dequantizer.DequantizeFloat(quantizer.QuantizeFloat(offset)) +
+          transform.min_value(c);
+      max_error = std::max(max_error, std::abs(decoded_value - value[c]));
+    }
+  }
+  return max_error;
+}
+
+// Returns the smallest number of quantization bits for which the values of
+// |att| are reconstructed within the |tolerance|, or -1 when no quantization
+// satisfies the |tolerance|.
+int ComputeQuantizationBits(const PointAttribute &att, float tolerance) {
+  const int kMaxQuantizationBits = 30;
+  // Octahedral coordinates need at least two bits.
+  int min_bits = att.attribute_type() == GeometryAttribute::NORMAL ? 2 : 1;
+  int max_bits = kMaxQuantizationBits;
+  if (ComputeQuantizationError(att, max_bits) > tolerance)
+    return -1;
+  // The error decreases with the number of quantization bits.
+  while (min_bits < max_bits) {
+    const int bits = (min_bits + max_bits) / 2;
+    if (ComputeQuantizationError(att, bits) <= tolerance) {
+      max_bits = bits;
+    } else {
+      min_bits = bits + 1;
+    }
+  }
+  return max_bits;
+}
+
+// Encoded candidate configuration.
+struct AutotuneCandidate {
+  AutotuneCandidate() : is_valid(false), decoding_time_ms(0.0) {}
+
+  AutotuneSettings settings;
+  EncoderBuffer buffer;
+  // Set when the candidate was successfully encoded and decoded.
+  bool is_valid;
+  double decoding_time_ms;
+};
+
+EncoderOptions CreateCandidateOptions(const EncoderOptions &base_options,
+                                      const AutotuneSettings &settings) {
+  EncoderOptions options = base_options;
+  options.SetGlobalInt("encoding_method", settings.encoding_method);
+  if (settings.edgebreaker_method != -1)
+    options.SetGlobalInt("edgebreaker_method", settings.edgebreaker_method);
+  if (settings.traversal_method != -1) {
+    options.SetGlobalInt("edgebreaker_traversal_method",
+                         settings.traversal_method);
+  }
+  options.SetSpeed(settings.speed, settings.speed);
+  for (int i = 0; i < static_cast<int>(settings.quantization_bits.size());
+       ++i) {
+    options.SetAttributeInt(i, "quantization_bits",
+                            settings.quantization_bits[i]);
+    options.SetAttributeInt(i, "prediction_scheme",
+                            settings.prediction_schemes[i]);
+  }
+  return options;
+}
+
+// Encodes and decodes the geometry using the |candidate| settings.
+void EvaluateCandidate(const PointCloud &pc, const Mesh *mesh,
+                       const EncoderOptions &base_options,
+                       int num_decoding_iterations,
+                       AutotuneCandidate *candidate) {
+  std::unique_ptr<ExpertEncoder> encoder(
+      mesh ? new ExpertEncoder(*mesh) : new ExpertEncoder(pc));
+  encoder->Reset(CreateCandidateOptions(base_options, candidate->settings));
+  if (!encoder->EncodeToBuffer(&candidate->buffer).ok())
+    return;
+  typedef std::chrono::steady_clock Clock;
+  double min_time_ms = std::numeric_limits<double>::max();
+  for (int i = 0; i < std::max(num_decoding_iterations, 1); ++i) {
+    DecoderBuffer buffer;
+    buffer.Init(candidate->buffer.data(), candidate->buffer.size());
+    Decoder decoder;
+    const Clock::time_point start = Clock::now();
+    const bool decoded = decoder.DecodePointCloudFromBuffer(&buffer).ok();
+    const double time_ms =
+        std::chrono::duration<double, std::milli>(Clock::now() - start)
+            .count();
+    if (!decoded)
+      return;
+    min_time_ms = std::min(min_time_ms, time_ms);
+  }
+  candidate->decoding_time_ms = min_time_ms;
+  candidate->is_valid = true;
+}
+
+bool IsWithinLimits(const AutotuneCandidate &candidate,
+                    const AutotuneOptions &options) {
+  if (!candidate.is_valid)
+    return false;
+  if (options.max_encoded_size > 0 &&
+      static_cast<int64_t>(candidate.buffer.size()) > options.max_encoded_size)
+    return false;
+  if (options.max_decoding_time_ms > 0 &&
+      candidate.decoding_time_ms > options.max_decoding_time_ms)
+    return false;
+  return true;
+}
+
+// Returns true when candidate |a| is preferred over candidate |b|.
+bool IsBetterCandidate(const AutotuneCandidate &a, const AutotuneCandidate &b,
+                       const AutotuneOptions &options) {
+  const bool a_within_limits = IsWithinLimits(a, options);
+  if (a_within_limits != IsWithinLimits(b, options))
+    return a_within_limits;
+  if (a.is_valid != b.is_valid)
+    return a.is_valid;
+  const size_t a_size = a.buffer.size();
+  const size_t b_size = b.buffer.size();
+  if (options.max_encoded_size > 0 && options.max_decoding_time_ms <= 0) {
+    // Only the size is limited. Prefer the fastest decoding.
+    if (a.decoding_time_ms != b.decoding_time_ms)
+      return a.decoding_time_ms < b.decoding_time_ms;
+    return a_size < b_size;
+  }
+  if (a_size != b_size)
+    return a_size < b_size;
+  return a.decoding_time_ms < b.decoding_time_ms;
+}
+
+// Returns prediction schemes that can be used for attributes of |type|.
+std::vector<int> GetPredictionSchemeCandidates(GeometryAttribute::Type type) {
+  if (type == GeometryAttribute::NORMAL)
+    return {PREDICTION_DIFFERENCE, MESH_PREDICTION_GEOMETRIC_NORMAL};
+  std::vector<int> schemes = {PREDICTION_DIFFERENCE,
+                              MESH_PREDICTION_PARALLELOGRAM,
+                              MESH_PREDICTION_CONSTRAINED_MULTI_PARALLELOGRAM};
+  if (type == GeometryAttribute::TEX_COORD)
+    schemes.push_back(MESH_PREDICTION_TEX_COORDS_PORTABLE);
+  return schemes;
+}
+
+// Returns the configurations tried in the first step of the search.
+std::vector<AutotuneSettings> GenerateMethodCandidates(
+    bool is_mesh, const AutotuneSettings &base_settings) {
+  std::vector<AutotuneSettings> candidates;
+  for (int speed : {0, 2, 4, 6, 8, 10}) {
+    AutotuneSettings settings = base_settings;
+    settings.speed = speed;
+    if (!is_mesh) {
+      for (int method : {POINT_CLOUD_SEQUENTIAL_ENCODING,
+                         POINT_CLOUD_KD_TREE_ENCODING}) {
+        settings.encoding_method = method;
+        candidates.push_back(settings);
+      }
+      continue;
+    }
+    settings.encoding_method = MESH_SEQUENTIAL_ENCODING;
+    candidates.push_back(settings);
+    settings.encoding_method = MESH_EDGEBREAKER_ENCODING;
+    for (int edgebreaker_method : {MESH_EDGEBREAKER_STANDARD_ENCODING,
+                                   MESH_EDGEBREAKER_VALENCE_ENCODING}) {
+      for (int traversal_method : {MESH_TRAVERSAL_DEPTH_FIRST,
+                                   MESH_TRAVERSAL_PREDICTION_DEGREE}) {
+        settings.edgebreaker_method = edgebreaker_method;
+        settings.traversal_method = traversal_method;
+        candidates.push_back(settings);
+      }
+    }
+  }
+  return candidates;
+}
+
+}  // namespace
+
+Status ExpertEncoder::Autotune(const AutotuneOptions &autotune_options,
+                               EncoderBuffer *out_buffer,
+                               AutotuneResult *out_result) {
+  if (point_cloud_ == nullptr)
+    return Status(Status::DRACO_ERROR, "Invalid input geometry.");
+  const PointCloud &pc = *point_cloud_;
+
+  // Settings shared by all candidates.
+  AutotuneSettings base_settings;
+  for (int i = 0; i < pc.num_attributes(); ++i) {
+    const PointAttribute *const att = pc.attribute(i);
+    int quantization_bits =
+        options().GetAttributeInt(i, "quantization_bits", -1);
+    const auto it = autotune_options.tolerances.find(att->attribute_type());
+    if (it != autotune_options.tolerances.end() &&
+        att->data_type() == DT_FLOAT32) {
+      quantization_bits = ComputeQuantizationBits(*att, it->second);
+    }
+    base_settings.quantization_bits.push_back(quantization_bits);
+    base_settings.prediction_schemes.push_back(options().GetAttributeInt(
+        i, "prediction_scheme", PREDICTION_UNDEFINED));
+  }
+
+  int num_threads = autotune_options.num_threads;
+  if (num_threads <= 0) {
+    num_threads =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+  // The calling thread takes part in the evaluation.
+  ThreadPool pool(num_threads - 1);
+  std::vector<std::unique_ptr<AutotuneCandidate>> candidates;
+  const EncoderOptions base_options = options();
+  const int num_decoding_iterations = autotune_options.num_decoding_iterations;
+  // Evaluates all |settings| and returns the index of the best of them.
+  const auto evaluate = [&](const std::vector<AutotuneSettings> &settings) {
+    const int first_candidate = static_cast<int>(candidates.size());
+    for (const AutotuneSettings &s : settings) {
+      candidates.push_back(
+          std::unique_ptr<AutotuneCandidate>(new AutotuneCandidate()));
+      candidates.back()->settings = s;
+    }
+    ParallelFor(&pool, static_cast<int>(settings.size()), [&](int i) {
+      EvaluateCandidate(pc, mesh_, base_options, num_decoding_iterations,
+                        candidates[first_candidate + i].get());
+      return true;
+    });
+    int best = first_candidate;
+    for (int i = first_candidate + 1; i < static_cast<int>(candidates.size());
+         ++i) {
+      if (IsBetterCandidate(*candidates[i], *candidates[best],
+                            autotune_options))
+        best = i;
+    }
+    return best;
+  };
+
+  // First find the best encoding method and speed.
+  int best =
+      evaluate(GenerateMethodCandidates(mesh_ != nullptr, base_settings));
+
+  if (mesh_ != nullptr && autotune_options.tune_prediction_schemes &&
+      candidates[best]->is_valid) {
+    // Try other prediction schemes for each attribute separately.
+    const AutotuneSettings best_settings = candidates[best]->settings;
+    std::vector<AutotuneSettings> settings;
+    std::vector<int> settings_att_ids;
+    for (int i = 0; i < pc.num_attributes(); ++i) {
+      for (int scheme :
+           GetPredictionSchemeCandidates(pc.attribute(i)->attribute_type())) {
+        if (scheme == best_settings.prediction_schemes[i])
+          continue;
+        settings.push_back(best_settings);
+        settings.back().prediction_schemes[i] = scheme;
+        settings_att_ids.push_back(i);
+      }
+    }
+    const int first_candidate = static_cast<int>(candidates.size());
+    evaluate(settings);
+
+    // Combine the best prediction schemes of all attributes.
+    AutotuneSettings combined_settings = best_settings;
+    std::vector<int> att_best(pc.num_attributes(), best);
+    for (int i = 0; i < static_cast<int>(settings.size()); ++i) {
+      const int att_id = settings_att_ids[i];
+      if (IsBetterCandidate(*candidates[first_candidate + i],
+                            *candidates[att_best[att_id]], autotune_options))
+        att_best[att_id] = first_candidate + i;
+    }
+    int num_improved_attributes = 0;
+    for (int i = 0; i < pc.num_attributes(); ++i) {
+      if (att_best[i] == best)
+        continue;
+      combined_settings.prediction_schemes[i] =
+          candidates[att_best[i]]->settings.prediction_schemes[i];
+      ++num_improved_attributes;
+    }
+    if (num_improved_attributes > 1)
+      evaluate({combined_settings});
+    for (int i = first_candidate; i < static_cast<int>(candidates.size());
+         ++i) {
+      if (IsBetterCandidate(*candidates[i], *candidates[best],
+                            autotune_options))
+        best = i;
+    }
+  }
+
+  const AutotuneCandidate &best_candidate = *candidates[best];
+  if (!IsWithinLimits(best_candidate, autotune_options)) {
+    return Status(Status::DRACO_ERROR,
+                  "No encoder settings satisfy the autotune limits.");
+  }
+  out_buffer->Encode(best_candidate.buffer.data(),
+                     best_candidate.buffer.size());
+  out_result->settings = best_candidate.settings;
+  out_result->options =
+      CreateCandidateOptions(base_options, best_candidate.settings);
+  out_result->encoded_size = best_candidate.buffer.size();
+  out_result->decoding_time_ms = best_candidate.decoding_time_ms;
+  out_result->num_evaluated_candidates = static_cast<int>(candidates.size());
+  Reset(out_result->options);
+  return OkStatus();
+}
+
+}  // namespace draco
@@ -0,0 +1,109 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_COMPRESSION_EXPERT_ENCODE_AUTOTUNE_H_
+#define DRACO_COMPRESSION_EXPERT_ENCODE_AUTOTUNE_H_
+
+#include <map>
+#include <vector>
+
+#include "draco/attributes/geometry_attribute.h"
+#include "draco/compression/config/encoder_options.h"
+
+namespace draco {
+
+// Constraints of the search performed by ExpertEncoder::Autotune().
+struct AutotuneOptions {
+  AutotuneOptions()
+      : max_decoding_time_ms(0.0),
+        max_encoded_size(0),
+        tune_prediction_schemes(true),
+        num_decoding_iterations(3),
+        num_threads(0) {}
+
+  // Maximum absolute error of the decoded values of float attributes of a
+  // given type. For normals, the error is measured on the decoded unit
+  // vectors. Matching attributes are quantized with the smallest number of
+  // bits that satisfies the tolerance (or they are encoded losslessly when no
+  // quantization can satisfy it). Other attributes use the quantization set in
+  // the encoder options.
+  std::map<GeometryAttribute::Type, float> tolerances;
+
+  // Maximum time in milliseconds needed to decode the encoded geometry on the
+  // local machine. Not used when <= 0.
+  double max_decoding_time_ms;
+
+  // Maximum size of the encoded geometry in bytes. Not used when <= 0.
+  int64_t max_encoded_size;
+
+  // When set, alternative prediction schemes are tried for each attribute of
+  // the best configuration found by the initial search.
+  bool tune_prediction_schemes;
+
+  // Number of times each candidate is decoded. The fastest run is used as the
+  // decoding time of the candidate.
+  int num_decoding_iterations;
+
+  // Number of candidates evaluated in parallel. 0 = one per hardware thread.
+  // Note that decoding times of candidates evaluated in parallel may be
+  // affected by each other.
+  int num_threads;
+};
+
+// Settings of a single configuration tried by ExpertEncoder::Autotune().
+struct AutotuneSettings {
+  AutotuneSettings()
+      : encoding_method(-1),
+        edgebreaker_method(-1),
+        traversal_method(-1),
+        speed(5) {}
+
+  // One of the MeshEncoderMethod or PointCloudEncodingMethod values.
+  int encoding_method;
+  // MESH_EDGEBREAKER_STANDARD_ENCODING or MESH_EDGEBREAKER_VALENCE_ENCODING,
+  // -1 for other encoding methods.
+  int edgebreaker_method;
+  // MeshTraversalMethod used for the position attribute by the edgebreaker,
+  // -1 for other encoding methods.
+  int traversal_method;
+  // Encoding and decoding speed.
+  int speed;
+  // Quantization bits for each attribute id (-1 = no quantization).
+  std::vector<int> quantization_bits;
+  // Prediction scheme for each attribute id (PREDICTION_UNDEFINED = selected
+  // automatically by the encoder).
+  std::vector<int> prediction_schemes;
+};
+
+// Result of ExpertEncoder::Autotune().
+struct AutotuneResult {
+  AutotuneResult()
+      : options(EncoderOptions::CreateEmptyOptions()),
+        encoded_size(0),
+        decoding_time_ms(0.0),
+        num_evaluated_candidates(0) {}
+
+  // Selected settings.
+  AutotuneSettings settings;
+  // Encoder options corresponding to the selected |settings|.
+  EncoderOptions options;
+  int64_t encoded_size;
+  double decoding_time_ms;
+  // Number of configurations that were encoded and decoded during the search.
+  int num_evaluated_candidates;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_EXPERT_ENCODE_AUTOTUNE_H_
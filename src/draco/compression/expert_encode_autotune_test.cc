@@ -0,0 +1,111 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/expert_encode_autotune.h"
+
+#include "draco/compression/decode.h"
+#include "draco/compression/expert_encode.h"
+#include "draco/core/draco_test_base.h"
+#include "draco/core/draco_test_utils.h"
+
+namespace {
+
+class ExpertEncodeAutotuneTest : public ::testing::Test {
+ protected:
+  // Runs the autotune on |pc| and verifies that the returned stream can be
+  // decoded and that it is reproduced by the returned encoder options.
+  void TestAutotune(const draco::PointCloud &pc, draco::ExpertEncoder *encoder,
+                    const draco::AutotuneOptions &autotune_options,
+                    draco::AutotuneResult *result) {
+    draco::EncoderBuffer buffer;
+    ASSERT_TRUE(encoder->Autotune(autotune_options, &buffer, result).ok());
+    ASSERT_EQ(buffer.size(), result->encoded_size);
+    ASSERT_GT(result->num_evaluated_candidates, 1);
+
+    draco::DecoderBuffer dec_buffer;
+    dec_buffer.Init(buffer.data(), buffer.size());
+    draco::Decoder decoder;
+    auto status_or = decoder.DecodePointCloudFromBuffer(&dec_buffer);
+    ASSERT_TRUE(status_or.ok());
+    ASSERT_EQ(status_or.value()->num_attributes(), pc.num_attributes());
+
+    // The encoder is reset to the selected options.
+    draco::EncoderBuffer reencoded_buffer;
+    ASSERT_TRUE(encoder->EncodeToBuffer(&reencoded_buffer).ok());
+    ASSERT_EQ(reencoded_buffer.size(), buffer.size());
+    ASSERT_EQ(memcmp(reencoded_buffer.data(), buffer.data(), buffer.size()),
+              0);
+  }
+};
+
+TEST_F(ExpertEncodeAutotuneTest, TestMeshTolerance) {
+  std::unique_ptr<draco::Mesh> mesh(draco::ReadMeshFromTestFile("test_nm.obj"));
+  ASSERT_NE(mesh, nullptr);
+  const int pos_att_id =
+      mesh->GetNamedAttributeId(draco::GeometryAttribute::POSITION);
+
+  int prev_quantization_bits = 0;
+  for (float tolerance : {0.1f, 0.01f, 0.001f}) {
+    draco::ExpertEncoder encoder(*mesh);
+    draco::AutotuneOptions autotune_options;
+    autotune_options.tolerances[draco::GeometryAttribute::POSITION] =
+        tolerance;
+    autotune_options.num_decoding_iterations = 1;
+    draco::AutotuneResult result;
+    TestAutotune(*mesh, &encoder, autotune_options, &result);
+    const int quantization_bits =
+        result.settings.quantization_bits[pos_att_id];
+    // Smaller tolerance requires more quantization bits.
+    ASSERT_GT(quantization_bits, prev_quantization_bits);
+    prev_quantization_bits = quantization_bits;
+  }
+}
+
+TEST_F(ExpertEncodeAutotuneTest, TestPointCloud) {
+  std::unique_ptr<draco::PointCloud> pc(
+      draco::ReadPointCloudFromTestFile("point_cloud_test_pos_norm.ply"));
+  ASSERT_NE(pc, nullptr);
+  draco::ExpertEncoder encoder(*pc);
+  draco::AutotuneOptions autotune_options;
+  autotune_options.tolerances[draco::GeometryAttribute::POSITION] = 0.001f;
+  autotune_options.tolerances[draco::GeometryAttribute::NORMAL] = 0.01f;
+  autotune_options.num_decoding_iterations = 1;
+  draco::AutotuneResult result;
+  TestAutotune(*pc, &encoder, autotune_options, &result);
+  for (int bits : result.settings.quantization_bits) {
+    ASSERT_GT(bits, 0);
+  }
+}
+
+TEST_F(ExpertEncodeAutotuneTest, TestSizeBudget) {
+  std::unique_ptr<draco::Mesh> mesh(
+      draco::ReadMeshFromTestFile("cube_att.obj"));
+  ASSERT_NE(mesh, nullptr);
+  draco::ExpertEncoder encoder(*mesh);
+  draco::AutotuneOptions autotune_options;
+  autotune_options.tolerances[draco::GeometryAttribute::POSITION] = 0.01f;
+  autotune_options.num_decoding_iterations = 1;
+
+  // No stream can be this small.
+  autotune_options.max_encoded_size = 1;
+  draco::EncoderBuffer buffer;
+  draco::AutotuneResult result;
+  ASSERT_FALSE(encoder.Autotune(autotune_options, &buffer, &result).ok());
+
+  autotune_options.max_encoded_size = 1 << 20;
+  TestAutotune(*mesh, &encoder, autotune_options, &result);
+  ASSERT_LE(result.encoded_size, autotune_options.max_encoded_size);
+}
+
+}  // namespace
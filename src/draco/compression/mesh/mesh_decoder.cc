@@ -24,11 +24,21 @@ Status MeshDecoder::Decode(const DecoderOptions &options,
   return PointCloudDecoder::Decode(options, in_buffer, out_mesh);
 }
 
+void MeshDecoder::StartDecoding(const DecoderOptions &options,
+                                DecoderBuffer *in_buffer, Mesh *out_mesh) {
+  mesh_ = out_mesh;
+  PointCloudDecoder::StartDecoding(options, in_buffer, out_mesh);
+}
+
 bool MeshDecoder::DecodeGeometryData() {
   if (mesh_ == nullptr)
     return false;
-  if (!DecodeConnectivity())
+  const FaceIndex::ValueType num_faces = mesh_->num_faces();
+  if (!DecodeConnectivity()) {
+    // Remove any faces added by the failed decoder.
+    mesh_->SetNumFaces(num_faces);
     return false;
+  }
   return PointCloudDecoder::DecodeGeometryData();
 }
 
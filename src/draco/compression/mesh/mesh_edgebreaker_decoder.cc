@@ -13,13 +13,15 @@
 // limitations under the License.
 //
 #include "draco/compression/mesh/mesh_edgebreaker_decoder.h"
+
+#include "draco/compression/decoder_scratch.h"
 #include "draco/compression/mesh/mesh_edgebreaker_decoder_impl.h"
 #include "draco/compression/mesh/mesh_edgebreaker_traversal_predictive_decoder.h"
 #include "draco/compression/mesh/mesh_edgebreaker_traversal_valence_decoder.h"
 
 namespace draco {
 
-MeshEdgebreakerDecoder::MeshEdgebreakerDecoder() {}
+MeshEdgebreakerDecoder::MeshEdgebreakerDecoder() : impl_(nullptr) {}
 
 bool MeshEdgebreakerDecoder::CreateAttributesDecoder(int32_t att_decoder_id) {
   return impl_->CreateAttributesDecoder(att_decoder_id);
@@ -30,27 +32,41 @@ bool MeshEdgebreakerDecoder::InitializeDecoder() {
   if (!buffer()->Decode(&traversal_decoder_type))
     return false;
   impl_ = nullptr;
+  owned_impl_ = nullptr;
+  // Reuse the implementation stored in the scratch if possible.
+  if (scratch() != nullptr) {
+    impl_ = scratch()->GetEdgebreakerDecoderImpl(traversal_decoder_type);
+    if (impl_ != nullptr)
+      return impl_->Init(this);
+  }
   if (traversal_decoder_type == MESH_EDGEBREAKER_STANDARD_ENCODING) {
 #ifdef DRACO_STANDARD_EDGEBREAKER_SUPPORTED
-    impl_ = std::unique_ptr<MeshEdgebreakerDecoderImplInterface>(
+    owned_impl_ = std::unique_ptr<MeshEdgebreakerDecoderImplInterface>(
         new MeshEdgebreakerDecoderImpl<MeshEdgebreakerTraversalDecoder>());
 #endif
   } else if (traversal_decoder_type == MESH_EDGEBREAKER_PREDICTIVE_ENCODING) {
 #ifdef DRACO_BACKWARDS_COMPATIBILITY_SUPPORTED
 #ifdef DRACO_PREDICTIVE_EDGEBREAKER_SUPPORTED
-    impl_ = std::unique_ptr<MeshEdgebreakerDecoderImplInterface>(
+    owned_impl_ = std::unique_ptr<MeshEdgebreakerDecoderImplInterface>(
         new MeshEdgebreakerDecoderImpl<
             MeshEdgebreakerTraversalPredictiveDecoder>());
 #endif
 #endif
   } else if (traversal_decoder_type == MESH_EDGEBREAKER_VALENCE_ENCODING) {
-    impl_ = std::unique_ptr<MeshEdgebreakerDecoderImplInterface>(
+    owned_impl_ = std::unique_ptr<MeshEdgebreakerDecoderImplInterface>(
         new MeshEdgebreakerDecoderImpl<
             MeshEdgebreakerTraversalValenceDecoder>());
   }
-  if (!impl_) {
+  if (!owned_impl_) {
     return false;
   }
+  impl_ = owned_impl_.get();
+  if (scratch() != nullptr) {
+    // Move the implementation to the scratch so it can be reused by
+    // subsequent decoding calls.
+    scratch()->SetEdgebreakerDecoderImpl(traversal_decoder_type,
+                                         std::move(owned_impl_));
+  }
   if (!impl_->Init(this))
     return false;
   return true;
@@ -15,6 +15,8 @@
 #ifndef DRACO_COMPRESSION_MESH_MESH_EDGEBREAKER_DECODER_H_
 #define DRACO_COMPRESSION_MESH_MESH_EDGEBREAKER_DECODER_H_
 
+#include <memory>
+
 #include "draco/draco_features.h"
 
 #include "draco/compression/mesh/mesh_decoder.h"
@@ -47,7 +49,10 @@ class MeshEdgebreakerDecoder : public MeshDecoder {
   bool DecodeConnectivity() override;
   bool OnAttributesDecoded() override;
 
-  std::unique_ptr<MeshEdgebreakerDecoderImplInterface> impl_;
+  // Implementation used for decoding. Either owned by the decoder or by the
+  // DecoderScratch set on the decoder.
+  MeshEdgebreakerDecoderImplInterface *impl_;
+  std::unique_ptr<MeshEdgebreakerDecoderImplInterface> owned_impl_;
 };
 
 }  // namespace draco
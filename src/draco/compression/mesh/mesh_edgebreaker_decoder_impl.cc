@@ -17,6 +17,7 @@
 #include <algorithm>
 
 #include "draco/compression/attributes/sequential_attribute_decoders_controller.h"
+#include "draco/compression/decoder_scratch.h"
 #include "draco/compression/mesh/mesh_edgebreaker_decoder.h"
 #include "draco/compression/mesh/mesh_edgebreaker_traversal_predictive_decoder.h"
 #include "draco/compression/mesh/mesh_edgebreaker_traversal_valence_decoder.h"
@@ -25,10 +26,25 @@
 #include "draco/compression/mesh/traverser/mesh_attribute_indices_encoding_observer.h"
 #include "draco/compression/mesh/traverser/mesh_traversal_sequencer.h"
 #include "draco/compression/mesh/traverser/traverser_base.h"
+#include "draco/core/tracer.h"
 #include "draco/mesh/corner_table_iterators.h"
 
 namespace draco {
 
+namespace {
+
+// Returns the number of bytes reserved by |vec|.
+template <typename T>
+size_t VectorCapacityInBytes(const std::vector<T> &vec) {
+  return vec.capacity() * sizeof(T);
+}
+
+size_t VectorCapacityInBytes(const std::vector<bool> &vec) {
+  return vec.capacity() / 8;
+}
+
+}  // namespace
+
 // Types of "free" edges that are used during topology decoding.
 // A free edge is an edge that is connected to one face only.
 // All edge types are stored in the opposite_corner_id_ array, where each
@@ -50,15 +66,55 @@ MeshEdgebreakerDecoderImpl<TraversalDecoder>::MeshEdgebreakerDecoderImpl()
       last_face_id_(-1),
       num_new_vertices_(0),
       num_encoded_vertices_(0),
-      pos_data_decoder_id_(-1) {}
+      pos_data_decoder_id_(-1),
+      allocated_size_at_start_(0) {}
 
 template <class TraversalDecoder>
 bool MeshEdgebreakerDecoderImpl<TraversalDecoder>::Init(
     MeshEdgebreakerDecoder *decoder) {
   decoder_ = decoder;
+  // The implementation may be reused for decoding of multiple meshes.
+  pos_data_decoder_id_ = -1;
   return true;
 }
 
+template <class TraversalDecoder>
+size_t MeshEdgebreakerDecoderImpl<TraversalDecoder>::ComputeAllocatedSize()
+    const {
+  size_t size = 0;
+  if (corner_table_)
+    size += corner_table_->ComputeAllocatedSize();
+  size += VectorCapacityInBytes(corner_traversal_stack_);
+  size += VectorCapacityInBytes(vertex_traversal_length_);
+  size += VectorCapacityInBytes(topology_split_data_);
+  size += VectorCapacityInBytes(hole_event_data_);
+  size += VectorCapacityInBytes(init_face_configurations_);
+  size += VectorCapacityInBytes(init_corners_);
+  size += VectorCapacityInBytes(visited_faces_);
+  size += VectorCapacityInBytes(visited_verts_);
+  size += VectorCapacityInBytes(is_vert_hole_);
+  size += VectorCapacityInBytes(processed_corner_ids_);
+  size += VectorCapacityInBytes(processed_connectivity_corners_);
+  size += VectorCapacityInBytes(active_corner_stack_);
+  size += VectorCapacityInBytes(topology_split_active_corners_);
+  size += VectorCapacityInBytes(invalid_vertices_);
+  size += VectorCapacityInBytes(point_to_corner_map_);
+  size += VectorCapacityInBytes(corner_to_point_map_);
+  size += pos_encoding_data_.ComputeAllocatedSize();
+  size += VectorCapacityInBytes(attribute_data_);
+  size += VectorCapacityInBytes(unused_attribute_data_);
+  for (const std::vector<AttributeData> *const data_array :
+       {&attribute_data_, &unused_attribute_data_}) {
+    for (const AttributeData &data : *data_array) {
+      size += data.connectivity_data.ComputeAllocatedSize();
+      size += data.encoding_data.ComputeAllocatedSize();
+      size += VectorCapacityInBytes(data.attribute_seam_corners);
+    }
+  }
+  size += traversal_decoder_.ComputeAllocatedSize();
+  return size;
+}
+
 template <class TraversalDecoder>
 const MeshAttributeCornerTable *
 MeshEdgebreakerDecoderImpl<TraversalDecoder>::GetAttributeCornerTable(
@@ -136,14 +192,17 @@ bool MeshEdgebreakerDecoderImpl<TraversalDecoder>::CreateAttributesDecoder(
     }
 
     // Ensure that the attribute data is not mapped to a different attributes
-    // decoder already.
-    if (attribute_data_[att_data_id].decoder_id >= 0)
+    // decoder already. The same decoder can be created again when the
+    // decoding of attributes decoders is restarted (see
+    // PointCloudDecoder::DecodeNextStage()).
+    if (attribute_data_[att_data_id].decoder_id >= 0 &&
+        attribute_data_[att_data_id].decoder_id != att_decoder_id)
       return false;
 
     attribute_data_[att_data_id].decoder_id = att_decoder_id;
   } else {
     // Assign the attributes decoder to |pos_encoding_data_|.
-    if (pos_data_decoder_id_ >= 0)
+    if (pos_data_decoder_id_ >= 0 && pos_data_decoder_id_ != att_decoder_id)
       return false;  // Some other decoder is already using the data. Error.
     pos_data_decoder_id_ = att_decoder_id;
   }
@@ -325,11 +384,42 @@ bool MeshEdgebreakerDecoderImpl<TraversalDecoder>::DecodeConnectivity() {
     return false;  // Split symbols are a sub-set of all symbols.
   }
 
+  if (decoder_->scratch() != nullptr) {
+    // Remember the size of the allocated memory so that we can detect any
+    // allocations made during decoding (see OnAttributesDecoded()). None of
+    // the buffers is ever released so the size can only grow.
+    allocated_size_at_start_ = ComputeAllocatedSize();
+  }
+
+  // Add one attribute data for each attribute decoder. Attribute data that are
+  // not needed are kept in |unused_attribute_data_| so that their memory can be
+  // reused later.
+  while (attribute_data_.size() > num_attribute_data) {
+    unused_attribute_data_.push_back(std::move(attribute_data_.back()));
+    attribute_data_.pop_back();
+  }
+  while (attribute_data_.size() < num_attribute_data) {
+    if (unused_attribute_data_.empty()) {
+      attribute_data_.emplace_back();
+    } else {
+      attribute_data_.push_back(std::move(unused_attribute_data_.back()));
+      unused_attribute_data_.pop_back();
+    }
+  }
+  // Ensure all attribute data can be moved to |unused_attribute_data_| without
+  // any allocation.
+  unused_attribute_data_.reserve(attribute_data_.size() +
+                                 unused_attribute_data_.size());
+  for (AttributeData &data : attribute_data_) {
+    data.decoder_id = -1;
+    data.is_connectivity_used = true;
+    data.attribute_seam_corners.clear();
+  }
+
   // Decode topology (connectivity).
   vertex_traversal_length_.clear();
-  corner_table_ = std::unique_ptr<CornerTable>(new CornerTable());
   if (corner_table_ == nullptr)
-    return false;
+    corner_table_ = std::unique_ptr<CornerTable>(new CornerTable());
   processed_corner_ids_.clear();
   processed_corner_ids_.reserve(num_faces);
   processed_connectivity_corners_.clear();
@@ -343,10 +433,6 @@ bool MeshEdgebreakerDecoderImpl<TraversalDecoder>::DecodeConnectivity() {
   last_face_id_ = -1;
   last_vert_id_ = -1;
 
-  attribute_data_.clear();
-  // Add one attribute data for each attribute decoder.
-  attribute_data_.resize(num_attribute_data);
-
   if (!corner_table_->Reset(num_faces,
                             num_encoded_vertices_ + num_encoded_split_symbols))
     return false;
@@ -386,6 +472,8 @@ bool MeshEdgebreakerDecoderImpl<TraversalDecoder>::DecodeConnectivity() {
   } else
 #endif
   {
+    TraceScope trace(decoder_->tracer(), "DecodeTopologySplitEvents",
+                     decoder_->buffer());
     if (DecodeHoleAndTopologySplitEvents(decoder_->buffer()) == -1)
       return false;
   }
@@ -397,17 +485,28 @@ bool MeshEdgebreakerDecoderImpl<TraversalDecoder>::DecodeConnectivity() {
   traversal_decoder_.SetNumAttributeData(num_attribute_data);
 
   DecoderBuffer traversal_end_buffer;
-  if (!traversal_decoder_.Start(&traversal_end_buffer))
-    return false;
+  {
+    TraceScope trace(decoder_->tracer(), "StartTraversalDecoding");
+    if (!traversal_decoder_.Start(&traversal_end_buffer))
+      return false;
+    // Report the size of all traversal data.
+    trace.set_num_bytes(traversal_end_buffer.data_head() -
+                        decoder_->buffer()->data_head());
+  }
 
-  const int num_connectivity_verts = DecodeConnectivity(num_encoded_symbols);
-  if (num_connectivity_verts == -1)
-    return false;
+  int num_connectivity_verts;
+  {
+    TraceScope trace(decoder_->tracer(), "DecodeEdgebreakerConnectivity");
+    num_connectivity_verts = DecodeConnectivity(num_encoded_symbols);
+    if (num_connectivity_verts == -1)
+      return false;
+  }
 
-  // Set the main buffer to the end of the traversal.
-  decoder_->buffer()->Init(traversal_end_buffer.data_head(),
-                           traversal_end_buffer.remaining_size(),
-                           decoder_->buffer()->bitstream_version());
+  // Move the main buffer to the end of the traversal. The buffer is advanced
+  // rather than re-initialized so that its decoded size keeps counting from
+  // the start of the input data.
+  decoder_->buffer()->Advance(traversal_end_buffer.data_head() -
+                              decoder_->buffer()->data_head());
 
 #ifdef DRACO_BACKWARDS_COMPATIBILITY_SUPPORTED
   if (decoder_->bitstream_version() < DRACO_BITSTREAM_VERSION(2, 2)) {
@@ -417,27 +516,31 @@ bool MeshEdgebreakerDecoderImpl<TraversalDecoder>::DecodeConnectivity() {
 #endif
 
   // Decode connectivity of non-position attributes.
-  if (attribute_data_.size() > 0) {
+  {
+    TraceScope trace(decoder_->tracer(), "DecodeAttributeSeams");
+    if (attribute_data_.size() > 0) {
 #ifdef DRACO_BACKWARDS_COMPATIBILITY_SUPPORTED
-    if (decoder_->bitstream_version() < DRACO_BITSTREAM_VERSION(2, 1)) {
-      for (CornerIndex ci(0); ci < corner_table_->num_corners(); ci += 3) {
-        if (!DecodeAttributeConnectivitiesOnFaceLegacy(ci))
-          return false;
-      }
+      if (decoder_->bitstream_version() < DRACO_BITSTREAM_VERSION(2, 1)) {
+        for (CornerIndex ci(0); ci < corner_table_->num_corners(); ci += 3) {
+          if (!DecodeAttributeConnectivitiesOnFaceLegacy(ci))
+            return false;
+        }
 
-    } else
+      } else
 #endif
-    {
-      for (CornerIndex ci(0); ci < corner_table_->num_corners(); ci += 3) {
-        if (!DecodeAttributeConnectivitiesOnFace(ci))
-          return false;
+      {
+        for (CornerIndex ci(0); ci < corner_table_->num_corners(); ci += 3) {
+          if (!DecodeAttributeConnectivitiesOnFace(ci))
+            return false;
+        }
       }
     }
+    traversal_decoder_.Done();
   }
-  traversal_decoder_.Done();
 
   // Decode attribute connectivity.
   // Prepare data structure for decoding non-position attribute connectivity.
+  TraceScope trace(decoder_->tracer(), "AssignPointsToCorners");
   for (uint32_t i = 0; i < attribute_data_.size(); ++i) {
     attribute_data_[i].connectivity_data.InitEmpty(corner_table_.get());
     // Add all seams.
@@ -467,6 +570,10 @@ bool MeshEdgebreakerDecoderImpl<TraversalDecoder>::DecodeConnectivity() {
 
 template <class TraversalDecoder>
 bool MeshEdgebreakerDecoderImpl<TraversalDecoder>::OnAttributesDecoded() {
+  DecoderScratch *const scratch = decoder_->scratch();
+  if (scratch != nullptr) {
+    scratch->RecordDecode(ComputeAllocatedSize() != allocated_size_at_start_);
+  }
   return true;
 }
 
@@ -483,17 +590,22 @@ int MeshEdgebreakerDecoderImpl<TraversalDecoder>::DecodeConnectivity(
   // decoder always processes only the latest active edge. TOPOLOGY_S then
   // removes the top edge from the stack and TOPOLOGY_E adds a new edge to the
   // stack.
-  std::vector<CornerIndex> active_corner_stack;
+  std::vector<CornerIndex> &active_corner_stack = active_corner_stack_;
+  active_corner_stack.clear();
 
   // Additional active edges may be added as a result of topology split events.
   // They can be added in arbitrary order, but we always know the split symbol
   // id they belong to, so we can address them using this symbol id.
-  std::unordered_map<int, CornerIndex> topology_split_active_corners;
+  std::vector<CornerIndex> &topology_split_active_corners =
+      topology_split_active_corners_;
+  topology_split_active_corners.assign(
+      topology_split_data_.empty() ? 0 : num_symbols, kInvalidCornerIndex);
 
   // Vector used for storing vertices that were marked as isolated during the
   // decoding process. Currently used only when the mesh doesn't contain any
   // non-position connectivity data.
-  std::vector<VertexIndex> invalid_vertices;
+  std::vector<VertexIndex> &invalid_vertices = invalid_vertices_;
+  invalid_vertices.clear();
   const bool remove_invalid_vertices = attribute_data_.empty();
 
   int max_num_vertices = static_cast<int>(is_vert_hole_.size());
@@ -621,10 +733,10 @@ int MeshEdgebreakerDecoderImpl<TraversalDecoder>::DecodeConnectivity(
 
       // Corner "a" can correspond either to a normal active edge, or to an edge
       // created from the topology split event.
-      const auto it = topology_split_active_corners.find(symbol_id);
-      if (it != topology_split_active_corners.end()) {
+      if (symbol_id < static_cast<int>(topology_split_active_corners.size()) &&
+          topology_split_active_corners[symbol_id] != kInvalidCornerIndex) {
         // Topology split event. Move the retrieved edge to the stack.
-        active_corner_stack.push_back(it->second);
+        active_corner_stack.push_back(topology_split_active_corners[symbol_id]);
       }
       if (active_corner_stack.empty())
         return -1;
@@ -737,6 +849,8 @@ int MeshEdgebreakerDecoderImpl<TraversalDecoder>::DecodeConnectivity(
         // Convert the encoder split symbol id to decoder symbol id.
         const int decoder_split_symbol_id =
             num_symbols - encoder_split_symbol_id - 1;
+        if (decoder_split_symbol_id < 0)
+          continue;  // The split symbol can never be reached.
         topology_split_active_corners[decoder_split_symbol_id] =
             new_active_corner;
       }
@@ -1050,9 +1164,11 @@ bool MeshEdgebreakerDecoderImpl<TraversalDecoder>::AssignPointsToCorners(
   // Map between point id and an associated corner id. Only one corner for
   // each point is stored. The corners are used to sample the attribute values
   // in the last stage of the deduplication.
-  std::vector<int32_t> point_to_corner_map;
+  std::vector<int32_t> &point_to_corner_map = point_to_corner_map_;
+  point_to_corner_map.clear();
   // Map between every corner and their new point ids.
-  std::vector<int32_t> corner_to_point_map(corner_table_->num_corners());
+  std::vector<int32_t> &corner_to_point_map = corner_to_point_map_;
+  corner_to_point_map.assign(corner_table_->num_corners(), 0);
   for (int v = 0; v < corner_table_->num_vertices(); ++v) {
     CornerIndex c = corner_table_->LeftMostCorner(VertexIndex(v));
     if (c == kInvalidCornerIndex)
@@ -67,6 +67,7 @@ class MeshEdgebreakerDecoderImpl : public MeshEdgebreakerDecoderImplInterface {
   const CornerTable *GetCornerTable() const override {
     return corner_table_.get();
   }
+  size_t ComputeAllocatedSize() const override;
 
  private:
   // Creates a vertex traversal sequencer for the specified |TraverserT| type.
@@ -198,6 +199,25 @@ class MeshEdgebreakerDecoderImpl : public MeshEdgebreakerDecoderImplInterface {
   // face).
   std::vector<int> processed_connectivity_corners_;
 
+  // Temporary data used by the connectivity decoder. Stored as member
+  // variables so that the memory can be reused when the decoder is used to
+  // decode multiple meshes (see DecoderScratch).
+
+  // Stack of active corners (see DecodeConnectivity(int)).
+  std::vector<CornerIndex> active_corner_stack_;
+  // Active corners of split symbols that are used by the TOPOLOGY_S symbol.
+  // Indexed by the decoder split symbol id.
+  std::vector<CornerIndex> topology_split_active_corners_;
+  // Vertices that were created by split symbols and later merged.
+  std::vector<VertexIndex> invalid_vertices_;
+  // Maps used for deduplication of points in AssignPointsToCorners().
+  std::vector<int32_t> point_to_corner_map_;
+  std::vector<int32_t> corner_to_point_map_;
+
+  // Size of the allocated memory at the start of the decoding. Used only when
+  // the decoder is reused via DecoderScratch to detect new allocations.
+  size_t allocated_size_at_start_;
+
   MeshAttributeIndicesEncodingData pos_encoding_data_;
 
   // Id of an attributes decoder that uses |pos_encoding_data_|.
@@ -217,6 +237,8 @@ class MeshEdgebreakerDecoderImpl : public MeshEdgebreakerDecoderImplInterface {
     std::vector<int32_t> attribute_seam_corners;
   };
   std::vector<AttributeData> attribute_data_;
+  // Attribute data that were used by previously decoded meshes.
+  std::vector<AttributeData> unused_attribute_data_;
 
   TraversalDecoderT traversal_decoder_;
 };
@@ -40,6 +40,11 @@ class MeshEdgebreakerDecoderImplInterface {
 
   virtual MeshEdgebreakerDecoder *GetDecoder() const = 0;
   virtual const CornerTable *GetCornerTable() const = 0;
+
+  // Returns the number of bytes reserved by the internal buffers of the
+  // decoder. The buffers are reused when the same implementation is used to
+  // decode multiple meshes (see DecoderScratch).
+  virtual size_t ComputeAllocatedSize() const = 0;
 };
 
 }  // namespace draco
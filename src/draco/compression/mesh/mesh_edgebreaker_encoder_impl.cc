@@ -152,15 +152,27 @@ bool MeshEdgebreakerEncoderImpl<TraversalEncoder>::GenerateAttributesEncoder(
       // Ensure we use the correct number of vertices in the encoding data.
       encoding_data->vertex_to_encoded_attribute_value_index_map.assign(
           corner_table_->num_vertices(), -1);
+      encoding_data->encoded_attribute_value_index_to_corner_map.reserve(
+          corner_table_->num_vertices());
 
       // Mark the attribute specific connectivity data as not used as we use the
       // position attribute connectivity data.
       attribute_data_[att_data_id].is_connectivity_used = false;
     }
 
-    if (GetEncoder()->options()->GetSpeed() == 0 &&
-        att->attribute_type() == GeometryAttribute::POSITION) {
-      traversal_method = MESH_TRAVERSAL_PREDICTION_DEGREE;
+    if (att->attribute_type() == GeometryAttribute::POSITION) {
+      // The traversal can be selected explicitly. By default, the prediction
+      // degree traversal is used only for the slowest speed.
+      const int selected_traversal_method =
+          GetEncoder()->options()->GetGlobalInt("edgebreaker_traversal_method",
+                                                -1);
+      if (selected_traversal_method == MESH_TRAVERSAL_DEPTH_FIRST ||
+          selected_traversal_method == MESH_TRAVERSAL_PREDICTION_DEGREE) {
+        traversal_method =
+            static_cast<MeshTraversalMethod>(selected_traversal_method);
+      } else if (GetEncoder()->options()->GetSpeed() == 0) {
+        traversal_method = MESH_TRAVERSAL_PREDICTION_DEGREE;
+      }
       if (use_single_connectivity_ && mesh_->num_attributes() > 1) {
         // Make sure we don't use the prediction degree traversal when we encode
         // multiple attributes using the same connectivity.
@@ -189,13 +201,18 @@ bool MeshEdgebreakerEncoderImpl<TraversalEncoder>::GenerateAttributesEncoder(
 
     MeshAttributeIndicesEncodingData *const encoding_data =
         &attribute_data_[att_data_id].encoding_data;
-    const MeshAttributeCornerTable *const corner_table =
+    MeshAttributeCornerTable *const corner_table =
         &attribute_data_[att_data_id].connectivity_data;
 
+    // Only the seam edges were computed in InitAttributeData(). Compute the
+    // attribute vertices now that we know the attribute connectivity is used.
+    corner_table->RecomputeVertices(mesh_, att);
+
     // Ensure we use the correct number of vertices in the encoding data.
-    attribute_data_[att_data_id]
-        .encoding_data.vertex_to_encoded_attribute_value_index_map.assign(
-            attribute_data_[att_data_id].connectivity_data.num_vertices(), -1);
+    encoding_data->vertex_to_encoded_attribute_value_index_map.assign(
+        corner_table->num_vertices(), -1);
+    encoding_data->encoded_attribute_value_index_to_corner_map.reserve(
+        corner_table->num_vertices());
 
     std::unique_ptr<MeshTraversalSequencer<AttTraverser>> traversal_sequencer(
         new MeshTraversalSequencer<AttTraverser>(mesh_, encoding_data));
@@ -303,7 +320,7 @@ Status MeshEdgebreakerEncoderImpl<TraversalEncoder>::EncodeConnectivity() {
       corner_table_->num_vertices(), -1);
   pos_encoding_data_.encoded_attribute_value_index_to_corner_map.clear();
   pos_encoding_data_.encoded_attribute_value_index_to_corner_map.reserve(
-      corner_table_->num_faces() * 3);
+      corner_table_->num_vertices());
   visited_vertex_ids_.assign(corner_table_->num_vertices(), false);
   vertex_traversal_length_.clear();
   last_encoded_symbol_id_ = -1;
@@ -421,9 +438,24 @@ Status MeshEdgebreakerEncoderImpl<TraversalEncoder>::EncodeConnectivity() {
   encoder_->buffer()->Encode(traversal_encoder_.buffer().data(),
                              traversal_encoder_.buffer().size());
 
+  ReleaseConnectivityEncodingData();
   return OkStatus();
 }
 
+template <class TraversalEncoder>
+void MeshEdgebreakerEncoderImpl<
+    TraversalEncoder>::ReleaseConnectivityEncodingData() {
+  std::vector<CornerIndex>().swap(corner_traversal_stack_);
+  std::vector<bool>().swap(visited_faces_);
+  std::vector<bool>().swap(visited_vertex_ids_);
+  std::vector<int>().swap(vertex_traversal_length_);
+  std::vector<TopologySplitEventData>().swap(topology_split_event_data_);
+  std::unordered_map<int, int>().swap(face_to_split_symbol_map_);
+  std::vector<bool>().swap(visited_holes_);
+  std::vector<int>().swap(vertex_hole_id_);
+  traversal_encoder_ = TraversalEncoder();
+}
+
 template <class TraversalEncoder>
 bool MeshEdgebreakerEncoderImpl<TraversalEncoder>::EncodeSplitData() {
   uint32_t num_events =
@@ -775,11 +807,10 @@ bool MeshEdgebreakerEncoderImpl<TraversalEncoder>::InitAttributeData() {
     attribute_data_[data_index].attribute_index = att_index;
     attribute_data_[data_index]
         .encoding_data.encoded_attribute_value_index_to_corner_map.clear();
-    attribute_data_[data_index]
-        .encoding_data.encoded_attribute_value_index_to_corner_map.reserve(
-            corner_table_->num_corners());
     attribute_data_[data_index].encoding_data.num_values = 0;
-    attribute_data_[data_index].connectivity_data.InitFromAttribute(
+    // The attribute vertices are computed later in GenerateAttributesEncoder()
+    // and only when the attribute connectivity is actually used.
+    attribute_data_[data_index].connectivity_data.InitSeamsFromAttribute(
         mesh_, corner_table_.get(), att);
     ++data_index;
   }
@@ -86,6 +86,11 @@ class MeshEdgebreakerEncoderImpl : public MeshEdgebreakerEncoderImplInterface {
   // Returns nullptr on error.
   bool EncodeSplitData();
 
+  // Releases all data that is needed only while the connectivity is being
+  // encoded (visited flags, holes, split events and the traversal encoder).
+  // The data needed by the attribute encoders is kept.
+  void ReleaseConnectivityEncodingData();
+
   CornerIndex GetRightCorner(CornerIndex corner_id) const;
   CornerIndex GetLeftCorner(CornerIndex corner_id) const;
 
@@ -48,8 +48,10 @@ class MeshEdgebreakerTraversalPredictiveDecoder
       return false;
     if (num_split_symbols >= num_vertices_)
       return false;
+    last_symbol_ = -1;
+    predicted_symbol_ = -1;
     // Set the valences of all initial vertices to 0.
-    vertex_valences_.resize(num_vertices_, 0);
+    vertex_valences_.assign(num_vertices_, 0);
     if (!prediction_decoder_.StartDecoding(out_buffer))
       return false;
     return true;
@@ -112,6 +114,11 @@ class MeshEdgebreakerTraversalPredictiveDecoder
     }
   }
 
+  size_t ComputeAllocatedSize() const {
+    return MeshEdgebreakerTraversalDecoder::ComputeAllocatedSize() +
+           vertex_valences_.capacity() * sizeof(int);
+  }
+
   inline void MergeVertices(VertexIndex dest, VertexIndex source) {
     // Update valences on the merged vertices.
     vertex_valences_[dest.value()] += vertex_valences_[source.value()];
@@ -89,14 +89,16 @@ class MeshEdgebreakerTraversalValenceDecoder
 
     if (num_vertices_ < 0)
       return false;
+    last_symbol_ = -1;
+    active_context_ = -1;
     // Set the valences of all initial vertices to 0.
-    vertex_valences_.resize(num_vertices_, 0);
+    vertex_valences_.assign(num_vertices_, 0);
 
     const int num_unique_valences = max_valence_ - min_valence_ + 1;
 
     // Decode all symbols for all contexts.
     context_symbols_.resize(num_unique_valences);
-    context_counters_.resize(context_symbols_.size());
+    context_counters_.assign(context_symbols_.size(), 0);
     for (int i = 0; i < context_symbols_.size(); ++i) {
       uint32_t num_symbols;
       DecodeVarint<uint32_t>(&num_symbols, out_buffer);
@@ -178,6 +180,16 @@ class MeshEdgebreakerTraversalValenceDecoder
     active_context_ = (clamped_valence - min_valence_);
   }
 
+  size_t ComputeAllocatedSize() const {
+    size_t size = MeshEdgebreakerTraversalDecoder::ComputeAllocatedSize() +
+                  vertex_valences_.capacity() * sizeof(int) +
+                  context_counters_.capacity() * sizeof(int);
+    for (const auto &symbols : context_symbols_) {
+      size += symbols.capacity() * sizeof(uint32_t);
+    }
+    return size;
+  }
+
   inline void MergeVertices(VertexIndex dest, VertexIndex source) {
     // Update valences on the merged vertices.
     vertex_valences_[dest] += vertex_valences_[source];
@@ -15,6 +15,8 @@
 #ifndef DRACO_COMPRESSION_MESH_MESH_EDGEBREAKER_TRAVERSAL_VALENCE_ENCODER_H_
 #define DRACO_COMPRESSION_MESH_MESH_EDGEBREAKER_TRAVERSAL_VALENCE_ENCODER_H_
 
+#include <unordered_map>
+
 #include "draco/compression/entropy/symbol_encoding.h"
 #include "draco/compression/mesh/mesh_edgebreaker_traversal_encoder.h"
 #include "draco/core/varint_encoding.h"
@@ -56,13 +58,12 @@ class MeshEdgebreakerTraversalValenceEncoder
       vertex_valences_[i] = corner_table_->Valence(VertexIndex(i));
     }
 
-    // Replicate the corner to vertex map from the corner table. We need to do
-    // this because the map may get updated during encoding because we add new
-    // vertices when we encounter split symbols.
-    corner_to_vertex_map_.resize(corner_table_->num_corners());
-    for (CornerIndex i(0); i < corner_table_->num_corners(); ++i) {
-      corner_to_vertex_map_[i] = corner_table_->Vertex(i);
-    }
+    // The corner to vertex map of the corner table may get updated during
+    // encoding because we add new vertices when we encounter split symbols.
+    // Instead of replicating the whole map, only the updated corners are
+    // tracked.
+    is_corner_remapped_.assign(corner_table_->num_corners(), false);
+    remapped_corner_vertices_.clear();
     const int32_t num_unique_valences = max_valence_ - min_valence_ + 1;
 
     context_symbols_.resize(num_unique_valences);
@@ -85,15 +86,15 @@ class MeshEdgebreakerTraversalValenceEncoder
     // Get valence on the tip corner of the active edge (outgoing edge that is
     // going to be used in reverse decoding of the connectivity to predict the
     // next symbol).
-    const int active_valence = vertex_valences_[corner_to_vertex_map_[next]];
+    const int active_valence = vertex_valences_[CornerToVertex(next)];
     switch (symbol) {
       case TOPOLOGY_C:
         // Compute prediction.
         FALLTHROUGH_INTENDED;
       case TOPOLOGY_S:
         // Update valences.
-        vertex_valences_[corner_to_vertex_map_[next]] -= 1;
-        vertex_valences_[corner_to_vertex_map_[prev]] -= 1;
+        vertex_valences_[CornerToVertex(next)] -= 1;
+        vertex_valences_[CornerToVertex(prev)] -= 1;
         if (symbol == TOPOLOGY_S) {
           // Whenever we reach a split symbol, we need to split the vertex into
           // two and attach all corners on the left and right sides of the split
@@ -122,8 +123,7 @@ class MeshEdgebreakerTraversalValenceEncoder
             ++num_left_faces;
             act_c = corner_table_->Opposite(corner_table_->Next(act_c));
           }
-          vertex_valences_[corner_to_vertex_map_[last_corner_]] =
-              num_left_faces + 1;
+          vertex_valences_[CornerToVertex(last_corner_)] = num_left_faces + 1;
 
           // Create a new vertex for the right side and count the number of
           // faces that should be attached to this vertex.
@@ -136,7 +136,10 @@ class MeshEdgebreakerTraversalValenceEncoder
               break;  // Stop when we reach the first visited face.
             ++num_right_faces;
             // Map corners on the right side to the newly created vertex.
-            corner_to_vertex_map_[corner_table_->Next(act_c)] = new_vert_id;
+            const CornerIndex remapped_c = corner_table_->Next(act_c);
+            is_corner_remapped_[remapped_c.value()] = true;
+            remapped_corner_vertices_[remapped_c.value()] =
+                VertexIndex(new_vert_id);
             act_c = corner_table_->Opposite(corner_table_->Previous(act_c));
           }
           vertex_valences_.push_back(num_right_faces + 1);
@@ -144,20 +147,20 @@ class MeshEdgebreakerTraversalValenceEncoder
         break;
       case TOPOLOGY_R:
         // Update valences.
-        vertex_valences_[corner_to_vertex_map_[last_corner_]] -= 1;
-        vertex_valences_[corner_to_vertex_map_[next]] -= 1;
-        vertex_valences_[corner_to_vertex_map_[prev]] -= 2;
+        vertex_valences_[CornerToVertex(last_corner_)] -= 1;
+        vertex_valences_[CornerToVertex(next)] -= 1;
+        vertex_valences_[CornerToVertex(prev)] -= 2;
         break;
       case TOPOLOGY_L:
 
-        vertex_valences_[corner_to_vertex_map_[last_corner_]] -= 1;
-        vertex_valences_[corner_to_vertex_map_[next]] -= 2;
-        vertex_valences_[corner_to_vertex_map_[prev]] -= 1;
+        vertex_valences_[CornerToVertex(last_corner_)] -= 1;
+        vertex_valences_[CornerToVertex(next)] -= 2;
+        vertex_valences_[CornerToVertex(prev)] -= 1;
         break;
       case TOPOLOGY_E:
-        vertex_valences_[corner_to_vertex_map_[last_corner_]] -= 2;
-        vertex_valences_[corner_to_vertex_map_[next]] -= 2;
-        vertex_valences_[corner_to_vertex_map_[prev]] -= 2;
+        vertex_valences_[CornerToVertex(last_corner_)] -= 2;
+        vertex_valences_[CornerToVertex(next)] -= 2;
+        vertex_valences_[CornerToVertex(prev)] -= 2;
         break;
       default:
         break;
@@ -201,11 +204,21 @@ class MeshEdgebreakerTraversalValenceEncoder
   int NumEncodedSymbols() const { return num_symbols_; }
 
  private:
+  // Returns the vertex of corner |c| including the vertices that were added
+  // for the already encoded split symbols.
+  inline VertexIndex CornerToVertex(CornerIndex c) const {
+    if (!is_corner_remapped_[c.value()])
+      return corner_table_->Vertex(c);
+    return remapped_corner_vertices_.find(c.value())->second;
+  }
+
   const CornerTable *corner_table_;
-  // Explicit map between corners and vertices. We cannot use the one stored
-  // in the |corner_table_| because we may need to add additional vertices to
-  // handle split symbols.
-  IndexTypeVector<CornerIndex, VertexIndex> corner_to_vertex_map_;
+  // Corners whose vertex differs from the vertex stored in the
+  // |corner_table_|. We cannot modify the |corner_table_| but we may need to
+  // add additional vertices to handle split symbols. Split symbols are rare so
+  // the new vertices are stored only for the affected corners.
+  std::vector<bool> is_corner_remapped_;
+  std::unordered_map<int, VertexIndex> remapped_corner_vertices_;
   IndexTypeVector<VertexIndex, int> vertex_valences_;
   // Previously encoded symbol.
   int32_t prev_symbol_;
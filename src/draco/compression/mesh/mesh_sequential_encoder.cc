@@ -115,8 +115,11 @@ bool MeshSequentialEncoder::CompressAndEncodeIndices() {
       last_index_value = index_value;
     }
   }
+  Options symbol_encoding_options;
+  SetSymbolEncodingInterleaved(&symbol_encoding_options,
+                               UseInterleavedSymbolCoding());
   EncodeSymbols(indices_buffer.data(), static_cast<int>(indices_buffer.size()),
-                1, nullptr, buffer());
+                1, &symbol_encoding_options, buffer());
   return true;
 }
 
@@ -17,9 +17,11 @@
 #ifndef DRACO_COMPRESSION_POINT_CLOUD_ALGORITHMS_DYNAMIC_INTEGER_POINTS_KD_TREE_DECODER_H_
 #define DRACO_COMPRESSION_POINT_CLOUD_ALGORITHMS_DYNAMIC_INTEGER_POINTS_KD_TREE_DECODER_H_
 
+#include <algorithm>
 #include <array>
 #include <memory>
-#include <stack>
+#include <type_traits>
+#include <vector>
 
 #include "draco/compression/bit_coders/adaptive_rans_bit_decoder.h"
 #include "draco/compression/bit_coders/direct_bit_decoder.h"
@@ -29,6 +31,8 @@
 #include "draco/core/bit_utils.h"
 #include "draco/core/decoder_buffer.h"
 #include "draco/core/math_utils.h"
+#include "draco/core/thread_pool.h"
+#include "draco/core/varint_decoding.h"
 
 namespace draco {
 
@@ -65,6 +69,18 @@ struct DynamicIntegerPointsKdTreeDecoderCompressionPolicy<6>
 };
 
 // Decodes a point cloud encoded by DynamicIntegerPointsKdTreeEncoder.
+//
+// Decoded points are passed to the output iterator as a pointer to
+// |dimension| uint32_t coordinates when the iterator supports
+// "*oit = static_cast<const uint32_t *>(point)". The pointer is valid only
+// during the assignment. Other iterators get the points as
+// std::vector<uint32_t>, i.e., they must support
+// "*oit = std::vector<uint32_t>(point, point + dimension)". This is slower
+// because each point is copied to the vector first.
+//
+// The tree is traversed depth-first using flat stacks that are allocated once
+// per decoded stream and sized by the maximum depth of the tree, so no memory
+// is allocated while the points are decoded.
 template <int compression_level_t>
 class DynamicIntegerPointsKdTreeDecoder {
   static_assert(compression_level_t >= 0, "Compression level must in [0..6].");
@@ -84,13 +100,12 @@ class DynamicIntegerPointsKdTreeDecoder {
       : bit_length_(0),
         num_points_(0),
         num_decoded_points_(0),
+        num_output_points_(0),
+        subtree_depth_(0),
+        thread_pool_(nullptr),
         dimension_(dimension),
         p_(dimension, 0),
-        axes_(dimension, 0),
-        // Init the stack with the maximum depth of the tree.
-        // +1 for a second leaf.
-        base_stack_(32 * dimension + 1, VectorUint32(dimension, 0)),
-        levels_stack_(32 * dimension + 1, VectorUint32(dimension, 0)) {}
+        axes_(dimension, 0) {}
 
   // Decodes a integer point cloud from |buffer|.
   template <class OutputIteratorT>
@@ -103,32 +118,191 @@ class DynamicIntegerPointsKdTreeDecoder {
 
   const uint32_t dimension() const { return dimension_; }
 
+  // Sets the depth of the tree at which the subtrees were encoded into
+  // independent streams. Must match the depth used by the encoder.
+  void set_subtree_depth(uint32_t depth) { subtree_depth_ = depth; }
+  uint32_t subtree_depth() const { return subtree_depth_; }
+
+  // Sets a thread pool that is used to decode the subtrees in parallel.
+  void set_thread_pool(ThreadPool *pool) { thread_pool_ = pool; }
+
+  // Restricts the decoded points to the box given by |box_min| and |box_max|
+  // (inclusive). Subtrees stored in independent streams that don't intersect
+  // the box are skipped without decoding. All other points are decoded but
+  // only the points inside the box are output.
+  void set_query_box(const VectorUint32 &box_min,
+                     const VectorUint32 &box_max) {
+    query_box_min_ = box_min;
+    query_box_max_ = box_max;
+  }
+
+  // Moves |buffer| past the encoded points. Only the top of the tree needs to
+  // be decoded when the data contains subtree streams.
+  bool SkipPoints(DecoderBuffer *buffer);
+
+  // Returns the number of points that were output by the last DecodePoints()
+  // call.
+  uint32_t num_output_points() const { return num_output_points_; }
+
  private:
-  uint32_t GetAxis(uint32_t num_remaining_points, const VectorUint32 &levels,
+  // Subtree rooted at |subtree_depth_| that is stored in its own streams.
+  struct Subtree {
+    uint32_t num_points;
+    uint32_t last_axis;
+    VectorUint32 base;
+    VectorUint32 levels;
+  };
+
+  // Output iterator that ignores all points.
+  class DiscardOutputIterator {
+   public:
+    DiscardOutputIterator &operator*() { return *this; }
+    DiscardOutputIterator &operator++() { return *this; }
+    DiscardOutputIterator &operator=(const uint32_t *) { return *this; }
+  };
+
+  // Output iterator that appends the decoded points to a flat array.
+  class PointsBufferOutputIterator {
+   public:
+    PointsBufferOutputIterator(std::vector<uint32_t> *points,
+                               uint32_t dimension)
+        : points_(points), dimension_(dimension) {}
+    PointsBufferOutputIterator &operator*() { return *this; }
+    PointsBufferOutputIterator &operator++() { return *this; }
+    PointsBufferOutputIterator &operator=(const uint32_t *point) {
+      points_->insert(points_->end(), point, point + dimension_);
+      return *this;
+    }
+
+   private:
+    std::vector<uint32_t> *points_;
+    uint32_t dimension_;
+  };
+
+  uint32_t GetAxis(uint32_t num_remaining_points, const uint32_t *levels,
                    uint32_t last_axis);
 
+  bool HasQueryBox() const { return !query_box_min_.empty(); }
+
+  bool IsInQueryBox(const uint32_t *point) const {
+    for (uint32_t i = 0; i < dimension_; ++i) {
+      if (point[i] < query_box_min_[i] || point[i] > query_box_max_[i])
+        return false;
+    }
+    return true;
+  }
+
+  // Outputs |point| if it is inside the query box.
+  template <class OutputIteratorT>
+  void OutputPoint(const uint32_t *point, OutputIteratorT &oit) {
+    ++num_decoded_points_;
+    if (HasQueryBox() && !IsInQueryBox(point))
+      return;
+    AssignPoint(point, oit);
+    ++oit;
+    ++num_output_points_;
+  }
+
+  // Passes |point| to the output iterator as a pointer or as a vector when the
+  // iterator does not accept pointers.
   template <class OutputIteratorT>
-  bool DecodeInternal(uint32_t num_points, OutputIteratorT &oit);
+  void AssignPoint(const uint32_t *point, OutputIteratorT &oit) {
+    AssignPoint(point, oit,
+                std::is_assignable<decltype(*oit), const uint32_t *>());
+  }
+  template <class OutputIteratorT>
+  void AssignPoint(const uint32_t *point, OutputIteratorT &oit,
+                   std::true_type) {
+    *oit = point;
+  }
+  template <class OutputIteratorT>
+  void AssignPoint(const uint32_t *point, OutputIteratorT &oit,
+                   std::false_type) {
+    point_vector_.assign(point, point + dimension_);
+    *oit = point_vector_;
+  }
+
+  // Returns true when the cell of |subtree| intersects the query box. Sets
+  // |inside| to true when the whole cell is inside the box.
+  bool SubtreeIntersectsQueryBox(const Subtree &subtree, bool *inside) const;
+
+  // Decodes |num_points| points of a node and all its descendants. When
+  // |subtrees| is not null, nodes at |subtree_depth_| are not decoded but they
+  // are added to |subtrees| instead.
+  template <class OutputIteratorT>
+  bool DecodeInternal(uint32_t num_points, uint32_t root_last_axis,
+                      const VectorUint32 &root_base,
+                      const VectorUint32 &root_levels,
+                      std::vector<Subtree> *subtrees, OutputIteratorT &oit);
+
+  // Decodes all subtrees stored after the streams of the top of the tree.
+  template <class OutputIteratorT>
+  bool DecodeSubtrees(DecoderBuffer *buffer,
+                      const std::vector<Subtree> &subtrees,
+                      OutputIteratorT &oit);
+
+  // Decodes all points of |subtree| from new streams stored in |buffer|.
+  template <class OutputIteratorT>
+  bool DecodeSubtree(DecoderBuffer *buffer, const Subtree &subtree,
+                     uint32_t bit_length, OutputIteratorT &oit);
+
+  // Sizes the traversal stacks for the current |bit_length_|. Memory is
+  // allocated only when a deeper tree than before is decoded.
+  void InitStacks() {
+    // The depth of the tree is bounded by the number of bits of all
+    // coordinates. +1 for the second half of the deepest node.
+    const size_t max_depth = static_cast<size_t>(bit_length_) * dimension_ + 1;
+    base_stack_.resize(max_depth * dimension_);
+    levels_stack_.resize(max_depth * dimension_);
+    // Each visited node leaves at most one of its halves on the stack.
+    status_stack_.resize(max_depth + 1);
+  }
+
+  bool StartDecoding(DecoderBuffer *buffer) {
+    if (!numbers_decoder_.StartDecoding(buffer))
+      return false;
+    if (!remaining_bits_decoder_.StartDecoding(buffer))
+      return false;
+    if (!axis_decoder_.StartDecoding(buffer))
+      return false;
+    if (!half_decoder_.StartDecoding(buffer))
+      return false;
+    return true;
+  }
+
+  void EndDecoding() {
+    numbers_decoder_.EndDecoding();
+    remaining_bits_decoder_.EndDecoding();
+    axis_decoder_.EndDecoding();
+    half_decoder_.EndDecoding();
+  }
 
   void DecodeNumber(int nbits, uint32_t *value) {
     numbers_decoder_.DecodeLeastSignificantBits32(nbits, value);
   }
 
   struct DecodingStatus {
+    DecodingStatus()
+        : num_remaining_points(0), last_axis(0), stack_pos(0), depth(0) {}
     DecodingStatus(uint32_t num_remaining_points_, uint32_t last_axis_,
-                   uint32_t stack_pos_)
+                   uint32_t stack_pos_, uint32_t depth_)
         : num_remaining_points(num_remaining_points_),
           last_axis(last_axis_),
-          stack_pos(stack_pos_) {}
+          stack_pos(stack_pos_),
+          depth(depth_) {}
 
     uint32_t num_remaining_points;
     uint32_t last_axis;
     uint32_t stack_pos;  // used to get base and levels
+    uint32_t depth;
   };
 
   uint32_t bit_length_;
   uint32_t num_points_;
   uint32_t num_decoded_points_;
+  uint32_t num_output_points_;
+  uint32_t subtree_depth_;
+  ThreadPool *thread_pool_;
   uint32_t dimension_;
   NumbersDecoder numbers_decoder_;
   RemainingBitsDecoder remaining_bits_decoder_;
@@ -136,8 +310,15 @@ class DynamicIntegerPointsKdTreeDecoder {
   HalfDecoder half_decoder_;
   VectorUint32 p_;
   VectorUint32 axes_;
-  std::vector<VectorUint32> base_stack_;
-  std::vector<VectorUint32> levels_stack_;
+  VectorUint32 query_box_min_;
+  VectorUint32 query_box_max_;
+  // Bases and levels of the nodes on the traversal stack. Entry |i| is stored
+  // at [i * dimension_, (i + 1) * dimension_).
+  VectorUint32 base_stack_;
+  VectorUint32 levels_stack_;
+  std::vector<DecodingStatus> status_stack_;
+  // Point passed to output iterators that don't accept pointers.
+  VectorUint32 point_vector_;
 };
 
 // Decodes a point cloud from |buffer|.
@@ -162,30 +343,171 @@ bool DynamicIntegerPointsKdTreeDecoder<compression_level_t>::DecodePoints(
   if (num_points_ == 0)
     return true;
   num_decoded_points_ = 0;
+  num_output_points_ = 0;
+  InitStacks();
 
-  if (!numbers_decoder_.StartDecoding(buffer))
-    return false;
-  if (!remaining_bits_decoder_.StartDecoding(buffer))
-    return false;
-  if (!axis_decoder_.StartDecoding(buffer))
-    return false;
-  if (!half_decoder_.StartDecoding(buffer))
+  if (!StartDecoding(buffer))
     return false;
 
-  if (!DecodeInternal(num_points_, oit))
+  const VectorUint32 root(dimension_, 0);
+  std::vector<Subtree> subtrees;
+  if (!DecodeInternal(num_points_, 0, root, root,
+                      subtree_depth_ > 0 ? &subtrees : nullptr, oit))
     return false;
 
-  numbers_decoder_.EndDecoding();
-  remaining_bits_decoder_.EndDecoding();
-  axis_decoder_.EndDecoding();
-  half_decoder_.EndDecoding();
+  EndDecoding();
+
+  if (subtree_depth_ > 0)
+    return DecodeSubtrees(buffer, subtrees, oit);
+  return true;
+}
+
+template <int compression_level_t>
+bool DynamicIntegerPointsKdTreeDecoder<compression_level_t>::SkipPoints(
+    DecoderBuffer *buffer) {
+  // An empty query box skips all subtrees.
+  const VectorUint32 box_min = query_box_min_;
+  const VectorUint32 box_max = query_box_max_;
+  query_box_min_.assign(dimension_, 1);
+  query_box_max_.assign(dimension_, 0);
+  DiscardOutputIterator oit;
+  const bool ret = DecodePoints(buffer, oit);
+  query_box_min_ = box_min;
+  query_box_max_ = box_max;
+  return ret;
+}
 
+template <int compression_level_t>
+bool DynamicIntegerPointsKdTreeDecoder<
+    compression_level_t>::SubtreeIntersectsQueryBox(const Subtree &subtree,
+                                                    bool *inside) const {
+  *inside = true;
+  for (uint32_t i = 0; i < dimension_; ++i) {
+    const uint64_t cell_min = subtree.base[i];
+    const uint64_t cell_max =
+        cell_min + (uint64_t(1) << (bit_length_ - subtree.levels[i])) - 1;
+    if (query_box_min_[i] > query_box_max_[i] ||
+        cell_max < query_box_min_[i] || cell_min > query_box_max_[i])
+      return false;
+    if (cell_min < query_box_min_[i] || cell_max > query_box_max_[i])
+      *inside = false;
+  }
   return true;
 }
 
+template <int compression_level_t>
+template <class OutputIteratorT>
+bool DynamicIntegerPointsKdTreeDecoder<compression_level_t>::DecodeSubtrees(
+    DecoderBuffer *buffer, const std::vector<Subtree> &subtrees,
+    OutputIteratorT &oit) {
+  uint32_t num_subtrees;
+  if (!DecodeVarint(&num_subtrees, buffer) || num_subtrees != subtrees.size())
+    return false;
+  std::vector<uint64_t> offsets(num_subtrees + 1, 0);
+  for (uint32_t i = 0; i < num_subtrees; ++i) {
+    uint64_t size;
+    if (!DecodeVarint(&size, buffer))
+      return false;
+    if (size > static_cast<uint64_t>(buffer->remaining_size()))
+      return false;
+    offsets[i + 1] = offsets[i] + size;
+  }
+  if (offsets[num_subtrees] > static_cast<uint64_t>(buffer->remaining_size()))
+    return false;
+  const char *const data = buffer->data_head();
+
+  // Select the subtrees that need to be decoded. Subtrees that are fully
+  // inside the query box don't need to check the individual points.
+  std::vector<uint32_t> decoded_subtrees;
+  std::vector<bool> subtree_inside_box(num_subtrees, true);
+  for (uint32_t i = 0; i < num_subtrees; ++i) {
+    bool inside = true;
+    if (HasQueryBox() && !SubtreeIntersectsQueryBox(subtrees[i], &inside))
+      continue;
+    subtree_inside_box[i] = inside;
+    decoded_subtrees.push_back(i);
+  }
+  const auto init_subtree_decoder =
+      [&](uint32_t i, DynamicIntegerPointsKdTreeDecoder *subtree_decoder,
+          DecoderBuffer *subtree_buffer) {
+        subtree_buffer->Init(data + offsets[i], offsets[i + 1] - offsets[i],
+                             buffer->bitstream_version());
+        if (subtree_inside_box[i]) {
+          subtree_decoder->set_query_box(VectorUint32(), VectorUint32());
+        } else {
+          subtree_decoder->set_query_box(query_box_min_, query_box_max_);
+        }
+      };
+
+  if (thread_pool_ == nullptr) {
+    // Decode the subtrees one by one directly into the output iterator. The
+    // same decoder is reused so its stacks are allocated only once.
+    DynamicIntegerPointsKdTreeDecoder subtree_decoder(dimension_);
+    for (const uint32_t i : decoded_subtrees) {
+      DecoderBuffer subtree_buffer;
+      init_subtree_decoder(i, &subtree_decoder, &subtree_buffer);
+      if (!subtree_decoder.DecodeSubtree(&subtree_buffer, subtrees[i],
+                                         bit_length_, oit))
+        return false;
+      num_output_points_ += subtree_decoder.num_output_points();
+    }
+  } else {
+    // Decode the subtrees in parallel into temporary arrays and output the
+    // points in order afterwards.
+    std::vector<std::vector<uint32_t>> subtree_points(decoded_subtrees.size());
+    const auto decode_subtree = [&](int j) {
+      const uint32_t i = decoded_subtrees[j];
+      DynamicIntegerPointsKdTreeDecoder subtree_decoder(dimension_);
+      DecoderBuffer subtree_buffer;
+      init_subtree_decoder(i, &subtree_decoder, &subtree_buffer);
+      // The number of points comes from the unvalidated input, so the
+      // reservation is capped by the size of the subtree data.
+      subtree_points[j].reserve(
+          std::min(static_cast<size_t>(subtrees[i].num_points) * dimension_,
+                   static_cast<size_t>(offsets[i + 1] - offsets[i])));
+      PointsBufferOutputIterator points_it(&subtree_points[j], dimension_);
+      return subtree_decoder.DecodeSubtree(&subtree_buffer, subtrees[i],
+                                           bit_length_, points_it);
+    };
+    if (!ParallelFor(thread_pool_, static_cast<int>(decoded_subtrees.size()),
+                     decode_subtree))
+      return false;
+    for (const std::vector<uint32_t> &points : subtree_points) {
+      for (size_t i = 0; i < points.size(); i += dimension_) {
+        AssignPoint(points.data() + i, oit);
+        ++oit;
+      }
+      num_output_points_ += static_cast<uint32_t>(points.size() / dimension_);
+    }
+  }
+  num_decoded_points_ = num_points_;
+  buffer->Advance(offsets[num_subtrees]);
+  return true;
+}
+
+template <int compression_level_t>
+template <class OutputIteratorT>
+bool DynamicIntegerPointsKdTreeDecoder<compression_level_t>::DecodeSubtree(
+    DecoderBuffer *buffer, const Subtree &subtree, uint32_t bit_length,
+    OutputIteratorT &oit) {
+  bit_length_ = bit_length;
+  num_points_ = subtree.num_points;
+  num_decoded_points_ = 0;
+  num_output_points_ = 0;
+  InitStacks();
+  if (!StartDecoding(buffer))
+    return false;
+  if (!DecodeInternal(subtree.num_points, subtree.last_axis, subtree.base,
+                      subtree.levels, nullptr, oit))
+    return false;
+  EndDecoding();
+  // Invalid data could produce a different number of points.
+  return num_decoded_points_ == subtree.num_points;
+}
+
 template <int compression_level_t>
 uint32_t DynamicIntegerPointsKdTreeDecoder<compression_level_t>::GetAxis(
-    uint32_t num_remaining_points, const VectorUint32 &levels,
+    uint32_t num_remaining_points, const uint32_t *levels,
     uint32_t last_axis) {
   if (!Policy::select_axis)
     return DRACO_INCREMENT_MOD(last_axis, dimension_);
@@ -207,28 +529,35 @@ uint32_t DynamicIntegerPointsKdTreeDecoder<compression_level_t>::GetAxis(
 template <int compression_level_t>
 template <class OutputIteratorT>
 bool DynamicIntegerPointsKdTreeDecoder<compression_level_t>::DecodeInternal(
-    uint32_t num_points, OutputIteratorT &oit) {
-  typedef DecodingStatus Status;
-  base_stack_[0] = VectorUint32(dimension_, 0);
-  levels_stack_[0] = VectorUint32(dimension_, 0);
-  DecodingStatus init_status(num_points, 0, 0);
-  std::stack<Status> status_stack;
-  status_stack.push(init_status);
-
-  // TODO(hemmer): use preallocated vector instead of stack.
-  while (!status_stack.empty()) {
-    const DecodingStatus status = status_stack.top();
-    status_stack.pop();
+    uint32_t num_points, uint32_t root_last_axis, const VectorUint32 &root_base,
+    const VectorUint32 &root_levels, std::vector<Subtree> *subtrees,
+    OutputIteratorT &oit) {
+  std::copy(root_base.begin(), root_base.end(), base_stack_.begin());
+  std::copy(root_levels.begin(), root_levels.end(), levels_stack_.begin());
+  DecodingStatus *const status_stack = status_stack_.data();
+  size_t num_statuses = 0;
+  status_stack[num_statuses++] =
+      DecodingStatus(num_points, root_last_axis, 0, 0);
+
+  while (num_statuses > 0) {
+    const DecodingStatus status = status_stack[--num_statuses];
 
     const uint32_t num_remaining_points = status.num_remaining_points;
     const uint32_t last_axis = status.last_axis;
     const uint32_t stack_pos = status.stack_pos;
-    const VectorUint32 &old_base = base_stack_[stack_pos];
-    const VectorUint32 &levels = levels_stack_[stack_pos];
+    uint32_t *const old_base = &base_stack_[stack_pos * dimension_];
+    uint32_t *const levels = &levels_stack_[stack_pos * dimension_];
 
     if (num_remaining_points > num_points)
       return false;
 
+    if (subtrees != nullptr && status.depth == subtree_depth_) {
+      subtrees->push_back({num_remaining_points, last_axis,
+                           VectorUint32(old_base, old_base + dimension_),
+                           VectorUint32(levels, levels + dimension_)});
+      continue;
+    }
+
     const uint32_t axis = GetAxis(num_remaining_points, levels, last_axis);
     if (axis >= dimension_)
       return false;
@@ -238,9 +567,7 @@ bool DynamicIntegerPointsKdTreeDecoder<compression_level_t>::DecodeInternal(
     // All axes have been fully subdivided, just output points.
     if ((bit_length_ - level) == 0) {
       for (uint32_t i = 0; i < num_remaining_points; i++) {
-        *oit = old_base;
-        ++oit;
-        ++num_decoded_points_;
+        OutputPoint(old_base, oit);
       }
       continue;
     }
@@ -263,9 +590,7 @@ bool DynamicIntegerPointsKdTreeDecoder<compression_level_t>::DecodeInternal(
                 num_remaining_bits, &p_[axes_[j]]);
           p_[axes_[j]] = old_base[axes_[j]] | p_[axes_[j]];
         }
-        *oit = p_;
-        ++oit;
-        ++num_decoded_points_;
+        OutputPoint(p_.data(), oit);
       }
       continue;
     }
@@ -275,8 +600,10 @@ bool DynamicIntegerPointsKdTreeDecoder<compression_level_t>::DecodeInternal(
 
     const int num_remaining_bits = bit_length_ - level;
     const uint32_t modifier = 1 << (num_remaining_bits - 1);
-    base_stack_[stack_pos + 1] = old_base;         // copy
-    base_stack_[stack_pos + 1][axis] += modifier;  // new base
+    uint32_t *const new_base = old_base + dimension_;
+    uint32_t *const new_levels = levels + dimension_;
+    std::copy(old_base, old_base + dimension_, new_base);
+    new_base[axis] += modifier;
 
     const int incoming_bits = MostSignificantBit(num_remaining_points);
 
@@ -290,12 +617,18 @@ bool DynamicIntegerPointsKdTreeDecoder<compression_level_t>::DecodeInternal(
       if (!half_decoder_.DecodeNextBit())
         std::swap(first_half, second_half);
 
-    levels_stack_[stack_pos][axis] += 1;
-    levels_stack_[stack_pos + 1] = levels_stack_[stack_pos];  // copy
-    if (first_half)
-      status_stack.push(DecodingStatus(first_half, axis, stack_pos));
-    if (second_half)
-      status_stack.push(DecodingStatus(second_half, axis, stack_pos + 1));
+    levels[axis] += 1;
+    std::copy(levels, levels + dimension_, new_levels);
+    // The first half reuses the entry of the current node. The second half is
+    // decoded first, so it can't overwrite the entry before it is needed.
+    if (first_half) {
+      status_stack[num_statuses++] =
+          DecodingStatus(first_half, axis, stack_pos, status.depth + 1);
+    }
+    if (second_half) {
+      status_stack[num_statuses++] =
+          DecodingStatus(second_half, axis, stack_pos + 1, status.depth + 1);
+    }
   }
   return true;
 }
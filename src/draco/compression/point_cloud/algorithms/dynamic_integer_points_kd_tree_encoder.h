@@ -29,6 +29,8 @@
 #include "draco/core/bit_utils.h"
 #include "draco/core/encoder_buffer.h"
 #include "draco/core/math_utils.h"
+#include "draco/core/thread_pool.h"
+#include "draco/core/varint_encoding.h"
 
 namespace draco {
 
@@ -85,6 +87,12 @@ struct DynamicIntegerPointsKdTreeEncoderCompressionPolicy<6>
 // in the smaller half of the two. This results in a better compression rate as
 // there are more leading zeros, which is then compressed better by the
 // arithmetic encoding.
+//
+// Optionally, all subtrees rooted at a given depth of the tree can be encoded
+// into independent streams (see set_subtree_depth()). The subtrees are then
+// encoded in parallel and the decoder can decode them in parallel as well.
+// The points of all subtrees are output after the points of the leaves above
+// the subtree depth.
 template <int compression_level_t>
 class DynamicIntegerPointsKdTreeEncoder {
   static_assert(compression_level_t >= 0, "Compression level must in [0..6].");
@@ -101,6 +109,8 @@ class DynamicIntegerPointsKdTreeEncoder {
  public:
   explicit DynamicIntegerPointsKdTreeEncoder(uint32_t dimension)
       : bit_length_(0),
+        subtree_depth_(0),
+        thread_pool_(nullptr),
         dimension_(dimension),
         deviations_(dimension, 0),
         num_remaining_bits_(dimension, 0),
@@ -123,14 +133,60 @@ class DynamicIntegerPointsKdTreeEncoder {
 
   const uint32_t dimension() const { return dimension_; }
 
+  // Sets the depth of the tree at which the subtrees are encoded into
+  // independent streams. 0 disables the subtree streams (default). The decoder
+  // must use the same depth.
+  void set_subtree_depth(uint32_t depth) { subtree_depth_ = depth; }
+  uint32_t subtree_depth() const { return subtree_depth_; }
+
+  // Sets a thread pool that is used to encode the subtrees in parallel. The
+  // encoded data is the same with or without the pool.
+  void set_thread_pool(ThreadPool *pool) { thread_pool_ = pool; }
+
  private:
+  // Subtree rooted at |subtree_depth_| that is encoded into its own streams.
+  template <class RandomAccessIteratorT>
+  struct Subtree {
+    RandomAccessIteratorT begin;
+    RandomAccessIteratorT end;
+    uint32_t last_axis;
+    VectorUint32 base;
+    VectorUint32 levels;
+  };
+
   template <class RandomAccessIteratorT>
   uint32_t GetAndEncodeAxis(RandomAccessIteratorT begin,
                             RandomAccessIteratorT end,
                             const VectorUint32 &old_base,
                             const VectorUint32 &levels, uint32_t last_axis);
+
+  // Encodes the node given by [begin,end) and all its descendants. When
+  // |subtrees| is not null, nodes at |subtree_depth_| are not encoded but they
+  // are added to |subtrees| instead.
+  template <class RandomAccessIteratorT>
+  void EncodeInternal(RandomAccessIteratorT begin, RandomAccessIteratorT end,
+                      uint32_t root_last_axis, const VectorUint32 &root_base,
+                      const VectorUint32 &root_levels,
+                      std::vector<Subtree<RandomAccessIteratorT>> *subtrees);
+
+  // Encodes all points of |subtree| into |buffer| using new streams.
   template <class RandomAccessIteratorT>
-  void EncodeInternal(RandomAccessIteratorT begin, RandomAccessIteratorT end);
+  void EncodeSubtree(const Subtree<RandomAccessIteratorT> &subtree,
+                     uint32_t bit_length, EncoderBuffer *buffer);
+
+  void StartEncoding() {
+    numbers_encoder_.StartEncoding();
+    remaining_bits_encoder_.StartEncoding();
+    axis_encoder_.StartEncoding();
+    half_encoder_.StartEncoding();
+  }
+
+  void EndEncoding(EncoderBuffer *buffer) {
+    numbers_encoder_.EndEncoding(buffer);
+    remaining_bits_encoder_.EndEncoding(buffer);
+    axis_encoder_.EndEncoding(buffer);
+    half_encoder_.EndEncoding(buffer);
+  }
 
   class Splitter {
    public:
@@ -152,11 +208,12 @@ class DynamicIntegerPointsKdTreeEncoder {
   template <class RandomAccessIteratorT>
   struct EncodingStatus {
     EncodingStatus(RandomAccessIteratorT begin_, RandomAccessIteratorT end_,
-                   uint32_t last_axis_, uint32_t stack_pos_)
+                   uint32_t last_axis_, uint32_t stack_pos_, uint32_t depth_)
         : begin(begin_),
           end(end_),
           last_axis(last_axis_),
-          stack_pos(stack_pos_) {
+          stack_pos(stack_pos_),
+          depth(depth_) {
       num_remaining_points = static_cast<uint32_t>(end - begin);
     }
 
@@ -165,10 +222,13 @@ class DynamicIntegerPointsKdTreeEncoder {
     uint32_t last_axis;
     uint32_t num_remaining_points;
     uint32_t stack_pos;  // used to get base and levels
+    uint32_t depth;
   };
 
   uint32_t bit_length_;
   uint32_t num_points_;
+  uint32_t subtree_depth_;
+  ThreadPool *thread_pool_;
   uint32_t dimension_;
   NumbersEncoder numbers_encoder_;
   RemainingBitsEncoder remaining_bits_encoder_;
@@ -194,20 +254,49 @@ bool DynamicIntegerPointsKdTreeEncoder<compression_level_t>::EncodePoints(
   if (num_points_ == 0)
     return true;
 
-  numbers_encoder_.StartEncoding();
-  remaining_bits_encoder_.StartEncoding();
-  axis_encoder_.StartEncoding();
-  half_encoder_.StartEncoding();
-
-  EncodeInternal(begin, end);
-
-  numbers_encoder_.EndEncoding(buffer);
-  remaining_bits_encoder_.EndEncoding(buffer);
-  axis_encoder_.EndEncoding(buffer);
-  half_encoder_.EndEncoding(buffer);
+  const VectorUint32 root(dimension_, 0);
+  std::vector<Subtree<RandomAccessIteratorT>> subtrees;
+  StartEncoding();
+  EncodeInternal(begin, end, 0, root, root,
+                 subtree_depth_ > 0 ? &subtrees : nullptr);
+  EndEncoding(buffer);
+  if (subtree_depth_ == 0)
+    return true;
 
+  // The subtrees are independent so they can be encoded in parallel. The
+  // number of subtrees and the sizes of their streams are stored before the
+  // actual data so that the decoder can decode them in parallel as well.
+  std::vector<EncoderBuffer> subtree_buffers(subtrees.size());
+  ParallelFor(thread_pool_, static_cast<int>(subtrees.size()), [&](int i) {
+    DynamicIntegerPointsKdTreeEncoder subtree_encoder(dimension_);
+    subtree_encoder.EncodeSubtree(subtrees[i], bit_length_,
+                                  &subtree_buffers[i]);
+    return true;
+  });
+  EncodeVarint(static_cast<uint32_t>(subtrees.size()), buffer);
+  for (const EncoderBuffer &subtree_buffer : subtree_buffers) {
+    EncodeVarint(static_cast<uint64_t>(subtree_buffer.size()), buffer);
+  }
+  for (const EncoderBuffer &subtree_buffer : subtree_buffers) {
+    if (!buffer->Encode(subtree_buffer.data(), subtree_buffer.size()))
+      return false;
+  }
   return true;
 }
+
+template <int compression_level_t>
+template <class RandomAccessIteratorT>
+void DynamicIntegerPointsKdTreeEncoder<compression_level_t>::EncodeSubtree(
+    const Subtree<RandomAccessIteratorT> &subtree, uint32_t bit_length,
+    EncoderBuffer *buffer) {
+  bit_length_ = bit_length;
+  num_points_ = static_cast<uint32_t>(subtree.end - subtree.begin);
+  StartEncoding();
+  EncodeInternal<RandomAccessIteratorT>(subtree.begin, subtree.end,
+                                        subtree.last_axis, subtree.base,
+                                        subtree.levels, nullptr);
+  EndEncoding(buffer);
+}
 template <int compression_level_t>
 template <class RandomAccessIteratorT>
 uint32_t
@@ -269,12 +358,15 @@ DynamicIntegerPointsKdTreeEncoder<compression_level_t>::GetAndEncodeAxis(
 template <int compression_level_t>
 template <class RandomAccessIteratorT>
 void DynamicIntegerPointsKdTreeEncoder<compression_level_t>::EncodeInternal(
-    RandomAccessIteratorT begin, RandomAccessIteratorT end) {
+    RandomAccessIteratorT begin, RandomAccessIteratorT end,
+    uint32_t root_last_axis, const VectorUint32 &root_base,
+    const VectorUint32 &root_levels,
+    std::vector<Subtree<RandomAccessIteratorT>> *subtrees) {
   typedef EncodingStatus<RandomAccessIteratorT> Status;
 
-  base_stack_[0] = VectorUint32(dimension_, 0);
-  levels_stack_[0] = VectorUint32(dimension_, 0);
-  Status init_status(begin, end, 0, 0);
+  base_stack_[0] = root_base;
+  levels_stack_[0] = root_levels;
+  Status init_status(begin, end, root_last_axis, 0, 0);
   std::stack<Status> status_stack;
   status_stack.push(init_status);
 
@@ -290,6 +382,11 @@ void DynamicIntegerPointsKdTreeEncoder<compression_level_t>::EncodeInternal(
     const VectorUint32 &old_base = base_stack_[stack_pos];
     const VectorUint32 &levels = levels_stack_[stack_pos];
 
+    if (subtrees != nullptr && status.depth == subtree_depth_) {
+      subtrees->push_back({begin, end, last_axis, old_base, levels});
+      continue;
+    }
+
     const uint32_t axis =
         GetAndEncodeAxis(begin, end, old_base, levels, last_axis);
     const uint32_t level = levels[axis];
@@ -349,10 +446,14 @@ void DynamicIntegerPointsKdTreeEncoder<compression_level_t>::EncodeInternal(
 
     levels_stack_[stack_pos][axis] += 1;
     levels_stack_[stack_pos + 1] = levels_stack_[stack_pos];  // copy
-    if (split != begin)
-      status_stack.push(Status(begin, split, axis, stack_pos));
-    if (split != end)
-      status_stack.push(Status(split, end, axis, stack_pos + 1));
+    if (split != begin) {
+      status_stack.push(
+          Status(begin, split, axis, stack_pos, status.depth + 1));
+    }
+    if (split != end) {
+      status_stack.push(
+          Status(split, end, axis, stack_pos + 1, status.depth + 1));
+    }
   }
 }
 extern template class DynamicIntegerPointsKdTreeEncoder<0>;
@@ -24,11 +24,9 @@
 namespace draco {
 
 struct Converter {
-  typedef std::vector<uint32_t> SourceType;
+  typedef const uint32_t *SourceType;
   typedef Point3ui TargetType;
-  Point3ui operator()(const std::vector<uint32_t> &v) {
-    return Point3ui(v[0], v[1], v[2]);
-  }
+  Point3ui operator()(const uint32_t *v) { return Point3ui(v[0], v[1], v[2]); }
 };
 
 // Output iterator that is used to decode values directly into the data buffer
@@ -23,7 +23,12 @@ PointCloudDecoder::PointCloudDecoder()
       buffer_(nullptr),
       version_major_(0),
       version_minor_(0),
-      options_(nullptr) {}
+      options_(nullptr),
+      thread_pool_(nullptr),
+      scratch_(nullptr),
+      stage_(DECODING_STAGE_HEADER),
+      header_flags_(0),
+      num_decoded_attributes_decoders_(0) {}
 
 Status PointCloudDecoder::DecodeHeader(DecoderBuffer *buffer,
                                        DracoHeader *out_header) {
@@ -51,16 +56,96 @@ Status PointCloudDecoder::DecodeMetadata() {
   MetadataDecoder metadata_decoder;
   if (!metadata_decoder.DecodeGeometryMetadata(buffer_, metadata.get()))
     return Status(Status::DRACO_ERROR, "Failed to decode metadata.");
-  point_cloud_->AddMetadata(std::move(metadata));
+  metadata_ = std::move(metadata);
   return OkStatus();
 }
 
 Status PointCloudDecoder::Decode(const DecoderOptions &options,
                                  DecoderBuffer *in_buffer,
                                  PointCloud *out_point_cloud) {
+  StartDecoding(options, in_buffer, out_point_cloud);
+  while (!IsDecodingDone()) {
+    DRACO_RETURN_IF_ERROR(DecodeNextStage())
+  }
+  return OkStatus();
+}
+
+void PointCloudDecoder::StartDecoding(const DecoderOptions &options,
+                                      DecoderBuffer *in_buffer,
+                                      PointCloud *out_point_cloud) {
   options_ = &options;
   buffer_ = in_buffer;
   point_cloud_ = out_point_cloud;
+  const int num_threads = options.GetGlobalInt("num_threads", 1);
+  if (thread_pool_ == nullptr && num_threads > 1) {
+    // The calling thread takes part in all parallel work so one worker thread
+    // less is needed.
+    owned_thread_pool_ =
+        std::unique_ptr<ThreadPool>(new ThreadPool(num_threads - 1));
+    thread_pool_ = owned_thread_pool_.get();
+  }
+  stage_ = DECODING_STAGE_HEADER;
+  header_flags_ = 0;
+  num_decoded_attributes_decoders_ = 0;
+  metadata_ = nullptr;
+}
+
+Status PointCloudDecoder::DecodeNextStage() {
+  switch (stage_) {
+    case DECODING_STAGE_HEADER: {
+      TraceScope trace(tracer(), "DecodeHeader", buffer_);
+      DRACO_RETURN_IF_ERROR(DecodeAndCheckHeader())
+      stage_ = DECODING_STAGE_METADATA;
+      break;
+    }
+    case DECODING_STAGE_METADATA:
+      if (bitstream_version() >= DRACO_BITSTREAM_VERSION(1, 3) &&
+          (header_flags_ & METADATA_FLAG_MASK)) {
+        TraceScope trace(tracer(), "DecodeMetadata", buffer_);
+        DRACO_RETURN_IF_ERROR(DecodeMetadata())
+      }
+      stage_ = DECODING_STAGE_GEOMETRY;
+      break;
+    case DECODING_STAGE_GEOMETRY: {
+      if (!InitializeDecoder())
+        return Status(Status::DRACO_ERROR, "Failed to initialize the decoder.");
+      TraceScope trace(tracer(), "DecodeGeometryData", buffer_);
+      if (!DecodeGeometryData())
+        return Status(Status::DRACO_ERROR, "Failed to decode geometry data.");
+      stage_ = DECODING_STAGE_ATTRIBUTES_DECODERS;
+      break;
+    }
+    case DECODING_STAGE_ATTRIBUTES_DECODERS: {
+      TraceScope trace(tracer(), "DecodeAttributesDecoders", buffer_);
+      if (!DecodeAttributesDecoders())
+        return Status(Status::DRACO_ERROR,
+                      "Failed to decode point attributes.");
+      if (metadata_ != nullptr)
+        point_cloud_->AddMetadata(std::move(metadata_));
+      stage_ = num_attributes_decoders() > 0 ? DECODING_STAGE_ATTRIBUTES
+                                             : DECODING_STAGE_TRANSFORMS;
+      break;
+    }
+    case DECODING_STAGE_ATTRIBUTES:
+      if (!DecodeAttributes(num_decoded_attributes_decoders_))
+        return Status(Status::DRACO_ERROR,
+                      "Failed to decode point attributes.");
+      if (++num_decoded_attributes_decoders_ == num_attributes_decoders())
+        stage_ = DECODING_STAGE_TRANSFORMS;
+      break;
+    case DECODING_STAGE_TRANSFORMS:
+      if (!TransformAllAttributes() || !OnAttributesDecoded())
+        return Status(Status::DRACO_ERROR,
+                      "Failed to decode point attributes.");
+      stage_ = DECODING_STAGE_DONE;
+      break;
+    case DECODING_STAGE_DONE:
+      return Status(Status::DRACO_ERROR, "Decoding is already finished.");
+  }
+  return OkStatus();
+}
+
+Status PointCloudDecoder::DecodeAndCheckHeader() {
   DracoHeader header;
   DRACO_RETURN_IF_ERROR(DecodeHeader(buffer_, &header))
   // Sanity check that we are really using the right decoder (mostly for cases
@@ -87,42 +172,49 @@ Status PointCloudDecoder::Decode(const DecoderOptions &options,
     return Status(Status::UNKNOWN_VERSION, "Unknown minor version.");
   buffer_->set_bitstream_version(
       DRACO_BITSTREAM_VERSION(version_major_, version_minor_));
-
-  if (bitstream_version() >= DRACO_BITSTREAM_VERSION(1, 3) &&
-      (header.flags & METADATA_FLAG_MASK)) {
-    DRACO_RETURN_IF_ERROR(DecodeMetadata())
-  }
-  if (!InitializeDecoder())
-    return Status(Status::DRACO_ERROR, "Failed to initialize the decoder.");
-  if (!DecodeGeometryData())
-    return Status(Status::DRACO_ERROR, "Failed to decode geometry data.");
-  if (!DecodePointAttributes())
-    return Status(Status::DRACO_ERROR, "Failed to decode point attributes.");
+  header_flags_ = header.flags;
   return OkStatus();
 }
 
-bool PointCloudDecoder::DecodePointAttributes() {
+bool PointCloudDecoder::DecodeAttributesDecoders() {
+  const int num_existing_attributes = point_cloud_->num_attributes();
+  attributes_decoders_.clear();
+  attribute_to_decoder_map_.clear();
+  bool success = true;
   uint8_t num_attributes_decoders;
   if (!buffer_->Decode(&num_attributes_decoders))
     return false;
   // Create all attribute decoders. This is implementation specific and the
   // derived classes can use any data encoded in the
   // PointCloudEncoder::EncodeAttributesEncoderIdentifier() call.
-  for (int i = 0; i < num_attributes_decoders; ++i) {
-    if (!CreateAttributesDecoder(i))
-      return false;
+  for (int i = 0; success && i < num_attributes_decoders; ++i) {
+    success = CreateAttributesDecoder(i);
   }
 
   // Initialize all attributes decoders. No data is decoded here.
-  for (auto &att_dec : attributes_decoders_) {
-    if (!att_dec->Init(this, point_cloud_))
-      return false;
+  if (success) {
+    for (auto &att_dec : attributes_decoders_) {
+      if (!att_dec->Init(this, point_cloud_)) {
+        success = false;
+        break;
+      }
+    }
   }
 
   // Decode any data needed by the attribute decoders.
-  for (int i = 0; i < num_attributes_decoders; ++i) {
-    if (!attributes_decoders_[i]->DecodeAttributesDecoderData(buffer_))
-      return false;
+  for (int i = 0; success && i < num_attributes_decoders; ++i) {
+    TraceScope trace(tracer(), "DecodeAttributesDecoderData", buffer_);
+    success = attributes_decoders_[i]->DecodeAttributesDecoderData(buffer_);
+  }
+
+  if (!success) {
+    // Remove all attributes that were created by the attribute decoders so the
+    // decoding can be restarted.
+    while (point_cloud_->num_attributes() > num_existing_attributes) {
+      point_cloud_->DeleteAttribute(point_cloud_->num_attributes() - 1);
+    }
+    attributes_decoders_.clear();
+    return false;
   }
 
   // Create map between attribute and decoder ids.
@@ -136,22 +228,32 @@ bool PointCloudDecoder::DecodePointAttributes() {
       attribute_to_decoder_map_[att_id] = i;
     }
   }
-
-  // Decode the actual attributes using the created attribute decoders.
-  if (!DecodeAllAttributes())
-    return false;
-
-  if (!OnAttributesDecoded())
-    return false;
   return true;
 }
 
-bool PointCloudDecoder::DecodeAllAttributes() {
-  for (auto &att_dec : attributes_decoders_) {
-    if (!att_dec->DecodeAttributes(buffer_))
-      return false;
+bool PointCloudDecoder::DecodeAttributes(int att_decoder_id) {
+  AttributesDecoderInterface *const att_dec =
+      attributes_decoders_[att_decoder_id].get();
+  if (!UseTransformStage()) {
+    TraceScope trace(tracer(), "DecodeAttributes", buffer_);
+    return att_dec->DecodeAttributes(buffer_);
   }
-  return true;
+  // Data of all attribute decoders are stored one after another in the buffer
+  // and the decoders can use the portable attributes of the previous decoders
+  // for prediction. Therefore, the portable data must be decoded serially.
+  TraceScope trace(tracer(), "DecodeAttributesWithoutTransform", buffer_);
+  return att_dec->DecodeAttributesWithoutTransform(buffer_);
+}
+
+bool PointCloudDecoder::TransformAllAttributes() {
+  if (!UseTransformStage())
+    return true;  // Attributes were already transformed.
+  // Attribute transforms depend only on the portable data of the transformed
+  // attribute and they can be reverted in parallel.
+  return ParallelFor(thread_pool_, num_attributes_decoders(), [this](int i) {
+    TraceScope trace(tracer(), "TransformAttributesToOriginalFormat");
+    return attributes_decoders_[i]->TransformAttributesToOriginalFormat();
+  });
 }
 
 const PointAttribute *PointCloudDecoder::GetPortableAttribute(
@@ -15,14 +15,21 @@
 #ifndef DRACO_COMPRESSION_POINT_CLOUD_POINT_CLOUD_DECODER_H_
 #define DRACO_COMPRESSION_POINT_CLOUD_POINT_CLOUD_DECODER_H_
 
+#include <algorithm>
+#include <vector>
+
 #include "draco/compression/attributes/attributes_decoder_interface.h"
 #include "draco/compression/config/compression_shared.h"
 #include "draco/compression/config/decoder_options.h"
 #include "draco/core/status.h"
+#include "draco/core/thread_pool.h"
+#include "draco/core/tracer.h"
 #include "draco/point_cloud/point_cloud.h"
 
 namespace draco {
 
+class DecoderScratch;
+
 // Abstract base class for all point cloud and mesh decoders. It provides a
 // basic functionality that is shared between different decoders.
 class PointCloudDecoder {
@@ -40,6 +47,28 @@ class PointCloudDecoder {
   Status Decode(const DecoderOptions &options, DecoderBuffer *in_buffer,
                 PointCloud *out_point_cloud);
 
+  // Incremental decoding. StartDecoding() prepares the decoder and each call of
+  // DecodeNextStage() decodes one stage of the geometry (header, metadata,
+  // geometry data, attribute decoders, data of each attributes decoder and
+  // the final attribute transforms) starting at the current position of the
+  // input buffer. When a stage fails, the decoder and the decoded geometry are
+  // left in the same state as before the stage so the stage can be decoded
+  // again once more input data is available. The input buffer must be the same
+  // object for all stages, but it can be re-initialized with a larger data
+  // between the stages. No stage keeps references to the data of the buffer.
+  void StartDecoding(const DecoderOptions &options, DecoderBuffer *in_buffer,
+                     PointCloud *out_point_cloud);
+  Status DecodeNextStage();
+  bool IsDecodingDone() const { return stage_ == DECODING_STAGE_DONE; }
+
+  // Returns true when all stages preceding the attribute values were decoded.
+  // At this point, the decoded geometry contains the final number of points
+  // and faces and all attributes are created, but no attribute values are
+  // decoded yet.
+  bool IsAttributeLayoutDecoded() const {
+    return stage_ >= DECODING_STAGE_ATTRIBUTES;
+  }
+
   bool SetAttributesDecoder(
       int att_decoder_id, std::unique_ptr<AttributesDecoderInterface> decoder) {
     if (att_decoder_id < 0)
@@ -58,6 +87,21 @@ class PointCloudDecoder {
   // that contains the quantized values (before the dequantization step).
   const PointAttribute *GetPortableAttribute(int32_t point_attribute_id);
 
+  // Sets ids of attributes whose values are needed only in the portable form.
+  // The attribute transform of such attributes is skipped and, if the
+  // transformed values are stored in a separate portable attribute, they are
+  // not copied to the decoded geometry either. Their values must then be read
+  // from GetPortableAttribute() when the attribute has attribute transform
+  // data, and from the decoded geometry otherwise.
+  void set_portable_only_attribute_ids(const std::vector<int32_t> &ids) {
+    portable_only_attribute_ids_ = ids;
+  }
+  bool IsPortableOnlyAttribute(int32_t att_id) const {
+    return std::find(portable_only_attribute_ids_.begin(),
+                     portable_only_attribute_ids_.end(),
+                     att_id) != portable_only_attribute_ids_.end();
+  }
+
   uint16_t bitstream_version() const {
     return DRACO_BITSTREAM_VERSION(version_major_, version_minor_);
   }
@@ -77,6 +121,28 @@ class PointCloudDecoder {
   DecoderBuffer *buffer() { return buffer_; }
   const DecoderOptions *options() const { return options_; }
 
+  // Returns the tracer attached to the decoder options or nullptr when tracing
+  // is disabled.
+  Tracer *tracer() const {
+    return options_ == nullptr ? nullptr : options_->GetTracer();
+  }
+
+  // Sets a thread pool that is used to decode independent parts of the
+  // geometry in parallel. When no pool is set, the decoder creates its own pool
+  // if the global option "num_threads" is greater than one. The |pool| must
+  // outlive the Decode() call.
+  void set_thread_pool(ThreadPool *pool) { thread_pool_ = pool; }
+
+  // Returns the thread pool used for parallel decoding or nullptr when the
+  // decoding runs on a single thread.
+  ThreadPool *thread_pool() const { return thread_pool_; }
+
+  // Sets scratch memory that can be used by the decoder to store temporary
+  // data that is reused between multiple decoding calls. The |scratch| must
+  // outlive the Decode() call.
+  void set_scratch(DecoderScratch *scratch) { scratch_ = scratch; }
+  DecoderScratch *scratch() const { return scratch_; }
+
  protected:
   // Can be implemented by derived classes to perform any custom initialization
   // of the decoder. Called in the Decode() method.
@@ -85,14 +151,42 @@ class PointCloudDecoder {
   // Creates an attribute decoder.
   virtual bool CreateAttributesDecoder(int32_t att_decoder_id) = 0;
   virtual bool DecodeGeometryData() { return true; }
-  virtual bool DecodePointAttributes();
-
-  virtual bool DecodeAllAttributes();
   virtual bool OnAttributesDecoded() { return true; }
 
   Status DecodeMetadata();
 
  private:
+  enum DecodingStage {
+    DECODING_STAGE_HEADER = 0,
+    DECODING_STAGE_METADATA,
+    DECODING_STAGE_GEOMETRY,
+    DECODING_STAGE_ATTRIBUTES_DECODERS,
+    DECODING_STAGE_ATTRIBUTES,
+    DECODING_STAGE_TRANSFORMS,
+    DECODING_STAGE_DONE,
+  };
+
+  // Decodes and validates the Draco header.
+  Status DecodeAndCheckHeader();
+
+  // Creates all attributes decoders and decodes their data. Attributes created
+  // by a failed call are removed from the decoded point cloud.
+  bool DecodeAttributesDecoders();
+
+  // Decodes the attribute values of a single attributes decoder. When
+  // |UseTransformStage()| is true, the decoded attributes are kept in their
+  // portable form until TransformAllAttributes() is called.
+  bool DecodeAttributes(int att_decoder_id);
+  bool TransformAllAttributes();
+
+  bool UseTransformStage() const {
+    // Older bitstreams use the final (transformed) attribute values for
+    // prediction of the subsequent attributes and they must be transformed
+    // right after they are decoded.
+    return thread_pool_ != nullptr &&
+           bitstream_version() >= DRACO_BITSTREAM_VERSION(2, 0);
+  }
+
   // Point cloud that is being filled in by the decoder.
   PointCloud *point_cloud_;
 
@@ -109,6 +203,27 @@ class PointCloudDecoder {
   uint8_t version_minor_;
 
   const DecoderOptions *options_;
+
+  ThreadPool *thread_pool_;
+
+  // Storage for a thread pool created by the decoder itself.
+  std::unique_ptr<ThreadPool> owned_thread_pool_;
+
+  DecoderScratch *scratch_;
+
+  // Ids of attributes that are kept in the portable form.
+  std::vector<int32_t> portable_only_attribute_ids_;
+
+  DecodingStage stage_;
+  uint16_t header_flags_;
+
+  // Number of attributes decoders that already decoded their data.
+  int num_decoded_attributes_decoders_;
+
+  // Decoded metadata. It is added to the point cloud only after all attributes
+  // were created so that the attribute metadata are not affected when
+  // attributes of a failed stage are removed.
+  std::unique_ptr<GeometryMetadata> metadata_;
 };
 
 }  // namespace draco
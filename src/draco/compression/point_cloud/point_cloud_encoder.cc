@@ -14,12 +14,18 @@
 //
 #include "draco/compression/point_cloud/point_cloud_encoder.h"
 
+#include <algorithm>
+
 #include "draco/metadata/metadata_encoder.h"
 
 namespace draco {
 
 PointCloudEncoder::PointCloudEncoder()
-    : point_cloud_(nullptr), buffer_(nullptr), num_encoded_points_(0) {}
+    : point_cloud_(nullptr),
+      buffer_(nullptr),
+      options_(nullptr),
+      thread_pool_(nullptr),
+      num_encoded_points_(0) {}
 
 void PointCloudEncoder::SetPointCloud(const PointCloud &pc) {
   point_cloud_ = &pc;
@@ -29,6 +35,14 @@ Status PointCloudEncoder::Encode(const EncoderOptions &options,
                                  EncoderBuffer *out_buffer) {
   options_ = &options;
   buffer_ = out_buffer;
+  const int num_threads = options.GetGlobalInt("num_threads", 1);
+  if (thread_pool_ == nullptr && num_threads > 1) {
+    // The calling thread takes part in all parallel work so one worker thread
+    // less is needed.
+    owned_thread_pool_ =
+        std::unique_ptr<ThreadPool>(new ThreadPool(num_threads - 1));
+    thread_pool_ = owned_thread_pool_.get();
+  }
 
   // Cleanup from previous runs.
   attributes_encoders_.clear();
@@ -37,20 +51,48 @@ Status PointCloudEncoder::Encode(const EncoderOptions &options,
 
   if (!point_cloud_)
     return Status(Status::DRACO_ERROR, "Invalid input geometry.");
-  DRACO_RETURN_IF_ERROR(EncodeHeader())
-  DRACO_RETURN_IF_ERROR(EncodeMetadata())
+  {
+    TraceScope trace(tracer(), "EncodeHeader", buffer_);
+    DRACO_RETURN_IF_ERROR(EncodeHeader())
+  }
+  {
+    TraceScope trace(tracer(), "EncodeMetadata", buffer_);
+    DRACO_RETURN_IF_ERROR(EncodeMetadata())
+  }
   if (!InitializeEncoder())
     return Status(Status::DRACO_ERROR, "Failed to initialize encoder.");
-  if (!EncodeEncoderData())
-    return Status(Status::DRACO_ERROR, "Failed to encode internal data.");
-  DRACO_RETURN_IF_ERROR(EncodeGeometryData());
-  if (!EncodePointAttributes())
-    return Status(Status::DRACO_ERROR, "Failed to encode point attributes.");
+  {
+    TraceScope trace(tracer(), "EncodeEncoderData", buffer_);
+    if (!EncodeEncoderData())
+      return Status(Status::DRACO_ERROR, "Failed to encode internal data.");
+  }
+  {
+    TraceScope trace(tracer(), "EncodeGeometryData", buffer_);
+    DRACO_RETURN_IF_ERROR(EncodeGeometryData());
+  }
+  {
+    TraceScope trace(tracer(), "EncodePointAttributes", buffer_);
+    if (!EncodePointAttributes())
+      return Status(Status::DRACO_ERROR, "Failed to encode point attributes.");
+  }
   if (options.GetGlobalBool("store_number_of_encoded_points", false))
     ComputeNumberOfEncodedPoints();
   return OkStatus();
 }
 
+bool PointCloudEncoder::UseInterleavedSymbolCoding() const {
+  return options_->GetGlobalBool("use_interleaved_symbol_coding", false);
+}
+
+int PointCloudEncoder::GetKdTreeSubtreeDepth() const {
+  if (GetGeometryType() != POINT_CLOUD ||
+      GetEncodingMethod() != POINT_CLOUD_KD_TREE_ENCODING)
+    return 0;
+  // The depth is stored in a single byte.
+  return std::max(
+      0, std::min(options_->GetGlobalInt("kd_tree_subtree_depth", 0), 255));
+}
+
 Status PointCloudEncoder::EncodeHeader() {
   // Encode the header according to our v1 specification.
   // Five bytes for Draco format.
@@ -60,9 +102,21 @@ Status PointCloudEncoder::EncodeHeader() {
   const uint8_t version_major = encoder_type == POINT_CLOUD
                                     ? kDracoPointCloudBitstreamVersionMajor
                                     : kDracoMeshBitstreamVersionMajor;
-  const uint8_t version_minor = encoder_type == POINT_CLOUD
-                                    ? kDracoPointCloudBitstreamVersionMinor
-                                    : kDracoMeshBitstreamVersionMinor;
+  uint8_t version_minor = encoder_type == POINT_CLOUD
+                              ? kDracoPointCloudBitstreamVersionMinor
+                              : kDracoMeshBitstreamVersionMinor;
+  // Use the older bit-stream version when possible to keep the encoded data
+  // compatible with older decoders.
+  if (encoder_type == POINT_CLOUD) {
+    if (GetKdTreeSubtreeDepth() == 0) {
+      version_minor =
+          UseInterleavedSymbolCoding()
+              ? kDracoPointCloudNonKdTreeSubtreeBitstreamVersionMinor
+              : kDracoPointCloudNonInterleavedBitstreamVersionMinor;
+    }
+  } else if (!UseInterleavedSymbolCoding()) {
+    version_minor = kDracoMeshNonInterleavedBitstreamVersionMinor;
+  }
   buffer_->Encode(version_major);
   buffer_->Encode(version_minor);
   // Type of the encoder (point cloud, mesh, ...).
@@ -145,13 +199,43 @@ bool PointCloudEncoder::GenerateAttributesEncoders() {
 }
 
 bool PointCloudEncoder::EncodeAllAttributes() {
+  if (thread_pool_ != nullptr && attributes_encoders_.size() > 1)
+    return EncodeAllAttributesInParallel();
   for (int att_encoder_id : attributes_encoder_ids_order_) {
+    TraceScope trace(tracer(), "EncodeAttributes", buffer_);
     if (!attributes_encoders_[att_encoder_id]->EncodeAttributes(buffer_))
       return false;
   }
   return true;
 }
 
+bool PointCloudEncoder::EncodeAllAttributesInParallel() {
+  // All attributes are transformed to their portable format first so the
+  // portable parent attributes are available to all encoders. After that, the
+  // encoders don't depend on each other.
+  const int num_encoders = num_attributes_encoders();
+  if (!ParallelFor(thread_pool_, num_encoders, [this](int i) {
+        TraceScope trace(tracer(), "TransformAttributesToPortableFormat");
+        return attributes_encoders_[i]->TransformAttributes();
+      })) {
+    return false;
+  }
+  std::vector<EncoderBuffer> encoder_buffers(num_encoders);
+  if (!ParallelFor(thread_pool_, num_encoders, [&](int i) {
+        TraceScope trace(tracer(), "EncodeAttributes", &encoder_buffers[i]);
+        return attributes_encoders_[i]->EncodeTransformedAttributes(
+            &encoder_buffers[i]);
+      })) {
+    return false;
+  }
+  for (int att_encoder_id : attributes_encoder_ids_order_) {
+    const EncoderBuffer &encoder_buffer = encoder_buffers[att_encoder_id];
+    if (!buffer_->Encode(encoder_buffer.data(), encoder_buffer.size()))
+      return false;
+  }
+  return true;
+}
+
 bool PointCloudEncoder::MarkParentAttribute(int32_t parent_att_id) {
   if (parent_att_id < 0 || parent_att_id >= point_cloud_->num_attributes())
     return false;
@@ -20,6 +20,8 @@
 #include "draco/compression/config/encoder_options.h"
 #include "draco/core/encoder_buffer.h"
 #include "draco/core/status.h"
+#include "draco/core/thread_pool.h"
+#include "draco/core/tracer.h"
 #include "draco/point_cloud/point_cloud.h"
 
 namespace draco {
@@ -72,10 +74,38 @@ class PointCloudEncoder {
   // as predictor for other attributes.
   const PointAttribute *GetPortableAttribute(int32_t point_attribute_id);
 
+  // Returns true when the symbols can be encoded using the interleaved rANS
+  // coding (see SYMBOL_CODING_RAW_INTERLEAVED). This is controlled by the
+  // "use_interleaved_symbol_coding" option which is disabled by default.
+  bool UseInterleavedSymbolCoding() const;
+
+  // Returns the depth of the kd-tree at which the subtrees are encoded into
+  // independent streams or 0 when the subtree streams are not used. This is
+  // controlled by the "kd_tree_subtree_depth" option and it applies only to
+  // point clouds encoded with the kd-tree method.
+  int GetKdTreeSubtreeDepth() const;
+
   EncoderBuffer *buffer() { return buffer_; }
   const EncoderOptions *options() const { return options_; }
+
+  // Returns the tracer attached to the encoder options or nullptr when tracing
+  // is disabled.
+  Tracer *tracer() const {
+    return options_ == nullptr ? nullptr : options_->GetTracer();
+  }
   const PointCloud *point_cloud() const { return point_cloud_; }
 
+  // Sets a thread pool that is used to encode independent attribute encoders
+  // in parallel. When no pool is set, the encoder creates its own pool if the
+  // global option "num_threads" is greater than one. The encoded data is the
+  // same regardless of the number of threads. The |pool| must outlive the
+  // Encode() call.
+  void set_thread_pool(ThreadPool *pool) { thread_pool_ = pool; }
+
+  // Returns the thread pool used for parallel encoding or nullptr when the
+  // encoding runs on a single thread.
+  ThreadPool *thread_pool() const { return thread_pool_; }
+
  protected:
   // Can be implemented by derived classes to perform any custom initialization
   // of the encoder. Called in the Encode() method.
@@ -115,6 +145,11 @@ class PointCloudEncoder {
   // Encodes all the attribute data using the created attribute encoders.
   virtual bool EncodeAllAttributes();
 
+  // Same as EncodeAllAttributes() but all attribute encoders are encoded in
+  // parallel into separate buffers that are then appended to |buffer_| in the
+  // encoding order.
+  bool EncodeAllAttributesInParallel();
+
   // Computes and sets the num_encoded_points_ for the encoder.
   virtual void ComputeNumberOfEncodedPoints() = 0;
 
@@ -150,6 +185,11 @@ class PointCloudEncoder {
 
   const EncoderOptions *options_;
 
+  ThreadPool *thread_pool_;
+
+  // Storage for a thread pool created by the encoder itself.
+  std::unique_ptr<ThreadPool> owned_thread_pool_;
+
   size_t num_encoded_points_;
 };
 
@@ -12,6 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //
+#include <algorithm>
+#include <iterator>
+
+#include "draco/compression/point_cloud/algorithms/dynamic_integer_points_kd_tree_decoder.h"
+#include "draco/compression/point_cloud/algorithms/dynamic_integer_points_kd_tree_encoder.h"
 #include "draco/compression/point_cloud/point_cloud_kd_tree_decoder.h"
 #include "draco/compression/point_cloud/point_cloud_kd_tree_encoder.h"
 #include "draco/core/draco_test_base.h"
@@ -82,6 +87,35 @@ class PointCloudKdTreeEncodingTest : public ::testing::Test {
     }
   }
 
+  // Creates a point cloud with |num_points| pseudo-random positions and a
+  // generic attribute. The position components are generated in range
+  // [0, 10000) and stored as value / |pos_divisor| + |pos_offset|. The generic
+  // value of point i is i % 1000 + |gen_offset|.
+  template <typename PosT, typename GenT>
+  std::unique_ptr<PointCloud> CreateRandomPointCloud(
+      int num_points, DataType pos_type, PosT pos_divisor, PosT pos_offset,
+      DataType gen_type, GenT gen_offset) const {
+    PointCloudBuilder builder;
+    builder.Start(num_points);
+    const int pos_att_id =
+        builder.AddAttribute(GeometryAttribute::POSITION, 3, pos_type);
+    const int gen_att_id =
+        builder.AddAttribute(GeometryAttribute::GENERIC, 1, gen_type);
+    uint32_t seed = 1;
+    for (PointIndex i(0); i < num_points; ++i) {
+      std::array<PosT, 3> pos;
+      for (int c = 0; c < 3; ++c) {
+        seed = seed * 1103515245 + 12345;
+        pos[c] = static_cast<PosT>((seed >> 8) % 10000) / pos_divisor +
+                 pos_offset;
+      }
+      const GenT value = static_cast<GenT>(i.value() % 1000 + gen_offset);
+      builder.SetAttributeValueForPoint(pos_att_id, i, &pos[0]);
+      builder.SetAttributeValueForPoint(gen_att_id, i, &value);
+    }
+    return builder.Finalize(false);
+  }
+
   void TestFloatEncoding(const std::string &file_name) {
     std::unique_ptr<PointCloud> pc = ReadPointCloudFromTestFile(file_name);
     ASSERT_NE(pc, nullptr);
@@ -453,4 +487,213 @@ TEST_F(PointCloudKdTreeEncodingTest, TestIntKdTreeEncodingHighDimensional) {
   TestKdTreeEncoding(*pc);
 }
 
+// Test encoding of subtrees into independent streams.
+TEST_F(PointCloudKdTreeEncodingTest, TestKdTreeSubtreeStreams) {
+  const std::unique_ptr<PointCloud> pc =
+      CreateRandomPointCloud<uint32_t, uint16_t>(5000, DT_UINT32, 1, 0,
+                                                 DT_UINT16, 0);
+  ASSERT_NE(pc, nullptr);
+
+  for (int subtree_depth : {0, 3, 12}) {
+    EncoderBuffer buffers[2];
+    for (int t = 0; t < 2; ++t) {
+      EncoderOptions options = EncoderOptions::CreateDefaultOptions();
+      options.SetGlobalInt("kd_tree_subtree_depth", subtree_depth);
+      options.SetGlobalInt("num_threads", t == 0 ? 1 : 4);
+      PointCloudKdTreeEncoder encoder;
+      encoder.SetPointCloud(*pc);
+      ASSERT_TRUE(encoder.Encode(options, &buffers[t]).ok());
+    }
+    // The encoded data must not depend on the number of threads.
+    ASSERT_EQ(buffers[0].size(), buffers[1].size());
+    ASSERT_EQ(memcmp(buffers[0].data(), buffers[1].data(), buffers[0].size()),
+              0);
+    // Minor version is stored right after the "DRACO" string and the major
+    // version. The latest version is needed only for the subtree streams.
+    ASSERT_EQ(buffers[0].data()[6] == kDracoPointCloudBitstreamVersionMinor,
+              subtree_depth > 0);
+
+    for (int num_threads : {1, 4}) {
+      DecoderBuffer dec_buffer;
+      dec_buffer.Init(buffers[0].data(), buffers[0].size());
+      PointCloudKdTreeDecoder decoder;
+      std::unique_ptr<PointCloud> out_pc(new PointCloud());
+      DecoderOptions dec_options;
+      dec_options.SetGlobalInt("num_threads", num_threads);
+      ASSERT_TRUE(decoder.Decode(dec_options, &dec_buffer, out_pc.get()).ok());
+      ComparePointClouds(*pc, *out_pc);
+    }
+  }
+}
+
+// Output iterator using the pointer contract of the kd-tree decoder.
+class PointPointerOutputIterator {
+ public:
+  explicit PointPointerOutputIterator(std::vector<std::vector<uint32_t>> *out,
+                                      uint32_t dimension)
+      : out_(out), dimension_(dimension) {}
+  PointPointerOutputIterator &operator++() { return *this; }
+  PointPointerOutputIterator operator++(int) { return *this; }
+  PointPointerOutputIterator &operator*() { return *this; }
+  PointPointerOutputIterator &operator=(const uint32_t *point) {
+    out_->emplace_back(point, point + dimension_);
+    return *this;
+  }
+
+ private:
+  std::vector<std::vector<uint32_t>> *out_;
+  uint32_t dimension_;
+};
+
+// Tests that the kd-tree decoder still accepts output iterators that take the
+// points as std::vector<uint32_t>.
+TEST_F(PointCloudKdTreeEncodingTest, TestKdTreeDecoderVectorOutputIterator) {
+  const uint32_t dimension = 3;
+  std::vector<std::vector<uint32_t>> points(2000,
+                                            std::vector<uint32_t>(dimension));
+  for (size_t i = 0; i < points.size(); ++i) {
+    for (uint32_t c = 0; c < dimension; ++c) {
+      points[i][c] = static_cast<uint32_t>((i * 7919 + c * 104729) % 1024);
+    }
+  }
+  std::sort(points.begin(), points.end());
+
+  ThreadPool pool(4);
+  for (uint32_t subtree_depth : {0, 3}) {
+    DynamicIntegerPointsKdTreeEncoder<2> encoder(dimension);
+    encoder.set_subtree_depth(subtree_depth);
+    EncoderBuffer buffer;
+    // The encoder reorders the points in place.
+    std::vector<std::vector<uint32_t>> encoded_points = points;
+    ASSERT_TRUE(encoder.EncodePoints(encoded_points.begin(),
+                                     encoded_points.end(), 10, &buffer));
+
+    std::vector<std::vector<uint32_t>> vector_points;
+    DecoderBuffer dec_buffer;
+    dec_buffer.Init(buffer.data(), buffer.size(),
+                    kDracoPointCloudBitstreamVersion);
+    DynamicIntegerPointsKdTreeDecoder<2> vector_decoder(dimension);
+    vector_decoder.set_subtree_depth(subtree_depth);
+    vector_decoder.set_thread_pool(&pool);
+    ASSERT_TRUE(vector_decoder.DecodePoints(
+        &dec_buffer, std::back_inserter(vector_points)));
+
+    std::vector<std::vector<uint32_t>> pointer_points;
+    dec_buffer.Init(buffer.data(), buffer.size(),
+                    kDracoPointCloudBitstreamVersion);
+    DynamicIntegerPointsKdTreeDecoder<2> pointer_decoder(dimension);
+    pointer_decoder.set_subtree_depth(subtree_depth);
+    pointer_decoder.set_thread_pool(&pool);
+    ASSERT_TRUE(pointer_decoder.DecodePoints(
+        &dec_buffer, PointPointerOutputIterator(&pointer_points, dimension)));
+
+    // Both contracts output the same points in the same order.
+    ASSERT_EQ(vector_points, pointer_points);
+    std::sort(vector_points.begin(), vector_points.end());
+    ASSERT_EQ(vector_points, points);
+  }
+}
+
+TEST_F(PointCloudKdTreeEncodingTest, TestQueryBox) {
+  constexpr int num_points = 5000;
+  const std::unique_ptr<PointCloud> pc = CreateRandomPointCloud<float, int16_t>(
+      num_points, DT_FLOAT32, 100.f, -50.f, DT_INT16, -500);
+  ASSERT_NE(pc, nullptr);
+
+  // Query boxes given as {position min, position max, generic min, generic
+  // max}. Empty vectors are not set.
+  const std::vector<std::vector<std::vector<float>>> queries = {
+      {{-20.f, -10.5f, 0.f}, {10.f, 30.f, 49.f}, {}, {}},
+      {{-20.f}, {-12.25f}, {}, {}},
+      {{}, {}, {-100.f}, {200.f}},
+      {{0.f, 0.f, 0.f}, {25.f, 25.f, 25.f}, {0.f}, {1000.f}},
+      {{60.f, 0.f, 0.f}, {70.f, 0.f, 0.f}, {}, {}},
+  };
+  for (int subtree_depth : {0, 6}) {
+    EncoderOptions options = EncoderOptions::CreateDefaultOptions();
+    options.SetAttributeInt(GeometryAttribute::POSITION, "quantization_bits",
+                            12);
+    options.SetGlobalInt("kd_tree_subtree_depth", subtree_depth);
+    PointCloudKdTreeEncoder encoder;
+    encoder.SetPointCloud(*pc);
+    EncoderBuffer buffer;
+    ASSERT_TRUE(encoder.Encode(options, &buffer).ok());
+
+    const auto decode = [&](const DecoderOptions &dec_options) {
+      DecoderBuffer dec_buffer;
+      dec_buffer.Init(buffer.data(), buffer.size());
+      PointCloudKdTreeDecoder decoder;
+      std::unique_ptr<PointCloud> out_pc(new PointCloud());
+      if (!decoder.Decode(dec_options, &dec_buffer, out_pc.get()).ok())
+        return std::unique_ptr<PointCloud>();
+      return out_pc;
+    };
+    const std::unique_ptr<PointCloud> full_pc = decode(DecoderOptions());
+    ASSERT_NE(full_pc, nullptr);
+    ASSERT_EQ(full_pc->num_points(), num_points);
+
+    for (const auto &query : queries) {
+      DecoderOptions dec_options;
+      const GeometryAttribute::Type types[2] = {GeometryAttribute::POSITION,
+                                                GeometryAttribute::GENERIC};
+      for (int t = 0; t < 2; ++t) {
+        if (!query[2 * t].empty()) {
+          dec_options.SetAttributeVector(
+              types[t], "query_box_min",
+              static_cast<int>(query[2 * t].size()), query[2 * t].data());
+          dec_options.SetAttributeVector(
+              types[t], "query_box_max",
+              static_cast<int>(query[2 * t + 1].size()),
+              query[2 * t + 1].data());
+        }
+      }
+      const std::unique_ptr<PointCloud> box_pc = decode(dec_options);
+      ASSERT_NE(box_pc, nullptr);
+
+      // Filter the fully decoded points and compare them with the result of
+      // the query.
+      PointCloudBuilder expected_builder;
+      std::vector<std::array<float, 3>> expected_pos;
+      std::vector<int16_t> expected_gen;
+      for (PointIndex i(0); i < full_pc->num_points(); ++i) {
+        std::array<float, 3> pos;
+        int16_t value;
+        full_pc->attribute(0)->GetMappedValue(i, &pos[0]);
+        full_pc->attribute(1)->GetMappedValue(i, &value);
+        const float values[4] = {pos[0], pos[1], pos[2],
+                                 static_cast<float>(value)};
+        bool inside = true;
+        for (int t = 0; t < 2; ++t) {
+          for (size_t c = 0; c < query[2 * t].size(); ++c) {
+            const float v = values[t == 0 ? c : 3];
+            inside &= v >= query[2 * t][c] && v <= query[2 * t + 1][c];
+          }
+        }
+        if (inside) {
+          expected_pos.push_back(pos);
+          expected_gen.push_back(value);
+        }
+      }
+      ASSERT_EQ(box_pc->num_points(), expected_pos.size());
+      if (expected_pos.empty())
+        continue;
+      expected_builder.Start(static_cast<PointIndex::ValueType>(
+          expected_pos.size()));
+      expected_builder.AddAttribute(GeometryAttribute::POSITION, 3,
+                                    DT_FLOAT32);
+      expected_builder.AddAttribute(GeometryAttribute::GENERIC, 1, DT_INT16);
+      for (PointIndex i(0); i < expected_pos.size(); ++i) {
+        expected_builder.SetAttributeValueForPoint(0, i,
+                                                   &expected_pos[i.value()]);
+        expected_builder.SetAttributeValueForPoint(1, i,
+                                                   &expected_gen[i.value()]);
+      }
+      std::unique_ptr<PointCloud> expected_pc =
+          expected_builder.Finalize(false);
+      ASSERT_NE(expected_pc, nullptr);
+      ComparePointClouds(*expected_pc, *box_pc);
+    }
+  }
+}
+
 }  // namespace draco
@@ -17,6 +17,7 @@
 #include "draco/core/draco_test_base.h"
 #include "draco/core/draco_test_utils.h"
 #include "draco/io/obj_decoder.h"
+#include "draco/point_cloud/point_cloud_builder.h"
 
 namespace draco {
 
@@ -84,6 +85,57 @@ TEST_F(PointCloudSequentialEncodingTest, EncodingPointCloudWithMetadata) {
             pc->attribute(pos_att_id)->unique_id());
 }
 
+// Tests that only the attributes selected by their ids are kept in the portable
+// form, even when other attributes have the same type.
+TEST_F(PointCloudSequentialEncodingTest, PortableOnlyAttributes) {
+  const int num_points = 100;
+  PointCloudBuilder builder;
+  builder.Start(num_points);
+  const int att_ids[2] = {
+      builder.AddAttribute(GeometryAttribute::TEX_COORD, 2, DT_FLOAT32),
+      builder.AddAttribute(GeometryAttribute::TEX_COORD, 2, DT_FLOAT32)};
+  for (PointIndex i(0); i < num_points; ++i) {
+    for (int a = 0; a < 2; ++a) {
+      const float value[2] = {i.value() / 100.f, (a + 1) * i.value() / 200.f};
+      builder.SetAttributeValueForPoint(att_ids[a], i, value);
+    }
+  }
+  std::unique_ptr<PointCloud> pc = builder.Finalize(false);
+  ASSERT_NE(pc, nullptr);
+
+  EncoderBuffer buffer;
+  PointCloudSequentialEncoder encoder;
+  EncoderOptions options = EncoderOptions::CreateDefaultOptions();
+  options.SetGlobalInt("quantization_bits", 10);
+  encoder.SetPointCloud(*pc);
+  ASSERT_TRUE(encoder.Encode(options, &buffer).ok());
+
+  DecoderBuffer dec_buffer;
+  dec_buffer.Init(buffer.data(), buffer.size());
+  PointCloudSequentialDecoder decoder;
+  decoder.set_portable_only_attribute_ids({att_ids[1]});
+  PointCloud out_pc;
+  DecoderOptions dec_options;
+  ASSERT_TRUE(decoder.Decode(dec_options, &dec_buffer, &out_pc).ok());
+
+  // The first attribute is dequantized as usual.
+  const PointAttribute *const att = out_pc.attribute(att_ids[0]);
+  ASSERT_EQ(att->data_type(), DT_FLOAT32);
+  ASSERT_EQ(att->GetAttributeTransformData(), nullptr);
+  for (PointIndex i(0); i < num_points; ++i) {
+    float value[2];
+    ASSERT_TRUE(att->ConvertValue<float>(att->mapped_index(i), value));
+    ASSERT_NEAR(value[0], i.value() / 100.f, 1e-2f);
+  }
+  // The second attribute is available only in the portable form.
+  const PointAttribute *const portable_att =
+      decoder.GetPortableAttribute(att_ids[1]);
+  ASSERT_NE(portable_att, nullptr);
+  ASSERT_NE(portable_att->GetAttributeTransformData(), nullptr);
+  ASSERT_EQ(out_pc.attribute(att_ids[1])->GetAttributeTransformData(),
+            nullptr);
+}
+
 // TODO(ostava): Test the reusability of a single instance of the encoder and
 // decoder class.
 
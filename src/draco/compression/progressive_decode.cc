@@ -0,0 +1,157 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/progressive_decode.h"
+
+#include <cstring>
+
+#include "draco/core/varint_decoding.h"
+
+namespace draco {
+
+namespace {
+
+// Upper bound on the size of a single level used to reject corrupted input.
+constexpr uint64_t kMaxLevelSize = static_cast<uint64_t>(1) << 48;
+
+}  // namespace
+
+ProgressiveMeshDecoder::ProgressiveMeshDecoder()
+    : data_offset_(0), index_decoded_(false), finished_(false) {}
+
+Status ProgressiveMeshDecoder::AppendData(const char *data, size_t data_size) {
+  if (finished_) {
+    return Status(Status::DRACO_ERROR, "Decoding was already finished.");
+  }
+  if (!IsDone()) {
+    data_.insert(data_.end(), data, data + data_size);
+  }
+  return DecodeAvailableLevels();
+}
+
+Status ProgressiveMeshDecoder::Finish() {
+  finished_ = true;
+  return DecodeAvailableLevels();
+}
+
+StatusOr<std::unique_ptr<Mesh>> ProgressiveMeshDecoder::ReleaseMesh() {
+  if (!error_status_.ok()) {
+    return error_status_;
+  }
+  if (decoded_levels_.empty()) {
+    return Status(Status::NEED_MORE_DATA, "No level was decoded yet.");
+  }
+  std::unique_ptr<Mesh> mesh = std::move(decoded_levels_.back());
+  decoded_levels_.clear();
+  data_.clear();
+  error_status_ = Status(Status::DRACO_ERROR, "Mesh was already released.");
+  return std::move(mesh);
+}
+
+Status ProgressiveMeshDecoder::DecodeAvailableLevels() {
+  if (!error_status_.ok()) {
+    return error_status_;
+  }
+  if (!index_decoded_) {
+    const Status status = DecodeLevelIndex();
+    if (!status.ok()) {
+      if (status.code() != Status::NEED_MORE_DATA) {
+        error_status_ = status;
+      } else if (finished_) {
+        error_status_ =
+            Status(Status::IO_ERROR, "Progressive mesh data is truncated.");
+      } else {
+        return status;
+      }
+      return error_status_;
+    }
+  }
+  while (num_decoded_levels() < num_levels()) {
+    const ProgressiveMeshLevelInfo &level = levels_[num_decoded_levels()];
+    const int64_t level_start =
+        static_cast<int64_t>(level.offset) - data_offset_;
+    const int64_t level_end = level_start + static_cast<int64_t>(level.size);
+    if (level_end > static_cast<int64_t>(data_.size())) {
+      if (finished_) {
+        error_status_ =
+            Status(Status::IO_ERROR, "Progressive mesh data is truncated.");
+        return error_status_;
+      }
+      return Status(Status::NEED_MORE_DATA, "Waiting for more input data.");
+    }
+    DecoderBuffer buffer;
+    buffer.Init(data_.data() + level_start, level.size);
+    StatusOr<std::unique_ptr<Mesh>> mesh_or =
+        decoder_.DecodeMeshFromBuffer(&buffer);
+    if (!mesh_or.ok()) {
+      error_status_ = mesh_or.status();
+      return error_status_;
+    }
+    decoded_levels_.push_back(std::move(mesh_or).value());
+    // Release the data of the decoded level.
+    data_.erase(data_.begin(), data_.begin() + level_end);
+    data_offset_ += level_end;
+  }
+  return OkStatus();
+}
+
+Status ProgressiveMeshDecoder::DecodeLevelIndex() {
+  DecoderBuffer buffer;
+  buffer.Init(data_.data(), data_.size());
+  char magic[kProgressiveMeshMagicLength];
+  if (!buffer.Decode(magic, kProgressiveMeshMagicLength)) {
+    return Status(Status::NEED_MORE_DATA, "Waiting for more input data.");
+  }
+  if (memcmp(magic, kProgressiveMeshMagic, kProgressiveMeshMagicLength) != 0) {
+    return Status(Status::DRACO_ERROR, "Not a progressive Draco mesh.");
+  }
+  uint8_t version_major, version_minor;
+  uint16_t flags;
+  if (!buffer.Decode(&version_major) || !buffer.Decode(&version_minor) ||
+      !buffer.Decode(&flags)) {
+    return Status(Status::NEED_MORE_DATA, "Waiting for more input data.");
+  }
+  if (version_major != kProgressiveMeshVersionMajor) {
+    return Status(Status::UNSUPPORTED_VERSION,
+                  "Unsupported progressive mesh version.");
+  }
+  uint32_t num_levels;
+  if (!DecodeVarint(&num_levels, &buffer)) {
+    return Status(Status::NEED_MORE_DATA, "Waiting for more input data.");
+  }
+  if (num_levels == 0 || num_levels > 64) {
+    return Status(Status::DRACO_ERROR, "Invalid number of levels.");
+  }
+  std::vector<ProgressiveMeshLevelInfo> levels(num_levels);
+  uint64_t offset = 0;
+  for (ProgressiveMeshLevelInfo &level : levels) {
+    if (!DecodeVarint(&level.num_faces, &buffer) ||
+        !DecodeVarint(&level.size, &buffer)) {
+      return Status(Status::NEED_MORE_DATA, "Waiting for more input data.");
+    }
+    if (level.size > kMaxLevelSize) {
+      return Status(Status::DRACO_ERROR, "Invalid level size.");
+    }
+    level.offset = offset;
+    offset += level.size;
+  }
+  levels_ = std::move(levels);
+  index_decoded_ = true;
+  // Only the data of the levels is kept.
+  data_.erase(data_.begin(), data_.begin() + buffer.decoded_size());
+  data_offset_ = 0;
+  return OkStatus();
+}
+
+}  // namespace draco
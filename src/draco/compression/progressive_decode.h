@@ -0,0 +1,126 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_COMPRESSION_PROGRESSIVE_DECODE_H_
+#define DRACO_COMPRESSION_PROGRESSIVE_DECODE_H_
+
+#include <memory>
+#include <vector>
+
+#include "draco/compression/decode.h"
+#include "draco/compression/progressive_mesh_shared.h"
+#include "draco/core/macros.h"
+
+namespace draco {
+
+// Decoder for meshes encoded with ProgressiveMeshEncoder whose data arrives in
+// multiple chunks. Each level of detail is decoded as soon as all of its data
+// is available, so the coarsest level can be shown after receiving only a
+// small part of the input.
+//
+// Example:
+//
+//   ProgressiveMeshDecoder decoder;
+//   while (ReceiveChunk(&chunk)) {
+//     const int num_levels = decoder.num_decoded_levels();
+//     const Status status = decoder.AppendData(chunk.data(), chunk.size());
+//     if (status.code() != Status::NEED_MORE_DATA && !status.ok())
+//       ...  // Handle error.
+//     if (decoder.num_decoded_levels() > num_levels)
+//       Render(*decoder.mesh());  // Show the finest available level.
+//   }
+//   DRACO_RETURN_IF_ERROR(decoder.Finish());
+//
+// The appended data is released as soon as the level it belongs to is
+// decoded. All decoded levels are kept until the decoder is destroyed or
+// until ReleaseMesh() is called.
+class ProgressiveMeshDecoder {
+ public:
+  ProgressiveMeshDecoder();
+
+  // Appends |data_size| bytes of encoded data and decodes all levels for which
+  // all data is available. Returns OkStatus() when all levels were decoded,
+  // Status::NEED_MORE_DATA when more data is needed, or an error status when
+  // the input is invalid. Data appended after the last level is ignored.
+  Status AppendData(const char *data, size_t data_size);
+
+  // Signals that no more data is going to be appended. Returns an error when
+  // the appended data does not contain all levels.
+  Status Finish();
+
+  // Returns true when all levels were decoded.
+  bool IsDone() const {
+    return index_decoded_ && num_decoded_levels() == num_levels();
+  }
+
+  // Returns the number of levels of detail or 0 if the level index was not
+  // decoded yet.
+  int num_levels() const { return static_cast<int>(levels_.size()); }
+  const ProgressiveMeshLevelInfo &level_info(int i) const {
+    return levels_[i];
+  }
+
+  // Returns the number of decoded levels. Levels are decoded from the
+  // coarsest to the finest.
+  int num_decoded_levels() const {
+    return static_cast<int>(decoded_levels_.size());
+  }
+
+  // Returns the decoded level |i|.
+  const Mesh *level(int i) const { return decoded_levels_[i].get(); }
+
+  // Returns the finest decoded level or nullptr if no level was decoded yet.
+  const Mesh *mesh() const {
+    return decoded_levels_.empty() ? nullptr : decoded_levels_.back().get();
+  }
+
+  // Returns the finest decoded level. All decoded levels are released and the
+  // decoder can't be used anymore.
+  StatusOr<std::unique_ptr<Mesh>> ReleaseMesh();
+
+  // Returns the options used for decoding. The options must be set before any
+  // data is appended.
+  DecoderOptions *options() { return decoder_.options(); }
+
+ private:
+  // Decodes the container header and the level index. Returns
+  // Status::NEED_MORE_DATA when the index is not complete.
+  Status DecodeLevelIndex();
+
+  // Decodes all levels for which there is enough data.
+  Status DecodeAvailableLevels();
+
+  Decoder decoder_;
+
+  // Appended data that was not released yet. |data_offset_| is the position
+  // of the first byte of |data_| in the input relative to the end of the level
+  // index.
+  std::vector<char> data_;
+  int64_t data_offset_;
+
+  bool index_decoded_;
+  bool finished_;
+  std::vector<ProgressiveMeshLevelInfo> levels_;
+  std::vector<std::unique_ptr<Mesh>> decoded_levels_;
+
+  // Set when the decoding failed with an error that can't be recovered by
+  // adding more data.
+  Status error_status_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProgressiveMeshDecoder);
+};
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_PROGRESSIVE_DECODE_H_
@@ -0,0 +1,128 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/progressive_encode.h"
+
+#include "draco/core/thread_pool.h"
+#include "draco/core/tracer.h"
+#include "draco/core/varint_encoding.h"
+#include "draco/mesh/mesh_clustering_simplifier.h"
+
+namespace draco {
+
+ProgressiveMeshEncoder::ProgressiveMeshEncoder()
+    : num_levels_(3), level_reduction_factor_(4) {}
+
+Status ProgressiveMeshEncoder::EncodePointCloudToBuffer(
+    const PointCloud &pc, EncoderBuffer *out_buffer) {
+  return Status(Status::DRACO_ERROR,
+                "Only meshes can be encoded progressively.");
+}
+
+Status ProgressiveMeshEncoder::EncodeMeshToBuffer(const Mesh &m,
+                                                  EncoderBuffer *out_buffer) {
+  if (num_levels_ < 1 || level_reduction_factor_ < 2) {
+    return Status(Status::DRACO_ERROR, "Invalid level of detail settings.");
+  }
+  if (m.num_faces() == 0) {
+    return Status(Status::DRACO_ERROR, "Mesh has no faces.");
+  }
+  MeshClusteringSimplifier simplifier;
+  if (!simplifier.Init(m)) {
+    return Status(Status::DRACO_ERROR,
+                  "Progressive encoding requires a 3D position attribute.");
+  }
+  set_num_encoded_points(0);
+  set_num_encoded_faces(0);
+
+  // Maximum number of faces of each level from the coarsest to the finest.
+  std::vector<int> max_level_faces(num_levels_);
+  max_level_faces[num_levels_ - 1] = m.num_faces();
+  for (int i = num_levels_ - 2; i >= 0; --i) {
+    max_level_faces[i] = max_level_faces[i + 1] / level_reduction_factor_;
+  }
+
+  // Levels are simplified and encoded in parallel, each of them on a single
+  // thread.
+  EncoderOptionsBase<GeometryAttribute::Type> level_options = options();
+  level_options.SetGlobalInt("num_threads", 1);
+  const int num_threads = options().GetGlobalInt("num_threads", 1);
+  std::unique_ptr<ThreadPool> pool;
+  if (num_threads > 1) {
+    pool.reset(new ThreadPool(num_threads - 1));
+  }
+  std::vector<EncoderBuffer> level_buffers(num_levels_);
+  std::vector<int> level_num_faces(num_levels_, 0);
+  std::vector<Status> level_statuses(num_levels_);
+  size_t num_encoded_points = 0;
+  size_t num_encoded_faces = 0;
+  ParallelFor(pool.get(), num_levels_, [&](int i) {
+    std::unique_ptr<Mesh> simplified_mesh;
+    const Mesh *level_mesh = &m;
+    if (i < num_levels_ - 1) {
+      TraceScope trace(options().GetTracer(),
+                       "ProgressiveMeshEncoder::Simplify");
+      simplified_mesh = simplifier.SimplifyToFaceCount(max_level_faces[i]);
+      level_mesh = simplified_mesh.get();
+      if (level_mesh->num_faces() == 0) {
+        return true;
+      }
+    }
+    level_num_faces[i] = level_mesh->num_faces();
+    Encoder encoder;
+    encoder.Reset(level_options);
+    level_statuses[i] =
+        encoder.EncodeMeshToBuffer(*level_mesh, &level_buffers[i]);
+    if (i == num_levels_ - 1) {
+      num_encoded_points = encoder.num_encoded_points();
+      num_encoded_faces = encoder.num_encoded_faces();
+    }
+    return level_statuses[i].ok();
+  });
+  levels_.clear();
+  for (int i = 0; i < num_levels_; ++i) {
+    DRACO_RETURN_IF_ERROR(level_statuses[i]);
+    if (level_num_faces[i] > 0) {
+      levels_.push_back(ProgressiveMeshLevelInfo());
+      levels_.back().num_faces = level_num_faces[i];
+      levels_.back().size = level_buffers[i].size();
+    }
+  }
+
+  // Write the container header and the level index.
+  out_buffer->Encode(kProgressiveMeshMagic, kProgressiveMeshMagicLength);
+  out_buffer->Encode(kProgressiveMeshVersionMajor);
+  out_buffer->Encode(kProgressiveMeshVersionMinor);
+  const uint16_t flags = 0;
+  out_buffer->Encode(flags);
+  EncodeVarint(static_cast<uint32_t>(levels_.size()), out_buffer);
+  uint64_t offset = 0;
+  for (ProgressiveMeshLevelInfo &level : levels_) {
+    EncodeVarint(level.num_faces, out_buffer);
+    EncodeVarint(level.size, out_buffer);
+    level.offset = offset;
+    offset += level.size;
+  }
+  for (int i = 0; i < num_levels_; ++i) {
+    if (level_num_faces[i] > 0) {
+      out_buffer->Encode(level_buffers[i].data(), level_buffers[i].size());
+    }
+  }
+  // Only the finest level is reported as it contains the input mesh.
+  set_num_encoded_points(num_encoded_points);
+  set_num_encoded_faces(num_encoded_faces);
+  return OkStatus();
+}
+
+}  // namespace draco
@@ -0,0 +1,79 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_COMPRESSION_PROGRESSIVE_ENCODE_H_
+#define DRACO_COMPRESSION_PROGRESSIVE_ENCODE_H_
+
+#include <vector>
+
+#include "draco/compression/encode.h"
+#include "draco/compression/progressive_mesh_shared.h"
+
+namespace draco {
+
+// Encoder that stores a mesh together with its coarser levels of detail in the
+// progressive mesh container described in progressive_mesh_shared.h. The
+// coarse levels are generated with MeshClusteringSimplifier and they are
+// stored before the input mesh, so that a ProgressiveMeshDecoder can show a
+// coarse approximation after receiving only a small part of the data.
+//
+// Each level is encoded with all options of the Encoder. The global option
+// "num_threads" (see SetNumThreads()) sets the number of levels that are
+// simplified and encoded at the same time.
+//
+// Example:
+//
+//   ProgressiveMeshEncoder encoder;
+//   encoder.SetAttributeQuantization(GeometryAttribute::POSITION, 14);
+//   encoder.SetNumLevels(3);
+//   EncoderBuffer buffer;
+//   const Status status = encoder.EncodeMeshToBuffer(mesh, &buffer);
+//
+class ProgressiveMeshEncoder : public Encoder {
+ public:
+  ProgressiveMeshEncoder();
+
+  // Only meshes can be encoded progressively. Always returns an error.
+  Status EncodePointCloudToBuffer(const PointCloud &pc,
+                                  EncoderBuffer *out_buffer) override;
+
+  // Encodes the levels of detail of mesh |m| into |out_buffer|. The mesh must
+  // have a position attribute with three components. Levels that would not
+  // contain any face are omitted.
+  Status EncodeMeshToBuffer(const Mesh &m, EncoderBuffer *out_buffer) override;
+
+  // Sets the maximum number of levels including the input mesh (default = 3).
+  void SetNumLevels(int num_levels) { num_levels_ = num_levels; }
+  int num_levels() const { return num_levels_; }
+
+  // Sets the ratio between the number of faces of two consecutive levels
+  // (default = 4). Each level has at most 1 / |factor| faces of the next finer
+  // level.
+  void SetLevelReductionFactor(int factor) { level_reduction_factor_ = factor; }
+  int level_reduction_factor() const { return level_reduction_factor_; }
+
+  // Returns the level index of the last encoded mesh.
+  const std::vector<ProgressiveMeshLevelInfo> &levels() const {
+    return levels_;
+  }
+
+ private:
+  int num_levels_;
+  int level_reduction_factor_;
+  std::vector<ProgressiveMeshLevelInfo> levels_;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_PROGRESSIVE_ENCODE_H_
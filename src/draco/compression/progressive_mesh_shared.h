@@ -0,0 +1,54 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_COMPRESSION_PROGRESSIVE_MESH_SHARED_H_
+#define DRACO_COMPRESSION_PROGRESSIVE_MESH_SHARED_H_
+
+#include <cstdint>
+
+namespace draco {
+
+// Layout of the progressive mesh container produced by
+// ProgressiveMeshEncoder. The container stores levels of detail of a mesh
+// ordered from the coarsest to the finest one. Each level is a regular,
+// independently decodable Draco mesh and the last level is the input mesh.
+// The container is defined as:
+//
+//   "DPROG"                        5 bytes
+//   version major, version minor   2 x uint8_t
+//   flags (reserved)               uint16_t
+//   number of levels               varint
+//   for each level:
+//     number of faces              varint
+//     size of the encoded level    varint
+//   encoded data of all levels in the order of the level index
+//
+static constexpr char kProgressiveMeshMagic[] = "DPROG";
+static constexpr int kProgressiveMeshMagicLength = 5;
+static constexpr uint8_t kProgressiveMeshVersionMajor = 1;
+static constexpr uint8_t kProgressiveMeshVersionMinor = 0;
+
+// Entry of the level index.
+struct ProgressiveMeshLevelInfo {
+  ProgressiveMeshLevelInfo() : num_faces(0), offset(0), size(0) {}
+
+  uint32_t num_faces;
+  // Location of the encoded level relative to the end of the level index.
+  uint64_t offset;
+  uint64_t size;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_PROGRESSIVE_MESH_SHARED_H_
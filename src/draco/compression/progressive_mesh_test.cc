@@ -0,0 +1,109 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/progressive_decode.h"
+#include "draco/compression/progressive_encode.h"
+
+#include <algorithm>
+
+#include "draco/core/draco_test_base.h"
+#include "draco/core/draco_test_utils.h"
+
+namespace {
+
+class ProgressiveMeshTest : public ::testing::Test {
+ protected:
+  void Encode(const draco::Mesh &mesh, int num_threads,
+              draco::ProgressiveMeshEncoder *encoder,
+              draco::EncoderBuffer *buffer) const {
+    encoder->SetAttributeQuantization(draco::GeometryAttribute::POSITION, 14);
+    encoder->SetNumThreads(num_threads);
+    ASSERT_TRUE(encoder->EncodeMeshToBuffer(mesh, buffer).ok());
+  }
+};
+
+TEST_F(ProgressiveMeshTest, TestLevelsDecodedProgressively) {
+  const std::unique_ptr<draco::Mesh> mesh(
+      draco::ReadMeshFromTestFile("bun_zipper.ply"));
+  ASSERT_NE(mesh, nullptr);
+  draco::ProgressiveMeshEncoder encoder;
+  draco::EncoderBuffer buffer;
+  Encode(*mesh, 1, &encoder, &buffer);
+  ASSERT_EQ(encoder.levels().size(), 3u);
+  ASSERT_EQ(encoder.levels().back().num_faces, mesh->num_faces());
+  for (size_t i = 1; i < encoder.levels().size(); ++i) {
+    ASSERT_LE(encoder.levels()[i - 1].num_faces * 4,
+              encoder.levels()[i].num_faces);
+  }
+  // The coarsest level takes only a small part of the data.
+  ASSERT_LT(encoder.levels()[0].size * 10, buffer.size());
+
+  // Feed the decoder in small chunks and verify that each level becomes
+  // available as soon as its data was received.
+  draco::ProgressiveMeshDecoder decoder;
+  const size_t chunk_size = 1000;
+  std::vector<size_t> level_decoded_at;
+  draco::Status status(draco::Status::NEED_MORE_DATA);
+  for (size_t pos = 0; pos < buffer.size(); pos += chunk_size) {
+    const size_t size = std::min(chunk_size, buffer.size() - pos);
+    const int num_levels = decoder.num_decoded_levels();
+    status = decoder.AppendData(buffer.data() + pos, size);
+    if (decoder.num_decoded_levels() > num_levels) {
+      ASSERT_EQ(decoder.mesh()->num_faces(),
+                decoder.level_info(decoder.num_decoded_levels() - 1).num_faces);
+      level_decoded_at.push_back(pos + size);
+    }
+  }
+  ASSERT_TRUE(status.ok()) << status.error_msg();
+  ASSERT_TRUE(decoder.Finish().ok());
+  ASSERT_TRUE(decoder.IsDone());
+  ASSERT_EQ(decoder.num_decoded_levels(), 3);
+  ASSERT_EQ(level_decoded_at.size(), 3u);
+  ASSERT_LT(level_decoded_at[0], buffer.size() / 5);
+
+  auto mesh_or = decoder.ReleaseMesh();
+  ASSERT_TRUE(mesh_or.ok());
+  ASSERT_EQ(mesh_or.value()->num_faces(), mesh->num_faces());
+}
+
+TEST_F(ProgressiveMeshTest, TestDeterministicThreading) {
+  const std::unique_ptr<draco::Mesh> mesh(
+      draco::ReadMeshFromTestFile("test_nm.obj"));
+  ASSERT_NE(mesh, nullptr);
+  draco::ProgressiveMeshEncoder encoder;
+  draco::EncoderBuffer buffer;
+  Encode(*mesh, 1, &encoder, &buffer);
+  draco::ProgressiveMeshEncoder mt_encoder;
+  draco::EncoderBuffer mt_buffer;
+  Encode(*mesh, 3, &mt_encoder, &mt_buffer);
+  ASSERT_EQ(buffer.size(), mt_buffer.size());
+  ASSERT_EQ(memcmp(buffer.data(), mt_buffer.data(), buffer.size()), 0);
+}
+
+TEST_F(ProgressiveMeshTest, TestTruncatedInput) {
+  const std::unique_ptr<draco::Mesh> mesh(
+      draco::ReadMeshFromTestFile("test_nm.obj"));
+  ASSERT_NE(mesh, nullptr);
+  draco::ProgressiveMeshEncoder encoder;
+  draco::EncoderBuffer buffer;
+  Encode(*mesh, 1, &encoder, &buffer);
+
+  draco::ProgressiveMeshDecoder decoder;
+  ASSERT_EQ(decoder.AppendData(buffer.data(), buffer.size() - 1).code(),
+            draco::Status::NEED_MORE_DATA);
+  ASSERT_FALSE(decoder.Finish().ok());
+  ASSERT_FALSE(decoder.IsDone());
+}
+
+}  // namespace
@@ -0,0 +1,145 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/streaming_decode.h"
+
+#include <algorithm>
+
+#ifdef DRACO_MESH_COMPRESSION_SUPPORTED
+#include "draco/compression/mesh/mesh_decoder.h"
+#endif
+
+namespace draco {
+
+// Decoder factories defined in decode.cc.
+#ifdef DRACO_POINT_CLOUD_COMPRESSION_SUPPORTED
+StatusOr<std::unique_ptr<PointCloudDecoder>> CreatePointCloudDecoder(
+    int8_t method);
+#endif
+#ifdef DRACO_MESH_COMPRESSION_SUPPORTED
+StatusOr<std::unique_ptr<MeshDecoder>> CreateMeshDecoder(uint8_t method);
+#endif
+
+StreamingDecoder::StreamingDecoder()
+    : geometry_type_(INVALID_GEOMETRY_TYPE),
+      stage_start_(0),
+      next_attempt_size_(0),
+      finished_(false) {}
+
+Status StreamingDecoder::AppendData(const char *data, size_t data_size) {
+  if (finished_)
+    return Status(Status::DRACO_ERROR, "Decoding was already finished.");
+  if (!IsDone())
+    data_.insert(data_.end(), data, data + data_size);
+  return DecodeAvailableStages();
+}
+
+Status StreamingDecoder::Finish() {
+  finished_ = true;
+  return DecodeAvailableStages();
+}
+
+StatusOr<std::unique_ptr<PointCloud>> StreamingDecoder::ReleasePointCloud() {
+  if (!error_status_.ok())
+    return error_status_;
+  if (!IsDone())
+    return Status(Status::NEED_MORE_DATA, "Geometry is not decoded yet.");
+  decoder_ = nullptr;
+  error_status_ = Status(Status::DRACO_ERROR, "Geometry was already released.");
+  return std::move(geometry_);
+}
+
+StatusOr<std::unique_ptr<Mesh>> StreamingDecoder::ReleaseMesh() {
+  if (error_status_.ok() && geometry_type_ != TRIANGULAR_MESH)
+    return Status(Status::DRACO_ERROR, "Input is not a mesh.");
+  DRACO_ASSIGN_OR_RETURN(std::unique_ptr<PointCloud> geometry,
+                         ReleasePointCloud())
+  return std::unique_ptr<Mesh>(static_cast<Mesh *>(geometry.release()));
+}
+
+Status StreamingDecoder::DecodeAvailableStages() {
+  if (!error_status_.ok())
+    return error_status_;
+  if (decoder_ == nullptr) {
+    const Status status = CreateDecoder();
+    if (!status.ok()) {
+      if (status.code() != Status::NEED_MORE_DATA)
+        error_status_ = status;
+      return status;
+    }
+  }
+  while (!decoder_->IsDecodingDone()) {
+    if (!finished_ && data_.size() < next_attempt_size_)
+      return Status(Status::NEED_MORE_DATA, "Waiting for more input data.");
+    // The data may have been reallocated since the last stage. The bitstream
+    // version set by the decoder is preserved.
+    buffer_.Init(data_.data(), data_.size());
+    buffer_.StartDecodingFrom(stage_start_);
+    const Status status = decoder_->DecodeNextStage();
+    if (status.ok()) {
+      stage_start_ = static_cast<size_t>(buffer_.decoded_size());
+      next_attempt_size_ = 0;
+      continue;
+    }
+    // Incomplete data is reported as a generic decoding error. Any other error
+    // (e.g. unsupported version) can't be fixed by more data.
+    if (finished_ || (status.code() != Status::DRACO_ERROR &&
+                      status.code() != Status::IO_ERROR)) {
+      error_status_ = status;
+      return status;
+    }
+    const size_t available_size = data_.size() - stage_start_;
+    next_attempt_size_ =
+        stage_start_ + std::max<size_t>(2 * available_size, 1);
+    return Status(Status::NEED_MORE_DATA, "Waiting for more input data.");
+  }
+  return OkStatus();
+}
+
+Status StreamingDecoder::CreateDecoder() {
+  DecoderBuffer header_buffer;
+  header_buffer.Init(data_.data(), data_.size());
+  DracoHeader header;
+  const Status status =
+      PointCloudDecoder::DecodeHeader(&header_buffer, &header);
+  if (!status.ok()) {
+    if (status.code() == Status::IO_ERROR && !finished_)
+      return Status(Status::NEED_MORE_DATA, "Waiting for more input data.");
+    return status;
+  }
+  if (header.encoder_type == POINT_CLOUD) {
+#ifdef DRACO_POINT_CLOUD_COMPRESSION_SUPPORTED
+    DRACO_ASSIGN_OR_RETURN(std::unique_ptr<PointCloudDecoder> decoder,
+                           CreatePointCloudDecoder(header.encoder_method))
+    geometry_ = std::unique_ptr<PointCloud>(new PointCloud());
+    decoder->StartDecoding(options_, &buffer_, geometry_.get());
+    decoder_ = std::move(decoder);
+#endif
+  } else if (header.encoder_type == TRIANGULAR_MESH) {
+#ifdef DRACO_MESH_COMPRESSION_SUPPORTED
+    DRACO_ASSIGN_OR_RETURN(std::unique_ptr<MeshDecoder> decoder,
+                           CreateMeshDecoder(header.encoder_method))
+    std::unique_ptr<Mesh> mesh(new Mesh());
+    decoder->StartDecoding(options_, &buffer_, mesh.get());
+    geometry_ = std::move(mesh);
+    decoder_ = std::move(decoder);
+#endif
+  }
+  if (decoder_ == nullptr)
+    return Status(Status::DRACO_ERROR, "Unsupported geometry type.");
+  geometry_type_ = static_cast<EncodedGeometryType>(header.encoder_type);
+  return OkStatus();
+}
+
+}  // namespace draco
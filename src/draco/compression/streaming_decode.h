@@ -0,0 +1,141 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_COMPRESSION_STREAMING_DECODE_H_
+#define DRACO_COMPRESSION_STREAMING_DECODE_H_
+
+#include <memory>
+#include <vector>
+
+#include "draco/compression/config/compression_shared.h"
+#include "draco/compression/config/decoder_options.h"
+#include "draco/compression/point_cloud/point_cloud_decoder.h"
+#include "draco/core/decoder_buffer.h"
+#include "draco/core/macros.h"
+#include "draco/core/status_or.h"
+#include "draco/mesh/mesh.h"
+
+namespace draco {
+
+// Decoder for geometry whose encoded data arrives in multiple chunks, e.g.,
+// over a network. Each appended chunk is decoded as far as possible and the
+// stages of the geometry that were already decoded (header, metadata,
+// connectivity and the data of each attributes decoder) are never decoded
+// again. This allows the decoding of connectivity to overlap with the
+// transfer of the attribute data.
+//
+// Example:
+//
+//   StreamingDecoder decoder;
+//   while (ReceiveChunk(&chunk)) {
+//     const Status status = decoder.AppendData(chunk.data(), chunk.size());
+//     if (status.code() != Status::NEED_MORE_DATA && !status.ok())
+//       ...  // Handle error.
+//   }
+//   DRACO_RETURN_IF_ERROR(decoder.Finish());
+//   std::unique_ptr<Mesh> mesh = decoder.ReleaseMesh().value();
+//
+// A stage that cannot be decoded from the available data is attempted again
+// only after the data available for the stage has doubled (or once Finish()
+// is called) so that the total decoding time remains linear in the size of
+// the input regardless of the chunk sizes.
+class StreamingDecoder {
+ public:
+  StreamingDecoder();
+
+  // Appends |data_size| bytes of encoded data and decodes all stages of the
+  // geometry for which enough data is available. Returns OkStatus() when the
+  // whole geometry was decoded, Status::NEED_MORE_DATA when more data is
+  // needed, or an error status when the input is invalid. Data appended after
+  // the geometry was decoded is ignored.
+  Status AppendData(const char *data, size_t data_size);
+
+  // Signals that no more data is going to be appended and decodes all
+  // remaining stages. Returns an error when the appended data does not contain
+  // the complete geometry.
+  Status Finish();
+
+  // Returns true when the whole geometry was decoded.
+  bool IsDone() const {
+    return decoder_ != nullptr && decoder_->IsDecodingDone();
+  }
+
+  // Returns the type of the decoded geometry or INVALID_GEOMETRY_TYPE when the
+  // header was not decoded yet.
+  EncodedGeometryType geometry_type() const { return geometry_type_; }
+
+  // Returns the geometry that is being decoded or nullptr if the header was
+  // not decoded yet. Parts of the geometry are available as soon as the
+  // corresponding stages are decoded, e.g., faces of a mesh can be accessed
+  // before the attribute data arrives.
+  const PointCloud *point_cloud() const { return geometry_.get(); }
+
+  // Returns the decoded mesh or nullptr if the geometry is not a mesh.
+  const Mesh *mesh() const {
+    return geometry_type_ == TRIANGULAR_MESH
+               ? static_cast<const Mesh *>(geometry_.get())
+               : nullptr;
+  }
+
+  // Returns the fully decoded geometry. In case of a mesh, the returned
+  // instance can be down-casted to Mesh. The decoder can't be used anymore
+  // after the geometry is released.
+  StatusOr<std::unique_ptr<PointCloud>> ReleasePointCloud();
+
+  // Returns the fully decoded mesh or an error if the geometry is not a mesh.
+  StatusOr<std::unique_ptr<Mesh>> ReleaseMesh();
+
+  // Number of input bytes consumed by all decoded stages.
+  size_t num_decoded_bytes() const { return stage_start_; }
+
+  // Returns the options used for decoding. The options must be set before any
+  // data is appended.
+  DecoderOptions *options() { return &options_; }
+
+ private:
+  // Decodes all stages for which there is enough data.
+  Status DecodeAvailableStages();
+
+  // Creates the decoder from the header at the start of the input data.
+  Status CreateDecoder();
+
+  DecoderOptions options_;
+
+  // All data appended so far.
+  std::vector<char> data_;
+  DecoderBuffer buffer_;
+
+  EncodedGeometryType geometry_type_;
+  std::unique_ptr<PointCloud> geometry_;
+  std::unique_ptr<PointCloudDecoder> decoder_;
+
+  // Offset of the data of the first stage that was not decoded yet.
+  size_t stage_start_;
+
+  // Size of the input data that is needed before the next attempt to decode
+  // the current stage.
+  size_t next_attempt_size_;
+
+  bool finished_;
+
+  // Set when the decoding failed with an error that can't be recovered by
+  // adding more data.
+  Status error_status_;
+
+  DISALLOW_COPY_AND_ASSIGN(StreamingDecoder);
+};
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_STREAMING_DECODE_H_
@@ -0,0 +1,250 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/streaming_decode.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "draco/compression/decode.h"
+#include "draco/compression/encode.h"
+#include "draco/core/draco_test_base.h"
+#include "draco/core/draco_test_utils.h"
+
+namespace {
+
+class StreamingDecodeTest : public ::testing::Test {
+ protected:
+  std::vector<char> ReadTestFile(const std::string &file_name) const {
+    std::ifstream input_file(draco::GetTestFileFullPath(file_name),
+                             std::ios::binary);
+    if (!input_file)
+      return std::vector<char>();
+    return std::vector<char>((std::istreambuf_iterator<char>(input_file)),
+                             std::istreambuf_iterator<char>());
+  }
+
+  std::vector<char> EncodeMeshTestFile(const std::string &file_name,
+                                       int encoding_method) const {
+    const std::unique_ptr<draco::Mesh> mesh =
+        draco::ReadMeshFromTestFile(file_name);
+    draco::EncoderBuffer buffer;
+    if (mesh == nullptr ||
+        !CreateEncoder(encoding_method).EncodeMeshToBuffer(*mesh, &buffer).ok())
+      return std::vector<char>();
+    return *buffer.buffer();
+  }
+
+  std::vector<char> EncodePointCloudTestFile(const std::string &file_name,
+                                             int encoding_method) const {
+    const std::unique_ptr<draco::PointCloud> pc =
+        draco::ReadPointCloudFromTestFile(file_name);
+    draco::EncoderBuffer buffer;
+    if (pc == nullptr || !CreateEncoder(encoding_method)
+                              .EncodePointCloudToBuffer(*pc, &buffer)
+                              .ok())
+      return std::vector<char>();
+    return *buffer.buffer();
+  }
+
+  draco::Encoder CreateEncoder(int encoding_method) const {
+    draco::Encoder encoder;
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 11);
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::NORMAL, 8);
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::TEX_COORD, 10);
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::GENERIC, 8);
+    encoder.SetEncodingMethod(encoding_method);
+    return encoder;
+  }
+
+  // Decodes |data| with the StreamingDecoder in chunks of |chunk_size| bytes
+  // and verifies that the result is the same as when the data is decoded with
+  // the standard Decoder.
+  void TestStreamingDecoding(const std::vector<char> &data, int chunk_size,
+                             int num_threads) const {
+    ASSERT_FALSE(data.empty());
+    draco::DecoderBuffer buffer;
+    buffer.Init(data.data(), data.size());
+    draco::Decoder decoder;
+    std::unique_ptr<draco::PointCloud> expected =
+        decoder.DecodePointCloudFromBuffer(&buffer).value();
+    ASSERT_NE(expected, nullptr);
+
+    draco::StreamingDecoder streaming_decoder;
+    streaming_decoder.options()->SetGlobalInt("num_threads", num_threads);
+    for (size_t offset = 0; offset < data.size(); offset += chunk_size) {
+      const size_t size =
+          std::min(data.size() - offset, static_cast<size_t>(chunk_size));
+      const draco::Status status =
+          streaming_decoder.AppendData(data.data() + offset, size);
+      if (offset + size < data.size()) {
+        ASSERT_EQ(status.code(), draco::Status::NEED_MORE_DATA)
+            << status.error_msg();
+      } else {
+        ASSERT_TRUE(status.ok() ||
+                    status.code() == draco::Status::NEED_MORE_DATA);
+      }
+    }
+    ASSERT_TRUE(streaming_decoder.Finish().ok());
+    ASSERT_TRUE(streaming_decoder.IsDone());
+    ASSERT_EQ(streaming_decoder.num_decoded_bytes(),
+              static_cast<size_t>(buffer.decoded_size()));
+    std::unique_ptr<draco::PointCloud> pc =
+        streaming_decoder.ReleasePointCloud().value();
+    ASSERT_NE(pc, nullptr);
+    ComparePointClouds(*expected, *pc);
+  }
+
+  void ComparePointClouds(const draco::PointCloud &expected,
+                          const draco::PointCloud &pc) const {
+    ASSERT_EQ(expected.num_points(), pc.num_points());
+    ASSERT_EQ(expected.num_attributes(), pc.num_attributes());
+    ASSERT_EQ(expected.GetMetadata() == nullptr, pc.GetMetadata() == nullptr);
+    for (int i = 0; i < expected.num_attributes(); ++i) {
+      const draco::PointAttribute *const expected_att = expected.attribute(i);
+      const draco::PointAttribute *const att = pc.attribute(i);
+      ASSERT_EQ(expected_att->attribute_type(), att->attribute_type());
+      ASSERT_EQ(expected_att->unique_id(), att->unique_id());
+      ASSERT_EQ(expected_att->size(), att->size());
+      ASSERT_EQ(expected_att->byte_stride(), att->byte_stride());
+      ASSERT_EQ(memcmp(expected_att->GetAddress(draco::AttributeValueIndex(0)),
+                       att->GetAddress(draco::AttributeValueIndex(0)),
+                       expected_att->size() * expected_att->byte_stride()),
+                0);
+      for (draco::PointIndex p(0); p < expected.num_points(); ++p) {
+        ASSERT_EQ(expected_att->mapped_index(p), att->mapped_index(p));
+      }
+      if (expected.GetMetadata() != nullptr) {
+        ASSERT_EQ(expected.GetAttributeMetadataByAttributeId(i) == nullptr,
+                  pc.GetAttributeMetadataByAttributeId(i) == nullptr);
+      }
+    }
+    const draco::Mesh *const expected_mesh =
+        dynamic_cast<const draco::Mesh *>(&expected);
+    if (expected_mesh != nullptr) {
+      const draco::Mesh *const mesh = dynamic_cast<const draco::Mesh *>(&pc);
+      ASSERT_NE(mesh, nullptr);
+      ASSERT_EQ(expected_mesh->num_faces(), mesh->num_faces());
+      for (draco::FaceIndex f(0); f < expected_mesh->num_faces(); ++f) {
+        ASSERT_EQ(expected_mesh->face(f), mesh->face(f));
+      }
+    }
+  }
+};
+
+TEST_F(StreamingDecodeTest, TestEncodedFiles) {
+  // Tests streaming decoding of all supported encoding methods.
+  const std::vector<std::vector<char>> encoded_files = {
+      EncodeMeshTestFile("test_nm.obj", draco::MESH_EDGEBREAKER_ENCODING),
+      EncodeMeshTestFile("test_nm.obj", draco::MESH_SEQUENTIAL_ENCODING),
+      EncodeMeshTestFile("cube_att.obj", draco::MESH_EDGEBREAKER_ENCODING),
+      EncodePointCloudTestFile("point_cloud_test_pos_norm.ply",
+                               draco::POINT_CLOUD_SEQUENTIAL_ENCODING),
+      EncodePointCloudTestFile("point_cloud_test_pos_norm.ply",
+                               draco::POINT_CLOUD_KD_TREE_ENCODING),
+  };
+  for (const auto &data : encoded_files) {
+    for (int chunk_size : {1, 13, 100, 1 << 20}) {
+      for (int num_threads : {1, 2}) {
+        SCOPED_TRACE(chunk_size);
+        TestStreamingDecoding(data, chunk_size, num_threads);
+      }
+    }
+  }
+}
+
+TEST_F(StreamingDecodeTest, TestLegacyFiles) {
+  // Tests streaming decoding of files with older bitstream versions and files
+  // with metadata.
+  const std::vector<std::string> file_names = {
+      "cube_att_sub_o_2.drc",
+      "pc_kd_color.drc",
+      "pc_color.drc",
+      "test_nm.obj.edgebreaker.0.9.1.drc",
+      "test_nm.obj.edgebreaker.1.2.0.drc",
+      "test_nm.obj.sequential.0.9.1.drc",
+      "test_nm.obj.sequential.1.2.0.drc",
+  };
+  for (const std::string &file_name : file_names) {
+    SCOPED_TRACE(file_name);
+    const std::vector<char> data = ReadTestFile(file_name);
+    for (int chunk_size : {7, 256}) {
+      TestStreamingDecoding(data, chunk_size, 1);
+    }
+  }
+}
+
+TEST_F(StreamingDecodeTest, TestConnectivityBeforeAttributes) {
+  // Tests that the mesh connectivity is available before the attribute data
+  // is received.
+  const std::vector<char> data =
+      EncodeMeshTestFile("test_nm.obj", draco::MESH_EDGEBREAKER_ENCODING);
+  ASSERT_FALSE(data.empty());
+  draco::StreamingDecoder decoder;
+  bool connectivity_decoded_early = false;
+  for (size_t offset = 0; offset < data.size(); offset += 64) {
+    const size_t size = std::min<size_t>(data.size() - offset, 64);
+    const draco::Status status = decoder.AppendData(data.data() + offset, size);
+    ASSERT_TRUE(status.ok() || status.code() == draco::Status::NEED_MORE_DATA);
+    if (!decoder.IsDone() && decoder.mesh() != nullptr &&
+        decoder.mesh()->num_faces() > 0) {
+      connectivity_decoded_early = true;
+    }
+  }
+  ASSERT_TRUE(connectivity_decoded_early);
+  ASSERT_TRUE(decoder.Finish().ok());
+  std::unique_ptr<draco::Mesh> mesh = decoder.ReleaseMesh().value();
+  ASSERT_NE(mesh, nullptr);
+  ASSERT_GT(mesh->num_faces(), 0);
+}
+
+TEST_F(StreamingDecodeTest, TestInvalidInput) {
+  const std::vector<char> data =
+      EncodeMeshTestFile("test_nm.obj", draco::MESH_EDGEBREAKER_ENCODING);
+  ASSERT_FALSE(data.empty());
+
+  // Truncated input is detected once no more data is expected.
+  draco::StreamingDecoder truncated_decoder;
+  ASSERT_EQ(truncated_decoder.AppendData(data.data(), data.size() - 1).code(),
+            draco::Status::NEED_MORE_DATA);
+  ASSERT_FALSE(truncated_decoder.Finish().ok());
+  ASSERT_FALSE(truncated_decoder.ReleasePointCloud().ok());
+
+  // Invalid header is reported immediately.
+  std::vector<char> invalid_data = data;
+  invalid_data[0] = 'X';
+  draco::StreamingDecoder invalid_decoder;
+  const draco::Status status =
+      invalid_decoder.AppendData(invalid_data.data(), 16);
+  ASSERT_FALSE(status.ok());
+  ASSERT_NE(status.code(), draco::Status::NEED_MORE_DATA);
+
+  // Unknown version is reported immediately.
+  std::vector<char> future_data = data;
+  future_data[5] = 100;
+  draco::StreamingDecoder future_decoder;
+  ASSERT_EQ(future_decoder.AppendData(future_data.data(), 16).code(),
+            draco::Status::UNKNOWN_VERSION);
+
+  // Point clouds can't be released as meshes.
+  const std::vector<char> pc_data = EncodePointCloudTestFile(
+      "point_cloud_test_pos_norm.ply", draco::POINT_CLOUD_SEQUENTIAL_ENCODING);
+  draco::StreamingDecoder pc_decoder;
+  ASSERT_TRUE(pc_decoder.AppendData(pc_data.data(), pc_data.size()).ok());
+  ASSERT_EQ(pc_decoder.mesh(), nullptr);
+  ASSERT_FALSE(pc_decoder.ReleaseMesh().ok());
+}
+
+}  // namespace
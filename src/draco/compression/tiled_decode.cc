@@ -0,0 +1,242 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/tiled_decode.h"
+
+#include <cstring>
+
+#include "draco/core/varint_decoding.h"
+
+namespace draco {
+
+TiledMeshDecoder::TiledMeshDecoder(int num_threads)
+    : batch_decoder_(num_threads), tile_data_(nullptr), tile_data_size_(0) {}
+
+TiledMeshDecoder::TiledMeshDecoder(ThreadPool *pool)
+    : batch_decoder_(pool), tile_data_(nullptr), tile_data_size_(0) {}
+
+Status TiledMeshDecoder::DecodeTileIndex(DecoderBuffer *in_buffer) {
+  tiles_.clear();
+  tile_data_ = nullptr;
+  tile_data_size_ = 0;
+
+  char magic[kTiledMeshMagicLength];
+  if (!in_buffer->Decode(magic, kTiledMeshMagicLength) ||
+      memcmp(magic, kTiledMeshMagic, kTiledMeshMagicLength) != 0) {
+    return Status(Status::DRACO_ERROR, "Not a tiled Draco mesh.");
+  }
+  uint8_t version_major, version_minor;
+  uint16_t flags;
+  if (!in_buffer->Decode(&version_major) ||
+      !in_buffer->Decode(&version_minor) || !in_buffer->Decode(&flags)) {
+    return Status(Status::IO_ERROR, "Failed to parse tiled mesh header.");
+  }
+  if (version_major != kTiledMeshVersionMajor) {
+    return Status(Status::UNSUPPORTED_VERSION,
+                  "Unsupported tiled mesh version.");
+  }
+  uint32_t num_tiles;
+  if (!DecodeVarint(&num_tiles, in_buffer)) {
+    return Status(Status::IO_ERROR, "Failed to parse tile index.");
+  }
+  // Each index entry takes at least 26 bytes.
+  if (num_tiles > in_buffer->remaining_size() / 26) {
+    return Status(Status::IO_ERROR, "Invalid number of tiles.");
+  }
+  tiles_.resize(num_tiles);
+  uint64_t offset = 0;
+  for (uint32_t i = 0; i < num_tiles; ++i) {
+    float box[6];
+    for (int c = 0; c < 6; ++c) {
+      if (!in_buffer->Decode(&box[c])) {
+        return Status(Status::IO_ERROR, "Failed to parse tile index.");
+      }
+    }
+    TiledMeshTileInfo &tile = tiles_[i];
+    tile.bounding_box = BoundingBox(Vector3f(box[0], box[1], box[2]),
+                                    Vector3f(box[3], box[4], box[5]));
+    if (!DecodeVarint(&tile.num_faces, in_buffer) ||
+        !DecodeVarint(&tile.size, in_buffer)) {
+      return Status(Status::IO_ERROR, "Failed to parse tile index.");
+    }
+    if (tile.size > static_cast<uint64_t>(in_buffer->remaining_size())) {
+      return Status(Status::IO_ERROR, "Invalid tile size.");
+    }
+    tile.offset = offset;
+    offset += tile.size;
+  }
+  if (offset > static_cast<uint64_t>(in_buffer->remaining_size())) {
+    return Status(Status::IO_ERROR, "Tiled mesh data is truncated.");
+  }
+  tile_data_ = in_buffer->data_head();
+  tile_data_size_ = offset;
+  in_buffer->Advance(offset);
+  return OkStatus();
+}
+
+std::vector<int> TiledMeshDecoder::FindTiles(const BoundingBox &box) const {
+  std::vector<int> tile_ids;
+  for (int i = 0; i < num_tiles(); ++i) {
+    const BoundingBox &tile_box = tiles_[i].bounding_box;
+    bool intersects = true;
+    for (int c = 0; c < 3; ++c) {
+      if (tile_box.min_point()[c] > box.max_point()[c] ||
+          tile_box.max_point()[c] < box.min_point()[c]) {
+        intersects = false;
+        break;
+      }
+    }
+    if (intersects) {
+      tile_ids.push_back(i);
+    }
+  }
+  return tile_ids;
+}
+
+std::vector<StatusOr<std::unique_ptr<Mesh>>> TiledMeshDecoder::DecodeTiles(
+    const std::vector<int> &tile_ids) {
+  std::vector<StatusOr<std::unique_ptr<Mesh>>> meshes(tile_ids.size());
+  // Only valid tiles are passed to the batch decoder. |buffer_items| maps the
+  // buffers back to the requested tiles.
+  std::vector<DecoderBuffer> buffers;
+  std::vector<size_t> buffer_items;
+  buffers.reserve(tile_ids.size());
+  for (size_t i = 0; i < tile_ids.size(); ++i) {
+    const int tile_id = tile_ids[i];
+    if (tile_id < 0 || tile_id >= num_tiles()) {
+      meshes[i] = Status(Status::INVALID_PARAMETER, "Invalid tile id.");
+      continue;
+    }
+    const TiledMeshTileInfo &tile = tiles_[tile_id];
+    buffers.emplace_back();
+    buffers.back().Init(tile_data_ + tile.offset, tile.size);
+    buffer_items.push_back(i);
+  }
+  std::vector<StatusOr<std::unique_ptr<Mesh>>> decoded_meshes =
+      batch_decoder_.DecodeMeshes(buffers.data(), buffers.size());
+  for (size_t i = 0; i < decoded_meshes.size(); ++i) {
+    meshes[buffer_items[i]] = std::move(decoded_meshes[i]);
+  }
+  return meshes;
+}
+
+StatusOr<std::unique_ptr<Mesh>> TiledMeshDecoder::DecodeMesh() {
+  std::vector<int> tile_ids(num_tiles());
+  for (int i = 0; i < num_tiles(); ++i) {
+    tile_ids[i] = i;
+  }
+  return DecodeAndStitchTiles(tile_ids);
+}
+
+StatusOr<std::unique_ptr<Mesh>> TiledMeshDecoder::DecodeMeshInBox(
+    const BoundingBox &box) {
+  return DecodeAndStitchTiles(FindTiles(box));
+}
+
+StatusOr<std::unique_ptr<Mesh>> TiledMeshDecoder::DecodeAndStitchTiles(
+    const std::vector<int> &tile_ids) {
+  if (tile_ids.empty()) {
+    return Status(Status::DRACO_ERROR, "No tiles to decode.");
+  }
+  std::vector<StatusOr<std::unique_ptr<Mesh>>> meshes = DecodeTiles(tile_ids);
+  std::vector<const Mesh *> tiles(meshes.size());
+  for (size_t i = 0; i < meshes.size(); ++i) {
+    if (!meshes[i].ok()) {
+      return meshes[i].status();
+    }
+    tiles[i] = meshes[i].value().get();
+  }
+  return StitchTiles(tiles);
+}
+
+StatusOr<std::unique_ptr<Mesh>> TiledMeshDecoder::StitchTiles(
+    const std::vector<const Mesh *> &tiles) {
+  if (tiles.empty()) {
+    return Status(Status::DRACO_ERROR, "No tiles to stitch.");
+  }
+  const Mesh &first_tile = *tiles[0];
+  size_t num_points = 0;
+  size_t num_faces = 0;
+  for (const Mesh *tile : tiles) {
+    if (tile->num_attributes() != first_tile.num_attributes()) {
+      return Status(Status::DRACO_ERROR, "Tiles have different attributes.");
+    }
+    for (int i = 0; i < tile->num_attributes(); ++i) {
+      const PointAttribute *const att = tile->attribute(i);
+      const PointAttribute *const first_att = first_tile.attribute(i);
+      if (att->attribute_type() != first_att->attribute_type() ||
+          att->data_type() != first_att->data_type() ||
+          att->num_components() != first_att->num_components() ||
+          att->normalized() != first_att->normalized()) {
+        return Status(Status::DRACO_ERROR, "Tiles have different attributes.");
+      }
+    }
+    num_points += tile->num_points();
+    num_faces += tile->num_faces();
+  }
+
+  std::unique_ptr<Mesh> mesh(new Mesh());
+  mesh->set_num_points(static_cast<uint32_t>(num_points));
+  mesh->SetNumFaces(num_faces);
+  for (int i = 0; i < first_tile.num_attributes(); ++i) {
+    const PointAttribute *const first_att = first_tile.attribute(i);
+    GeometryAttribute ga;
+    ga.Init(first_att->attribute_type(), nullptr, first_att->num_components(),
+            first_att->data_type(), first_att->normalized(),
+            DataTypeLength(first_att->data_type()) *
+                first_att->num_components(),
+            0);
+    const int att_id =
+        mesh->AddAttribute(ga, true, static_cast<uint32_t>(num_points));
+    mesh->attribute(att_id)->set_unique_id(first_att->unique_id());
+    mesh->SetAttributeElementType(att_id,
+                                  first_tile.GetAttributeElementType(i));
+  }
+
+  uint32_t point_offset = 0;
+  FaceIndex::ValueType face_offset = 0;
+  for (const Mesh *tile : tiles) {
+    for (int i = 0; i < tile->num_attributes(); ++i) {
+      const PointAttribute *const tile_att = tile->attribute(i);
+      PointAttribute *const att = mesh->attribute(i);
+      for (PointIndex p(0); p < tile->num_points(); ++p) {
+        att->SetAttributeValue(AttributeValueIndex(point_offset + p.value()),
+                               tile_att->GetAddressOfMappedIndex(p));
+      }
+    }
+    for (FaceIndex f(0); f < tile->num_faces(); ++f) {
+      const Mesh::Face &tile_face = tile->face(f);
+      Mesh::Face face;
+      for (int c = 0; c < 3; ++c) {
+        face[c] = tile_face[c] + point_offset;
+      }
+      mesh->SetFace(FaceIndex(face_offset + f.value()), face);
+    }
+    point_offset += tile->num_points();
+    face_offset += tile->num_faces();
+  }
+
+#ifdef DRACO_ATTRIBUTE_VALUES_DEDUPLICATION_SUPPORTED
+  // Merge points shared by neighboring tiles.
+  if (!mesh->DeduplicateAttributeValues()) {
+    return Status(Status::DRACO_ERROR, "Failed to merge tiles.");
+  }
+#endif
+#ifdef DRACO_ATTRIBUTE_INDICES_DEDUPLICATION_SUPPORTED
+  mesh->DeduplicatePointIds();
+#endif
+  return std::move(mesh);
+}
+
+}  // namespace draco
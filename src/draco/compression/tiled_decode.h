@@ -0,0 +1,90 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_COMPRESSION_TILED_DECODE_H_
+#define DRACO_COMPRESSION_TILED_DECODE_H_
+
+#include <vector>
+
+#include "draco/compression/batch_decode.h"
+#include "draco/compression/tiled_mesh_shared.h"
+
+namespace draco {
+
+// Decoder for meshes encoded with TiledMeshEncoder. The tile index is parsed
+// first and the tiles can then be decoded either all at once, or only those
+// that intersect a region of interest. Tiles are decoded in parallel by a
+// BatchDecoder.
+//
+// Example:
+//
+//   TiledMeshDecoder decoder(8);
+//   DRACO_RETURN_IF_ERROR(decoder.DecodeTileIndex(&buffer));
+//   auto mesh_or = decoder.DecodeMeshInBox(region);
+//
+class TiledMeshDecoder {
+ public:
+  // Creates a decoder that uses |num_threads| threads for decoding of tiles.
+  explicit TiledMeshDecoder(int num_threads);
+
+  // Creates a decoder that uses worker threads of an external |pool|. The
+  // |pool| must outlive the decoder.
+  explicit TiledMeshDecoder(ThreadPool *pool);
+
+  // Parses the header and the tile index of the tiled mesh stored in
+  // |in_buffer|. The buffer is advanced past the whole container. The data of
+  // |in_buffer| must stay valid until all tiles are decoded.
+  Status DecodeTileIndex(DecoderBuffer *in_buffer);
+
+  int num_tiles() const { return static_cast<int>(tiles_.size()); }
+  const TiledMeshTileInfo &tile(int i) const { return tiles_[i]; }
+
+  // Returns ids of all tiles whose bounding box intersects |box|.
+  std::vector<int> FindTiles(const BoundingBox &box) const;
+
+  // Decodes tiles |tile_ids| into separate meshes. The returned vector
+  // contains either the decoded mesh or the error status for each tile.
+  std::vector<StatusOr<std::unique_ptr<Mesh>>> DecodeTiles(
+      const std::vector<int> &tile_ids);
+
+  // Decodes all tiles and merges them into a single mesh.
+  StatusOr<std::unique_ptr<Mesh>> DecodeMesh();
+
+  // Decodes all tiles that intersect |box| and merges them into a single
+  // mesh. The result may contain faces outside of |box|.
+  StatusOr<std::unique_ptr<Mesh>> DecodeMeshInBox(const BoundingBox &box);
+
+  // Merges decoded tiles into a single mesh. All tiles must have the same
+  // attributes. Points shared by neighboring tiles are merged when attribute
+  // deduplication is supported.
+  static StatusOr<std::unique_ptr<Mesh>> StitchTiles(
+      const std::vector<const Mesh *> &tiles);
+
+  // Options used for decoding of all tiles.
+  DecoderOptions *options() { return batch_decoder_.options(); }
+
+ private:
+  StatusOr<std::unique_ptr<Mesh>> DecodeAndStitchTiles(
+      const std::vector<int> &tile_ids);
+
+  BatchDecoder batch_decoder_;
+  std::vector<TiledMeshTileInfo> tiles_;
+  // Start of the encoded data of the tiles in the input buffer.
+  const char *tile_data_;
+  size_t tile_data_size_;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_TILED_DECODE_H_
@@ -0,0 +1,341 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/tiled_encode.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#include "draco/attributes/attribute_quantization_transform.h"
+#include "draco/core/thread_pool.h"
+#include "draco/core/tracer.h"
+#include "draco/core/varint_encoding.h"
+
+namespace draco {
+
+namespace {
+
+// Creates a mesh containing |num_faces| |faces| of the source |mesh| and all
+// points used by them. Bounding box of the positions of the new mesh is
+// returned in |out_bounding_box|. Returns nullptr on error.
+std::unique_ptr<Mesh> CreateTileMesh(const Mesh &mesh, const FaceIndex *faces,
+                                     int num_faces,
+                                     BoundingBox *out_bounding_box) {
+  // Gather the source points used by the tile, sorted by their source index.
+  std::vector<PointIndex> points;
+  points.reserve(3 * num_faces);
+  for (int i = 0; i < num_faces; ++i) {
+    const Mesh::Face &face = mesh.face(faces[i]);
+    for (int c = 0; c < 3; ++c) {
+      points.push_back(face[c]);
+    }
+  }
+  std::sort(points.begin(), points.end());
+  points.erase(std::unique(points.begin(), points.end()), points.end());
+  const int num_points = static_cast<int>(points.size());
+
+  std::unique_ptr<Mesh> tile(new Mesh());
+  tile->set_num_points(num_points);
+  for (int i = 0; i < mesh.num_attributes(); ++i) {
+    const PointAttribute *const src_att = mesh.attribute(i);
+    GeometryAttribute ga;
+    ga.Init(src_att->attribute_type(), nullptr, src_att->num_components(),
+            src_att->data_type(), src_att->normalized(),
+            DataTypeLength(src_att->data_type()) * src_att->num_components(),
+            0);
+    const int att_id = tile->AddAttribute(ga, true, num_points);
+    PointAttribute *const att = tile->attribute(att_id);
+    att->set_unique_id(src_att->unique_id());
+    tile->SetAttributeElementType(att_id, mesh.GetAttributeElementType(i));
+    for (int p = 0; p < num_points; ++p) {
+      att->SetAttributeValue(AttributeValueIndex(p),
+                             src_att->GetAddressOfMappedIndex(points[p]));
+    }
+  }
+
+  for (int i = 0; i < num_faces; ++i) {
+    const Mesh::Face &src_face = mesh.face(faces[i]);
+    Mesh::Face face;
+    for (int c = 0; c < 3; ++c) {
+      face[c] = PointIndex(static_cast<uint32_t>(
+          std::lower_bound(points.begin(), points.end(), src_face[c]) -
+          points.begin()));
+    }
+    tile->AddFace(face);
+  }
+
+#ifdef DRACO_ATTRIBUTE_VALUES_DEDUPLICATION_SUPPORTED
+  // Each point got its own attribute values above. Merge values shared across
+  // attribute seams so that the tile connectivity has no artificial holes.
+  if (!tile->DeduplicateAttributeValues())
+    return nullptr;
+#endif
+#ifdef DRACO_ATTRIBUTE_INDICES_DEDUPLICATION_SUPPORTED
+  tile->DeduplicatePointIds();
+#endif
+
+  const PointAttribute *const pos_att =
+      tile->GetNamedAttribute(GeometryAttribute::POSITION);
+  std::array<float, 3> pos;
+  pos_att->ConvertValue<float>(AttributeValueIndex(0), 3, &pos[0]);
+  BoundingBox bounding_box(Vector3f(pos[0], pos[1], pos[2]),
+                           Vector3f(pos[0], pos[1], pos[2]));
+  for (AttributeValueIndex p(1); p < pos_att->size(); ++p) {
+    pos_att->ConvertValue<float>(p, 3, &pos[0]);
+    bounding_box.update_bounding_box(Vector3f(pos[0], pos[1], pos[2]));
+  }
+  *out_bounding_box = bounding_box;
+  return tile;
+}
+
+}  // namespace
+
+TiledMeshEncoder::TiledMeshEncoder() : max_faces_per_tile_(65536) {}
+
+Status TiledMeshEncoder::EncodePointCloudToBuffer(const PointCloud &pc,
+                                                  EncoderBuffer *out_buffer) {
+  return Status(Status::DRACO_ERROR, "Only meshes can be encoded into tiles.");
+}
+
+Status TiledMeshEncoder::EncodeMeshToBuffer(const Mesh &m,
+                                            EncoderBuffer *out_buffer) {
+  const PointAttribute *const pos_att =
+      m.GetNamedAttribute(GeometryAttribute::POSITION);
+  if (pos_att == nullptr || pos_att->num_components() != 3) {
+    return Status(Status::DRACO_ERROR,
+                  "Tiled encoding requires a 3D position attribute.");
+  }
+  if (max_faces_per_tile_ < 1) {
+    return Status(Status::DRACO_ERROR, "Invalid number of faces per tile.");
+  }
+  if (m.num_faces() == 0) {
+    return Status(Status::DRACO_ERROR, "Mesh has no faces.");
+  }
+  set_num_encoded_points(0);
+  set_num_encoded_faces(0);
+
+  std::vector<FaceIndex> tile_faces;
+  std::vector<int> tile_ends;
+  {
+    TraceScope trace(options().GetTracer(), "TiledMeshEncoder::Partition");
+    DRACO_RETURN_IF_ERROR(PartitionFaces(m, &tile_faces, &tile_ends));
+  }
+  EncoderOptionsBase<GeometryAttribute::Type> tile_options =
+      EncoderOptionsBase<GeometryAttribute::Type>::CreateEmptyOptions();
+  DRACO_RETURN_IF_ERROR(CreateTileOptions(m, &tile_options));
+
+  // Tiles are encoded in parallel, each of them on a single thread.
+  const int num_threads = options().GetGlobalInt("num_threads", 1);
+  std::unique_ptr<ThreadPool> pool;
+  if (num_threads > 1) {
+    pool.reset(new ThreadPool(num_threads - 1));
+  }
+  const int num_tiles = static_cast<int>(tile_ends.size());
+  tiles_.assign(num_tiles, TiledMeshTileInfo());
+  std::vector<EncoderBuffer> tile_buffers(num_tiles);
+  std::vector<Status> tile_statuses(num_tiles);
+  std::vector<std::pair<size_t, size_t>> tile_num_encoded(num_tiles);
+  ParallelFor(pool.get(), num_tiles, [&](int i) {
+    const int begin = i == 0 ? 0 : tile_ends[i - 1];
+    const int num_faces = tile_ends[i] - begin;
+    std::unique_ptr<Mesh> tile_mesh = CreateTileMesh(
+        m, &tile_faces[begin], num_faces, &tiles_[i].bounding_box);
+    if (tile_mesh == nullptr) {
+      tile_statuses[i] = Status(Status::DRACO_ERROR, "Failed to create tile.");
+      return false;
+    }
+    tiles_[i].num_faces = num_faces;
+    Encoder encoder;
+    encoder.Reset(tile_options);
+    tile_statuses[i] =
+        encoder.EncodeMeshToBuffer(*tile_mesh, &tile_buffers[i]);
+    tiles_[i].size = tile_buffers[i].size();
+    tile_num_encoded[i] = std::make_pair(encoder.num_encoded_points(),
+                                         encoder.num_encoded_faces());
+    return tile_statuses[i].ok();
+  });
+  for (int i = 0; i < num_tiles; ++i) {
+    DRACO_RETURN_IF_ERROR(tile_statuses[i]);
+  }
+
+  // Write the container header and the tile index.
+  out_buffer->Encode(kTiledMeshMagic, kTiledMeshMagicLength);
+  out_buffer->Encode(kTiledMeshVersionMajor);
+  out_buffer->Encode(kTiledMeshVersionMinor);
+  const uint16_t flags = 0;
+  out_buffer->Encode(flags);
+  EncodeVarint(static_cast<uint32_t>(num_tiles), out_buffer);
+  uint64_t offset = 0;
+  for (int i = 0; i < num_tiles; ++i) {
+    TiledMeshTileInfo &tile = tiles_[i];
+    for (int c = 0; c < 3; ++c) {
+      out_buffer->Encode(tile.bounding_box.min_point()[c]);
+    }
+    for (int c = 0; c < 3; ++c) {
+      out_buffer->Encode(tile.bounding_box.max_point()[c]);
+    }
+    EncodeVarint(tile.num_faces, out_buffer);
+    EncodeVarint(tile.size, out_buffer);
+    tile.offset = offset;
+    offset += tile.size;
+  }
+  size_t num_encoded_points = 0;
+  size_t num_encoded_faces = 0;
+  for (int i = 0; i < num_tiles; ++i) {
+    out_buffer->Encode(tile_buffers[i].data(), tile_buffers[i].size());
+    num_encoded_points += tile_num_encoded[i].first;
+    num_encoded_faces += tile_num_encoded[i].second;
+  }
+  set_num_encoded_points(num_encoded_points);
+  set_num_encoded_faces(num_encoded_faces);
+  return OkStatus();
+}
+
+Status TiledMeshEncoder::PartitionFaces(const Mesh &mesh,
+                                        std::vector<FaceIndex> *tile_faces,
+                                        std::vector<int> *tile_ends) const {
+  // Compute centroids of all faces.
+  const PointAttribute *const pos_att =
+      mesh.GetNamedAttribute(GeometryAttribute::POSITION);
+  const int num_faces = mesh.num_faces();
+  std::vector<Vector3f> centroids(num_faces);
+  std::array<float, 3> pos;
+  for (FaceIndex f(0); f < num_faces; ++f) {
+    const Mesh::Face &face = mesh.face(f);
+    Vector3f centroid(0.f, 0.f, 0.f);
+    for (int c = 0; c < 3; ++c) {
+      if (!pos_att->ConvertValue<float>(pos_att->mapped_index(face[c]), 3,
+                                        &pos[0])) {
+        return Status(Status::DRACO_ERROR, "Failed to read face positions.");
+      }
+      centroid = centroid + Vector3f(pos[0], pos[1], pos[2]);
+    }
+    centroids[f.value()] = centroid / 3.f;
+  }
+
+  tile_faces->resize(num_faces);
+  for (int i = 0; i < num_faces; ++i) {
+    (*tile_faces)[i] = FaceIndex(i);
+  }
+  tile_ends->clear();
+
+  // Recursively split face ranges in the middle of the longest axis of their
+  // centroid bounding box until they fit into a single tile. Ranges are
+  // processed in depth-first order so that neighboring tiles are stored next
+  // to each other.
+  std::vector<std::pair<int, int>> ranges;
+  ranges.push_back(std::make_pair(0, num_faces));
+  while (!ranges.empty()) {
+    const int begin = ranges.back().first;
+    const int end = ranges.back().second;
+    ranges.pop_back();
+    if (end - begin <= max_faces_per_tile_) {
+      tile_ends->push_back(end);
+      continue;
+    }
+    const Vector3f &first = centroids[(*tile_faces)[begin].value()];
+    BoundingBox box(first, first);
+    for (int i = begin + 1; i < end; ++i) {
+      box.update_bounding_box(centroids[(*tile_faces)[i].value()]);
+    }
+    const Vector3f extent = box.max_point() - box.min_point();
+    int axis = 0;
+    if (extent[1] > extent[axis]) {
+      axis = 1;
+    }
+    if (extent[2] > extent[axis]) {
+      axis = 2;
+    }
+    const int mid = begin + (end - begin) / 2;
+    std::nth_element(tile_faces->begin() + begin, tile_faces->begin() + mid,
+                     tile_faces->begin() + end,
+                     [&](FaceIndex a, FaceIndex b) {
+                       const float va = centroids[a.value()][axis];
+                       const float vb = centroids[b.value()][axis];
+                       return va < vb || (va == vb && a < b);
+                     });
+    ranges.push_back(std::make_pair(mid, end));
+    ranges.push_back(std::make_pair(begin, mid));
+  }
+  return OkStatus();
+}
+
+Status TiledMeshEncoder::CreateTileOptions(
+    const Mesh &mesh,
+    EncoderOptionsBase<GeometryAttribute::Type> *out_options) const {
+  *out_options = options();
+  out_options->SetGlobalInt("num_threads", 1);
+
+  // Quantize each float attribute type in a box shared by all tiles. Normals
+  // are quantized in a fixed octahedral domain and they do not need it.
+  for (int i = 0; i < mesh.num_attributes(); ++i) {
+    const PointAttribute *const att = mesh.attribute(i);
+    const GeometryAttribute::Type type = att->attribute_type();
+    if (type == GeometryAttribute::NORMAL || att->data_type() != DT_FLOAT32) {
+      continue;
+    }
+    const int quantization_bits =
+        options().GetAttributeInt(type, "quantization_bits", -1);
+    if (quantization_bits < 1 ||
+        out_options->IsAttributeOptionSet(type, "quantization_origin")) {
+      continue;
+    }
+    // Union of the quantization boxes of all attributes of the same type.
+    const int num_components = att->num_components();
+    std::vector<float> min_values;
+    std::vector<float> max_values;
+    bool is_valid = true;
+    for (int j = 0; j < mesh.num_attributes(); ++j) {
+      const PointAttribute *const other_att = mesh.attribute(j);
+      if (other_att->attribute_type() != type) {
+        continue;
+      }
+      AttributeQuantizationTransform transform;
+      if (other_att->data_type() != DT_FLOAT32 ||
+          other_att->num_components() != num_components ||
+          !transform.ComputeParameters(*other_att, quantization_bits)) {
+        is_valid = false;
+        break;
+      }
+      if (min_values.empty()) {
+        min_values = transform.min_values();
+        max_values.resize(num_components);
+        for (int c = 0; c < num_components; ++c) {
+          max_values[c] = min_values[c] + transform.range();
+        }
+        continue;
+      }
+      for (int c = 0; c < num_components; ++c) {
+        min_values[c] = std::min(min_values[c], transform.min_value(c));
+        max_values[c] = std::max(max_values[c],
+                                 transform.min_value(c) + transform.range());
+      }
+    }
+    if (!is_valid) {
+      // Mixed attribute formats are quantized separately in each tile.
+      continue;
+    }
+    float range = 0.f;
+    for (int c = 0; c < num_components; ++c) {
+      range = std::max(range, max_values[c] - min_values[c]);
+    }
+    out_options->SetAttributeVector(type, "quantization_origin",
+                                    num_components, min_values.data());
+    out_options->SetAttributeFloat(type, "quantization_range", range);
+  }
+  return OkStatus();
+}
+
+}  // namespace draco
@@ -0,0 +1,91 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_COMPRESSION_TILED_ENCODE_H_
+#define DRACO_COMPRESSION_TILED_ENCODE_H_
+
+#include <vector>
+
+#include "draco/compression/encode.h"
+#include "draco/compression/tiled_mesh_shared.h"
+
+namespace draco {
+
+// Encoder that splits the input mesh into spatially coherent tiles and encodes
+// each tile as an independent Draco mesh. The result is stored in the tiled
+// mesh container described in tiled_mesh_shared.h, which can be decoded with
+// TiledMeshDecoder either completely (with the tiles decoded in parallel) or
+// only for the tiles that intersect a given region.
+//
+// All options of the Encoder are used for the encoding of each tile. Float
+// attributes that are quantized without an explicitly set quantization box
+// are quantized in a box computed from the whole mesh, so that the points
+// shared by neighboring tiles are decoded to the same values. The global
+// option "num_threads" (see SetNumThreads()) sets the number of tiles that are
+// encoded at the same time. The encoded data is the same for any number of
+// threads.
+//
+// Example:
+//
+//   TiledMeshEncoder encoder;
+//   encoder.SetAttributeQuantization(GeometryAttribute::POSITION, 14);
+//   encoder.SetMaxFacesPerTile(100000);
+//   encoder.SetNumThreads(8);
+//   EncoderBuffer buffer;
+//   const Status status = encoder.EncodeMeshToBuffer(mesh, &buffer);
+//
+class TiledMeshEncoder : public Encoder {
+ public:
+  TiledMeshEncoder();
+
+  // Only meshes can be encoded into tiles. Always returns an error.
+  Status EncodePointCloudToBuffer(const PointCloud &pc,
+                                  EncoderBuffer *out_buffer) override;
+
+  // Encodes the mesh |m| into tiles and stores the tiled mesh container in
+  // |out_buffer|. The mesh must have a position attribute with three
+  // components.
+  Status EncodeMeshToBuffer(const Mesh &m, EncoderBuffer *out_buffer) override;
+
+  // Sets the maximum number of faces stored in a single tile (default =
+  // 65536). Smaller tiles allow finer region queries and more parallelism,
+  // but they decrease the compression efficiency.
+  void SetMaxFacesPerTile(int max_faces_per_tile) {
+    max_faces_per_tile_ = max_faces_per_tile;
+  }
+  int max_faces_per_tile() const { return max_faces_per_tile_; }
+
+  // Returns the tile index of the last encoded mesh.
+  const std::vector<TiledMeshTileInfo> &tiles() const { return tiles_; }
+
+ private:
+  // Splits faces of |mesh| into tiles. On output, |tile_faces| contains the
+  // faces ordered by tiles and |tile_ends| contains the end of each tile in
+  // |tile_faces|.
+  Status PartitionFaces(const Mesh &mesh, std::vector<FaceIndex> *tile_faces,
+                        std::vector<int> *tile_ends) const;
+
+  // Computes the options used for encoding of the individual tiles of |mesh|
+  // from the options of this encoder.
+  Status CreateTileOptions(
+      const Mesh &mesh,
+      EncoderOptionsBase<GeometryAttribute::Type> *out_options) const;
+
+  int max_faces_per_tile_;
+  std::vector<TiledMeshTileInfo> tiles_;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_TILED_ENCODE_H_
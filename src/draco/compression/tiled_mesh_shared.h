@@ -0,0 +1,62 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_COMPRESSION_TILED_MESH_SHARED_H_
+#define DRACO_COMPRESSION_TILED_MESH_SHARED_H_
+
+#include <cstdint>
+
+#include "draco/core/bounding_box.h"
+
+namespace draco {
+
+// Layout of the tiled mesh container produced by TiledMeshEncoder. The mesh is
+// split into spatially coherent tiles and each tile is stored as a regular,
+// independently decodable Draco mesh. The container is defined as:
+//
+//   "DTILE"                        5 bytes
+//   version major, version minor   2 x uint8_t
+//   flags (reserved)               uint16_t
+//   number of tiles                varint
+//   for each tile:
+//     bounding box min, max        6 x float
+//     number of faces              varint
+//     size of the encoded tile     varint
+//   encoded data of all tiles in the order of the tile index
+//
+static constexpr char kTiledMeshMagic[] = "DTILE";
+static constexpr int kTiledMeshMagicLength = 5;
+static constexpr uint8_t kTiledMeshVersionMajor = 1;
+static constexpr uint8_t kTiledMeshVersionMinor = 0;
+
+// Entry of the tile index.
+struct TiledMeshTileInfo {
+  TiledMeshTileInfo()
+      : bounding_box(Vector3f(0.f, 0.f, 0.f), Vector3f(0.f, 0.f, 0.f)),
+        num_faces(0),
+        offset(0),
+        size(0) {}
+
+  // Bounding box of the positions of all points of the tile.
+  BoundingBox bounding_box;
+  // Number of faces of the source mesh that were assigned to the tile.
+  uint32_t num_faces;
+  // Location of the encoded tile relative to the end of the tile index.
+  uint64_t offset;
+  uint64_t size;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_TILED_MESH_SHARED_H_
@@ -0,0 +1,205 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/tiled_decode.h"
+#include "draco/compression/tiled_encode.h"
+
+#include <array>
+#include <set>
+
+#include "draco/core/draco_test_base.h"
+#include "draco/core/draco_test_utils.h"
+#include "draco/core/vector_d.h"
+#include "draco/mesh/triangle_soup_mesh_builder.h"
+
+namespace {
+
+class TiledMeshTest : public ::testing::Test {
+ protected:
+  // Creates a regular grid mesh with |grid_size| x |grid_size| quads. When
+  // |with_seam| is set, texture coordinates of the right two thirds of the
+  // grid are shifted which creates a seam that crosses some of the tiles.
+  std::unique_ptr<draco::Mesh> CreateGrid(int grid_size,
+                                          bool with_seam = false) const {
+    draco::TriangleSoupMeshBuilder mesh_builder;
+    mesh_builder.Start(grid_size * grid_size * 2);
+    const int pos_att_id = mesh_builder.AddAttribute(
+        draco::GeometryAttribute::POSITION, 3, draco::DT_FLOAT32);
+    const int tex_att_id = mesh_builder.AddAttribute(
+        draco::GeometryAttribute::TEX_COORD, 2, draco::DT_FLOAT32);
+    draco::FaceIndex face(0);
+    for (int y = 0; y < grid_size; ++y) {
+      for (int x = 0; x < grid_size; ++x) {
+        const float x0 = static_cast<float>(x);
+        const float y0 = static_cast<float>(y);
+        const float u0 = x0 + (with_seam && 3 * x >= grid_size ? grid_size : 0);
+        draco::Vector3f p00(x0, y0, 0.f), p10(x0 + 1.f, y0, 0.f),
+            p01(x0, y0 + 1.f, 0.f), p11(x0 + 1.f, y0 + 1.f, 0.f);
+        draco::Vector2f t00(u0 / grid_size, y0 / grid_size),
+            t10((u0 + 1.f) / grid_size, y0 / grid_size),
+            t01(u0 / grid_size, (y0 + 1.f) / grid_size),
+            t11((u0 + 1.f) / grid_size, (y0 + 1.f) / grid_size);
+        mesh_builder.SetAttributeValuesForFace(pos_att_id, face, p00.data(),
+                                               p10.data(), p11.data());
+        mesh_builder.SetAttributeValuesForFace(tex_att_id, face, t00.data(),
+                                               t10.data(), t11.data());
+        ++face;
+        mesh_builder.SetAttributeValuesForFace(pos_att_id, face, p00.data(),
+                                               p11.data(), p01.data());
+        mesh_builder.SetAttributeValuesForFace(tex_att_id, face, t00.data(),
+                                               t11.data(), t01.data());
+        ++face;
+      }
+    }
+    return mesh_builder.Finalize();
+  }
+
+  void EncodeTiled(const draco::Mesh &mesh, int num_threads,
+                   draco::EncoderBuffer *buffer) const {
+    draco::TiledMeshEncoder encoder;
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 11);
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::TEX_COORD, 10);
+    encoder.SetMaxFacesPerTile(200);
+    encoder.SetNumThreads(num_threads);
+    ASSERT_TRUE(encoder.EncodeMeshToBuffer(mesh, buffer).ok());
+    ASSERT_GT(encoder.tiles().size(), 1u);
+    for (const draco::TiledMeshTileInfo &tile : encoder.tiles()) {
+      ASSERT_LE(tile.num_faces, 200u);
+    }
+  }
+};
+
+TEST_F(TiledMeshTest, TestDecodeMesh) {
+  const std::unique_ptr<draco::Mesh> mesh = CreateGrid(32);
+  ASSERT_NE(mesh, nullptr);
+  draco::EncoderBuffer buffer;
+  EncodeTiled(*mesh, 1, &buffer);
+
+  draco::DecoderBuffer dec_buffer;
+  dec_buffer.Init(buffer.data(), buffer.size());
+  draco::TiledMeshDecoder decoder(4);
+  ASSERT_TRUE(decoder.DecodeTileIndex(&dec_buffer).ok());
+  ASSERT_EQ(dec_buffer.remaining_size(), 0);
+  auto mesh_or = decoder.DecodeMesh();
+  ASSERT_TRUE(mesh_or.ok()) << mesh_or.status().error_msg();
+  const std::unique_ptr<draco::Mesh> decoded_mesh = std::move(mesh_or).value();
+  ASSERT_EQ(decoded_mesh->num_faces(), mesh->num_faces());
+  // All tiles share the same quantization grid so the points on the tile
+  // borders are merged back together.
+  ASSERT_EQ(decoded_mesh->num_points(), mesh->num_points());
+}
+
+TEST_F(TiledMeshTest, TestDecodeMeshInBox) {
+  const std::unique_ptr<draco::Mesh> mesh = CreateGrid(32);
+  ASSERT_NE(mesh, nullptr);
+  draco::EncoderBuffer buffer;
+  EncodeTiled(*mesh, 1, &buffer);
+
+  draco::DecoderBuffer dec_buffer;
+  dec_buffer.Init(buffer.data(), buffer.size());
+  draco::TiledMeshDecoder decoder(2);
+  ASSERT_TRUE(decoder.DecodeTileIndex(&dec_buffer).ok());
+  const draco::BoundingBox box(draco::Vector3f(1.f, 1.f, -1.f),
+                               draco::Vector3f(3.f, 3.f, 1.f));
+  const std::vector<int> tile_ids = decoder.FindTiles(box);
+  ASSERT_FALSE(tile_ids.empty());
+  ASSERT_LT(tile_ids.size(), static_cast<size_t>(decoder.num_tiles()));
+
+  auto mesh_or = decoder.DecodeMeshInBox(box);
+  ASSERT_TRUE(mesh_or.ok()) << mesh_or.status().error_msg();
+  const std::unique_ptr<draco::Mesh> region = std::move(mesh_or).value();
+  uint32_t expected_num_faces = 0;
+  for (int tile_id : tile_ids) {
+    expected_num_faces += decoder.tile(tile_id).num_faces;
+  }
+  ASSERT_EQ(region->num_faces(), expected_num_faces);
+  ASSERT_LT(region->num_faces(), mesh->num_faces());
+
+  // Invalid tile ids are reported for each tile separately.
+  auto tiles = decoder.DecodeTiles({tile_ids[0], decoder.num_tiles()});
+  ASSERT_EQ(tiles.size(), 2u);
+  ASSERT_TRUE(tiles[0].ok());
+  ASSERT_FALSE(tiles[1].ok());
+}
+
+TEST_F(TiledMeshTest, TestAttributeSeam) {
+  const std::unique_ptr<draco::Mesh> mesh = CreateGrid(32, true);
+  ASSERT_NE(mesh, nullptr);
+  const draco::PointAttribute *const pos_att =
+      mesh->GetNamedAttribute(draco::GeometryAttribute::POSITION);
+  ASSERT_EQ(pos_att->size(), 33u * 33u);
+  ASSERT_GT(mesh->num_points(), pos_att->size());
+  draco::EncoderBuffer buffer;
+  EncodeTiled(*mesh, 1, &buffer);
+
+  draco::DecoderBuffer dec_buffer;
+  dec_buffer.Init(buffer.data(), buffer.size());
+  draco::TiledMeshDecoder decoder(2);
+  ASSERT_TRUE(decoder.DecodeTileIndex(&dec_buffer).ok());
+  std::vector<int> tile_ids(decoder.num_tiles());
+  for (int i = 0; i < decoder.num_tiles(); ++i) {
+    tile_ids[i] = i;
+  }
+  // Points on the seam share their positions within each tile, i.e., there
+  // are no cracks along the seam in the decoded tiles.
+  for (auto &tile_or : decoder.DecodeTiles(tile_ids)) {
+    ASSERT_TRUE(tile_or.ok()) << tile_or.status().error_msg();
+    const draco::Mesh &tile = *tile_or.value();
+    const draco::PointAttribute *const tile_pos_att =
+        tile.GetNamedAttribute(draco::GeometryAttribute::POSITION);
+    std::set<std::array<float, 3>> positions;
+    for (draco::AttributeValueIndex i(0); i < tile_pos_att->size(); ++i) {
+      std::array<float, 3> pos;
+      tile_pos_att->ConvertValue<float>(i, 3, &pos[0]);
+      positions.insert(pos);
+    }
+    ASSERT_EQ(positions.size(), tile_pos_att->size());
+  }
+
+  auto mesh_or = decoder.DecodeMesh();
+  ASSERT_TRUE(mesh_or.ok()) << mesh_or.status().error_msg();
+  ASSERT_EQ(mesh_or.value()->num_points(), mesh->num_points());
+}
+
+TEST_F(TiledMeshTest, TestDeterministicThreading) {
+  const std::unique_ptr<draco::Mesh> mesh = CreateGrid(24);
+  ASSERT_NE(mesh, nullptr);
+  draco::EncoderBuffer buffer;
+  EncodeTiled(*mesh, 1, &buffer);
+  draco::EncoderBuffer mt_buffer;
+  EncodeTiled(*mesh, 4, &mt_buffer);
+  ASSERT_EQ(buffer.size(), mt_buffer.size());
+  ASSERT_EQ(memcmp(buffer.data(), mt_buffer.data(), buffer.size()), 0);
+}
+
+TEST_F(TiledMeshTest, TestInvalidInput) {
+  std::unique_ptr<draco::PointCloud> pc(
+      draco::ReadPointCloudFromTestFile("point_cloud_test_pos.ply"));
+  ASSERT_NE(pc, nullptr);
+  draco::TiledMeshEncoder encoder;
+  draco::EncoderBuffer buffer;
+  ASSERT_FALSE(encoder.EncodePointCloudToBuffer(*pc, &buffer).ok());
+
+  // Regular Draco stream is not a tiled mesh.
+  const std::unique_ptr<draco::Mesh> mesh = CreateGrid(4);
+  ASSERT_NE(mesh, nullptr);
+  draco::Encoder regular_encoder;
+  ASSERT_TRUE(regular_encoder.EncodeMeshToBuffer(*mesh, &buffer).ok());
+  draco::DecoderBuffer dec_buffer;
+  dec_buffer.Init(buffer.data(), buffer.size());
+  draco::TiledMeshDecoder decoder(1);
+  ASSERT_FALSE(decoder.DecodeTileIndex(&dec_buffer).ok());
+}
+
+}  // namespace
@@ -0,0 +1,315 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/vertex_layout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "draco/attributes/attribute_octahedron_transform.h"
+#include "draco/attributes/attribute_quantization_transform.h"
+#include "draco/compression/attributes/normal_compression_utils.h"
+#include "draco/core/quantization_utils.h"
+
+namespace draco {
+
+namespace {
+
+// Converts |value| to the nearest IEEE 754 half-precision float (ties are
+// rounded to even).
+uint16_t FloatToHalf(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+  const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff);
+  uint32_t mantissa = bits & 0x7fffff;
+  if (exponent == 0xff) {
+    // Infinity or NaN.
+    return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+  }
+  const int32_t half_exponent = exponent - 127 + 15;
+  if (half_exponent >= 0x1f)
+    return sign | 0x7c00;  // Overflow to infinity.
+  if (half_exponent <= 0) {
+    // Denormalized half value.
+    if (half_exponent < -10)
+      return sign;
+    mantissa |= 0x800000;
+    const int shift = 14 - half_exponent;
+    uint32_t half_mantissa = mantissa >> shift;
+    const uint32_t remainder = mantissa & ((1u << shift) - 1);
+    const uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (half_mantissa & 1)))
+      ++half_mantissa;
+    return sign | static_cast<uint16_t>(half_mantissa);
+  }
+  uint32_t half =
+      (static_cast<uint32_t>(half_exponent) << 10) | (mantissa >> 13);
+  const uint32_t remainder = mantissa & 0x1fff;
+  // The rounding can carry over to the exponent which is the desired result.
+  if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+    ++half;
+  return sign | static_cast<uint16_t>(half);
+}
+
+template <typename T>
+T ToInteger(double value, bool normalized) {
+  if (std::isnan(value))
+    return 0;
+  if (normalized) {
+    const double min_value = std::numeric_limits<T>::is_signed ? -1.0 : 0.0;
+    value = std::max(min_value, std::min(value, 1.0)) *
+            static_cast<double>(std::numeric_limits<T>::max());
+  }
+  value = std::floor(value + 0.5);
+  value = std::max(static_cast<double>(std::numeric_limits<T>::lowest()),
+                   std::min(value, static_cast<double>(
+                                       std::numeric_limits<T>::max())));
+  return static_cast<T>(value);
+}
+
+// Function that writes |num_components| values into |out_data| using one of
+// the vertex component types.
+typedef void (*WriteComponentsFunction)(const double *values,
+                                        int num_components, bool normalized,
+                                        uint8_t *out_data);
+
+template <typename T>
+void WriteIntegerComponents(const double *values, int num_components,
+                            bool normalized, uint8_t *out_data) {
+  for (int c = 0; c < num_components; ++c) {
+    const T value = ToInteger<T>(values[c], normalized);
+    memcpy(out_data + c * sizeof(T), &value, sizeof(T));
+  }
+}
+
+void WriteFloat32Components(const double *values, int num_components,
+                            bool /* normalized */, uint8_t *out_data) {
+  for (int c = 0; c < num_components; ++c) {
+    const float value = static_cast<float>(values[c]);
+    memcpy(out_data + c * sizeof(float), &value, sizeof(float));
+  }
+}
+
+void WriteFloat16Components(const double *values, int num_components,
+                            bool /* normalized */, uint8_t *out_data) {
+  for (int c = 0; c < num_components; ++c) {
+    const uint16_t value = FloatToHalf(static_cast<float>(values[c]));
+    memcpy(out_data + c * sizeof(uint16_t), &value, sizeof(uint16_t));
+  }
+}
+
+WriteComponentsFunction GetWriteComponentsFunction(VertexComponentType type) {
+  switch (type) {
+    case VERTEX_COMPONENT_FLOAT32:
+      return WriteFloat32Components;
+    case VERTEX_COMPONENT_FLOAT16:
+      return WriteFloat16Components;
+    case VERTEX_COMPONENT_INT8:
+      return WriteIntegerComponents<int8_t>;
+    case VERTEX_COMPONENT_UINT8:
+      return WriteIntegerComponents<uint8_t>;
+    case VERTEX_COMPONENT_INT16:
+      return WriteIntegerComponents<int16_t>;
+    case VERTEX_COMPONENT_UINT16:
+      return WriteIntegerComponents<uint16_t>;
+    case VERTEX_COMPONENT_INT32:
+      return WriteIntegerComponents<int32_t>;
+    case VERTEX_COMPONENT_UINT32:
+      return WriteIntegerComponents<uint32_t>;
+  }
+  return nullptr;
+}
+
+// Returns the |c|-th quantized component of the value mapped to point |p|.
+// Quantized portable values are stored either as int32 or uint32 numbers that
+// always fit into the positive range of int32.
+inline int32_t GetQuantizedComponent(const PointAttribute &att, PointIndex p,
+                                     int c) {
+  int32_t value;
+  memcpy(&value, att.GetAddress(att.mapped_index(p)) + c * sizeof(int32_t),
+         sizeof(int32_t));
+  return value;
+}
+
+bool HasQuantizedDataType(const PointAttribute &att) {
+  return att.data_type() == DT_INT32 || att.data_type() == DT_UINT32;
+}
+
+Status WriteVertexElement(PointIndex::ValueType num_points,
+                          const PointAttribute &att,
+                          const VertexElement &element, int stride,
+                          uint8_t *out_data) {
+  const WriteComponentsFunction write_components =
+      GetWriteComponentsFunction(element.component_type);
+  const int num_components = element.num_components;
+  const int num_att_components = att.num_components();
+  // Source values of a single point. Octahedral values are always decoded to
+  // three components. Components that are not present in the source attribute
+  // stay zero.
+  std::vector<double> values(
+      std::max(std::max(num_components, num_att_components), 3), 0.0);
+  out_data += element.offset;
+
+  const AttributeTransformData *const transform_data =
+      att.GetAttributeTransformData();
+  const AttributeTransformType transform_type =
+      transform_data ? transform_data->transform_type()
+                     : ATTRIBUTE_INVALID_TRANSFORM;
+  if (transform_type == ATTRIBUTE_QUANTIZATION_TRANSFORM) {
+    AttributeQuantizationTransform transform;
+    if (!transform.InitFromAttribute(att) || !HasQuantizedDataType(att) ||
+        transform.quantization_bits() < 1 || transform.quantization_bits() > 31)
+      return Status(Status::DRACO_ERROR, "Invalid quantized attribute.");
+    const int32_t max_quantized_value =
+        (1u << static_cast<uint32_t>(transform.quantization_bits())) - 1;
+    Dequantizer dequantizer;
+    if (!dequantizer.Init(transform.range(), max_quantized_value))
+      return Status(Status::DRACO_ERROR, "Invalid quantized attribute.");
+    for (PointIndex p(0); p < num_points; ++p) {
+      for (int c = 0; c < num_att_components; ++c) {
+        // Same operations as in the regular dequantization of the decoder.
+        const float value =
+            dequantizer.DequantizeFloat(GetQuantizedComponent(att, p, c)) +
+            transform.min_value(c);
+        values[c] = value;
+      }
+      write_components(values.data(), num_components, element.normalized,
+                       out_data);
+      out_data += stride;
+    }
+  } else if (transform_type == ATTRIBUTE_OCTAHEDRON_TRANSFORM) {
+    AttributeOctahedronTransform transform;
+    OctahedronToolBox octahedron_tool_box;
+    if (!transform.InitFromAttribute(att) || !HasQuantizedDataType(att) ||
+        num_att_components != 2 ||
+        !octahedron_tool_box.SetQuantizationBits(transform.quantization_bits()))
+      return Status(Status::DRACO_ERROR, "Invalid octahedral attribute.");
+    float normal[3];
+    for (PointIndex p(0); p < num_points; ++p) {
+      octahedron_tool_box.QuantizedOctaherdalCoordsToUnitVector(
+          GetQuantizedComponent(att, p, 0), GetQuantizedComponent(att, p, 1),
+          normal);
+      for (int c = 0; c < 3; ++c) {
+        values[c] = normal[c];
+      }
+      write_components(values.data(), num_components, element.normalized,
+                       out_data);
+      out_data += stride;
+    }
+  } else {
+    for (PointIndex p(0); p < num_points; ++p) {
+      if (!att.ConvertValue<double>(att.mapped_index(p), values.data()))
+        return Status(Status::DRACO_ERROR, "Unsupported attribute data type.");
+      write_components(values.data(), num_components, element.normalized,
+                       out_data);
+      out_data += stride;
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+int VertexComponentTypeLength(VertexComponentType type) {
+  switch (type) {
+    case VERTEX_COMPONENT_INT8:
+    case VERTEX_COMPONENT_UINT8:
+      return 1;
+    case VERTEX_COMPONENT_FLOAT16:
+    case VERTEX_COMPONENT_INT16:
+    case VERTEX_COMPONENT_UINT16:
+      return 2;
+    case VERTEX_COMPONENT_FLOAT32:
+    case VERTEX_COMPONENT_INT32:
+    case VERTEX_COMPONENT_UINT32:
+      return 4;
+  }
+  return -1;
+}
+
+Status WriteVertexBuffer(const PointCloud &pc, const VertexLayout &layout,
+                         void *out_data, size_t out_data_size) {
+  std::vector<const PointAttribute *> attributes;
+  for (const VertexElement &element : layout.elements) {
+    if (element.attribute_id < 0 ||
+        element.attribute_id >= pc.num_attributes())
+      return Status(Status::DRACO_ERROR, "Invalid vertex element.");
+    attributes.push_back(pc.attribute(element.attribute_id));
+  }
+  return WriteVertexBuffer(pc.num_points(), layout, attributes, out_data,
+                           out_data_size);
+}
+
+Status WriteVertexBuffer(PointIndex::ValueType num_points,
+                         const VertexLayout &layout,
+                         const std::vector<const PointAttribute *> &attributes,
+                         void *out_data, size_t out_data_size) {
+  if (layout.stride <= 0)
+    return Status(Status::DRACO_ERROR, "Invalid vertex stride.");
+  if (static_cast<uint64_t>(num_points) * layout.stride > out_data_size)
+    return Status(Status::DRACO_ERROR, "Vertex buffer is too small.");
+  if (attributes.size() != layout.elements.size())
+    return Status(Status::DRACO_ERROR, "Invalid vertex element.");
+  for (size_t i = 0; i < layout.elements.size(); ++i) {
+    const VertexElement &element = layout.elements[i];
+    const int component_size =
+        VertexComponentTypeLength(element.component_type);
+    if (attributes[i] == nullptr || component_size < 0 ||
+        element.num_components <= 0 || element.offset < 0 ||
+        element.offset + element.num_components * component_size >
+            layout.stride)
+      return Status(Status::DRACO_ERROR, "Invalid vertex element.");
+  }
+  for (size_t i = 0; i < layout.elements.size(); ++i) {
+    DRACO_RETURN_IF_ERROR(WriteVertexElement(
+        num_points, *attributes[i], layout.elements[i], layout.stride,
+        static_cast<uint8_t *>(out_data)))
+  }
+  return OkStatus();
+}
+
+Status WriteIndexBuffer(const Mesh &mesh, DataType index_type, void *out_data,
+                        size_t out_data_size) {
+  if (index_type != DT_UINT16 && index_type != DT_UINT32)
+    return Status(Status::DRACO_ERROR, "Unsupported index type.");
+  if (index_type == DT_UINT16 &&
+      mesh.num_points() > std::numeric_limits<uint16_t>::max() + 1)
+    return Status(Status::DRACO_ERROR, "Too many points for 16-bit indices.");
+  const size_t index_size = DataTypeLength(index_type);
+  if (static_cast<uint64_t>(mesh.num_faces()) * 3 * index_size > out_data_size)
+    return Status(Status::DRACO_ERROR, "Index buffer is too small.");
+  if (index_type == DT_UINT16) {
+    uint16_t *const indices = static_cast<uint16_t *>(out_data);
+    for (FaceIndex f(0); f < mesh.num_faces(); ++f) {
+      const Mesh::Face &face = mesh.face(f);
+      for (int c = 0; c < 3; ++c) {
+        indices[3 * f.value() + c] = static_cast<uint16_t>(face[c].value());
+      }
+    }
+  } else {
+    uint32_t *const indices = static_cast<uint32_t *>(out_data);
+    for (FaceIndex f(0); f < mesh.num_faces(); ++f) {
+      const Mesh::Face &face = mesh.face(f);
+      for (int c = 0; c < 3; ++c) {
+        indices[3 * f.value() + c] = face[c].value();
+      }
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace draco
@@ -0,0 +1,107 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_COMPRESSION_VERTEX_LAYOUT_H_
+#define DRACO_COMPRESSION_VERTEX_LAYOUT_H_
+
+#include <vector>
+
+#include "draco/core/draco_types.h"
+#include "draco/core/status.h"
+#include "draco/mesh/mesh.h"
+#include "draco/point_cloud/point_cloud.h"
+
+namespace draco {
+
+// Types of components that can be written into an interleaved vertex buffer.
+enum VertexComponentType {
+  VERTEX_COMPONENT_FLOAT32 = 0,
+  // IEEE 754 half-precision float.
+  VERTEX_COMPONENT_FLOAT16,
+  VERTEX_COMPONENT_INT8,
+  VERTEX_COMPONENT_UINT8,
+  VERTEX_COMPONENT_INT16,
+  VERTEX_COMPONENT_UINT16,
+  VERTEX_COMPONENT_INT32,
+  VERTEX_COMPONENT_UINT32,
+};
+
+// Returns the size of a single component of the given type in bytes.
+int VertexComponentTypeLength(VertexComponentType type);
+
+// Describes where and in what format the values of one attribute are stored
+// within a vertex.
+struct VertexElement {
+  VertexElement()
+      : attribute_id(-1),
+        offset(0),
+        num_components(0),
+        component_type(VERTEX_COMPONENT_FLOAT32),
+        normalized(false) {}
+  VertexElement(int att_id, int byte_offset, int components,
+                VertexComponentType type, bool normalized_int)
+      : attribute_id(att_id),
+        offset(byte_offset),
+        num_components(components),
+        component_type(type),
+        normalized(normalized_int) {}
+
+  // Id of the source attribute in the decoded geometry (the same as the index
+  // in GeometryInfo::attributes).
+  int attribute_id;
+  // Byte offset of the first component from the start of the vertex.
+  int offset;
+  // Number of written components. Components missing in the source attribute
+  // are set to zero and extra source components are ignored.
+  int num_components;
+  VertexComponentType component_type;
+  // For integer component types, values are mapped from <-1, 1> (signed
+  // types) or <0, 1> (unsigned types) to the full range of the type.
+  bool normalized;
+};
+
+// Layout of a single vertex in an interleaved vertex buffer.
+struct VertexLayout {
+  VertexLayout() : stride(0) {}
+
+  // Number of bytes between the starts of two consecutive vertices.
+  int stride;
+  std::vector<VertexElement> elements;
+};
+
+// Writes the values of all attributes described by |layout| for all points of
+// |pc| into |out_data| that must hold at least |pc.num_points()| vertices.
+// Attributes holding quantized or octahedral values together with their
+// attribute transform data (see DecoderOptions "skip_attribute_transform")
+// are transformed to their original values while they are written, so the
+// final floating point values never need to be stored in the attribute.
+Status WriteVertexBuffer(const PointCloud &pc, const VertexLayout &layout,
+                         void *out_data, size_t out_data_size);
+
+// Same as above, but the values of the i-th element of |layout| are read from
+// |attributes[i]| instead of the attribute with the element's id. Used to write
+// attributes that are kept in their portable form by the decoder.
+Status WriteVertexBuffer(PointIndex::ValueType num_points,
+                         const VertexLayout &layout,
+                         const std::vector<const PointAttribute *> &attributes,
+                         void *out_data, size_t out_data_size);
+
+// Writes point indices of all faces of |mesh| into |out_data| using
+// |index_type| that can be either DT_UINT16 or DT_UINT32.
+Status WriteIndexBuffer(const Mesh &mesh, DataType index_type, void *out_data,
+                        size_t out_data_size);
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_VERTEX_LAYOUT_H_
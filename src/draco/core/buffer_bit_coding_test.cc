@@ -15,6 +15,9 @@
 #include "draco/core/decoder_buffer.h"
 #include "draco/core/encoder_buffer.h"
 
+#include <random>
+#include <vector>
+
 #include "draco/core/draco_test_base.h"
 
 namespace draco {
@@ -23,6 +26,50 @@ class BufferBitCodingTest : public ::testing::Test {
  public:
   typedef DecoderBuffer::BitDecoder BitDecoder;
   typedef EncoderBuffer::BitEncoder BitEncoder;
+
+ protected:
+  // Reference implementation of the bit writer that writes one bit at a time.
+  static void PutBitsReference(uint32_t data, int32_t nbits, char *buffer,
+                               uint64_t *bit_offset) {
+    for (int32_t bit = 0; bit < nbits; ++bit) {
+      const uint64_t byte_offset = *bit_offset / 8;
+      const int bit_shift = *bit_offset % 8;
+      buffer[byte_offset] &= ~(1 << bit_shift);
+      buffer[byte_offset] |= ((data >> bit) & 1) << bit_shift;
+      ++*bit_offset;
+    }
+  }
+
+  // Reference implementation of the bit reader that reads one bit at a time.
+  // Bits past the end of the buffer are returned as zeros.
+  static uint32_t GetBitsReference(int32_t nbits, const char *buffer,
+                                   uint64_t buffer_size, uint64_t *bit_offset) {
+    uint32_t value = 0;
+    for (int32_t bit = 0; bit < nbits; ++bit) {
+      const uint64_t byte_offset = *bit_offset / 8;
+      if (byte_offset >= buffer_size)
+        break;
+      const int bit_shift = *bit_offset % 8;
+      value |= ((static_cast<uint8_t>(buffer[byte_offset]) >> bit_shift) & 1)
+               << bit;
+      ++*bit_offset;
+    }
+    return value;
+  }
+
+  // Generates |num_values| random values with random bit lengths.
+  static void GenerateRandomValues(int num_values,
+                                   std::vector<uint32_t> *values,
+                                   std::vector<int32_t> *num_bits) {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int32_t> num_bits_distribution(0, 32);
+    values->resize(num_values);
+    num_bits->resize(num_values);
+    for (int i = 0; i < num_values; ++i) {
+      (*values)[i] = generator();
+      (*num_bits)[i] = num_bits_distribution(generator);
+    }
+  }
 };
 
 TEST_F(BufferBitCodingTest, TestBitCodersByteAligned) {
@@ -113,4 +160,79 @@ TEST_F(BufferBitCodingTest, TestMultipleBits) {
   }
 }
 
+TEST_F(BufferBitCodingTest, TestBitExactness) {
+  // Tests that the bit coders produce the same results as the reference
+  // implementations that process one bit at a time.
+  constexpr int kNumValues = 10000;
+  std::vector<uint32_t> values;
+  std::vector<int32_t> num_bits;
+  GenerateRandomValues(kNumValues, &values, &num_bits);
+
+  // Bits that are not written by the encoder must keep their original values.
+  const size_t buffer_size = kNumValues * 4 + 8;
+  std::vector<char> buffer(buffer_size, 0x5a);
+  std::vector<char> reference_buffer(buffer_size, 0x5a);
+  BitEncoder encoder(buffer.data());
+  uint64_t reference_bit_offset = 0;
+  for (int i = 0; i < kNumValues; ++i) {
+    encoder.PutBits(values[i], num_bits[i]);
+    PutBitsReference(values[i], num_bits[i], reference_buffer.data(),
+                     &reference_bit_offset);
+    ASSERT_EQ(encoder.Bits(), reference_bit_offset);
+  }
+  ASSERT_EQ(buffer, reference_buffer);
+
+  // Decode the data past the end of the encoded bits to test the behavior on
+  // the buffer boundary.
+  const uint64_t encoded_size = (reference_bit_offset + 7) / 8;
+  BitDecoder decoder;
+  decoder.reset(buffer.data(), encoded_size);
+  reference_bit_offset = 0;
+  for (int i = 0; i < kNumValues + 10; ++i) {
+    const int32_t nbits = num_bits[i % kNumValues];
+    uint32_t x;
+    ASSERT_TRUE(decoder.GetBits(nbits, &x));
+    ASSERT_EQ(x, GetBitsReference(nbits, buffer.data(), encoded_size,
+                                  &reference_bit_offset));
+    ASSERT_EQ(decoder.BitsDecoded(), reference_bit_offset);
+  }
+}
+
+TEST_F(BufferBitCodingTest, TestBitCodingChecksum) {
+  // Tests that the bit coders and the reference implementations agree on
+  // data written by the other implementation, including the zero bits read
+  // past the end of the encoded data.
+  constexpr int kNumValues = 1000;
+  std::vector<uint32_t> values;
+  std::vector<int32_t> num_bits;
+  GenerateRandomValues(kNumValues, &values, &num_bits);
+  std::vector<char> buffer(kNumValues * 4 + 8);
+  std::vector<char> reference_buffer(buffer.size());
+
+  uint64_t reference_bit_offset = 0;
+  BitEncoder encoder(buffer.data());
+  for (int i = 0; i < kNumValues; ++i) {
+    PutBitsReference(values[i], num_bits[i], reference_buffer.data(),
+                     &reference_bit_offset);
+    encoder.PutBits(values[i], num_bits[i]);
+  }
+  ASSERT_EQ(buffer, reference_buffer);
+
+  reference_bit_offset = 0;
+  uint32_t reference_checksum = 0;
+  BitDecoder decoder;
+  decoder.reset(buffer.data(), buffer.size());
+  uint32_t checksum = 0;
+  // Decode the values twice to read past the end of the encoded bits.
+  for (int i = 0; i < 2 * kNumValues; ++i) {
+    const int32_t nbits = num_bits[i % kNumValues];
+    reference_checksum += GetBitsReference(nbits, buffer.data(), buffer.size(),
+                                           &reference_bit_offset);
+    uint32_t x;
+    ASSERT_TRUE(decoder.GetBits(nbits, &x));
+    checksum += x;
+  }
+  ASSERT_EQ(checksum, reference_checksum);
+}
+
 }  // namespace draco
@@ -0,0 +1,100 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/core/chrome_trace_recorder.h"
+
+#include <cstdio>
+#include <fstream>
+
+namespace draco {
+
+ChromeTraceRecorder::ChromeTraceRecorder()
+    : start_time_(std::chrono::steady_clock::now()) {}
+
+void ChromeTraceRecorder::BeginStage(const char *name) {
+  AddEvent(name, 'B', -1);
+}
+
+void ChromeTraceRecorder::EndStage(const char *name, int64_t num_bytes) {
+  AddEvent(name, 'E', num_bytes);
+}
+
+void ChromeTraceRecorder::AddEvent(const char *name, char phase,
+                                   int64_t num_bytes) {
+  const int64_t timestamp_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start_time_)
+          .count();
+  const std::thread::id thread = std::this_thread::get_id();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = thread_ids_.find(thread);
+  if (it == thread_ids_.end()) {
+    const int new_id = static_cast<int>(thread_ids_.size());
+    it = thread_ids_.insert(std::make_pair(thread, new_id)).first;
+  }
+  Event event;
+  event.name = name;
+  event.phase = phase;
+  event.timestamp_ns = timestamp_ns;
+  event.thread_id = it->second;
+  event.num_bytes = num_bytes;
+  events_.push_back(event);
+}
+
+std::vector<ChromeTraceRecorder::Event> ChromeTraceRecorder::GetEvents() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return events_;
+}
+
+void ChromeTraceRecorder::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.clear();
+}
+
+std::string ChromeTraceRecorder::ToJson() const {
+  const std::vector<Event> events = GetEvents();
+  std::string json = "{\"traceEvents\":[";
+  char entry[256];
+  for (size_t i = 0; i < events.size(); ++i) {
+    const Event &event = events[i];
+    // Timestamps are stored in microseconds. Keep the full nanosecond
+    // precision using the fractional part.
+    snprintf(entry, sizeof(entry),
+             "%s\n{\"name\":\"%s\",\"cat\":\"draco\",\"ph\":\"%c\","
+             "\"ts\":%" PRId64 ".%03d,\"pid\":0,\"tid\":%d",
+             i == 0 ? "" : ",", event.name, event.phase,
+             event.timestamp_ns / 1000,
+             static_cast<int>(event.timestamp_ns % 1000), event.thread_id);
+    json += entry;
+    if (event.phase == 'E' && event.num_bytes >= 0) {
+      snprintf(entry, sizeof(entry), ",\"args\":{\"bytes\":%" PRId64 "}",
+               event.num_bytes);
+      json += entry;
+    }
+    json += "}";
+  }
+  json += "\n],\"displayTimeUnit\":\"ns\"}\n";
+  return json;
+}
+
+bool ChromeTraceRecorder::WriteJsonToFile(const std::string &file_name) const {
+  std::ofstream file(file_name, std::ios::binary);
+  if (!file)
+    return false;
+  const std::string json = ToJson();
+  file.write(json.data(), json.size());
+  return static_cast<bool>(file);
+}
+
+}  // namespace draco
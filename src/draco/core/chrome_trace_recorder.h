@@ -0,0 +1,84 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_CORE_CHROME_TRACE_RECORDER_H_
+#define DRACO_CORE_CHROME_TRACE_RECORDER_H_
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "draco/core/tracer.h"
+
+namespace draco {
+
+// Tracer that records all events with nanosecond timestamps and exports them
+// in the Chrome trace event format. The exported JSON can be loaded in
+// chrome://tracing or in the Perfetto UI.
+//
+// Example:
+//
+//   ChromeTraceRecorder recorder;
+//   Decoder decoder;
+//   decoder.options()->SetTracer(&recorder);
+//   decoder.DecodeMeshFromBuffer(&buffer);
+//   recorder.WriteJsonToFile("decode_trace.json");
+//
+class ChromeTraceRecorder : public Tracer {
+ public:
+  struct Event {
+    const char *name;
+    // 'B' for begin events and 'E' for end events.
+    char phase;
+    // Time since the creation of the recorder.
+    int64_t timestamp_ns;
+    // Sequential id of the thread that reported the event.
+    int thread_id;
+    // Number of bytes processed by the stage (-1 when unknown or for begin
+    // events).
+    int64_t num_bytes;
+  };
+
+  ChromeTraceRecorder();
+
+  void BeginStage(const char *name) override;
+  void EndStage(const char *name, int64_t num_bytes) override;
+
+  // Returns a copy of all recorded events.
+  std::vector<Event> GetEvents() const;
+
+  // Removes all recorded events.
+  void Clear();
+
+  // Returns all recorded events in the Chrome trace JSON format.
+  std::string ToJson() const;
+
+  // Writes the JSON returned by ToJson() to a file. Returns false on error.
+  bool WriteJsonToFile(const std::string &file_name) const;
+
+ private:
+  void AddEvent(const char *name, char phase, int64_t num_bytes);
+
+  const std::chrono::steady_clock::time_point start_time_;
+  mutable std::mutex mutex_;
+  std::vector<Event> events_;
+  std::map<std::thread::id, int> thread_ids_;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_CORE_CHROME_TRACE_RECORDER_H_
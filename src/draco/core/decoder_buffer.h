@@ -15,6 +15,7 @@
 #ifndef DRACO_CORE_DECODER_BUFFER_H_
 #define DRACO_CORE_DECODER_BUFFER_H_
 
+#include <stddef.h>
 #include <stdint.h>
 #include <cstring>
 #include <memory>
@@ -142,12 +143,7 @@ class DecoderBuffer {
     inline uint32_t EnsureBits(int k) {
       DRACO_DCHECK_LE(k, 24);
       DRACO_DCHECK_LE(static_cast<uint64_t>(k), AvailBits());
-
-      uint32_t buf = 0;
-      for (int i = 0; i < k; ++i) {
-        buf |= PeekBit(i) << i;
-      }
-      return buf;  // Okay to return extra bits
+      return PeekBits(k);  // Okay to return extra bits
     }
 
     inline void ConsumeBits(int k) { bit_offset_ += k; }
@@ -156,37 +152,36 @@ class DecoderBuffer {
     inline bool GetBits(int32_t nbits, uint32_t *x) {
       DRACO_DCHECK_GE(nbits, 0);
       DRACO_DCHECK_LE(nbits, 32);
-      uint32_t value = 0;
-      for (int32_t bit = 0; bit < nbits; ++bit)
-        value |= GetBit() << bit;
-      *x = value;
+      *x = PeekBits(nbits);
+      // Bits past the end of the buffer are returned as zeros and they are
+      // not counted as decoded.
+      const uint64_t avail_bits = AvailBits();
+      bit_offset_ += static_cast<uint64_t>(nbits) < avail_bits
+                         ? static_cast<size_t>(nbits)
+                         : static_cast<size_t>(avail_bits);
       return true;
     }
 
    private:
     // TODO(fgalligan): Add support for error reporting on range check.
-    // Returns one bit from the bit buffer.
-    inline int GetBit() {
-      const size_t off = bit_offset_;
-      const size_t byte_offset = off >> 3;
-      const int bit_shift = static_cast<int>(off & 0x7);
-      if (bit_buffer_ + byte_offset < bit_buffer_end_) {
-        const int bit = (bit_buffer_[byte_offset] >> bit_shift) & 1;
-        bit_offset_ = off + 1;
-        return bit;
-      }
-      return 0;
-    }
-
-    inline int PeekBit(int offset) {
-      const size_t off = bit_offset_ + offset;
-      const size_t byte_offset = off >> 3;
-      const int bit_shift = static_cast<int>(off & 0x7);
-      if (bit_buffer_ + byte_offset < bit_buffer_end_) {
-        const int bit = (bit_buffer_[byte_offset] >> bit_shift) & 1;
-        return bit;
+    // Returns the next |nbits| bits without advancing the bit offset. Bits
+    // past the end of the buffer are set to zero.
+    inline uint32_t PeekBits(int32_t nbits) const {
+      const size_t byte_offset = bit_offset_ >> 3;
+      const int bit_shift = static_cast<int>(bit_offset_ & 0x7);
+      const uint8_t *const src = bit_buffer_ + byte_offset;
+      // Load 64 bits at once whenever possible. Up to 39 bits are needed to
+      // extract 32 bits from an arbitrary bit offset.
+      uint64_t word = 0;
+      if (bit_buffer_end_ - src >= static_cast<ptrdiff_t>(sizeof(word))) {
+        memcpy(&word, src, sizeof(word));
+      } else {
+        for (const uint8_t *ptr = src; ptr < bit_buffer_end_; ++ptr) {
+          word |= static_cast<uint64_t>(*ptr) << (8 * (ptr - src));
+        }
       }
-      return 0;
+      const uint64_t mask = (static_cast<uint64_t>(1) << nbits) - 1;
+      return static_cast<uint32_t>((word >> bit_shift) & mask);
     }
 
     const uint8_t *bit_buffer_;
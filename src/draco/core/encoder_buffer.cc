@@ -21,15 +21,41 @@
 namespace draco {
 
 EncoderBuffer::EncoderBuffer()
-    : bit_encoder_reserved_bytes_(false), encode_bit_sequence_size_(false) {}
+    : bit_encoder_reserved_bytes_(false),
+      encode_bit_sequence_size_(false),
+      sink_(nullptr),
+      staging_size_(0),
+      num_flushed_bytes_(0),
+      sink_failed_(false) {}
 
 void EncoderBuffer::Clear() {
   buffer_.clear();
   bit_encoder_reserved_bytes_ = 0;
+  num_flushed_bytes_ = 0;
+  sink_failed_ = false;
 }
 
 void EncoderBuffer::Resize(int64_t nbytes) { buffer_.resize(nbytes); }
 
+void EncoderBuffer::SetSink(EncoderBufferSink *sink, size_t staging_size) {
+  sink_ = sink;
+  staging_size_ = staging_size;
+  sink_failed_ = false;
+}
+
+bool EncoderBuffer::Flush() {
+  if (bit_encoder_active())
+    return false;
+  if (sink_ == nullptr || buffer_.empty())
+    return !sink_failed_;
+  if (!sink_failed_ && !sink_->Write(buffer_.data(), buffer_.size()))
+    sink_failed_ = true;
+  num_flushed_bytes_ += buffer_.size();
+  // The staged data is discarded even on failure to keep the memory bounded.
+  buffer_.clear();
+  return !sink_failed_;
+}
+
 bool EncoderBuffer::StartBitEncoding(int64_t required_bits, bool encode_size) {
   if (bit_encoder_active())
     return false;  // Bit encoding mode already active.
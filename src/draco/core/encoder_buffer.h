@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "draco/core/bit_utils.h"
+#include "draco/core/encoder_buffer_sink.h"
 #include "draco/core/macros.h"
 
 namespace draco {
@@ -26,12 +27,34 @@ namespace draco {
 // Class representing a buffer that can be used for either for byte-aligned
 // encoding of arbitrary data structures or for encoding of variable-length
 // bit data.
+// By default, all encoded data is stored in the buffer. When a sink is set
+// (see SetSink()), the buffer holds only a staging area that is written to the
+// sink once it grows over a given size, so the memory needed by the buffer
+// doesn't depend on the total size of the encoded data. In this case, data(),
+// size() and Resize() refer only to the data that wasn't written to the sink
+// yet.
 class EncoderBuffer {
  public:
   EncoderBuffer();
   void Clear();
   void Resize(int64_t nbytes);
 
+  // Default size of the staging area used with sinks.
+  static constexpr size_t kDefaultStagingSize = 1 << 16;
+
+  // Sets a |sink| that receives all subsequently encoded data. Staged data is
+  // written to the sink whenever its size reaches |staging_size| bytes and a
+  // new value is encoded. Data that is still being modified (such as reserved
+  // memory for bit sequences) is never written until it is finished. Flush()
+  // must be called to write the remaining data after the encoding is done.
+  // The |sink| must outlive the buffer or until another sink is set.
+  void SetSink(EncoderBufferSink *sink,
+               size_t staging_size = kDefaultStagingSize);
+
+  // Writes all staged data to the sink. Returns false when the sink failed to
+  // write any data since it was set, or when a bit sequence is being encoded.
+  bool Flush();
+
   // Start encoding a bit sequence. A maximum size of the sequence needs to
   // be known upfront.
   // If encode_size is true, the size of encoded bit sequence is stored before
@@ -59,6 +82,8 @@ class EncoderBuffer {
   bool Encode(const T &data) {
     if (bit_encoder_active())
       return false;
+    if (sink_ != nullptr && !FlushIfNeeded())
+      return false;
     const uint8_t *src_data = reinterpret_cast<const uint8_t *>(&data);
     buffer_.insert(buffer_.end(), src_data, src_data + sizeof(T));
     return true;
@@ -66,6 +91,8 @@ class EncoderBuffer {
   bool Encode(const void *data, size_t data_size) {
     if (bit_encoder_active())
       return false;
+    if (sink_ != nullptr && !FlushIfNeeded())
+      return false;
     const uint8_t *src_data = reinterpret_cast<const uint8_t *>(data);
     buffer_.insert(buffer_.end(), src_data, src_data + data_size);
     return true;
@@ -76,7 +103,18 @@ class EncoderBuffer {
   size_t size() const { return buffer_.size(); }
   std::vector<char> *buffer() { return &buffer_; }
 
+  // Returns the total number of encoded bytes including the bytes that were
+  // already written to the sink.
+  size_t encoded_size() const { return num_flushed_bytes_ + buffer_.size(); }
+
  private:
+  // Writes the staged data to the sink when it reaches |staging_size_|.
+  // Called before new data is encoded, i.e., at a point when no previously
+  // encoded data can be modified anymore.
+  bool FlushIfNeeded() {
+    return buffer_.size() < staging_size_ || Flush();
+  }
+
   // Internal helper class to encode bits to a bit buffer.
   class BitEncoder {
    public:
@@ -87,8 +125,23 @@ class EncoderBuffer {
     void PutBits(uint32_t data, int32_t nbits) {
       DRACO_DCHECK_GE(nbits, 0);
       DRACO_DCHECK_LE(nbits, 32);
-      for (int32_t bit = 0; bit < nbits; ++bit)
-        PutBit((data >> bit) & 1);
+      const uint64_t off = static_cast<uint64_t>(bit_offset_);
+      const int bit_shift = static_cast<int>(off & 0x7);
+      const int num_bytes = (bit_shift + nbits + 7) >> 3;
+      // Combine all bits into one 64-bit word and write it out byte by byte.
+      // Bits of the first and the last byte that are not covered by |nbits|
+      // keep their original values.
+      const uint64_t mask = ((static_cast<uint64_t>(1) << nbits) - 1)
+                            << bit_shift;
+      const uint64_t bits = (static_cast<uint64_t>(data) << bit_shift) & mask;
+      uint8_t *const dst =
+          reinterpret_cast<uint8_t *>(bit_buffer_) + (off >> 3);
+      for (int i = 0; i < num_bytes; ++i) {
+        const int shift = 8 * i;
+        dst[i] = static_cast<uint8_t>((dst[i] & ~(mask >> shift)) |
+                                      (bits >> shift));
+      }
+      bit_offset_ += nbits;
     }
 
     // Return number of bits encoded so far.
@@ -105,21 +158,6 @@ class EncoderBuffer {
     }
 
    private:
-    void PutBit(uint8_t value) {
-      const int byte_size = 8;
-      const uint64_t off = static_cast<uint64_t>(bit_offset_);
-      const uint64_t byte_offset = off / byte_size;
-      const int bit_shift = off % byte_size;
-
-      // TODO(fgalligan): Check performance if we add a branch and only do one
-      // memory write if bit_shift is 7. Also try using a temporary variable to
-      // hold the bits before writing to the buffer.
-
-      bit_buffer_[byte_offset] &= ~(1 << bit_shift);
-      bit_buffer_[byte_offset] |= value << bit_shift;
-      bit_offset_++;
-    }
-
     char *bit_buffer_;
     size_t bit_offset_;
   };
@@ -141,6 +179,13 @@ class EncoderBuffer {
   // Flag used indicating that we need to store the length of the currently
   // processed bit sequence.
   bool encode_bit_sequence_size_;
+
+  EncoderBufferSink *sink_;
+  size_t staging_size_;
+  // Number of bytes already written to |sink_|.
+  size_t num_flushed_bytes_;
+  // Set when any write to |sink_| failed.
+  bool sink_failed_;
 };
 
 }  // namespace draco
@@ -0,0 +1,28 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/core/encoder_buffer_sink.h"
+
+namespace draco {
+
+bool StreamEncoderBufferSink::Write(const char *data, size_t size) {
+  os_->write(data, size);
+  return static_cast<bool>(*os_);
+}
+
+bool FileEncoderBufferSink::Write(const char *data, size_t size) {
+  return fwrite(data, 1, size, file_) == size;
+}
+
+}  // namespace draco
@@ -0,0 +1,74 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_CORE_ENCODER_BUFFER_SINK_H_
+#define DRACO_CORE_ENCODER_BUFFER_SINK_H_
+
+#include <cstdio>
+#include <functional>
+#include <ostream>
+#include <utility>
+
+namespace draco {
+
+// Destination of data encoded into an EncoderBuffer (see
+// EncoderBuffer::SetSink()). The sink receives the encoded data in the order in
+// which it is going to be stored in the final output.
+class EncoderBufferSink {
+ public:
+  virtual ~EncoderBufferSink() = default;
+
+  // Appends |size| bytes of |data| to the output. Returns false on error.
+  virtual bool Write(const char *data, size_t size) = 0;
+};
+
+// Sink writing the encoded data into an std::ostream.
+class StreamEncoderBufferSink : public EncoderBufferSink {
+ public:
+  explicit StreamEncoderBufferSink(std::ostream *os) : os_(os) {}
+  bool Write(const char *data, size_t size) override;
+
+ private:
+  std::ostream *os_;
+};
+
+// Sink writing the encoded data into an open C file (the file can be created
+// from a file descriptor with fdopen()). The file is not closed by the sink.
+class FileEncoderBufferSink : public EncoderBufferSink {
+ public:
+  explicit FileEncoderBufferSink(FILE *file) : file_(file) {}
+  bool Write(const char *data, size_t size) override;
+
+ private:
+  FILE *file_;
+};
+
+// Sink passing the encoded data to a user provided callback.
+class CallbackEncoderBufferSink : public EncoderBufferSink {
+ public:
+  typedef std::function<bool(const char *, size_t)> Callback;
+
+  explicit CallbackEncoderBufferSink(Callback callback)
+      : callback_(std::move(callback)) {}
+  bool Write(const char *data, size_t size) override {
+    return callback_(data, size);
+  }
+
+ private:
+  Callback callback_;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_CORE_ENCODER_BUFFER_SINK_H_
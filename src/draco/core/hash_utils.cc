@@ -14,7 +14,9 @@
 //
 #include "draco/core/hash_utils.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <functional>
 #include <limits>
 
@@ -54,4 +56,110 @@ uint64_t FingerprintString(const char *s, size_t len) {
     hash += 2;
   return hash;
 }
+
+namespace {
+
+inline uint64_t RotateLeft(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t FinalizationMix(uint64_t k) {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+constexpr uint64_t kFingerprintC1 = 0x87c37b91114253d5ULL;
+constexpr uint64_t kFingerprintC2 = 0x4cf5ad432745937fULL;
+
+}  // namespace
+
+Fingerprinter::Fingerprinter() : h1_(0), h2_(0), length_(0) {}
+
+void Fingerprinter::Update(const void *data, size_t size) {
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  size_t tail_size = static_cast<size_t>(length_ % 16);
+  length_ += size;
+  if (tail_size > 0) {
+    const size_t num_copied = std::min(size, 16 - tail_size);
+    memcpy(tail_ + tail_size, bytes, num_copied);
+    bytes += num_copied;
+    size -= num_copied;
+    tail_size += num_copied;
+    if (tail_size < 16)
+      return;
+    ProcessBlock(tail_);
+  }
+  for (; size >= 16; size -= 16, bytes += 16) {
+    ProcessBlock(bytes);
+  }
+  memcpy(tail_, bytes, size);
+}
+
+void Fingerprinter::ProcessBlock(const uint8_t *block) {
+  uint64_t k1, k2;
+  memcpy(&k1, block, 8);
+  memcpy(&k2, block + 8, 8);
+  k1 *= kFingerprintC1;
+  k1 = RotateLeft(k1, 31);
+  k1 *= kFingerprintC2;
+  h1_ ^= k1;
+  h1_ = RotateLeft(h1_, 27);
+  h1_ += h2_;
+  h1_ = h1_ * 5 + 0x52dce729;
+  k2 *= kFingerprintC2;
+  k2 = RotateLeft(k2, 33);
+  k2 *= kFingerprintC1;
+  h2_ ^= k2;
+  h2_ = RotateLeft(h2_, 31);
+  h2_ += h1_;
+  h2_ = h2_ * 5 + 0x38495ab5;
+}
+
+std::string Fingerprinter::HexDigest() const {
+  uint64_t h1 = h1_;
+  uint64_t h2 = h2_;
+  const size_t tail_size = static_cast<size_t>(length_ % 16);
+  uint64_t k1 = 0;
+  uint64_t k2 = 0;
+  for (size_t i = tail_size; i > 8; --i) {
+    k2 = (k2 << 8) | tail_[i - 1];
+  }
+  for (size_t i = std::min<size_t>(tail_size, 8); i > 0; --i) {
+    k1 = (k1 << 8) | tail_[i - 1];
+  }
+  if (tail_size > 8) {
+    k2 *= kFingerprintC2;
+    k2 = RotateLeft(k2, 33);
+    k2 *= kFingerprintC1;
+    h2 ^= k2;
+  }
+  if (tail_size > 0) {
+    k1 *= kFingerprintC1;
+    k1 = RotateLeft(k1, 31);
+    k1 *= kFingerprintC2;
+    h1 ^= k1;
+  }
+  h1 ^= length_;
+  h2 ^= length_;
+  h1 += h2;
+  h2 += h1;
+  h1 = FinalizationMix(h1);
+  h2 = FinalizationMix(h2);
+  h1 += h2;
+  h2 += h1;
+
+  static const char kHexDigits[] = "0123456789abcdef";
+  std::string digest(32, '0');
+  for (int i = 0; i < 16; ++i) {
+    const uint64_t h = i < 8 ? h1 : h2;
+    const int byte = static_cast<int>((h >> (8 * (i % 8))) & 0xff);
+    digest[2 * i] = kHexDigits[byte >> 4];
+    digest[2 * i + 1] = kHexDigits[byte & 0xf];
+  }
+  return digest;
+}
 }  // namespace draco
@@ -16,7 +16,9 @@
 #define DRACO_CORE_HASH_UTILS_H_
 
 #include <stdint.h>
+#include <cstddef>
 #include <functional>
+#include <string>
 
 // TODO(fgalligan): Move this to core.
 
@@ -42,6 +44,42 @@ inline uint64_t HashCombine(uint64_t a, uint64_t b) {
 // Will never return 1 or 0.
 uint64_t FingerprintString(const char *s, size_t len);
 
+// Incremental 128-bit fingerprint of a byte sequence (MurmurHash3 x64 128).
+// Unlike FingerprintString(), every input byte affects the whole result, so it
+// can be used to identify large inputs such as the content of whole meshes.
+// The result depends on the byte order of the platform.
+class Fingerprinter {
+ public:
+  Fingerprinter();
+
+  // Appends |size| bytes of |data| to the fingerprinted sequence.
+  void Update(const void *data, size_t size);
+
+  // Appends the binary representation of a trivially copyable |value|.
+  template <typename T>
+  void UpdateValue(const T &value) {
+    Update(&value, sizeof(value));
+  }
+
+  void UpdateString(const std::string &str) {
+    UpdateValue(static_cast<uint64_t>(str.size()));
+    Update(str.data(), str.size());
+  }
+
+  // Returns the fingerprint of all data appended so far as a 32 character
+  // hexadecimal string.
+  std::string HexDigest() const;
+
+ private:
+  void ProcessBlock(const uint8_t *block);
+
+  uint64_t h1_;
+  uint64_t h2_;
+  uint64_t length_;
+  // Bytes that do not yet form a complete 16 byte block.
+  uint8_t tail_[16];
+};
+
 // Hash for std::array.
 template <typename T>
 struct HashArray {
@@ -68,6 +68,11 @@ class Options {
     return options_.count(name) > 0;
   }
 
+  // Returns all options as <name, value> pairs sorted by their names.
+  const std::map<std::string, std::string> &GetAllOptions() const {
+    return options_;
+  }
+
  private:
   // All entries are internally stored as strings and converted to the desired
   // return type based on the used Get* method.
@@ -14,8 +14,185 @@
 //
 #include "draco/core/quantization_utils.h"
 
+#include <vector>
+
+// SSE2 is always available on x86-64. AVX2 is detected at runtime and it is
+// enabled only for the functions that use it. Note that the kernels must not
+// be compiled with FMA instructions, because fused multiply-add would round
+// differently than the scalar code.
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DRACO_QUANTIZATION_SSE2
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(DRACO_OLD_GCC)
+#include <immintrin.h>
+#define DRACO_QUANTIZATION_AVX2
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DRACO_QUANTIZATION_NEON
+#endif
+
 namespace draco {
 
+namespace {
+
+#if defined(DRACO_QUANTIZATION_SSE2) || defined(DRACO_QUANTIZATION_NEON)
+// Maximum number of values processed by a single SIMD instruction.
+constexpr int kMaxSimdLanes = 8;
+
+// Returns |min_values| repeated |num_lanes| times. Components of the returned
+// array match the components of the values in any block of |num_components| *
+// |num_lanes| values that starts at an entry boundary.
+std::vector<float> ExpandMinValues(const float *min_values,
+                                   int num_components, int num_lanes) {
+  std::vector<float> expanded_min_values(num_components * num_lanes);
+  for (size_t i = 0; i < expanded_min_values.size(); ++i) {
+    expanded_min_values[i] = min_values[i % num_components];
+  }
+  return expanded_min_values;
+}
+#endif
+
+// The SIMD kernels below process blocks of |num_components| * lanes values
+// starting at |begin| and return the end of the last processed block. The
+// remaining values are processed by the caller. |min_values| must be expanded
+// by ExpandMinValues().
+
+#ifdef DRACO_QUANTIZATION_AVX2
+bool HasAvx2() {
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  return has_avx2;
+}
+
+__attribute__((target("avx2"))) size_t QuantizeFloatsAvx2(
+    const float *in_values, size_t begin, size_t end, int num_components,
+    const float *min_values, float inverse_delta, int32_t *out_values) {
+  const size_t block_size = 8 * num_components;
+  const __m256 inverse_delta_v = _mm256_set1_ps(inverse_delta);
+  const __m256 half_v = _mm256_set1_ps(0.5f);
+  size_t i = begin;
+  for (; i + block_size <= end; i += block_size) {
+    for (size_t j = 0; j < block_size; j += 8) {
+      __m256 val = _mm256_sub_ps(_mm256_loadu_ps(in_values + i + j),
+                                 _mm256_loadu_ps(min_values + j));
+      val = _mm256_mul_ps(val, inverse_delta_v);
+      val = _mm256_floor_ps(_mm256_add_ps(val, half_v));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out_values + i + j),
+                          _mm256_cvttps_epi32(val));
+    }
+  }
+  return i;
+}
+
+__attribute__((target("avx2"))) size_t DequantizeFloatsAvx2(
+    const int32_t *in_values, size_t begin, size_t end, int num_components,
+    const float *min_values, float delta, float *out_values) {
+  const size_t block_size = 8 * num_components;
+  const __m256 delta_v = _mm256_set1_ps(delta);
+  size_t i = begin;
+  for (; i + block_size <= end; i += block_size) {
+    for (size_t j = 0; j < block_size; j += 8) {
+      const __m256i q_val = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(in_values + i + j));
+      const __m256 val = _mm256_mul_ps(_mm256_cvtepi32_ps(q_val), delta_v);
+      _mm256_storeu_ps(out_values + i + j,
+                       _mm256_add_ps(val, _mm256_loadu_ps(min_values + j)));
+    }
+  }
+  return i;
+}
+#endif  // DRACO_QUANTIZATION_AVX2
+
+#ifdef DRACO_QUANTIZATION_SSE2
+size_t QuantizeFloatsSse2(const float *in_values, size_t begin, size_t end,
+                          int num_components, const float *min_values,
+                          float inverse_delta, int32_t *out_values) {
+  const size_t block_size = 4 * num_components;
+  const __m128 inverse_delta_v = _mm_set1_ps(inverse_delta);
+  const __m128 half_v = _mm_set1_ps(0.5f);
+  size_t i = begin;
+  for (; i + block_size <= end; i += block_size) {
+    for (size_t j = 0; j < block_size; j += 4) {
+      __m128 val = _mm_sub_ps(_mm_loadu_ps(in_values + i + j),
+                              _mm_loadu_ps(min_values + j));
+      val = _mm_add_ps(_mm_mul_ps(val, inverse_delta_v), half_v);
+      // SSE2 has no floor. Truncate and subtract one from the values that
+      // were rounded up (the comparison mask is -1).
+      __m128i q_val = _mm_cvttps_epi32(val);
+      const __m128 rounded_up = _mm_cmpgt_ps(_mm_cvtepi32_ps(q_val), val);
+      q_val = _mm_add_epi32(q_val, _mm_castps_si128(rounded_up));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out_values + i + j), q_val);
+    }
+  }
+  return i;
+}
+
+size_t DequantizeFloatsSse2(const int32_t *in_values, size_t begin,
+                            size_t end, int num_components,
+                            const float *min_values, float delta,
+                            float *out_values) {
+  const size_t block_size = 4 * num_components;
+  const __m128 delta_v = _mm_set1_ps(delta);
+  size_t i = begin;
+  for (; i + block_size <= end; i += block_size) {
+    for (size_t j = 0; j < block_size; j += 4) {
+      const __m128i q_val = _mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(in_values + i + j));
+      const __m128 val = _mm_mul_ps(_mm_cvtepi32_ps(q_val), delta_v);
+      _mm_storeu_ps(out_values + i + j,
+                    _mm_add_ps(val, _mm_loadu_ps(min_values + j)));
+    }
+  }
+  return i;
+}
+#endif  // DRACO_QUANTIZATION_SSE2
+
+#ifdef DRACO_QUANTIZATION_NEON
+size_t QuantizeFloatsNeon(const float *in_values, size_t begin, size_t end,
+                          int num_components, const float *min_values,
+                          float inverse_delta, int32_t *out_values) {
+  const size_t block_size = 4 * num_components;
+  const float32x4_t inverse_delta_v = vdupq_n_f32(inverse_delta);
+  const float32x4_t half_v = vdupq_n_f32(0.5f);
+  size_t i = begin;
+  for (; i + block_size <= end; i += block_size) {
+    for (size_t j = 0; j < block_size; j += 4) {
+      float32x4_t val =
+          vsubq_f32(vld1q_f32(in_values + i + j), vld1q_f32(min_values + j));
+      val = vaddq_f32(vmulq_f32(val, inverse_delta_v), half_v);
+      // Truncate and subtract one from the values that were rounded up (the
+      // comparison mask is -1).
+      int32x4_t q_val = vcvtq_s32_f32(val);
+      const uint32x4_t rounded_up = vcgtq_f32(vcvtq_f32_s32(q_val), val);
+      q_val = vaddq_s32(q_val, vreinterpretq_s32_u32(rounded_up));
+      vst1q_s32(out_values + i + j, q_val);
+    }
+  }
+  return i;
+}
+
+size_t DequantizeFloatsNeon(const int32_t *in_values, size_t begin,
+                            size_t end, int num_components,
+                            const float *min_values, float delta,
+                            float *out_values) {
+  const size_t block_size = 4 * num_components;
+  const float32x4_t delta_v = vdupq_n_f32(delta);
+  size_t i = begin;
+  for (; i + block_size <= end; i += block_size) {
+    for (size_t j = 0; j < block_size; j += 4) {
+      const float32x4_t val =
+          vmulq_f32(vcvtq_f32_s32(vld1q_s32(in_values + i + j)), delta_v);
+      vst1q_f32(out_values + i + j,
+                vaddq_f32(val, vld1q_f32(min_values + j)));
+    }
+  }
+  return i;
+}
+#endif  // DRACO_QUANTIZATION_NEON
+
+}  // namespace
+
 Quantizer::Quantizer() : inverse_delta_(1.f) {}
 
 void Quantizer::Init(float range, int32_t max_quantized_value) {
@@ -24,6 +201,38 @@ void Quantizer::Init(float range, int32_t max_quantized_value) {
 
 void Quantizer::Init(float delta) { inverse_delta_ = 1.f / delta; }
 
+void Quantizer::QuantizeFloats(const float *in_values, size_t num_values,
+                               int num_components, const float *min_values,
+                               int32_t *out_values) const {
+  const size_t num_elements = num_values * num_components;
+  size_t i = 0;
+#if defined(DRACO_QUANTIZATION_SSE2) || defined(DRACO_QUANTIZATION_NEON)
+  if (num_elements >= 4 * static_cast<size_t>(num_components)) {
+    const std::vector<float> expanded_min_values =
+        ExpandMinValues(min_values, num_components, kMaxSimdLanes);
+    const float *const mins = expanded_min_values.data();
+#ifdef DRACO_QUANTIZATION_AVX2
+    if (HasAvx2()) {
+      i = QuantizeFloatsAvx2(in_values, i, num_elements, num_components, mins,
+                             inverse_delta_, out_values);
+    }
+#endif
+#ifdef DRACO_QUANTIZATION_SSE2
+    i = QuantizeFloatsSse2(in_values, i, num_elements, num_components, mins,
+                           inverse_delta_, out_values);
+#else
+    i = QuantizeFloatsNeon(in_values, i, num_elements, num_components, mins,
+                           inverse_delta_, out_values);
+#endif
+  }
+#endif
+  for (; i < num_elements; i += num_components) {
+    for (int c = 0; c < num_components; ++c) {
+      out_values[i + c] = QuantizeFloat(in_values[i + c] - min_values[c]);
+    }
+  }
+}
+
 Dequantizer::Dequantizer() : delta_(1.f) {}
 
 bool Dequantizer::Init(float range, int32_t max_quantized_value) {
@@ -38,4 +247,38 @@ bool Dequantizer::Init(float delta) {
   return true;
 }
 
+void Dequantizer::DequantizeFloats(const int32_t *in_values,
+                                   size_t num_values, int num_components,
+                                   const float *min_values,
+                                   float *out_values) const {
+  const size_t num_elements = num_values * num_components;
+  size_t i = 0;
+#if defined(DRACO_QUANTIZATION_SSE2) || defined(DRACO_QUANTIZATION_NEON)
+  if (num_elements >= 4 * static_cast<size_t>(num_components)) {
+    const std::vector<float> expanded_min_values =
+        ExpandMinValues(min_values, num_components, kMaxSimdLanes);
+    const float *const mins = expanded_min_values.data();
+#ifdef DRACO_QUANTIZATION_AVX2
+    if (HasAvx2()) {
+      i = DequantizeFloatsAvx2(in_values, i, num_elements, num_components,
+                               mins, delta_, out_values);
+    }
+#endif
+#ifdef DRACO_QUANTIZATION_SSE2
+    i = DequantizeFloatsSse2(in_values, i, num_elements, num_components, mins,
+                             delta_, out_values);
+#else
+    i = DequantizeFloatsNeon(in_values, i, num_elements, num_components, mins,
+                             delta_, out_values);
+#endif
+  }
+#endif
+  for (; i < num_elements; i += num_components) {
+    for (int c = 0; c < num_components; ++c) {
+      const float value = DequantizeFloat(in_values[i + c]);
+      out_values[i + c] = value + min_values[c];
+    }
+  }
+}
+
 }  // namespace draco
@@ -21,6 +21,7 @@
 #ifndef DRACO_CORE_QUANTIZATION_UTILS_H_
 #define DRACO_CORE_QUANTIZATION_UTILS_H_
 
+#include <stddef.h>
 #include <stdint.h>
 #include <cmath>
 
@@ -49,6 +50,15 @@ class Quantizer {
   }
   inline int32_t operator()(float val) const { return QuantizeFloat(val); }
 
+  // Quantizes |num_values| entries with |num_components| interleaved
+  // components each. |min_values| are subtracted from the respective
+  // components before the quantization. The result is always identical to
+  // calling QuantizeFloat() on each component, but SIMD instructions are used
+  // when they are available.
+  void QuantizeFloats(const float *in_values, size_t num_values,
+                      int num_components, const float *min_values,
+                      int32_t *out_values) const;
+
  private:
   float inverse_delta_;
 };
@@ -72,6 +82,15 @@ class Dequantizer {
   }
   inline float operator()(int32_t val) const { return DequantizeFloat(val); }
 
+  // Dequantizes |num_values| entries with |num_components| interleaved
+  // components each. |min_values| are added to the respective components after
+  // the dequantization. The result is always identical to calling
+  // DequantizeFloat() on each component and adding the min value, but SIMD
+  // instructions are used when they are available.
+  void DequantizeFloats(const int32_t *in_values, size_t num_values,
+                        int num_components, const float *min_values,
+                        float *out_values) const;
+
  private:
   float delta_;
 };
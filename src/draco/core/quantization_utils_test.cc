@@ -14,6 +14,9 @@
 //
 #include "draco/core/quantization_utils.h"
 
+#include <random>
+#include <vector>
+
 #include "draco/core/draco_test_base.h"
 
 namespace draco {
@@ -88,4 +91,44 @@ TEST_F(QuantizationUtilsTest, TestDeltaQuantization) {
             dequantizer_range.DequantizeFloat(0));
 }
 
+TEST_F(QuantizationUtilsTest, TestBulkQuantization) {
+  // Test verifies that the bulk functions produce exactly the same results as
+  // the per-value quantization for all numbers of components and for inputs
+  // that are not a multiple of the SIMD block size.
+  std::mt19937 gen(13);
+  std::uniform_real_distribution<float> dist(-12.f, 12.f);
+  const float min_values[5] = {-10.f, -2.5f, 0.f, -7.125f, 3.f};
+  Quantizer quantizer;
+  quantizer.Init(20.f, (1 << 14) - 1);
+  Dequantizer dequantizer;
+  ASSERT_TRUE(dequantizer.Init(20.f, (1 << 14) - 1));
+  for (int num_components = 1; num_components <= 5; ++num_components) {
+    for (int num_values : {0, 1, 3, 4, 7, 8, 9, 31, 100}) {
+      std::vector<float> values(num_values * num_components);
+      for (float &value : values) {
+        value = dist(gen);
+      }
+      // Include values that lie exactly between two quantized values.
+      if (!values.empty()) {
+        values[0] = min_values[0] + 0.5f * 20.f / ((1 << 14) - 1);
+      }
+      std::vector<int32_t> quantized_values(values.size());
+      quantizer.QuantizeFloats(values.data(), num_values, num_components,
+                               min_values, quantized_values.data());
+      std::vector<float> dequantized_values(values.size());
+      dequantizer.DequantizeFloats(quantized_values.data(), num_values,
+                                   num_components, min_values,
+                                   dequantized_values.data());
+      for (size_t i = 0; i < values.size(); ++i) {
+        const int c = i % num_components;
+        const int32_t q_val =
+            quantizer.QuantizeFloat(values[i] - min_values[c]);
+        EXPECT_EQ(quantized_values[i], q_val);
+        EXPECT_EQ(dequantized_values[i],
+                  dequantizer.DequantizeFloat(q_val) + min_values[c]);
+      }
+    }
+  }
+}
+
 }  // namespace draco
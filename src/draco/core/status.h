@@ -31,6 +31,8 @@ class Status {
     UNSUPPORTED_VERSION = -4,  // Input not compatible with the current version.
     UNKNOWN_VERSION = -5,      // Input was created with an unknown version of
                                // the library.
+    NEED_MORE_DATA = -6,       // Input is incomplete and more data is needed
+                               // to continue (see StreamingDecoder).
   };
 
   Status() : code_(OK) {}
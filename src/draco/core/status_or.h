@@ -40,6 +40,9 @@ class StatusOr {
   StatusOr(const Status &status, const T &value)
       : status_(status), value_(value) {}
 
+  StatusOr &operator=(const StatusOr &) = default;
+  StatusOr &operator=(StatusOr &&) = default;
+
   const Status &status() const { return status_; }
   const T &value() const & { return value_; }
   const T &&value() const && { return std::move(value_); }
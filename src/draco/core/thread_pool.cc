@@ -0,0 +1,124 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/core/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace draco {
+
+ThreadPool::ThreadPool(int num_threads) : stopping_(false) {
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  condition_.notify_all();
+  for (std::thread &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::Schedule(std::function<void()> task) {
+  if (workers_.empty()) {
+    task();
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  condition_.notify_one();
+}
+
+void ThreadPool::WorkerLoop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+      // Remaining tasks are always finished before the worker exits.
+      if (tasks_.empty())
+        return;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+namespace {
+
+// State shared between the calling thread of ParallelFor() and the helper
+// tasks scheduled on the thread pool. Helper tasks may start only after all
+// indices were already processed so the state must outlive the caller.
+struct ParallelForState {
+  ParallelForState(int num, const std::function<bool(int)> *f)
+      : num_tasks(num), func(f), next_task(0), num_finished(0), ok(true) {}
+
+  // Processes tasks until no unclaimed index is left.
+  void Run() {
+    int task_id;
+    while ((task_id = next_task.fetch_add(1)) < num_tasks) {
+      const bool task_ok = (*func)(task_id);
+      std::unique_lock<std::mutex> lock(mutex);
+      if (!task_ok)
+        ok = false;
+      if (++num_finished == num_tasks)
+        finished.notify_all();
+    }
+  }
+
+  const int num_tasks;
+  // Valid only while there are unclaimed indices.
+  const std::function<bool(int)> *const func;
+  std::atomic<int> next_task;
+  int num_finished;
+  bool ok;
+  std::mutex mutex;
+  std::condition_variable finished;
+};
+
+}  // namespace
+
+bool ParallelFor(ThreadPool *pool, int num_tasks,
+                 const std::function<bool(int)> &func) {
+  if (pool == nullptr || pool->num_threads() == 0 || num_tasks <= 1) {
+    for (int i = 0; i < num_tasks; ++i) {
+      if (!func(i))
+        return false;
+    }
+    return true;
+  }
+  const std::shared_ptr<ParallelForState> state =
+      std::make_shared<ParallelForState>(num_tasks, &func);
+  const int num_helpers = std::min(pool->num_threads(), num_tasks - 1);
+  for (int i = 0; i < num_helpers; ++i) {
+    pool->Schedule([state]() { state->Run(); });
+  }
+  state->Run();
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->finished.wait(
+      lock, [&state] { return state->num_finished == state->num_tasks; });
+  return state->ok;
+}
+
+}  // namespace draco
@@ -0,0 +1,72 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_CORE_THREAD_POOL_H_
+#define DRACO_CORE_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "draco/core/macros.h"
+
+namespace draco {
+
+// Fixed size pool of worker threads that execute scheduled tasks in the order
+// in which they were scheduled. The pool can be shared between multiple
+// encoders and decoders that run at the same time.
+class ThreadPool {
+ public:
+  // Creates a pool with |num_threads| worker threads. When |num_threads| is
+  // zero or negative, no workers are created and all tasks are executed
+  // directly on the calling thread in Schedule().
+  explicit ThreadPool(int num_threads);
+
+  // Finishes all scheduled tasks and joins the worker threads.
+  ~ThreadPool();
+
+  // Adds a new task to the queue. The task is executed by the first available
+  // worker thread.
+  void Schedule(std::function<void()> task);
+
+  int num_threads() const { return static_cast<int>(workers_.size()); }
+
+ private:
+  void WorkerLoop();
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool stopping_;
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadPool);
+};
+
+// Calls |func| for all indices in range [0, |num_tasks|) using the worker
+// threads of |pool| together with the calling thread, and returns after all
+// calls are finished. Because the calling thread always takes part in the
+// work, the function can be safely called from within a task running on the
+// same |pool|. |pool| can be nullptr in which case all calls are executed
+// serially on the calling thread. Returns false when any call of |func|
+// returned false.
+bool ParallelFor(ThreadPool *pool, int num_tasks,
+                 const std::function<bool(int)> &func);
+
+}  // namespace draco
+
+#endif  // DRACO_CORE_THREAD_POOL_H_
@@ -0,0 +1,65 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/core/thread_pool.h"
+
+#include <atomic>
+
+#include "draco/core/draco_test_base.h"
+
+namespace {
+
+TEST(ThreadPoolTest, TestParallelFor) {
+  // Tests that all indices are processed exactly once for different pool
+  // sizes, including the serial fallback.
+  for (int num_threads = 0; num_threads < 4; ++num_threads) {
+    draco::ThreadPool pool(num_threads);
+    std::vector<std::atomic<int>> counts(100);
+    for (auto &count : counts) {
+      count = 0;
+    }
+    ASSERT_TRUE(draco::ParallelFor(&pool, static_cast<int>(counts.size()),
+                                   [&counts](int i) {
+                                     ++counts[i];
+                                     return true;
+                                   }));
+    for (auto &count : counts) {
+      ASSERT_EQ(count, 1);
+    }
+  }
+}
+
+TEST(ThreadPoolTest, TestParallelForFailure) {
+  draco::ThreadPool pool(3);
+  ASSERT_FALSE(
+      draco::ParallelFor(&pool, 10, [](int i) { return i != 7; }));
+  ASSERT_FALSE(
+      draco::ParallelFor(nullptr, 10, [](int i) { return i != 7; }));
+}
+
+TEST(ThreadPoolTest, TestNestedParallelFor) {
+  // Tests that ParallelFor() can be called from a task running on the same
+  // pool without deadlocking.
+  draco::ThreadPool pool(2);
+  std::atomic<int> count(0);
+  ASSERT_TRUE(draco::ParallelFor(&pool, 4, [&pool, &count](int) {
+    return draco::ParallelFor(&pool, 8, [&count](int) {
+      ++count;
+      return true;
+    });
+  }));
+  ASSERT_EQ(count, 32);
+}
+
+}  // namespace
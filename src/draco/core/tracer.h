@@ -0,0 +1,125 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_CORE_TRACER_H_
+#define DRACO_CORE_TRACER_H_
+
+#include <inttypes.h>
+
+#include "draco/core/decoder_buffer.h"
+#include "draco/core/encoder_buffer.h"
+#include "draco/core/macros.h"
+
+namespace draco {
+
+// Interface for receiving events about the individual stages of the encoding
+// and decoding pipelines (header, connectivity, entropy coding, prediction,
+// quantization, ...). A tracer can be attached to the encoder or decoder
+// through DracoOptions::SetTracer().
+//
+// Each BeginStage() call is followed by a matching EndStage() call made from
+// the same thread. Stages can be nested. When parallel decoding is enabled,
+// events can be reported from multiple threads at the same time and therefore
+// the implementations must be thread safe.
+class Tracer {
+ public:
+  virtual ~Tracer() = default;
+
+  // Called when a stage identified by |name| starts. The |name| is always a
+  // string literal that stays valid for the lifetime of the program.
+  virtual void BeginStage(const char *name) = 0;
+
+  // Called when the stage ends. |num_bytes| is the number of bytes read or
+  // written by the stage, or -1 when it is not known.
+  virtual void EndStage(const char *name, int64_t num_bytes) = 0;
+};
+
+// Helper class that reports a stage to the |tracer| for the lifetime of the
+// object. When |tracer| is nullptr, no event is generated.
+//
+// Example:
+//
+//   {
+//     TraceScope trace(tracer(), "DecodeHeader", buffer);
+//     ...  // Decode the header from the |buffer|.
+//   }
+//
+class TraceScope {
+ public:
+  TraceScope(Tracer *tracer, const char *name)
+      : tracer_(tracer),
+        name_(name),
+        num_bytes_(-1),
+        decoder_buffer_(nullptr),
+        decoder_buffer_head_(nullptr),
+        encoder_buffer_(nullptr),
+        encoder_buffer_size_(0) {
+    if (tracer_ != nullptr)
+      tracer_->BeginStage(name_);
+  }
+
+  // The number of bytes reported for the stage is the number of bytes read
+  // from the |buffer| during the lifetime of the object.
+  TraceScope(Tracer *tracer, const char *name, const DecoderBuffer *buffer)
+      : TraceScope(tracer, name) {
+    if (tracer_ != nullptr) {
+      decoder_buffer_ = buffer;
+      decoder_buffer_head_ = buffer->data_head();
+    }
+  }
+
+  // The number of bytes reported for the stage is the number of bytes written
+  // to the |buffer| during the lifetime of the object.
+  TraceScope(Tracer *tracer, const char *name, const EncoderBuffer *buffer)
+      : TraceScope(tracer, name) {
+    if (tracer_ != nullptr) {
+      encoder_buffer_ = buffer;
+      encoder_buffer_size_ = static_cast<int64_t>(buffer->encoded_size());
+    }
+  }
+
+  ~TraceScope() {
+    if (tracer_ == nullptr)
+      return;
+    if (num_bytes_ < 0) {
+      if (decoder_buffer_ != nullptr) {
+        num_bytes_ = decoder_buffer_->data_head() - decoder_buffer_head_;
+      } else if (encoder_buffer_ != nullptr) {
+        num_bytes_ =
+            static_cast<int64_t>(encoder_buffer_->encoded_size()) -
+            encoder_buffer_size_;
+      }
+    }
+    tracer_->EndStage(name_, num_bytes_);
+  }
+
+  // Sets the number of bytes processed by the stage explicitly. Overrides the
+  // number computed from the buffer (if any).
+  void set_num_bytes(int64_t num_bytes) { num_bytes_ = num_bytes; }
+
+ private:
+  Tracer *const tracer_;
+  const char *const name_;
+  int64_t num_bytes_;
+  const DecoderBuffer *decoder_buffer_;
+  const char *decoder_buffer_head_;
+  const EncoderBuffer *encoder_buffer_;
+  int64_t encoder_buffer_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceScope);
+};
+
+}  // namespace draco
+
+#endif  // DRACO_CORE_TRACER_H_
@@ -14,6 +14,15 @@
 //
 #include "draco/io/file_utils.h"
 
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
 #include "draco/io/parser_utils.h"
 
 namespace draco {
@@ -62,4 +71,64 @@ std::string GetFullPath(const std::string &input_file_relative_path,
   return input_file_full_path;
 }
 
+bool GetFilesInDirectory(const std::string &dir_path,
+                         std::vector<std::string> *out_file_names) {
+  out_file_names->clear();
+#ifdef _WIN32
+  WIN32_FIND_DATAA find_data;
+  const HANDLE find_handle =
+      FindFirstFileA((dir_path + "\\*").c_str(), &find_data);
+  if (find_handle == INVALID_HANDLE_VALUE)
+    return false;
+  do {
+    if (!(find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+      out_file_names->push_back(find_data.cFileName);
+  } while (FindNextFileA(find_handle, &find_data));
+  FindClose(find_handle);
+#else
+  DIR *const dir = opendir(dir_path.c_str());
+  if (dir == nullptr)
+    return false;
+  while (const dirent *const entry = readdir(dir)) {
+    // Entry type is not reported by all file systems, use stat() instead.
+    struct stat entry_stat;
+    const std::string entry_path = dir_path + "/" + entry->d_name;
+    if (stat(entry_path.c_str(), &entry_stat) == 0 &&
+        S_ISREG(entry_stat.st_mode))
+      out_file_names->push_back(entry->d_name);
+  }
+  closedir(dir);
+#endif
+  std::sort(out_file_names->begin(), out_file_names->end());
+  return true;
+}
+
+bool MatchesWildcardPattern(const std::string &pattern,
+                            const std::string &file_name) {
+  size_t p = 0, f = 0;
+  // Position of the last '*' in |pattern| and the position in |file_name|
+  // where the characters matched by the '*' end. When a mismatch is found, the
+  // '*' is extended by one character and the matching continues from there.
+  size_t star_p = std::string::npos, star_f = 0;
+  while (f < file_name.size()) {
+    if (p < pattern.size() &&
+        (pattern[p] == '?' || pattern[p] == file_name[f])) {
+      ++p;
+      ++f;
+    } else if (p < pattern.size() && pattern[p] == '*') {
+      star_p = p++;
+      star_f = f;
+    } else if (star_p != std::string::npos) {
+      p = star_p + 1;
+      f = ++star_f;
+    } else {
+      return false;
+    }
+  }
+  while (p < pattern.size() && pattern[p] == '*') {
+    ++p;
+  }
+  return p == pattern.size();
+}
+
 }  // namespace draco
@@ -16,6 +16,7 @@
 #define DRACO_IO_FILE_UTILS_H_
 
 #include <string>
+#include <vector>
 
 namespace draco {
 
@@ -46,6 +47,17 @@ std::string LowercaseFileExtension(const std::string &filename);
 std::string GetFullPath(const std::string &input_file_relative_path,
                         const std::string &sibling_file_full_path);
 
+// Returns names of all regular files stored directly in |dir_path| sorted in
+// the lexicographical order. Returns false when |dir_path| is not a readable
+// directory.
+bool GetFilesInDirectory(const std::string &dir_path,
+                         std::vector<std::string> *out_file_names);
+
+// Returns true when |file_name| matches |pattern| that can contain the
+// wildcards '*' (any sequence of characters) and '?' (any single character).
+bool MatchesWildcardPattern(const std::string &pattern,
+                            const std::string &file_name);
+
 }  // namespace draco
 
 #endif  // DRACO_IO_FILE_UTILS_H_
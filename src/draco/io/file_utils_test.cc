@@ -13,6 +13,9 @@
 // limitations under the License.
 //
 #include "draco/io/file_utils.h"
+
+#include <algorithm>
+
 #include "draco/core/draco_test_base.h"
 #include "draco/core/draco_test_utils.h"
 
@@ -52,4 +55,30 @@ TEST(FileUtilsTest, GetFullPath) {
   ASSERT_EQ(draco::GetFullPath("xo.mtl", "xo.obj"), "xo.mtl");
 }
 
+TEST(FileUtilsTest, GetFilesInDirectory) {
+  std::vector<std::string> file_names;
+  ASSERT_TRUE(draco::GetFilesInDirectory(
+      draco::GetTestFileFullPath("."), &file_names));
+  ASSERT_TRUE(std::is_sorted(file_names.begin(), file_names.end()));
+  ASSERT_NE(std::find(file_names.begin(), file_names.end(), "test_nm.obj"),
+            file_names.end());
+  ASSERT_EQ(std::find(file_names.begin(), file_names.end(), "."),
+            file_names.end());
+
+  ASSERT_FALSE(draco::GetFilesInDirectory(
+      draco::GetTestFileFullPath("test_nm.obj"), &file_names));
+}
+
+TEST(FileUtilsTest, MatchesWildcardPattern) {
+  ASSERT_TRUE(draco::MatchesWildcardPattern("*.obj", "a.obj"));
+  ASSERT_TRUE(draco::MatchesWildcardPattern("*.obj", ".obj"));
+  ASSERT_TRUE(draco::MatchesWildcardPattern("a?c*", "abc"));
+  ASSERT_TRUE(draco::MatchesWildcardPattern("*b*b", "abbcbb"));
+  ASSERT_TRUE(draco::MatchesWildcardPattern("*", ""));
+  ASSERT_FALSE(draco::MatchesWildcardPattern("*.obj", "a.ply"));
+  ASSERT_FALSE(draco::MatchesWildcardPattern("a?c", "ac"));
+  ASSERT_FALSE(draco::MatchesWildcardPattern("*b*b", "abbc"));
+  ASSERT_FALSE(draco::MatchesWildcardPattern("", "a"));
+}
+
 }  // namespace
@@ -26,18 +26,19 @@ template <typename OutStreamT>
 OutStreamT WriteMeshIntoStream(const Mesh *mesh, OutStreamT &&os,
                                MeshEncoderMethod method,
                                const EncoderOptions &options) {
+  // The encoded data is written to the stream while it is being encoded.
+  StreamEncoderBufferSink sink(&os);
   EncoderBuffer buffer;
+  buffer.SetSink(&sink);
   EncoderOptions local_options = options;
   ExpertEncoder encoder(*mesh);
   encoder.Reset(local_options);
   encoder.SetEncodingMethod(method);
-  if (!encoder.EncodeToBuffer(&buffer).ok()) {
+  if (!encoder.EncodeToBuffer(&buffer).ok() || !buffer.Flush()) {
     os.setstate(std::ios_base::badbit);
     return os;
   }
 
-  os.write(static_cast<const char *>(buffer.data()), buffer.size());
-
   return os;
 }
 
@@ -0,0 +1,377 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/io/point_cloud_chunk_reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "draco/core/decoder_buffer.h"
+#include "draco/core/draco_types.h"
+#include "draco/io/file_utils.h"
+#include "draco/io/parser_utils.h"
+
+namespace draco {
+
+namespace {
+
+// Characters separating values on a line of a text file.
+constexpr char kValueSeparators[] = " \t\r,;";
+
+// Parses the next value of |line_buffer|.
+bool ParseNextValue(DecoderBuffer *line_buffer, float *value) {
+  parser::SkipCharacters(line_buffer, kValueSeparators);
+  return parser::ParseFloat(line_buffer, value);
+}
+
+// Returns true when |line| contains no values.
+bool IsEmptyLine(const std::string &line) {
+  const size_t start = line.find_first_not_of(kValueSeparators);
+  return start == std::string::npos || line[start] == '#';
+}
+
+// Returns the data type of a PLY property type name.
+DataType GetPlyDataType(const std::string &name) {
+  if (name == "char" || name == "int8")
+    return DT_INT8;
+  if (name == "uchar" || name == "uint8")
+    return DT_UINT8;
+  if (name == "short" || name == "int16")
+    return DT_INT16;
+  if (name == "ushort" || name == "uint16")
+    return DT_UINT16;
+  if (name == "int" || name == "int32")
+    return DT_INT32;
+  if (name == "uint" || name == "uint32")
+    return DT_UINT32;
+  if (name == "float" || name == "float32")
+    return DT_FLOAT32;
+  if (name == "double" || name == "float64")
+    return DT_FLOAT64;
+  return DT_INVALID;
+}
+
+template <typename T>
+float ConvertToFloat(const char *data) {
+  T value;
+  memcpy(&value, data, sizeof(T));
+  return static_cast<float>(value);
+}
+
+// Converts a little endian value of |data_type| stored at |data| to float.
+float ConvertToFloat(const char *data, DataType data_type) {
+  switch (data_type) {
+    case DT_INT8:
+      return ConvertToFloat<int8_t>(data);
+    case DT_UINT8:
+      return ConvertToFloat<uint8_t>(data);
+    case DT_INT16:
+      return ConvertToFloat<int16_t>(data);
+    case DT_UINT16:
+      return ConvertToFloat<uint16_t>(data);
+    case DT_INT32:
+      return ConvertToFloat<int32_t>(data);
+    case DT_UINT32:
+      return ConvertToFloat<uint32_t>(data);
+    case DT_FLOAT32:
+      return ConvertToFloat<float>(data);
+    case DT_FLOAT64:
+      return ConvertToFloat<double>(data);
+    default:
+      return 0.f;
+  }
+}
+
+// Reader of points stored in the "vertex" element of a PLY file.
+class PlyChunkReader : public PointCloudChunkReader {
+ public:
+  PlyChunkReader()
+      : is_ascii_(false),
+        num_points_(0),
+        num_read_points_(0),
+        point_size_(0) {}
+
+  Status Open(const std::string &file_name);
+
+  StatusOr<int64_t> ReadChunk(int64_t max_points,
+                              std::vector<float> *out_positions) override;
+  Status Rewind() override;
+
+ private:
+  // Scalar property of the vertex element.
+  struct Property {
+    std::string name;
+    DataType data_type;
+    // Offset of the property in a binary vertex.
+    int offset;
+  };
+
+  Status ParseHeader();
+  StatusOr<int64_t> ReadChunkBinary(int64_t num_points,
+                                    std::vector<float> *out_positions);
+  StatusOr<int64_t> ReadChunkAscii(int64_t num_points,
+                                   std::vector<float> *out_positions);
+
+  std::ifstream file_;
+  bool is_ascii_;
+  int64_t num_points_;
+  int64_t num_read_points_;
+  std::vector<Property> properties_;
+  // Index of the x, y and z properties.
+  int position_properties_[3];
+  // Size of a binary vertex.
+  int point_size_;
+  std::streampos data_start_;
+  std::vector<char> data_;
+};
+
+Status PlyChunkReader::Open(const std::string &file_name) {
+  file_.open(file_name, std::ios::binary);
+  if (!file_) {
+    return Status(Status::IO_ERROR, "Failed to open the input file.");
+  }
+  DRACO_RETURN_IF_ERROR(ParseHeader());
+  data_start_ = file_.tellg();
+  return OkStatus();
+}
+
+Status PlyChunkReader::ParseHeader() {
+  std::string line;
+  if (!std::getline(file_, line) || line.compare(0, 3, "ply") != 0) {
+    return Status(Status::INVALID_PARAMETER, "Not a valid ply file.");
+  }
+  bool format_found = false;
+  // Name of the last element declared in the header.
+  std::string element;
+  while (true) {
+    if (!std::getline(file_, line)) {
+      return Status(Status::INVALID_PARAMETER,
+                    "End of file reached before the end_header.");
+    }
+    std::istringstream line_stream(line);
+    std::string keyword;
+    line_stream >> keyword;
+    if (keyword == "end_header") {
+      break;
+    }
+    if (keyword == "format") {
+      std::string format;
+      line_stream >> format;
+      if (format == "ascii") {
+        is_ascii_ = true;
+      } else if (format != "binary_little_endian") {
+        return Status(Status::UNSUPPORTED_VERSION,
+                      "Unsupported format. Currently we support only ascii "
+                      "and binary_little_endian format.");
+      }
+      format_found = true;
+    } else if (keyword == "element") {
+      if (element == "vertex") {
+        // Elements after the vertex data are not read.
+        element = "";
+        break;
+      }
+      line_stream >> element;
+      if (element == "vertex") {
+        line_stream >> num_points_;
+      } else {
+        return Status(Status::DRACO_ERROR,
+                      "The vertex element must be the first element.");
+      }
+    } else if (keyword == "property" && element == "vertex") {
+      std::string type_name;
+      Property property;
+      line_stream >> type_name >> property.name;
+      if (type_name == "list") {
+        return Status(Status::DRACO_ERROR,
+                      "List properties of vertices are not supported.");
+      }
+      property.data_type = GetPlyDataType(type_name);
+      if (property.data_type == DT_INVALID) {
+        return Status(Status::INVALID_PARAMETER, "Invalid property type.");
+      }
+      property.offset = point_size_;
+      point_size_ += DataTypeLength(property.data_type);
+      properties_.push_back(property);
+    }
+  }
+  // Skip the rest of the header when it declares other elements after the
+  // vertex element.
+  while (line.compare(0, 10, "end_header") != 0) {
+    if (!std::getline(file_, line)) {
+      return Status(Status::INVALID_PARAMETER,
+                    "End of file reached before the end_header.");
+    }
+  }
+  if (!format_found) {
+    return Status(Status::INVALID_PARAMETER, "Missing ply format.");
+  }
+  if (num_points_ < 0) {
+    return Status(Status::INVALID_PARAMETER, "Invalid number of vertices.");
+  }
+  const char *const position_names[3] = {"x", "y", "z"};
+  for (int c = 0; c < 3; ++c) {
+    position_properties_[c] = -1;
+    for (size_t i = 0; i < properties_.size(); ++i) {
+      if (properties_[i].name == position_names[c]) {
+        position_properties_[c] = static_cast<int>(i);
+      }
+    }
+    if (position_properties_[c] < 0) {
+      return Status(Status::INVALID_PARAMETER,
+                    "Missing vertex position property.");
+    }
+  }
+  return OkStatus();
+}
+
+StatusOr<int64_t> PlyChunkReader::ReadChunk(
+    int64_t max_points, std::vector<float> *out_positions) {
+  const int64_t num_points =
+      std::min(max_points, num_points_ - num_read_points_);
+  if (num_points <= 0) {
+    return 0;
+  }
+  if (is_ascii_) {
+    return ReadChunkAscii(num_points, out_positions);
+  }
+  return ReadChunkBinary(num_points, out_positions);
+}
+
+StatusOr<int64_t> PlyChunkReader::ReadChunkBinary(
+    int64_t num_points, std::vector<float> *out_positions) {
+  data_.resize(num_points * point_size_);
+  if (!file_.read(data_.data(), data_.size())) {
+    return Status(Status::IO_ERROR, "Unexpected end of the vertex data.");
+  }
+  const char *data = data_.data();
+  for (int64_t i = 0; i < num_points; ++i, data += point_size_) {
+    for (int c = 0; c < 3; ++c) {
+      const Property &property = properties_[position_properties_[c]];
+      out_positions->push_back(
+          ConvertToFloat(data + property.offset, property.data_type));
+    }
+  }
+  num_read_points_ += num_points;
+  return num_points;
+}
+
+StatusOr<int64_t> PlyChunkReader::ReadChunkAscii(
+    int64_t num_points, std::vector<float> *out_positions) {
+  std::string line;
+  std::vector<float> values(properties_.size());
+  int64_t num_parsed_points = 0;
+  while (num_parsed_points < num_points) {
+    if (!std::getline(file_, line)) {
+      return Status(Status::IO_ERROR, "Unexpected end of the vertex data.");
+    }
+    if (IsEmptyLine(line)) {
+      continue;
+    }
+    DecoderBuffer line_buffer;
+    line_buffer.Init(line.data(), line.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+      if (!ParseNextValue(&line_buffer, &values[i])) {
+        return Status(Status::IO_ERROR, "Failed to parse vertex data.");
+      }
+    }
+    for (int c = 0; c < 3; ++c) {
+      out_positions->push_back(values[position_properties_[c]]);
+    }
+    ++num_parsed_points;
+  }
+  num_read_points_ += num_points;
+  return num_points;
+}
+
+Status PlyChunkReader::Rewind() {
+  file_.clear();
+  file_.seekg(data_start_);
+  if (!file_) {
+    return Status(Status::IO_ERROR, "Failed to rewind the input file.");
+  }
+  num_read_points_ = 0;
+  return OkStatus();
+}
+
+// Reader of text files with one point per line.
+class XyzChunkReader : public PointCloudChunkReader {
+ public:
+  Status Open(const std::string &file_name) {
+    file_.open(file_name, std::ios::binary);
+    if (!file_) {
+      return Status(Status::IO_ERROR, "Failed to open the input file.");
+    }
+    return OkStatus();
+  }
+
+  StatusOr<int64_t> ReadChunk(int64_t max_points,
+                              std::vector<float> *out_positions) override {
+    std::string line;
+    int64_t num_points = 0;
+    while (num_points < max_points && std::getline(file_, line)) {
+      if (IsEmptyLine(line)) {
+        continue;
+      }
+      DecoderBuffer line_buffer;
+      line_buffer.Init(line.data(), line.size());
+      float pos[3];
+      for (int c = 0; c < 3; ++c) {
+        if (!ParseNextValue(&line_buffer, &pos[c])) {
+          return Status(Status::IO_ERROR, "Failed to parse point position.");
+        }
+      }
+      out_positions->insert(out_positions->end(), pos, pos + 3);
+      ++num_points;
+    }
+    if (file_.bad()) {
+      return Status(Status::IO_ERROR, "Failed to read the input file.");
+    }
+    return num_points;
+  }
+
+  Status Rewind() override {
+    file_.clear();
+    file_.seekg(0);
+    if (!file_) {
+      return Status(Status::IO_ERROR, "Failed to rewind the input file.");
+    }
+    return OkStatus();
+  }
+
+ private:
+  std::ifstream file_;
+};
+
+}  // namespace
+
+StatusOr<std::unique_ptr<PointCloudChunkReader>> CreatePointCloudChunkReader(
+    const std::string &file_name) {
+  const std::string extension = LowercaseFileExtension(file_name);
+  if (extension == "ply") {
+    std::unique_ptr<PlyChunkReader> reader(new PlyChunkReader());
+    DRACO_RETURN_IF_ERROR(reader->Open(file_name));
+    return std::unique_ptr<PointCloudChunkReader>(std::move(reader));
+  }
+  if (extension == "xyz" || extension == "txt") {
+    std::unique_ptr<XyzChunkReader> reader(new XyzChunkReader());
+    DRACO_RETURN_IF_ERROR(reader->Open(file_name));
+    return std::unique_ptr<PointCloudChunkReader>(std::move(reader));
+  }
+  return Status(Status::DRACO_ERROR, "Unsupported input format.");
+}
+
+}  // namespace draco
@@ -0,0 +1,54 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_IO_POINT_CLOUD_CHUNK_READER_H_
+#define DRACO_IO_POINT_CLOUD_CHUNK_READER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "draco/core/status_or.h"
+
+namespace draco {
+
+// Sequential reader of point positions from sources that are too large to be
+// loaded into memory at once. Unlike PlyReader or ReadPointCloudFromFile(),
+// the points are read in chunks of a bounded size and only the current chunk
+// needs to be held in memory.
+class PointCloudChunkReader {
+ public:
+  virtual ~PointCloudChunkReader() = default;
+
+  // Reads up to |max_points| next points and appends their positions to
+  // |out_positions| as (x, y, z) triplets. Returns the number of read points,
+  // which is zero once all points were read.
+  virtual StatusOr<int64_t> ReadChunk(int64_t max_points,
+                                      std::vector<float> *out_positions) = 0;
+
+  // Restarts reading from the first point.
+  virtual Status Rewind() = 0;
+};
+
+// Opens |file_name| for reading in chunks. The format is determined from the
+// file extension. Supported formats are PLY (".ply", ascii or binary little
+// endian, with the "vertex" element stored first) and XYZ text (".xyz" or
+// ".txt", one point per line given by three coordinates separated by
+// whitespace or commas, additional values on the line are ignored).
+StatusOr<std::unique_ptr<PointCloudChunkReader>> CreatePointCloudChunkReader(
+    const std::string &file_name);
+
+}  // namespace draco
+
+#endif  // DRACO_IO_POINT_CLOUD_CHUNK_READER_H_
@@ -0,0 +1,131 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/io/point_cloud_chunk_reader.h"
+
+#include <fstream>
+
+#include "draco/core/draco_test_base.h"
+#include "draco/core/draco_test_utils.h"
+#include "draco/io/ply_property_reader.h"
+#include "draco/io/ply_reader.h"
+
+namespace draco {
+
+class PointCloudChunkReaderTest : public ::testing::Test {
+ protected:
+  // Reads all positions from |reader| in chunks of |chunk_size| points.
+  std::vector<float> ReadAllPositions(PointCloudChunkReader *reader,
+                                      int chunk_size) const {
+    std::vector<float> positions;
+    while (true) {
+      auto num_points_or = reader->ReadChunk(chunk_size, &positions);
+      EXPECT_TRUE(num_points_or.ok()) << num_points_or.status();
+      if (!num_points_or.ok() || num_points_or.value() == 0)
+        break;
+      EXPECT_LE(num_points_or.value(), chunk_size);
+    }
+    return positions;
+  }
+
+  // Reads positions of the vertices of a PLY file with the PlyReader.
+  std::vector<float> ReadPlyPositions(const std::string &file_name) const {
+    std::ifstream file(GetTestFileFullPath(file_name), std::ios::binary);
+    const std::vector<char> data((std::istreambuf_iterator<char>(file)),
+                                 std::istreambuf_iterator<char>());
+    DecoderBuffer buffer;
+    buffer.Init(data.data(), data.size());
+    PlyReader reader;
+    EXPECT_TRUE(reader.Read(&buffer).ok());
+    const PlyElement *const vertex = reader.GetElementByName("vertex");
+    std::vector<float> positions;
+    if (vertex == nullptr)
+      return positions;
+    PlyPropertyReader<float> x(vertex->GetPropertyByName("x"));
+    PlyPropertyReader<float> y(vertex->GetPropertyByName("y"));
+    PlyPropertyReader<float> z(vertex->GetPropertyByName("z"));
+    for (int i = 0; i < vertex->num_entries(); ++i) {
+      positions.push_back(x.ReadValue(i));
+      positions.push_back(y.ReadValue(i));
+      positions.push_back(z.ReadValue(i));
+    }
+    return positions;
+  }
+
+  void TestPlyFile(const std::string &file_name) {
+    SCOPED_TRACE(file_name);
+    auto reader_or =
+        CreatePointCloudChunkReader(GetTestFileFullPath(file_name));
+    ASSERT_TRUE(reader_or.ok()) << reader_or.status();
+    std::unique_ptr<PointCloudChunkReader> reader =
+        std::move(reader_or).value();
+    const std::vector<float> expected_positions = ReadPlyPositions(file_name);
+    ASSERT_FALSE(expected_positions.empty());
+    ASSERT_EQ(ReadAllPositions(reader.get(), 7), expected_positions);
+    // Reading again after rewinding gives the same points.
+    ASSERT_TRUE(reader->Rewind().ok());
+    ASSERT_EQ(ReadAllPositions(reader.get(), 1000), expected_positions);
+  }
+};
+
+TEST_F(PointCloudChunkReaderTest, TestPlyBinary) {
+  TestPlyFile("test_pos_color.ply");
+  TestPlyFile("point_cloud_test_pos.ply");
+}
+
+TEST_F(PointCloudChunkReaderTest, TestPlyAscii) {
+  TestPlyFile("test_pos_color_ascii.ply");
+  TestPlyFile("test_more_datatypes.ply");
+  TestPlyFile("test_extra_whitespace.ply");
+  TestPlyFile("int_point_cloud.ply");
+}
+
+TEST_F(PointCloudChunkReaderTest, TestXyz) {
+  const std::string path = GetTestTempFileFullPath("chunk_reader_test.xyz");
+  {
+    std::ofstream file(path);
+    file << "# x y z intensity\n"
+         << "1.5 2 -3 100\n"
+         << "\n"
+         << "4,5.25,6\n"
+         << "  -7e1\t8 9.5\n";
+  }
+  auto reader_or = CreatePointCloudChunkReader(path);
+  ASSERT_TRUE(reader_or.ok()) << reader_or.status();
+  std::unique_ptr<PointCloudChunkReader> reader = std::move(reader_or).value();
+  const std::vector<float> expected_positions = {1.5f, 2.f,  -3.f, 4.f, 5.25f,
+                                                 6.f,  -70.f, 8.f, 9.5f};
+  ASSERT_EQ(ReadAllPositions(reader.get(), 2), expected_positions);
+  ASSERT_TRUE(reader->Rewind().ok());
+  ASSERT_EQ(ReadAllPositions(reader.get(), 5), expected_positions);
+}
+
+TEST_F(PointCloudChunkReaderTest, TestInvalidInput) {
+  ASSERT_FALSE(CreatePointCloudChunkReader(GetTestFileFullPath("cube_att.obj"))
+                   .ok());
+  ASSERT_FALSE(
+      CreatePointCloudChunkReader(GetTestTempFileFullPath("missing.xyz")).ok());
+
+  const std::string path = GetTestTempFileFullPath("chunk_reader_test.txt");
+  {
+    std::ofstream file(path);
+    file << "1 2 3\n4 5\n";
+  }
+  auto reader_or = CreatePointCloudChunkReader(path);
+  ASSERT_TRUE(reader_or.ok()) << reader_or.status();
+  std::vector<float> positions;
+  ASSERT_FALSE(reader_or.value()->ReadChunk(10, &positions).ok());
+}
+
+}  // namespace draco
@@ -14,6 +14,7 @@
 //
 #include "draco/mesh/corner_table.h"
 
+#include <algorithm>
 #include <limits>
 
 #include "draco/attributes/geometry_indices.h"
@@ -35,15 +36,36 @@ std::unique_ptr<CornerTable> CornerTable::Create(
   return ct;
 }
 
+std::unique_ptr<CornerTable> CornerTable::Create(
+    IndexTypeVector<CornerIndex, VertexIndex> *corner_to_vertex_map) {
+  std::unique_ptr<CornerTable> ct(new CornerTable());
+  if (!ct->Init(corner_to_vertex_map))
+    return nullptr;
+  return ct;
+}
+
 bool CornerTable::Init(const IndexTypeVector<FaceIndex, FaceType> &faces) {
-  valence_cache_.ClearValenceCache();
-  valence_cache_.ClearValenceCacheInaccurate();
   corner_to_vertex_map_.resize(faces.size() * 3);
   for (FaceIndex fi(0); fi < static_cast<uint32_t>(faces.size()); ++fi) {
     for (int i = 0; i < 3; ++i) {
       corner_to_vertex_map_[FirstCorner(fi) + i] = faces[fi][i];
     }
   }
+  return ComputeConnectivity();
+}
+
+bool CornerTable::Init(
+    IndexTypeVector<CornerIndex, VertexIndex> *corner_to_vertex_map) {
+  if (corner_to_vertex_map == nullptr || corner_to_vertex_map->size() % 3 != 0)
+    return false;
+  corner_to_vertex_map_.clear();
+  corner_to_vertex_map_.swap(*corner_to_vertex_map);
+  return ComputeConnectivity();
+}
+
+bool CornerTable::ComputeConnectivity() {
+  valence_cache_.ClearValenceCache();
+  valence_cache_.ClearValenceCacheInaccurate();
   int num_vertices = -1;
   if (!ComputeOppositeCorners(&num_vertices))
     return false;
@@ -66,6 +88,7 @@ bool CornerTable::Reset(int num_faces, int num_vertices) {
     return false;
   corner_to_vertex_map_.assign(num_faces * 3, kInvalidVertexIndex);
   opposite_corners_.assign(num_faces * 3, kInvalidCornerIndex);
+  vertex_corners_.clear();
   vertex_corners_.reserve(num_vertices);
   valence_cache_.ClearValenceCache();
   valence_cache_.ClearValenceCacheInaccurate();
@@ -87,43 +110,36 @@ bool CornerTable::ComputeOppositeCorners(int *num_vertices) {
   // half-edge to its source vertex.
 
   // First compute the number of outgoing half-edges (corners) attached to each
-  // vertex.
-  std::vector<int> num_corners_on_vertices;
-  num_corners_on_vertices.reserve(num_corners());
+  // vertex. The counts are stored shifted by one so that they can be converted
+  // in place to the offsets of the vertices below.
+  int max_vertex = -1;
+  for (CornerIndex c(0); c < num_corners(); ++c) {
+    max_vertex = std::max(max_vertex, static_cast<int>(Vertex(c).value()));
+  }
+  std::vector<int> vertex_offset(max_vertex + 2, 0);
   for (CornerIndex c(0); c < num_corners(); ++c) {
-    const VertexIndex v1 = Vertex(c);
-    if (v1.value() >= static_cast<int>(num_corners_on_vertices.size()))
-      num_corners_on_vertices.resize(v1.value() + 1, 0);
     // For each corner there is always exactly one outgoing half-edge attached
     // to its vertex.
-    num_corners_on_vertices[v1.value()]++;
+    vertex_offset[Vertex(c).value() + 1]++;
   }
 
-  // Create a storage for half-edges on each vertex. We store all half-edges in
-  // one array, where each entry is identified by the half-edge's sink vertex id
-  // and the associated half-edge corner id (corner opposite to the half-edge).
-  // Each vertex will be assigned storage for up to
-  // |num_corners_on_vertices[vert_id]| half-edges. Unused half-edges are marked
-  // with |sink_vert| == kInvalidVertexIndex.
-  struct VertexEdgePair {
-    VertexEdgePair()
-        : sink_vert(kInvalidVertexIndex), edge_corner(kInvalidCornerIndex) {}
-    VertexIndex sink_vert;
-    CornerIndex edge_corner;
-  };
-  std::vector<VertexEdgePair> vertex_edges(num_corners(), VertexEdgePair());
-
   // For each vertex compute the offset (location where the first half-edge
   // entry of a given vertex is going to be stored). This way each vertex is
   // guaranteed to have a non-overlapping storage with respect to the other
-  // vertices.
-  std::vector<int> vertex_offset(num_corners_on_vertices.size());
-  int offset = 0;
-  for (size_t i = 0; i < num_corners_on_vertices.size(); ++i) {
-    vertex_offset[i] = offset;
-    offset += num_corners_on_vertices[i];
+  // vertices. The number of half-edges of vertex |i| is equal to
+  // |vertex_offset[i + 1] - vertex_offset[i]|.
+  for (size_t i = 1; i < vertex_offset.size(); ++i) {
+    vertex_offset[i] += vertex_offset[i - 1];
   }
 
+  // Create a storage for half-edges on each vertex. We store all half-edges in
+  // one array, where each entry is identified by the half-edge's corner id
+  // (corner opposite to the half-edge). The sink vertex of the half-edge is
+  // the vertex of the previous corner. Each vertex has storage for as many
+  // half-edges as there are corners attached to it. Unused half-edges are
+  // marked with kInvalidCornerIndex.
+  std::vector<CornerIndex> vertex_edges(num_corners(), kInvalidCornerIndex);
+
   // Now go over the all half-edges (using their opposite corners) and either
   // insert them to the |vertex_edge| array or connect them with existing
   // half-edges.
@@ -144,45 +160,42 @@ bool CornerTable::ComputeOppositeCorners(int *num_vertices) {
     }
 
     CornerIndex opposite_c(kInvalidCornerIndex);
-    // The maximum number of half-edges attached to the sink vertex.
-    const int num_corners_on_vert = num_corners_on_vertices[sink_v.value()];
     // Where to look for the first half-edge on the sink vertex.
-    offset = vertex_offset[sink_v.value()];
-    for (int i = 0; i < num_corners_on_vert; ++i, ++offset) {
-      const VertexIndex other_v = vertex_edges[offset].sink_vert;
-      if (other_v == kInvalidVertexIndex)
+    int offset = vertex_offset[sink_v.value()];
+    const int sink_end_offset = vertex_offset[sink_v.value() + 1];
+    for (; offset < sink_end_offset; ++offset) {
+      const CornerIndex other_c = vertex_edges[offset];
+      if (other_c == kInvalidCornerIndex)
         break;  // No matching half-edge found on the sink vertex.
-      if (other_v == source_v) {
-        if (tip_v == Vertex(vertex_edges[offset].edge_corner))
+      if (Vertex(Previous(other_c)) == source_v) {
+        if (tip_v == Vertex(other_c))
           continue;  // Don't connect mirrored faces.
         // A matching half-edge was found on the sink vertex. Mark the
         // half-edge's opposite corner.
-        opposite_c = vertex_edges[offset].edge_corner;
+        opposite_c = other_c;
         // Remove the half-edge from the sink vertex. We remap all subsequent
         // half-edges one slot down.
         // TODO(ostava): This can be optimized a little bit, by remapping only
         // the half-edge on the last valid slot into the deleted half-edge's
         // slot.
-        for (int j = i + 1; j < num_corners_on_vert; ++j, ++offset) {
+        for (; offset + 1 < sink_end_offset; ++offset) {
           vertex_edges[offset] = vertex_edges[offset + 1];
-          if (vertex_edges[offset].sink_vert == kInvalidVertexIndex)
+          if (vertex_edges[offset] == kInvalidCornerIndex)
             break;  // Unused half-edge reached.
         }
         // Mark the last entry as unused.
-        vertex_edges[offset].sink_vert = kInvalidVertexIndex;
+        vertex_edges[offset] = kInvalidCornerIndex;
         break;
       }
     }
     if (opposite_c == kInvalidCornerIndex) {
       // No opposite corner found. Insert the new edge
-      const int num_corners_on_source_vert =
-          num_corners_on_vertices[source_v.value()];
-      offset = vertex_offset[source_v.value()];
-      for (int i = 0; i < num_corners_on_source_vert; ++i, ++offset) {
+      const int source_end_offset = vertex_offset[source_v.value() + 1];
+      for (offset = vertex_offset[source_v.value()];
+           offset < source_end_offset; ++offset) {
         // Find the first unused half-edge slot on the source vertex.
-        if (vertex_edges[offset].sink_vert == kInvalidVertexIndex) {
-          vertex_edges[offset].sink_vert = sink_v;
-          vertex_edges[offset].edge_corner = c;
+        if (vertex_edges[offset] == kInvalidCornerIndex) {
+          vertex_edges[offset] = c;
           break;
         }
       }
@@ -192,7 +205,7 @@ bool CornerTable::ComputeOppositeCorners(int *num_vertices) {
       opposite_corners_[opposite_c] = c;
     }
   }
-  *num_vertices = static_cast<int>(num_corners_on_vertices.size());
+  *num_vertices = max_vertex + 1;
   return true;
 }
 
@@ -57,18 +57,35 @@ class CornerTable {
   CornerTable();
   static std::unique_ptr<CornerTable> Create(
       const IndexTypeVector<FaceIndex, FaceType> &faces);
+  static std::unique_ptr<CornerTable> Create(
+      IndexTypeVector<CornerIndex, VertexIndex> *corner_to_vertex_map);
 
   // Initializes the CornerTable from provides set of indexed faces.
   // The input faces can represent a non-manifold topology, in which case the
   // non-manifold edges and vertices are going to be split.
   bool Init(const IndexTypeVector<FaceIndex, FaceType> &faces);
 
+  // Same as above but the faces are given as a map between corners and their
+  // vertices (three consecutive corners per face). The content of the map is
+  // moved to the corner table, which avoids storing a second copy of the
+  // faces while the table is being built. |corner_to_vertex_map| is left
+  // empty.
+  bool Init(IndexTypeVector<CornerIndex, VertexIndex> *corner_to_vertex_map);
+
   // Resets the corner table to the given number of invalid faces.
   bool Reset(int num_faces);
 
   // Resets the corner table to the given number of invalid faces and vertices.
   bool Reset(int num_faces, int num_vertices);
 
+  // Returns the number of bytes reserved by the internal data of the table.
+  size_t ComputeAllocatedSize() const {
+    return corner_to_vertex_map_.capacity() * sizeof(VertexIndex) +
+           opposite_corners_.capacity() * sizeof(CornerIndex) +
+           vertex_corners_.capacity() * sizeof(CornerIndex) +
+           non_manifold_vertex_parents_.capacity() * sizeof(VertexIndex);
+  }
+
   inline int num_vertices() const {
     return static_cast<int>(vertex_corners_.size());
   }
@@ -331,6 +348,10 @@ class CornerTable {
   }
 
  private:
+  // Computes all connectivity data from the data stored in
+  // |corner_to_vertex_map_|.
+  bool ComputeConnectivity();
+
   // Computes opposite corners mapping from the data stored in
   // |corner_to_vertex_map_|.
   bool ComputeOppositeCorners(int *num_vertices);
@@ -28,9 +28,10 @@ bool MeshAttributeCornerTable::InitEmpty(const CornerTable *table) {
   valence_cache_.ClearValenceCacheInaccurate();
   is_edge_on_seam_.assign(table->num_corners(), false);
   is_vertex_on_seam_.assign(table->num_vertices(), false);
-  corner_to_vertex_map_.assign(table->num_corners(), kInvalidVertexIndex);
-  vertex_to_attribute_entry_id_map_.reserve(table->num_vertices());
-  vertex_to_left_most_corner_map_.reserve(table->num_vertices());
+  // The vertex data is allocated in RecomputeVertices().
+  corner_to_vertex_map_.clear();
+  vertex_to_attribute_entry_id_map_.clear();
+  vertex_to_left_most_corner_map_.clear();
   corner_table_ = table;
   no_interior_seams_ = true;
   return true;
@@ -39,10 +40,16 @@ bool MeshAttributeCornerTable::InitEmpty(const CornerTable *table) {
 bool MeshAttributeCornerTable::InitFromAttribute(const Mesh *mesh,
                                                  const CornerTable *table,
                                                  const PointAttribute *att) {
+  if (!InitSeamsFromAttribute(mesh, table, att))
+    return false;
+  RecomputeVertices(mesh, att);
+  return true;
+}
+
+bool MeshAttributeCornerTable::InitSeamsFromAttribute(
+    const Mesh *mesh, const CornerTable *table, const PointAttribute *att) {
   if (!InitEmpty(table))
     return false;
-  valence_cache_.ClearValenceCache();
-  valence_cache_.ClearValenceCacheInaccurate();
 
   // Find all necessary data for encoding attributes. For now we check which of
   // the mesh vertices is part of an attribute seam, because seams require
@@ -96,7 +103,6 @@ bool MeshAttributeCornerTable::InitFromAttribute(const Mesh *mesh,
       }
     }
   }
-  RecomputeVertices(mesh, att);
   return true;
 }
 
@@ -124,6 +130,12 @@ void MeshAttributeCornerTable::AddSeamEdge(CornerIndex c) {
 void MeshAttributeCornerTable::RecomputeVertices(const Mesh *mesh,
                                                  const PointAttribute *att) {
   DRACO_DCHECK(GetValenceCache().IsCacheEmpty());
+  corner_to_vertex_map_.assign(corner_table_->num_corners(),
+                               kInvalidVertexIndex);
+  vertex_to_attribute_entry_id_map_.clear();
+  vertex_to_attribute_entry_id_map_.reserve(corner_table_->num_vertices());
+  vertex_to_left_most_corner_map_.clear();
+  vertex_to_left_most_corner_map_.reserve(corner_table_->num_vertices());
   if (mesh != nullptr && att != nullptr) {
     RecomputeVerticesInternal<true>(mesh, att);
   } else {
@@ -34,6 +34,13 @@ class MeshAttributeCornerTable {
   bool InitFromAttribute(const Mesh *mesh, const CornerTable *table,
                          const PointAttribute *att);
 
+  // Same as InitFromAttribute() but only the seam edges are computed. The
+  // vertices of the table are not available until RecomputeVertices() is
+  // called, which allows the caller to skip the allocation of the per-corner
+  // and per-vertex data when only the seam edges are needed.
+  bool InitSeamsFromAttribute(const Mesh *mesh, const CornerTable *table,
+                              const PointAttribute *att);
+
   void AddSeamEdge(CornerIndex opp_corner);
 
   // Recomputes vertices using the newly added seam edges (needs to be called
@@ -42,6 +49,16 @@ class MeshAttributeCornerTable {
   // attribute value ids is set to identity.
   void RecomputeVertices(const Mesh *mesh, const PointAttribute *att);
 
+  // Returns the number of bytes reserved by the internal data of the table.
+  size_t ComputeAllocatedSize() const {
+    // std::vector<bool> stores one bit per entry.
+    return (is_edge_on_seam_.capacity() + is_vertex_on_seam_.capacity()) / 8 +
+           corner_to_vertex_map_.capacity() * sizeof(VertexIndex) +
+           vertex_to_left_most_corner_map_.capacity() * sizeof(CornerIndex) +
+           vertex_to_attribute_entry_id_map_.capacity() *
+               sizeof(AttributeValueIndex);
+  }
+
   inline bool IsCornerOppositeToSeamEdge(CornerIndex corner) const {
     return is_edge_on_seam_[corner.value()];
   }
@@ -0,0 +1,252 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/mesh/mesh_clustering_simplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <utility>
+
+namespace draco {
+
+namespace {
+
+// Maximum number of cells along one side of the grid.
+constexpr int kMaxGridSize = 1 << 20;
+
+}  // namespace
+
+MeshClusteringSimplifier::MeshClusteringSimplifier()
+    : mesh_(nullptr), max_extent_(0.f) {}
+
+bool MeshClusteringSimplifier::Init(const Mesh &mesh) {
+  const PointAttribute *const pos_att =
+      mesh.GetNamedAttribute(GeometryAttribute::POSITION);
+  if (pos_att == nullptr || pos_att->num_components() != 3) {
+    return false;
+  }
+  mesh_ = &mesh;
+  positions_.resize(mesh.num_points());
+  for (PointIndex p(0); p < mesh.num_points(); ++p) {
+    if (!pos_att->ConvertValue<float>(pos_att->mapped_index(p), 3,
+                                      &positions_[p.value()][0])) {
+      return false;
+    }
+  }
+  Vector3f max_position;
+  if (!positions_.empty()) {
+    min_position_ = max_position = positions_[0];
+  }
+  for (const Vector3f &pos : positions_) {
+    for (int c = 0; c < 3; ++c) {
+      min_position_[c] = std::min(min_position_[c], pos[c]);
+      max_position[c] = std::max(max_position[c], pos[c]);
+    }
+  }
+  max_extent_ = (max_position - min_position_).MaxCoeff();
+  return true;
+}
+
+std::unique_ptr<Mesh> MeshClusteringSimplifier::Simplify(int grid_size) const {
+  if (mesh_ == nullptr || grid_size < 1) {
+    return nullptr;
+  }
+  std::vector<int> point_clusters;
+  const int num_clusters = ClusterPoints(grid_size, &point_clusters);
+  std::vector<ClusterFace> faces;
+  ComputeFaces(point_clusters, &faces);
+  return CreateMesh(point_clusters, num_clusters, faces);
+}
+
+std::unique_ptr<Mesh> MeshClusteringSimplifier::SimplifyToFaceCount(
+    int max_faces) const {
+  if (mesh_ == nullptr || max_faces < 0) {
+    return nullptr;
+  }
+  // The number of faces of a simplified surface grows roughly with the square
+  // of the grid size, so a grid with 4 * sqrt(max_faces) cells is usually
+  // already too fine.
+  int min_grid_size = 1;
+  int max_grid_size = std::min(
+      kMaxGridSize, 4 * static_cast<int>(std::sqrt(max_faces)) + 2);
+  std::vector<int> point_clusters;
+  std::vector<ClusterFace> faces;
+  int best_grid_size = 1;
+  size_t best_num_faces = 0;
+  while (min_grid_size <= max_grid_size) {
+    const int grid_size = min_grid_size + (max_grid_size - min_grid_size) / 2;
+    ClusterPoints(grid_size, &point_clusters);
+    ComputeFaces(point_clusters, &faces);
+    if (faces.size() <= static_cast<size_t>(max_faces)) {
+      if (faces.size() >= best_num_faces) {
+        best_grid_size = grid_size;
+        best_num_faces = faces.size();
+      }
+      min_grid_size = grid_size + 1;
+    } else {
+      max_grid_size = grid_size - 1;
+    }
+  }
+  return Simplify(best_grid_size);
+}
+
+int MeshClusteringSimplifier::ClusterPoints(
+    int grid_size, std::vector<int> *point_clusters) const {
+  grid_size = std::min(grid_size, kMaxGridSize);
+  const float cell_size =
+      max_extent_ > 0.f ? max_extent_ / grid_size : 1.f;
+  std::unordered_map<uint64_t, int> cell_clusters;
+  point_clusters->resize(positions_.size());
+  for (size_t i = 0; i < positions_.size(); ++i) {
+    uint64_t key = 0;
+    for (int c = 0; c < 3; ++c) {
+      const int cell = static_cast<int>(
+          std::floor((positions_[i][c] - min_position_[c]) / cell_size));
+      key = key * grid_size +
+            static_cast<uint64_t>(std::max(0, std::min(cell, grid_size - 1)));
+    }
+    const int num_clusters = static_cast<int>(cell_clusters.size());
+    (*point_clusters)[i] =
+        cell_clusters.insert(std::make_pair(key, num_clusters)).first->second;
+  }
+  return static_cast<int>(cell_clusters.size());
+}
+
+void MeshClusteringSimplifier::ComputeFaces(
+    const std::vector<int> &point_clusters,
+    std::vector<ClusterFace> *faces) const {
+  // Collect non-degenerate faces together with a key that is the same for all
+  // faces connecting the same clusters.
+  std::vector<std::pair<ClusterFace, FaceIndex>> sorted_faces;
+  sorted_faces.reserve(mesh_->num_faces());
+  for (FaceIndex f(0); f < mesh_->num_faces(); ++f) {
+    const Mesh::Face &face = mesh_->face(f);
+    ClusterFace key;
+    for (int c = 0; c < 3; ++c) {
+      key[c] = point_clusters[face[c].value()];
+    }
+    if (key[0] == key[1] || key[0] == key[2] || key[1] == key[2]) {
+      continue;
+    }
+    std::sort(key.begin(), key.end());
+    sorted_faces.push_back(std::make_pair(key, f));
+  }
+  std::sort(sorted_faces.begin(), sorted_faces.end());
+
+  // Keep the first face of each key in the original order of the faces.
+  std::vector<FaceIndex> unique_faces;
+  for (size_t i = 0; i < sorted_faces.size(); ++i) {
+    if (i == 0 || sorted_faces[i].first != sorted_faces[i - 1].first) {
+      unique_faces.push_back(sorted_faces[i].second);
+    }
+  }
+  std::sort(unique_faces.begin(), unique_faces.end());
+  faces->resize(unique_faces.size());
+  for (size_t i = 0; i < unique_faces.size(); ++i) {
+    const Mesh::Face &face = mesh_->face(unique_faces[i]);
+    for (int c = 0; c < 3; ++c) {
+      (*faces)[i][c] = point_clusters[face[c].value()];
+    }
+  }
+}
+
+std::unique_ptr<Mesh> MeshClusteringSimplifier::CreateMesh(
+    const std::vector<int> &point_clusters, int num_clusters,
+    const std::vector<ClusterFace> &faces) const {
+  // Only clusters used by the faces become points of the new mesh. The points
+  // are ordered by their first use.
+  std::vector<int> cluster_points(num_clusters, -1);
+  int num_points = 0;
+  std::unique_ptr<Mesh> mesh(new Mesh());
+  mesh->SetNumFaces(faces.size());
+  for (size_t i = 0; i < faces.size(); ++i) {
+    Mesh::Face face;
+    for (int c = 0; c < 3; ++c) {
+      int &point = cluster_points[faces[i][c]];
+      if (point < 0) {
+        point = num_points++;
+      }
+      face[c] = PointIndex(point);
+    }
+    mesh->SetFace(FaceIndex(static_cast<uint32_t>(i)), face);
+  }
+  mesh->set_num_points(num_points);
+
+  // Source point of each new point whose value is used for non-float
+  // attributes.
+  std::vector<PointIndex> representatives(num_points, kInvalidPointIndex);
+  for (PointIndex p(0); p < mesh_->num_points(); ++p) {
+    const int point = cluster_points[point_clusters[p.value()]];
+    if (point >= 0 && representatives[point] == kInvalidPointIndex) {
+      representatives[point] = p;
+    }
+  }
+
+  for (int i = 0; i < mesh_->num_attributes(); ++i) {
+    const PointAttribute *const src_att = mesh_->attribute(i);
+    const int num_components = src_att->num_components();
+    GeometryAttribute ga;
+    ga.Init(src_att->attribute_type(), nullptr, num_components,
+            src_att->data_type(), src_att->normalized(),
+            DataTypeLength(src_att->data_type()) * num_components, 0);
+    const int att_id = mesh->AddAttribute(ga, true, num_points);
+    PointAttribute *const att = mesh->attribute(att_id);
+    att->set_unique_id(src_att->unique_id());
+
+    if (src_att->data_type() != DT_FLOAT32) {
+      for (int p = 0; p < num_points; ++p) {
+        att->SetAttributeValue(
+            AttributeValueIndex(p),
+            src_att->GetAddressOfMappedIndex(representatives[p]));
+      }
+      continue;
+    }
+
+    // Average values of all merged points.
+    std::vector<float> sums(num_points * num_components, 0.f);
+    std::vector<int> counts(num_points, 0);
+    std::vector<float> value(num_components);
+    for (PointIndex p(0); p < mesh_->num_points(); ++p) {
+      const int point = cluster_points[point_clusters[p.value()]];
+      if (point < 0) {
+        continue;
+      }
+      src_att->GetMappedValue(p, &value[0]);
+      for (int c = 0; c < num_components; ++c) {
+        sums[point * num_components + c] += value[c];
+      }
+      ++counts[point];
+    }
+    for (int p = 0; p < num_points; ++p) {
+      float *const mean = &sums[p * num_components];
+      float norm = 0.f;
+      for (int c = 0; c < num_components; ++c) {
+        mean[c] /= counts[p];
+        norm += mean[c] * mean[c];
+      }
+      if (src_att->attribute_type() == GeometryAttribute::NORMAL &&
+          norm > 0.f) {
+        norm = std::sqrt(norm);
+        for (int c = 0; c < num_components; ++c) {
+          mean[c] /= norm;
+        }
+      }
+      att->SetAttributeValue(AttributeValueIndex(p), mean);
+    }
+  }
+  return mesh;
+}
+
+}  // namespace draco
@@ -0,0 +1,77 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_MESH_MESH_CLUSTERING_SIMPLIFIER_H_
+#define DRACO_MESH_MESH_CLUSTERING_SIMPLIFIER_H_
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "draco/core/vector_d.h"
+#include "draco/mesh/mesh.h"
+
+namespace draco {
+
+// Class for creating coarse approximations of meshes using vertex clustering.
+// The bounding box of the mesh is divided into a regular grid of cubic cells
+// and all points within the same cell are merged into a single point. Values
+// of float attributes of the merged point are averaged (normals are also
+// renormalized), other attributes use the value of the first merged point.
+// Faces that become degenerate and duplicate faces are removed.
+//
+// The simplification is fast and robust to any input, but it does not
+// preserve the topology of the mesh. It is intended for generating of coarse
+// levels of detail.
+class MeshClusteringSimplifier {
+ public:
+  MeshClusteringSimplifier();
+
+  // Prepares the simplification of |mesh|. The mesh must contain a position
+  // attribute with three components and it must outlive the simplifier.
+  bool Init(const Mesh &mesh);
+
+  // Returns the mesh simplified on a grid with |grid_size| cells along the
+  // longest side of the bounding box.
+  std::unique_ptr<Mesh> Simplify(int grid_size) const;
+
+  // Returns the finest simplification with at most |max_faces| faces. The
+  // grid size is found by bisection.
+  std::unique_ptr<Mesh> SimplifyToFaceCount(int max_faces) const;
+
+ private:
+  typedef std::array<int, 3> ClusterFace;
+
+  // Assigns all points of the mesh to clusters given by the |grid_size|.
+  // Returns the number of clusters.
+  int ClusterPoints(int grid_size, std::vector<int> *point_clusters) const;
+
+  // Computes the faces of the simplified mesh in terms of cluster ids.
+  void ComputeFaces(const std::vector<int> &point_clusters,
+                    std::vector<ClusterFace> *faces) const;
+
+  std::unique_ptr<Mesh> CreateMesh(const std::vector<int> &point_clusters,
+                                   int num_clusters,
+                                   const std::vector<ClusterFace> &faces) const;
+
+  const Mesh *mesh_;
+  // Positions of all points of the mesh.
+  std::vector<Vector3f> positions_;
+  Vector3f min_position_;
+  float max_extent_;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_MESH_MESH_CLUSTERING_SIMPLIFIER_H_
@@ -0,0 +1,61 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/mesh/mesh_clustering_simplifier.h"
+
+#include "draco/core/draco_test_base.h"
+#include "draco/core/draco_test_utils.h"
+
+namespace draco {
+
+class MeshClusteringSimplifierTest : public ::testing::Test {};
+
+TEST_F(MeshClusteringSimplifierTest, TestSimplify) {
+  const std::unique_ptr<Mesh> mesh(ReadMeshFromTestFile("bun_zipper.ply"));
+  ASSERT_NE(mesh, nullptr);
+  MeshClusteringSimplifier simplifier;
+  ASSERT_TRUE(simplifier.Init(*mesh));
+
+  // A single cell merges all points.
+  std::unique_ptr<Mesh> simplified = simplifier.Simplify(1);
+  ASSERT_NE(simplified, nullptr);
+  ASSERT_EQ(simplified->num_faces(), 0);
+
+  int prev_num_faces = 0;
+  for (int grid_size : {8, 32, 128}) {
+    simplified = simplifier.Simplify(grid_size);
+    ASSERT_NE(simplified, nullptr);
+    ASSERT_GT(simplified->num_faces(), prev_num_faces);
+    ASSERT_LT(simplified->num_faces(), mesh->num_faces());
+    ASSERT_EQ(simplified->num_attributes(), mesh->num_attributes());
+    prev_num_faces = simplified->num_faces();
+  }
+}
+
+TEST_F(MeshClusteringSimplifierTest, TestSimplifyToFaceCount) {
+  const std::unique_ptr<Mesh> mesh(ReadMeshFromTestFile("bun_zipper.ply"));
+  ASSERT_NE(mesh, nullptr);
+  MeshClusteringSimplifier simplifier;
+  ASSERT_TRUE(simplifier.Init(*mesh));
+  for (int max_faces : {100, 1000, 10000}) {
+    const std::unique_ptr<Mesh> simplified =
+        simplifier.SimplifyToFaceCount(max_faces);
+    ASSERT_NE(simplified, nullptr);
+    ASSERT_LE(simplified->num_faces(), max_faces);
+    // The face budget should be reasonably well used.
+    ASSERT_GT(simplified->num_faces(), max_faces / 4);
+  }
+}
+
+}  // namespace draco
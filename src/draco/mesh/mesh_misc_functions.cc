@@ -18,41 +18,39 @@ namespace draco {
 
 std::unique_ptr<CornerTable> CreateCornerTableFromPositionAttribute(
     const Mesh *mesh) {
-  typedef CornerTable::FaceType FaceType;
-
   const PointAttribute *const att =
       mesh->GetNamedAttribute(GeometryAttribute::POSITION);
   if (att == nullptr)
     return nullptr;
-  IndexTypeVector<FaceIndex, FaceType> faces(mesh->num_faces());
-  FaceType new_face;
+  // The corner to vertex map is moved directly into the corner table so that
+  // the faces don't need to be stored twice.
+  IndexTypeVector<CornerIndex, VertexIndex> corner_to_vertex_map(
+      mesh->num_faces() * 3);
   for (FaceIndex i(0); i < mesh->num_faces(); ++i) {
     const Mesh::Face &face = mesh->face(i);
     for (int j = 0; j < 3; ++j) {
       // Map general vertex indices to position indices.
-      new_face[j] = att->mapped_index(face[j]).value();
+      corner_to_vertex_map[CornerIndex(3 * i.value() + j)] =
+          att->mapped_index(face[j]).value();
     }
-    faces[FaceIndex(i)] = new_face;
   }
   // Build the corner table.
-  return CornerTable::Create(faces);
+  return CornerTable::Create(&corner_to_vertex_map);
 }
 
 std::unique_ptr<CornerTable> CreateCornerTableFromAllAttributes(
     const Mesh *mesh) {
-  typedef CornerTable::FaceType FaceType;
-  IndexTypeVector<FaceIndex, FaceType> faces(mesh->num_faces());
-  FaceType new_face;
+  IndexTypeVector<CornerIndex, VertexIndex> corner_to_vertex_map(
+      mesh->num_faces() * 3);
   for (FaceIndex i(0); i < mesh->num_faces(); ++i) {
     const Mesh::Face &face = mesh->face(i);
     // Each face is identified by point indices that automatically split the
     // mesh along attribute seams.
     for (int j = 0; j < 3; ++j) {
-      new_face[j] = face[j].value();
+      corner_to_vertex_map[CornerIndex(3 * i.value() + j)] = face[j].value();
     }
-    faces[i] = new_face;
   }
   // Build the corner table.
-  return CornerTable::Create(faces);
+  return CornerTable::Create(&corner_to_vertex_map);
 }
 }  // namespace draco
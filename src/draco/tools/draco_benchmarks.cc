@@ -0,0 +1,1029 @@
+// Copyright 2018 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Benchmark of the encoding and decoding pipelines. Each input geometry is
+// encoded and decoded with all combinations of the selected encoding methods,
+// compression levels and position quantization bits. For every run, the
+// throughput and the peak heap memory of the whole encoding and decoding is
+// reported together with a breakdown to the individual stages reported through
+// the draco::Tracer interface. For meshes, the peak memory is also reported
+// per input triangle, and the peak resident set size of the process is
+// reported when the platform supports it. For point clouds, the decoded points
+// per second are reported. The kd-tree method uses the compression level
+// capped at 6, so "-cl 0,1,2,3,4,5,6" covers all of its levels. The results
+// can be written in JSON format so that they can be compared between builds.
+// In addition, the throughput of individual components of the library, such
+// as the batch decoding of many small meshes, the bit coders or the symbol
+// decoding, is compared against their baseline implementations.
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "draco/compression/batch_decode.h"
+#include "draco/compression/config/compression_shared.h"
+#include "draco/compression/decode.h"
+#include "draco/compression/encode.h"
+#include "draco/compression/entropy/symbol_decoding.h"
+#include "draco/compression/entropy/symbol_encoding.h"
+#include "draco/core/tracer.h"
+#include "draco/io/mesh_io.h"
+#include "draco/io/point_cloud_io.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#define DRACO_BENCHMARK_HAS_RUSAGE
+#endif
+
+// Heap usage of the process. All allocations of the benchmark go through the
+// replaced global operators new and delete below.
+namespace {
+
+std::atomic<int64_t> current_heap_bytes(0);
+std::atomic<int64_t> peak_heap_bytes(0);
+
+// Size of the header stored in front of each allocation. It keeps the
+// alignment of the returned memory.
+constexpr size_t kAllocationHeaderSize = 16;
+
+void *TrackedAlloc(size_t size) {
+  void *const ptr = malloc(size + kAllocationHeaderSize);
+  if (ptr == nullptr)
+    return nullptr;
+  *static_cast<size_t *>(ptr) = size;
+  const int64_t current =
+      current_heap_bytes.fetch_add(static_cast<int64_t>(size)) +
+      static_cast<int64_t>(size);
+  int64_t peak = peak_heap_bytes.load();
+  while (current > peak &&
+         !peak_heap_bytes.compare_exchange_weak(peak, current)) {
+  }
+  return static_cast<char *>(ptr) + kAllocationHeaderSize;
+}
+
+void TrackedFree(void *ptr) {
+  if (ptr == nullptr)
+    return;
+  void *const base = static_cast<char *>(ptr) - kAllocationHeaderSize;
+  current_heap_bytes.fetch_sub(
+      static_cast<int64_t>(*static_cast<size_t *>(base)));
+  free(base);
+}
+
+}  // anonymous namespace
+
+void *operator new(size_t size) {
+  void *const ptr = TrackedAlloc(size);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  return TrackedAlloc(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+  return TrackedAlloc(size);
+}
+
+void operator delete(void *ptr) noexcept { TrackedFree(ptr); }
+
+void operator delete[](void *ptr) noexcept { TrackedFree(ptr); }
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+  TrackedFree(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+  TrackedFree(ptr);
+}
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Measures the time and the peak heap memory of a block of code. Peak memory
+// is reported relative to the heap usage at the start of the measurement.
+// Measurements can be nested.
+class Measurement {
+ public:
+  Measurement()
+      : start_time_(Clock::now()),
+        start_heap_bytes_(current_heap_bytes.load()),
+        saved_peak_heap_bytes_(peak_heap_bytes.exchange(start_heap_bytes_)) {}
+
+  // Stops the measurement. Must be called exactly once.
+  void Stop(double *out_time_ms, int64_t *out_peak_memory_bytes) {
+    *out_time_ms = std::chrono::duration<double, std::milli>(Clock::now() -
+                                                             start_time_)
+                       .count();
+    const int64_t peak = peak_heap_bytes.load();
+    *out_peak_memory_bytes = peak - start_heap_bytes_;
+    // Restore the peak of the enclosing measurement.
+    if (saved_peak_heap_bytes_ > peak)
+      peak_heap_bytes.store(saved_peak_heap_bytes_);
+  }
+
+ private:
+  const Clock::time_point start_time_;
+  const int64_t start_heap_bytes_;
+  const int64_t saved_peak_heap_bytes_;
+};
+
+struct StageStats {
+  StageStats() : count(0), time_ms(0), num_bytes(0), peak_memory_bytes(0) {}
+
+  int count;
+  double time_ms;
+  int64_t num_bytes;
+  int64_t peak_memory_bytes;
+};
+
+// Tracer that accumulates the time, processed bytes and peak memory of all
+// stages with the same name. The benchmark runs the pipelines on a single
+// thread so the stages are always properly nested.
+class StageStatsTracer : public draco::Tracer {
+ public:
+  void BeginStage(const char * /* name */) override {
+    measurements_.emplace_back(new Measurement());
+  }
+
+  void EndStage(const char *name, int64_t num_bytes) override {
+    double time_ms;
+    int64_t peak_memory_bytes;
+    measurements_.back()->Stop(&time_ms, &peak_memory_bytes);
+    measurements_.pop_back();
+    StageStats &stats = stats_[name];
+    if (stats.count == 0)
+      stage_order_.push_back(name);
+    ++stats.count;
+    stats.time_ms += time_ms;
+    if (num_bytes > 0)
+      stats.num_bytes += num_bytes;
+    stats.peak_memory_bytes =
+        std::max(stats.peak_memory_bytes, peak_memory_bytes);
+  }
+
+  void Clear() {
+    stats_.clear();
+    stage_order_.clear();
+  }
+
+  // Names of all stages in the order in which they were first completed.
+  const std::vector<std::string> &stage_order() const { return stage_order_; }
+  const StageStats &stats(const std::string &name) const {
+    return stats_.at(name);
+  }
+
+ private:
+  std::vector<std::unique_ptr<Measurement>> measurements_;
+  std::map<std::string, StageStats> stats_;
+  std::vector<std::string> stage_order_;
+};
+
+// Returns the peak resident set size of the process in bytes or 0 when it is
+// not available on the current platform.
+int64_t GetPeakResidentSetSize() {
+#ifdef DRACO_BENCHMARK_HAS_RUSAGE
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#ifdef __APPLE__
+  // Reported in bytes on macOS.
+  return static_cast<int64_t>(usage.ru_maxrss);
+#else
+  // Reported in kilobytes on Linux and BSD.
+  return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+  return 0;
+#endif
+}
+
+struct PipelineResult {
+  PipelineResult() : time_ms(0), peak_memory_bytes(0) {}
+
+  double time_ms;
+  int64_t peak_memory_bytes;
+  std::vector<std::pair<std::string, StageStats>> stages;
+};
+
+struct BenchmarkResult {
+  std::string input;
+  bool is_mesh;
+  int num_points;
+  int num_faces;
+  int64_t raw_size;
+  std::string encoding_method;
+  int compression_level;
+  int position_quantization_bits;
+  std::string error;
+  int64_t encoded_size;
+  PipelineResult encode;
+  PipelineResult decode;
+  // Peak resident set size of the process after the benchmark. Note that the
+  // value never decreases, so it is affected by all previous benchmarks.
+  int64_t peak_rss;
+};
+
+// Result of a benchmark of a single component of the library.
+struct ComponentResult {
+  ComponentResult() : time_ms(0), num_items(0) {}
+
+  std::string name;
+  std::string error;
+  double time_ms;
+  // Number of processed items, e.g. meshes or values.
+  int64_t num_items;
+};
+
+struct Options {
+  Options();
+
+  std::vector<std::string> inputs;
+  std::string testdata_dir;
+  int synthetic_size;
+  std::vector<int> compression_levels;
+  std::vector<int> position_quantization_bits;
+  int iterations;
+  bool components;
+  std::string output;
+};
+
+Options::Options()
+    : synthetic_size(512),
+      compression_levels({0, 7, 10}),
+      position_quantization_bits({11, 14}),
+      iterations(3),
+      components(true) {}
+
+void Usage() {
+  printf("Usage: draco_benchmarks [options]\n");
+  printf("\n");
+  printf("Main options:\n");
+  printf("  -h | -?               show help.\n");
+  printf(
+      "  -i <input>            input mesh or point cloud, can be repeated. "
+      "By default,\n");
+  printf(
+      "                        a set of files from the test data directory "
+      "is used.\n");
+  printf(
+      "  -testdata <dir>       directory with the default inputs, "
+      "default=%s.\n",
+      DRACO_BENCHMARK_TESTDATA_DIR);
+  printf(
+      "  -synthetic <size>     resolution of the synthetic grid mesh and "
+      "point cloud,\n");
+  printf(
+      "                        0 disables synthetic inputs, default=512.\n");
+  printf(
+      "  -cl <list>            comma separated compression levels, "
+      "default=0,7,10.\n");
+  printf(
+      "  -qp <list>            comma separated position quantization bits, "
+      "default=11,14.\n");
+  printf(
+      "  -iterations <value>   number of runs of each configuration, the "
+      "fastest run\n");
+  printf("                        is reported, default=3.\n");
+  printf(
+      "  -components <0|1>     run the benchmarks of individual components, "
+      "default=1.\n");
+  printf("  -o <output>           output JSON file name.\n");
+}
+
+int StringToInt(const std::string &s) {
+  char *end;
+  return strtol(s.c_str(), &end, 10);  // NOLINT
+}
+
+std::vector<int> StringToIntList(const std::string &s) {
+  std::vector<int> values;
+  std::stringstream stream(s);
+  std::string value;
+  while (std::getline(stream, value, ',')) {
+    if (!value.empty())
+      values.push_back(StringToInt(value));
+  }
+  return values;
+}
+
+int64_t GetRawSize(const draco::PointCloud &pc) {
+  int64_t size = 0;
+  for (int i = 0; i < pc.num_attributes(); ++i) {
+    const draco::PointAttribute *const att = pc.attribute(i);
+    size += static_cast<int64_t>(pc.num_points()) *
+            draco::DataTypeLength(att->data_type()) * att->num_components();
+  }
+  const draco::Mesh *const mesh = dynamic_cast<const draco::Mesh *>(&pc);
+  if (mesh)
+    size += static_cast<int64_t>(mesh->num_faces()) * 3 * sizeof(uint32_t);
+  return size;
+}
+
+// Adds a float attribute with one value for each point of |pc|.
+int AddFloatAttribute(draco::PointCloud *pc,
+                      draco::GeometryAttribute::Type type, int num_components) {
+  draco::GeometryAttribute att;
+  att.Init(type, nullptr, num_components, draco::DT_FLOAT32, false,
+           sizeof(float) * num_components, 0);
+  return pc->AddAttribute(att, true, pc->num_points());
+}
+
+// Creates a regular grid mesh with |size| x |size| vertices displaced by a
+// smooth height field. The mesh has positions, normals and texture
+// coordinates.
+std::unique_ptr<draco::Mesh> CreateSyntheticMesh(int size) {
+  std::unique_ptr<draco::Mesh> mesh(new draco::Mesh());
+  mesh->set_num_points(size * size);
+  const int pos_id =
+      AddFloatAttribute(mesh.get(), draco::GeometryAttribute::POSITION, 3);
+  const int norm_id =
+      AddFloatAttribute(mesh.get(), draco::GeometryAttribute::NORMAL, 3);
+  const int tex_id =
+      AddFloatAttribute(mesh.get(), draco::GeometryAttribute::TEX_COORD, 2);
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      const draco::AttributeValueIndex avi(y * size + x);
+      const float u = static_cast<float>(x) / (size - 1);
+      const float v = static_cast<float>(y) / (size - 1);
+      const float pos[3] = {u, v,
+                            0.1f * std::sin(12.f * u) * std::cos(9.f * v)};
+      // Normal of the height field.
+      const float dx = 1.2f * std::cos(12.f * u) * std::cos(9.f * v);
+      const float dy = -0.9f * std::sin(12.f * u) * std::sin(9.f * v);
+      const float length = std::sqrt(dx * dx + dy * dy + 1.f);
+      const float norm[3] = {-dx / length, -dy / length, 1.f / length};
+      const float tex[2] = {u, v};
+      mesh->attribute(pos_id)->SetAttributeValue(avi, pos);
+      mesh->attribute(norm_id)->SetAttributeValue(avi, norm);
+      mesh->attribute(tex_id)->SetAttributeValue(avi, tex);
+    }
+  }
+  for (int y = 0; y + 1 < size; ++y) {
+    for (int x = 0; x + 1 < size; ++x) {
+      const draco::PointIndex p(y * size + x);
+      mesh->AddFace({{p, p + 1, p + size}});
+      mesh->AddFace({{p + 1, p + size + 1, p + size}});
+    }
+  }
+  return mesh;
+}
+
+// Creates a point cloud with |size| x |size| random points on the surface of
+// a unit sphere with random colors.
+std::unique_ptr<draco::PointCloud> CreateSyntheticPointCloud(int size) {
+  std::unique_ptr<draco::PointCloud> pc(new draco::PointCloud());
+  pc->set_num_points(size * size);
+  const int pos_id =
+      AddFloatAttribute(pc.get(), draco::GeometryAttribute::POSITION, 3);
+  draco::GeometryAttribute color_att;
+  color_att.Init(draco::GeometryAttribute::COLOR, nullptr, 3, draco::DT_UINT8,
+                 true, 3, 0);
+  const int color_id = pc->AddAttribute(color_att, true, pc->num_points());
+  std::mt19937 generator(1);
+  std::normal_distribution<float> normal_distribution;
+  std::uniform_int_distribution<int> color_distribution(0, 255);
+  for (draco::AttributeValueIndex i(0); i < pc->num_points(); ++i) {
+    float pos[3];
+    float length = 0.f;
+    while (length < 1e-6f) {
+      for (int c = 0; c < 3; ++c) {
+        pos[c] = normal_distribution(generator);
+      }
+      length = std::sqrt(pos[0] * pos[0] + pos[1] * pos[1] + pos[2] * pos[2]);
+    }
+    for (int c = 0; c < 3; ++c) {
+      pos[c] /= length;
+    }
+    uint8_t color[3];
+    for (int c = 0; c < 3; ++c) {
+      color[c] = static_cast<uint8_t>(color_distribution(generator));
+    }
+    pc->attribute(pos_id)->SetAttributeValue(i, pos);
+    pc->attribute(color_id)->SetAttributeValue(i, color);
+  }
+  return pc;
+}
+
+void CollectStages(const StageStatsTracer &tracer, PipelineResult *result) {
+  result->stages.clear();
+  for (const std::string &name : tracer.stage_order()) {
+    result->stages.push_back(std::make_pair(name, tracer.stats(name)));
+  }
+}
+
+// Encodes and decodes |pc| |iterations| times and stores the results of the
+// fastest runs in |result|.
+void RunBenchmark(const draco::PointCloud &pc, int encoding_method,
+                  int iterations, BenchmarkResult *result) {
+  const draco::Mesh *mesh = dynamic_cast<const draco::Mesh *>(&pc);
+  // Meshes without faces (e.g., loaded from point cloud PLY files) are
+  // encoded as point clouds.
+  if (mesh != nullptr && mesh->num_faces() == 0)
+    mesh = nullptr;
+  StageStatsTracer tracer;
+  draco::Encoder encoder;
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION,
+                                   result->position_quantization_bits);
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::TEX_COORD, 12);
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::NORMAL, 10);
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::GENERIC, 8);
+  const int speed = 10 - result->compression_level;
+  encoder.SetSpeedOptions(speed, speed);
+  encoder.SetEncodingMethod(encoding_method);
+  encoder.options().SetTracer(&tracer);
+  draco::Decoder decoder;
+  decoder.options()->SetTracer(&tracer);
+
+  for (int i = 0; i < iterations; ++i) {
+    draco::EncoderBuffer buffer;
+    PipelineResult encode;
+    tracer.Clear();
+    {
+      Measurement measurement;
+      const draco::Status status =
+          mesh ? encoder.EncodeMeshToBuffer(*mesh, &buffer)
+               : encoder.EncodePointCloudToBuffer(pc, &buffer);
+      measurement.Stop(&encode.time_ms, &encode.peak_memory_bytes);
+      if (!status.ok()) {
+        result->error = status.error_msg_string();
+        return;
+      }
+    }
+    CollectStages(tracer, &encode);
+    result->encoded_size = static_cast<int64_t>(buffer.size());
+
+    draco::DecoderBuffer decoder_buffer;
+    decoder_buffer.Init(buffer.data(), buffer.size());
+    PipelineResult decode;
+    tracer.Clear();
+    {
+      Measurement measurement;
+      draco::StatusOr<std::unique_ptr<draco::PointCloud>> decoded =
+          decoder.DecodePointCloudFromBuffer(&decoder_buffer);
+      // Include the destruction of the decoded geometry in the measurement.
+      const draco::Status status = decoded.status();
+      decoded = draco::Status(draco::Status::DRACO_ERROR, "Released.");
+      measurement.Stop(&decode.time_ms, &decode.peak_memory_bytes);
+      if (!status.ok()) {
+        result->error = status.error_msg_string();
+        return;
+      }
+    }
+    CollectStages(tracer, &decode);
+
+    if (i == 0 || encode.time_ms < result->encode.time_ms)
+      result->encode = encode;
+    if (i == 0 || decode.time_ms < result->decode.time_ms)
+      result->decode = decode;
+  }
+}
+
+std::string EncodingMethodName(bool is_mesh, int method) {
+  if (is_mesh) {
+    return method == draco::MESH_SEQUENTIAL_ENCODING ? "sequential"
+                                                     : "edgebreaker";
+  }
+  return method == draco::POINT_CLOUD_SEQUENTIAL_ENCODING ? "sequential"
+                                                          : "kd_tree";
+}
+
+double PerSecond(double value, double time_ms) {
+  return time_ms > 0 ? value * 1000.0 / time_ms : 0.0;
+}
+
+double PerTriangle(int64_t num_bytes, const BenchmarkResult &result) {
+  return result.num_faces > 0 ? static_cast<double>(num_bytes) /
+                                    result.num_faces
+                              : 0.0;
+}
+
+void RunBenchmarks(const std::string &name, const draco::PointCloud &pc,
+                   const Options &options,
+                   std::vector<BenchmarkResult> *results) {
+  const draco::Mesh *const mesh = dynamic_cast<const draco::Mesh *>(&pc);
+  const bool is_mesh = mesh != nullptr && mesh->num_faces() > 0;
+  std::vector<int> methods;
+  if (is_mesh) {
+    methods = {draco::MESH_SEQUENTIAL_ENCODING,
+               draco::MESH_EDGEBREAKER_ENCODING};
+  } else {
+    methods = {draco::POINT_CLOUD_SEQUENTIAL_ENCODING,
+               draco::POINT_CLOUD_KD_TREE_ENCODING};
+  }
+  for (int method : methods) {
+    for (int compression_level : options.compression_levels) {
+      for (int qp : options.position_quantization_bits) {
+        BenchmarkResult result;
+        result.input = name;
+        result.is_mesh = is_mesh;
+        result.num_points = pc.num_points();
+        result.num_faces = is_mesh ? mesh->num_faces() : 0;
+        result.raw_size = GetRawSize(pc);
+        result.encoding_method = EncodingMethodName(is_mesh, method);
+        result.compression_level = compression_level;
+        result.position_quantization_bits = qp;
+        result.encoded_size = 0;
+        RunBenchmark(pc, method, std::max(options.iterations, 1), &result);
+        result.peak_rss = GetPeakResidentSetSize();
+        if (result.error.empty()) {
+          printf("%-32s %-11s cl=%-2d qp=%-2d %10" PRId64
+                 " bytes  encode %9.2f ms  decode %9.2f ms",
+                 name.c_str(), result.encoding_method.c_str(),
+                 compression_level, qp, result.encoded_size,
+                 result.encode.time_ms, result.decode.time_ms);
+          if (is_mesh) {
+            printf("  encode peak %7.1f B/triangle",
+                   PerTriangle(result.encode.peak_memory_bytes, result));
+          } else {
+            printf("  decode %7.2f Mpoints/s",
+                   PerSecond(result.num_points, result.decode.time_ms) / 1e6);
+          }
+          printf("\n");
+        } else {
+          printf("%-32s %-11s cl=%-2d qp=%-2d failed: %s\n", name.c_str(),
+                 result.encoding_method.c_str(), compression_level, qp,
+                 result.error.c_str());
+        }
+        results->push_back(result);
+      }
+    }
+  }
+}
+
+// Runs |func| |iterations| times and stores the time of the fastest run in
+// |result|. |func| returns an empty string on success or an error message.
+template <class FuncT>
+void MeasureFastestRun(int iterations, const FuncT &func,
+                       ComponentResult *result) {
+  for (int i = 0; i < iterations; ++i) {
+    const Clock::time_point start = Clock::now();
+    result->error = func();
+    const double time_ms =
+        std::chrono::duration<double, std::milli>(Clock::now() - start)
+            .count();
+    if (!result->error.empty())
+      return;
+    if (i == 0 || time_ms < result->time_ms)
+      result->time_ms = time_ms;
+  }
+}
+
+void PrintComponentResult(const ComponentResult &result, const char *unit) {
+  if (result.error.empty()) {
+    printf("%-44s %9.2f ms  %12.0f %s/s\n", result.name.c_str(),
+           result.time_ms, PerSecond(result.num_items, result.time_ms), unit);
+  } else {
+    printf("%-44s failed: %s\n", result.name.c_str(), result.error.c_str());
+  }
+}
+
+// Compares decoding of many small meshes one at a time against decoding them
+// with draco::BatchDecoder.
+void RunBatchDecodeBenchmark(int iterations,
+                             std::vector<ComponentResult> *results) {
+  constexpr int kNumTiles = 2000;
+  std::vector<draco::EncoderBuffer> encoded_tiles(kNumTiles);
+  draco::Encoder encoder;
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 11);
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::TEX_COORD, 10);
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::NORMAL, 8);
+  for (int i = 0; i < kNumTiles; ++i) {
+    const std::unique_ptr<draco::Mesh> tile = CreateSyntheticMesh(5 + i % 5);
+    const draco::Status status =
+        encoder.EncodeMeshToBuffer(*tile, &encoded_tiles[i]);
+    if (!status.ok()) {
+      ComponentResult result;
+      result.name = "batch_decode";
+      result.error = status.error_msg_string();
+      PrintComponentResult(result, "meshes");
+      results->push_back(result);
+      return;
+    }
+  }
+  std::vector<draco::DecoderBuffer> buffers(kNumTiles);
+  const auto init_buffers = [&]() {
+    for (int i = 0; i < kNumTiles; ++i) {
+      buffers[i].Init(encoded_tiles[i].data(), encoded_tiles[i].size());
+    }
+  };
+
+  ComponentResult serial;
+  serial.name = "batch_decode_serial";
+  serial.num_items = kNumTiles;
+  MeasureFastestRun(
+      iterations,
+      [&]() -> std::string {
+        init_buffers();
+        for (int i = 0; i < kNumTiles; ++i) {
+          draco::Decoder decoder;
+          const auto mesh = decoder.DecodeMeshFromBuffer(&buffers[i]);
+          if (!mesh.ok())
+            return mesh.status().error_msg_string();
+        }
+        return "";
+      },
+      &serial);
+  PrintComponentResult(serial, "meshes");
+  results->push_back(serial);
+
+  const int num_threads =
+      std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+  draco::BatchDecoder batch_decoder(num_threads);
+  ComponentResult batch;
+  batch.name = "batch_decode_" + std::to_string(num_threads) + "_threads";
+  batch.num_items = kNumTiles;
+  MeasureFastestRun(
+      iterations,
+      [&]() -> std::string {
+        init_buffers();
+        const auto meshes =
+            batch_decoder.DecodeMeshes(buffers.data(), buffers.size());
+        for (const auto &mesh : meshes) {
+          if (!mesh.ok())
+            return mesh.status().error_msg_string();
+        }
+        return "";
+      },
+      &batch);
+  PrintComponentResult(batch, "meshes");
+  results->push_back(batch);
+}
+
+// Baseline bit writer that writes one bit at a time.
+void PutBitsBitByBit(uint32_t data, int32_t nbits, char *buffer,
+                     uint64_t *bit_offset) {
+  for (int32_t bit = 0; bit < nbits; ++bit) {
+    const uint64_t byte_offset = *bit_offset / 8;
+    const int bit_shift = *bit_offset % 8;
+    buffer[byte_offset] &= ~(1 << bit_shift);
+    buffer[byte_offset] |= ((data >> bit) & 1) << bit_shift;
+    ++*bit_offset;
+  }
+}
+
+// Baseline bit reader that reads one bit at a time.
+uint32_t GetBitsBitByBit(int32_t nbits, const char *buffer,
+                         uint64_t *bit_offset) {
+  uint32_t value = 0;
+  for (int32_t bit = 0; bit < nbits; ++bit) {
+    const uint64_t byte_offset = *bit_offset / 8;
+    const int bit_shift = *bit_offset % 8;
+    value |= ((static_cast<uint8_t>(buffer[byte_offset]) >> bit_shift) & 1)
+             << bit;
+    ++*bit_offset;
+  }
+  return value;
+}
+
+// Compares the bit coding of the encoder and decoder buffers against the
+// baseline implementations that process one bit at a time.
+void RunBitCodingBenchmark(int iterations,
+                           std::vector<ComponentResult> *results) {
+  constexpr int kNumValues = 1 << 20;
+  std::vector<uint32_t> values(kNumValues);
+  std::vector<int32_t> num_bits(kNumValues);
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int32_t> num_bits_distribution(0, 32);
+  int64_t total_bits = 0;
+  for (int i = 0; i < kNumValues; ++i) {
+    values[i] = generator();
+    num_bits[i] = num_bits_distribution(generator);
+    total_bits += num_bits[i];
+  }
+  std::vector<char> reference_buffer((total_bits + 7) / 8);
+  draco::EncoderBuffer buffer;
+  const auto add_result = [&](const char *name, const ComponentResult &base) {
+    ComponentResult result = base;
+    result.name = name;
+    result.num_items = kNumValues;
+    PrintComponentResult(result, "values");
+    results->push_back(result);
+  };
+
+  ComponentResult result;
+  MeasureFastestRun(
+      iterations,
+      [&]() -> std::string {
+        uint64_t bit_offset = 0;
+        for (int i = 0; i < kNumValues; ++i) {
+          PutBitsBitByBit(values[i], num_bits[i], reference_buffer.data(),
+                          &bit_offset);
+        }
+        return "";
+      },
+      &result);
+  add_result("bit_encode_bit_by_bit", result);
+
+  MeasureFastestRun(
+      iterations,
+      [&]() -> std::string {
+        buffer.Clear();
+        if (!buffer.StartBitEncoding(total_bits, false))
+          return "Failed to start bit encoding.";
+        for (int i = 0; i < kNumValues; ++i) {
+          buffer.EncodeLeastSignificantBits32(num_bits[i], values[i]);
+        }
+        buffer.EndBitEncoding();
+        if (buffer.size() != reference_buffer.size() ||
+            memcmp(buffer.data(), reference_buffer.data(), buffer.size()) != 0)
+          return "Encoded data mismatch.";
+        return "";
+      },
+      &result);
+  add_result("bit_encode", result);
+
+  uint32_t reference_checksum = 0;
+  MeasureFastestRun(
+      iterations,
+      [&]() -> std::string {
+        uint64_t bit_offset = 0;
+        reference_checksum = 0;
+        for (int i = 0; i < kNumValues; ++i) {
+          reference_checksum += GetBitsBitByBit(
+              num_bits[i], reference_buffer.data(), &bit_offset);
+        }
+        return "";
+      },
+      &result);
+  add_result("bit_decode_bit_by_bit", result);
+
+  MeasureFastestRun(
+      iterations,
+      [&]() -> std::string {
+        draco::DecoderBuffer decoder_buffer;
+        decoder_buffer.Init(buffer.data(), buffer.size());
+        if (!decoder_buffer.StartBitDecoding(false, nullptr))
+          return "Failed to start bit decoding.";
+        uint32_t checksum = 0;
+        for (int i = 0; i < kNumValues; ++i) {
+          uint32_t x;
+          decoder_buffer.DecodeLeastSignificantBits32(num_bits[i], &x);
+          checksum += x;
+        }
+        decoder_buffer.EndBitDecoding();
+        return checksum == reference_checksum ? "" : "Checksum mismatch.";
+      },
+      &result);
+  add_result("bit_decode", result);
+}
+
+// Compares the decoding of symbols encoded with the raw and the interleaved
+// raw symbol coding.
+void RunSymbolDecodingBenchmark(int iterations,
+                                std::vector<ComponentResult> *results) {
+  constexpr int kNumValues = 1 << 22;
+  std::mt19937 generator(42);
+  std::geometric_distribution<uint32_t> distribution(1.0 / 64);
+  std::vector<uint32_t> in(kNumValues);
+  for (int i = 0; i < kNumValues; ++i) {
+    in[i] = std::min<uint32_t>(distribution(generator), 4095);
+  }
+  std::vector<uint32_t> out(kNumValues);
+  const std::pair<draco::SymbolCodingMethod, const char *> methods[] = {
+      {draco::SYMBOL_CODING_RAW, "symbol_decode_raw"},
+      {draco::SYMBOL_CODING_RAW_INTERLEAVED, "symbol_decode_raw_interleaved"}};
+  for (const auto &method : methods) {
+    draco::Options options;
+    draco::SetSymbolEncodingMethod(&options, method.first);
+    draco::EncoderBuffer buffer;
+    ComponentResult result;
+    result.name = method.second;
+    result.num_items = kNumValues;
+    if (!draco::EncodeSymbols(in.data(), kNumValues, 1, &options, &buffer)) {
+      result.error = "Failed to encode symbols.";
+    } else {
+      MeasureFastestRun(
+          iterations,
+          [&]() -> std::string {
+            draco::DecoderBuffer decoder_buffer;
+            decoder_buffer.Init(buffer.data(), buffer.size());
+            decoder_buffer.set_bitstream_version(
+                draco::kDracoMeshBitstreamVersion);
+            if (!draco::DecodeSymbols(
+                    kNumValues, 1,
+                    draco::InterleavedSymbolCodingBitstreamVersion(
+                        draco::TRIANGULAR_MESH),
+                    &decoder_buffer, out.data()))
+              return "Failed to decode symbols.";
+            return in == out ? "" : "Decoded symbols mismatch.";
+          },
+          &result);
+    }
+    PrintComponentResult(result, "symbols");
+    results->push_back(result);
+  }
+}
+
+void RunComponentBenchmarks(const Options &options,
+                            std::vector<ComponentResult> *results) {
+  const int iterations = std::max(options.iterations, 1);
+  RunBatchDecodeBenchmark(iterations, results);
+  RunBitCodingBenchmark(iterations, results);
+  RunSymbolDecodingBenchmark(iterations, results);
+}
+
+std::string JsonString(const std::string &s) {
+  std::string out = "\"";
+  for (const char c : s) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      out += escaped;
+    } else {
+      out += c;
+    }
+  }
+  return out + "\"";
+}
+
+void WritePipelineJson(const BenchmarkResult &result,
+                       const PipelineResult &pipeline, std::ostream *out) {
+  const double mb = result.raw_size / (1024.0 * 1024.0);
+  *out << "{\"time_ms\":" << pipeline.time_ms
+       << ",\"mb_per_s\":" << PerSecond(mb, pipeline.time_ms)
+       << ",\"points_per_s\":" << PerSecond(result.num_points, pipeline.time_ms)
+       << ",\"triangles_per_s\":"
+       << PerSecond(result.num_faces, pipeline.time_ms)
+       << ",\"peak_memory_bytes\":" << pipeline.peak_memory_bytes;
+  if (result.is_mesh) {
+    *out << ",\"peak_memory_bytes_per_triangle\":"
+         << PerTriangle(pipeline.peak_memory_bytes, result);
+  }
+  *out << ",\"stages\":[";
+  for (size_t i = 0; i < pipeline.stages.size(); ++i) {
+    const StageStats &stats = pipeline.stages[i].second;
+    if (i > 0)
+      *out << ",";
+    *out << "{\"name\":" << JsonString(pipeline.stages[i].first)
+         << ",\"count\":" << stats.count << ",\"time_ms\":" << stats.time_ms
+         << ",\"bytes\":" << stats.num_bytes << ",\"mb_per_s\":"
+         << PerSecond(stats.num_bytes / (1024.0 * 1024.0), stats.time_ms)
+         << ",\"peak_memory_bytes\":" << stats.peak_memory_bytes << "}";
+  }
+  *out << "]}";
+}
+
+void WriteJson(const std::vector<BenchmarkResult> &results,
+               const std::vector<ComponentResult> &components,
+               std::ostream *out) {
+  out->precision(9);
+  *out << "{\"benchmarks\":[\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchmarkResult &result = results[i];
+    *out << "{\"input\":" << JsonString(result.input)
+         << ",\"geometry\":\"" << (result.is_mesh ? "mesh" : "point_cloud")
+         << "\",\"num_points\":" << result.num_points
+         << ",\"num_faces\":" << result.num_faces
+         << ",\"raw_size_bytes\":" << result.raw_size
+         << ",\"encoding_method\":\"" << result.encoding_method
+         << "\",\"compression_level\":" << result.compression_level
+         << ",\"position_quantization_bits\":"
+         << result.position_quantization_bits
+         << ",\"peak_rss_bytes\":" << result.peak_rss;
+    if (!result.error.empty()) {
+      *out << ",\"error\":" << JsonString(result.error);
+    } else {
+      *out << ",\"encoded_size_bytes\":" << result.encoded_size
+           << ",\"encode\":";
+      WritePipelineJson(result, result.encode, out);
+      *out << ",\"decode\":";
+      WritePipelineJson(result, result.decode, out);
+    }
+    *out << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  *out << "],\n\"components\":[\n";
+  for (size_t i = 0; i < components.size(); ++i) {
+    const ComponentResult &component = components[i];
+    *out << "{\"name\":" << JsonString(component.name);
+    if (!component.error.empty()) {
+      *out << ",\"error\":" << JsonString(component.error);
+    } else {
+      *out << ",\"time_ms\":" << component.time_ms
+           << ",\"num_items\":" << component.num_items
+           << ",\"items_per_s\":"
+           << PerSecond(component.num_items, component.time_ms);
+    }
+    *out << "}" << (i + 1 < components.size() ? ",\n" : "\n");
+  }
+  *out << "]}\n";
+}
+
+}  // anonymous namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  options.testdata_dir = DRACO_BENCHMARK_TESTDATA_DIR;
+  const int argc_check = argc - 1;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp("-h", argv[i]) || !strcmp("-?", argv[i])) {
+      Usage();
+      return 0;
+    } else if (!strcmp("-i", argv[i]) && i < argc_check) {
+      options.inputs.push_back(argv[++i]);
+    } else if (!strcmp("-testdata", argv[i]) && i < argc_check) {
+      options.testdata_dir = argv[++i];
+    } else if (!strcmp("-synthetic", argv[i]) && i < argc_check) {
+      options.synthetic_size = StringToInt(argv[++i]);
+    } else if (!strcmp("-cl", argv[i]) && i < argc_check) {
+      options.compression_levels = StringToIntList(argv[++i]);
+    } else if (!strcmp("-qp", argv[i]) && i < argc_check) {
+      options.position_quantization_bits = StringToIntList(argv[++i]);
+      for (int qp : options.position_quantization_bits) {
+        if (qp < 1 || qp > 30) {
+          printf("Error: Position quantization bits must be in range 1-30.\n");
+          return -1;
+        }
+      }
+    } else if (!strcmp("-iterations", argv[i]) && i < argc_check) {
+      options.iterations = StringToInt(argv[++i]);
+    } else if (!strcmp("-components", argv[i]) && i < argc_check) {
+      options.components = StringToInt(argv[++i]) != 0;
+    } else if (!strcmp("-o", argv[i]) && i < argc_check) {
+      options.output = argv[++i];
+    } else {
+      Usage();
+      return -1;
+    }
+  }
+  if (options.inputs.empty()) {
+    for (const char *file_name :
+         {"bun_zipper.ply", "test_nm.obj", "cube_att.obj", "sphere.obj",
+          "point_cloud_test_pos_norm.ply", "test_pos_color.ply"}) {
+      options.inputs.push_back(options.testdata_dir + "/" + file_name);
+    }
+  }
+
+  std::vector<BenchmarkResult> results;
+  for (const std::string &input : options.inputs) {
+    auto maybe_mesh = draco::ReadMeshFromFile(input);
+    if (!maybe_mesh.ok()) {
+      printf("Failed loading %s: %s.\n", input.c_str(),
+             maybe_mesh.status().error_msg());
+      return -1;
+    }
+    const std::string name = input.substr(input.find_last_of("/\\") + 1);
+    RunBenchmarks(name, *maybe_mesh.value(), options, &results);
+  }
+  if (options.synthetic_size > 1) {
+    const std::string size = std::to_string(options.synthetic_size);
+    RunBenchmarks("synthetic_grid_" + size + "x" + size,
+                  *CreateSyntheticMesh(options.synthetic_size), options,
+                  &results);
+    RunBenchmarks("synthetic_points_" + size + "x" + size,
+                  *CreateSyntheticPointCloud(options.synthetic_size), options,
+                  &results);
+  }
+  std::vector<ComponentResult> components;
+  if (options.components)
+    RunComponentBenchmarks(options, &components);
+
+  if (!options.output.empty()) {
+    std::ofstream out_file(options.output);
+    if (!out_file) {
+      printf("Failed to create the output file.\n");
+      return -1;
+    }
+    WriteJson(results, components, &out_file);
+    printf("\nResults saved to %s.\n", options.output.c_str());
+  }
+  for (const BenchmarkResult &result : results) {
+    if (!result.error.empty())
+      return -1;
+  }
+  for (const ComponentResult &component : components) {
+    if (!component.error.empty())
+      return -1;
+  }
+  return 0;
+}
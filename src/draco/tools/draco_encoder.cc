@@ -12,12 +12,20 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //
+#include <algorithm>
 #include <cinttypes>
+#include <cstdio>
 #include <cstdlib>
 #include <fstream>
+#include <map>
+#include <thread>
+#include <vector>
 
 #include "draco/compression/encode.h"
+#include "draco/compression/encode_cache.h"
 #include "draco/core/cycle_timer.h"
+#include "draco/core/thread_pool.h"
+#include "draco/io/file_utils.h"
 #include "draco/io/mesh_io.h"
 #include "draco/io/point_cloud_io.h"
 
@@ -38,6 +46,13 @@ struct Options {
   bool use_metadata;
   std::string input;
   std::string output;
+  // Directory, wildcard pattern or manifest file with the inputs of the batch
+  // mode.
+  std::string batch_input;
+  // Number of threads used in the batch mode, 0 = one per hardware thread.
+  int num_threads;
+  // Directory of the encode cache used in the batch mode. Empty = no cache.
+  std::string cache_directory;
 };
 
 Options::Options()
@@ -50,10 +65,12 @@ Options::Options()
       generic_quantization_bits(8),
       generic_deleted(false),
       compression_level(7),
-      use_metadata(false) {}
+      use_metadata(false),
+      num_threads(0) {}
 
 void Usage() {
   printf("Usage: draco_encoder [options] -i input\n");
+  printf("       draco_encoder [options] -batch input\n");
   printf("\n");
   printf("Main options:\n");
   printf("  -h | -?               show help.\n");
@@ -83,6 +100,25 @@ void Usage() {
   printf(
       "  --metadata            use metadata to encode extra information in "
       "mesh files.\n");
+  printf("\nBatch options:\n");
+  printf(
+      "  -batch <input>        encodes all .obj and .ply files in a "
+      "directory, all files\n"
+      "                        matching a wildcard pattern such as "
+      "dir/*.ply, or all\n"
+      "                        files listed in a manifest file (one per "
+      "line).\n"
+      "                        -o specifies the output directory.\n");
+  printf(
+      "  -threads <value>      number of files encoded in parallel in the "
+      "batch mode,\n"
+      "                        default=number of hardware threads.\n");
+  printf(
+      "  -cache <dir>          reuses files encoded with the same settings "
+      "from an\n"
+      "                        existing cache directory and stores newly "
+      "encoded files\n"
+      "                        there.\n");
   printf(
       "\nUse negative quantization values to skip the specified attribute\n");
 }
@@ -140,55 +176,355 @@ void PrintOptions(const draco::PointCloud &pc, const Options &options) {
 int EncodePointCloudToFile(const draco::PointCloud &pc, const std::string &file,
                            draco::Encoder *encoder) {
   draco::CycleTimer timer;
-  // Encode the geometry.
+  std::ofstream out_file(file, std::ios::binary);
+  if (!out_file) {
+    printf("Failed to create the output file.\n");
+    return -1;
+  }
+  // Encode the geometry directly into the output file.
+  draco::StreamEncoderBufferSink sink(&out_file);
   draco::EncoderBuffer buffer;
+  buffer.SetSink(&sink);
   timer.Start();
   const draco::Status status = encoder->EncodePointCloudToBuffer(pc, &buffer);
   if (!status.ok()) {
     printf("Failed to encode the point cloud.\n");
     printf("%s\n", status.error_msg());
+    out_file.close();
+    std::remove(file.c_str());
     return -1;
   }
   timer.Stop();
-  // Save the encoded geometry into a file.
-  std::ofstream out_file(file, std::ios::binary);
-  if (!out_file) {
-    printf("Failed to create the output file.\n");
+  if (!buffer.Flush()) {
+    printf("Failed to write the output file.\n");
     return -1;
   }
-  out_file.write(buffer.data(), buffer.size());
   printf("Encoded point cloud saved to %s (%" PRId64 " ms to encode).\n",
          file.c_str(), timer.GetInMs());
-  printf("\nEncoded size = %zu bytes\n\n", buffer.size());
+  printf("\nEncoded size = %zu bytes\n\n", buffer.encoded_size());
   return 0;
 }
 
 int EncodeMeshToFile(const draco::Mesh &mesh, const std::string &file,
                      draco::Encoder *encoder) {
   draco::CycleTimer timer;
-  // Encode the geometry.
+  std::ofstream out_file(file, std::ios::binary);
+  if (!out_file) {
+    printf("Failed to create the output file.\n");
+    return -1;
+  }
+  // Encode the geometry directly into the output file.
+  draco::StreamEncoderBufferSink sink(&out_file);
   draco::EncoderBuffer buffer;
+  buffer.SetSink(&sink);
   timer.Start();
   const draco::Status status = encoder->EncodeMeshToBuffer(mesh, &buffer);
   if (!status.ok()) {
     printf("Failed to encode the mesh.\n");
     printf("%s\n", status.error_msg());
+    out_file.close();
+    std::remove(file.c_str());
     return -1;
   }
   timer.Stop();
-  // Save the encoded geometry into a file.
-  std::ofstream out_file(file, std::ios::binary);
-  if (!out_file) {
-    printf("Failed to create the output file.\n");
+  if (!buffer.Flush()) {
+    printf("Failed to write the output file.\n");
     return -1;
   }
-  out_file.write(buffer.data(), buffer.size());
   printf("Encoded mesh saved to %s (%" PRId64 " ms to encode).\n", file.c_str(),
          timer.GetInMs());
-  printf("\nEncoded size = %zu bytes\n\n", buffer.size());
+  printf("\nEncoded size = %zu bytes\n\n", buffer.encoded_size());
   return 0;
 }
 
+// Deletes all attributes that were skipped in the |options| and updates the
+// |options| accordingly.
+void DeleteSkippedAttributes(draco::PointCloud *pc, Options *options) {
+  if (options->tex_coords_quantization_bits < 0) {
+    if (pc->NumNamedAttributes(draco::GeometryAttribute::TEX_COORD) > 0) {
+      options->tex_coords_deleted = true;
+    }
+    while (pc->NumNamedAttributes(draco::GeometryAttribute::TEX_COORD) > 0) {
+      pc->DeleteAttribute(
+          pc->GetNamedAttributeId(draco::GeometryAttribute::TEX_COORD, 0));
+    }
+  }
+  if (options->normals_quantization_bits < 0) {
+    if (pc->NumNamedAttributes(draco::GeometryAttribute::NORMAL) > 0) {
+      options->normals_deleted = true;
+    }
+    while (pc->NumNamedAttributes(draco::GeometryAttribute::NORMAL) > 0) {
+      pc->DeleteAttribute(
+          pc->GetNamedAttributeId(draco::GeometryAttribute::NORMAL, 0));
+    }
+  }
+  if (options->generic_quantization_bits < 0) {
+    if (pc->NumNamedAttributes(draco::GeometryAttribute::GENERIC) > 0) {
+      options->generic_deleted = true;
+    }
+    while (pc->NumNamedAttributes(draco::GeometryAttribute::GENERIC) > 0) {
+      pc->DeleteAttribute(
+          pc->GetNamedAttributeId(draco::GeometryAttribute::GENERIC, 0));
+    }
+  }
+#ifdef DRACO_ATTRIBUTE_INDICES_DEDUPLICATION_SUPPORTED
+  // If any attribute has been deleted, run deduplication of point indices again
+  // as some points can be possibly combined.
+  if (options->tex_coords_deleted || options->normals_deleted ||
+      options->generic_deleted) {
+    pc->DeduplicatePointIds();
+  }
+#endif
+}
+
+void SetupEncoder(const Options &options, draco::Encoder *encoder) {
+  // Convert compression level to speed (that 0 = slowest, 10 = fastest).
+  const int speed = 10 - options.compression_level;
+
+  if (options.pos_quantization_bits > 0) {
+    encoder->SetAttributeQuantization(draco::GeometryAttribute::POSITION,
+                                      options.pos_quantization_bits);
+  }
+  if (options.tex_coords_quantization_bits > 0) {
+    encoder->SetAttributeQuantization(draco::GeometryAttribute::TEX_COORD,
+                                      options.tex_coords_quantization_bits);
+  }
+  if (options.normals_quantization_bits > 0) {
+    encoder->SetAttributeQuantization(draco::GeometryAttribute::NORMAL,
+                                      options.normals_quantization_bits);
+  }
+  if (options.generic_quantization_bits > 0) {
+    encoder->SetAttributeQuantization(draco::GeometryAttribute::GENERIC,
+                                      options.generic_quantization_bits);
+  }
+  encoder->SetSpeedOptions(speed, speed);
+}
+
+// Result of encoding of a single file in the batch mode.
+struct BatchFileResult {
+  BatchFileResult() : input_size(0), encoded_size(0) {}
+
+  std::string input;
+  std::string output;
+  size_t input_size;
+  size_t encoded_size;
+  // Empty when the file was encoded successfully.
+  std::string error;
+};
+
+// Fills |out_inputs| with the input files of the batch mode. |batch_input| is
+// either a directory, a wildcard pattern of file names in a directory or a
+// manifest file listing one input file per line.
+bool CollectBatchInputs(const std::string &batch_input,
+                        std::vector<std::string> *out_inputs) {
+  std::vector<std::string> file_names;
+  if (draco::GetFilesInDirectory(batch_input, &file_names)) {
+    for (const std::string &file_name : file_names) {
+      const std::string extension = draco::LowercaseFileExtension(file_name);
+      if (extension == "obj" || extension == "ply")
+        out_inputs->push_back(batch_input + "/" + file_name);
+    }
+    return true;
+  }
+  if (batch_input.find_first_of("*?") != std::string::npos) {
+    std::string dir_path, pattern;
+    draco::SplitPath(batch_input, &dir_path, &pattern);
+    if (!draco::GetFilesInDirectory(dir_path, &file_names))
+      return false;
+    for (const std::string &file_name : file_names) {
+      if (draco::MatchesWildcardPattern(pattern, file_name))
+        out_inputs->push_back(dir_path + "/" + file_name);
+    }
+    return true;
+  }
+  std::ifstream manifest_file(batch_input);
+  if (!manifest_file)
+    return false;
+  std::string line;
+  while (std::getline(manifest_file, line)) {
+    // Strip surrounding white spaces (including '\r' of Windows line endings).
+    const size_t begin = line.find_first_not_of(" \t\r");
+    if (begin == std::string::npos || line[begin] == '#')
+      continue;  // Skip empty lines and comments.
+    const size_t end = line.find_last_not_of(" \t\r");
+    out_inputs->push_back(line.substr(begin, end - begin + 1));
+  }
+  return true;
+}
+
+void EncodeBatchFile(Options options, draco::EncodeCache *cache,
+                     BatchFileResult *result) {
+  if (!result->error.empty())
+    return;  // Rejected before the encoding.
+  std::ifstream input_file(result->input, std::ios::binary | std::ios::ate);
+  if (!input_file) {
+    result->error = "Failed to open the input file.";
+    return;
+  }
+  result->input_size = static_cast<size_t>(input_file.tellg());
+  input_file.close();
+
+  std::unique_ptr<draco::PointCloud> pc;
+  draco::Mesh *mesh = nullptr;
+  if (!options.is_point_cloud) {
+    auto maybe_mesh =
+        draco::ReadMeshFromFile(result->input, options.use_metadata);
+    if (!maybe_mesh.ok()) {
+      result->error = maybe_mesh.status().error_msg_string();
+      return;
+    }
+    mesh = maybe_mesh.value().get();
+    pc = std::move(maybe_mesh).value();
+  } else {
+    auto maybe_pc = draco::ReadPointCloudFromFile(result->input);
+    if (!maybe_pc.ok()) {
+      result->error = maybe_pc.status().error_msg_string();
+      return;
+    }
+    pc = std::move(maybe_pc).value();
+  }
+  DeleteSkippedAttributes(pc.get(), &options);
+
+  draco::Encoder encoder;
+  SetupEncoder(options, &encoder);
+  std::ofstream out_file(result->output, std::ios::binary);
+  if (!out_file) {
+    result->error = "Failed to create the output file.";
+    return;
+  }
+  draco::StreamEncoderBufferSink sink(&out_file);
+  draco::EncoderBuffer buffer;
+  buffer.SetSink(&sink);
+  const bool input_is_mesh = mesh && mesh->num_faces() > 0;
+  draco::Status status;
+  if (cache != nullptr) {
+    status = input_is_mesh
+                 ? cache->EncodeMeshToBuffer(encoder.options(), *mesh, &buffer)
+                 : cache->EncodePointCloudToBuffer(encoder.options(), *pc,
+                                                   &buffer);
+  } else {
+    status = input_is_mesh ? encoder.EncodeMeshToBuffer(*mesh, &buffer)
+                           : encoder.EncodePointCloudToBuffer(*pc, &buffer);
+  }
+  if (!status.ok()) {
+    result->error = status.error_msg_string();
+    out_file.close();
+    std::remove(result->output.c_str());
+    return;
+  }
+  if (!buffer.Flush()) {
+    result->error = "Failed to write the output file.";
+    return;
+  }
+  result->encoded_size = buffer.encoded_size();
+}
+
+// Encodes all input files of the batch mode on multiple threads. Each thread
+// reads, encodes and writes one file at a time so reading of the input files
+// overlaps with encoding of the files on the other threads. Files that fail to
+// encode are reported at the end instead of aborting the whole batch.
+int EncodeBatch(const Options &options) {
+  std::vector<std::string> inputs;
+  if (!CollectBatchInputs(options.batch_input, &inputs)) {
+    printf("Failed to read the batch input %s.\n",
+           options.batch_input.c_str());
+    return -1;
+  }
+  if (inputs.empty()) {
+    printf("No input files found in %s.\n", options.batch_input.c_str());
+    return -1;
+  }
+  std::vector<BatchFileResult> results(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    results[i].input = inputs[i];
+    if (options.output.empty()) {
+      results[i].output = inputs[i] + ".drc";
+    } else {
+      std::string file_name;
+      draco::SplitPath(inputs[i], nullptr, &file_name);
+      results[i].output = options.output + "/" + file_name + ".drc";
+    }
+  }
+  // Files that would be written to the same output (e.g., inputs with the same
+  // name in different directories) are reported as failures. Only the first
+  // of them is encoded.
+  std::map<std::string, size_t> output_to_input;
+  for (size_t i = 0; i < results.size(); ++i) {
+    const auto inserted = output_to_input.insert(
+        std::make_pair(results[i].output, i));
+    if (!inserted.second) {
+      results[i].error = "Output file " + results[i].output +
+                         " is already used by " +
+                         results[inserted.first->second].input + ".";
+    }
+  }
+
+  int num_threads = options.num_threads;
+  if (num_threads <= 0) {
+    num_threads = std::max(1, static_cast<int>(
+                                  std::thread::hardware_concurrency()));
+  }
+  printf("Encoding %zu files using %d threads.\n", inputs.size(),
+         num_threads);
+  std::unique_ptr<draco::EncodeCache> cache;
+  if (!options.cache_directory.empty()) {
+    cache.reset(new draco::EncodeCache(options.cache_directory));
+  }
+  // The calling thread takes part in the work so one worker thread less is
+  // needed.
+  draco::ThreadPool pool(num_threads - 1);
+  draco::CycleTimer timer;
+  timer.Start();
+  draco::ParallelFor(&pool, static_cast<int>(results.size()), [&](int i) {
+    EncodeBatchFile(options, cache.get(), &results[i]);
+    return true;
+  });
+  timer.Stop();
+
+  int num_encoded_files = 0;
+  uint64_t total_input_size = 0;
+  uint64_t total_encoded_size = 0;
+  for (const BatchFileResult &result : results) {
+    if (!result.error.empty())
+      continue;
+    ++num_encoded_files;
+    total_input_size += result.input_size;
+    total_encoded_size += result.encoded_size;
+  }
+  const double seconds = std::max<int64_t>(timer.GetInMs(), 1) / 1000.0;
+  const double input_mb = total_input_size / (1024.0 * 1024.0);
+  printf("\nEncoded %d of %zu files in %.3f s.\n", num_encoded_files,
+         results.size(), seconds);
+  printf("  Throughput = %.2f files/s, %.2f input MB/s\n",
+         num_encoded_files / seconds, input_mb / seconds);
+  printf("  Input size = %.2f MB, encoded size = %.2f MB\n", input_mb,
+         total_encoded_size / (1024.0 * 1024.0));
+  if (total_encoded_size > 0) {
+    printf("  Compression ratio = %.2f\n",
+           static_cast<double>(total_input_size) / total_encoded_size);
+  }
+  if (cache) {
+    const draco::EncodeCacheStats stats = cache->stats();
+    printf("  Cache hits = %" PRId64 ", misses = %" PRId64 "\n",
+           stats.num_hits, stats.num_misses);
+    if (stats.num_failed_stores > 0) {
+      printf("  Failed to store %" PRId64 " files in the cache %s.\n",
+             stats.num_failed_stores, options.cache_directory.c_str());
+    }
+  }
+
+  const int num_failed_files =
+      static_cast<int>(results.size()) - num_encoded_files;
+  if (num_failed_files == 0)
+    return 0;
+  printf("\nFailed to encode %d files:\n", num_failed_files);
+  for (const BatchFileResult &result : results) {
+    if (!result.error.empty())
+      printf("  %s: %s\n", result.input.c_str(), result.error.c_str());
+  }
+  return -1;
+}
+
 }  // anonymous namespace
 
 int main(int argc, char **argv) {
@@ -253,13 +589,27 @@ int main(int argc, char **argv) {
       ++i;
     } else if (!strcmp("--metadata", argv[i])) {
       options.use_metadata = true;
+    } else if (!strcmp("-batch", argv[i]) && i < argc_check) {
+      options.batch_input = argv[++i];
+    } else if (!strcmp("-threads", argv[i]) && i < argc_check) {
+      options.num_threads = StringToInt(argv[++i]);
+    } else if (!strcmp("-cache", argv[i]) && i < argc_check) {
+      options.cache_directory = argv[++i];
     }
   }
-  if (argc < 3 || options.input.empty()) {
+  if (argc < 3 || (options.input.empty() && options.batch_input.empty())) {
     Usage();
     return -1;
   }
 
+  if (!options.batch_input.empty()) {
+    if (options.pos_quantization_bits < 0) {
+      printf("Error: Position attribute cannot be skipped.\n");
+      return -1;
+    }
+    return EncodeBatch(options);
+  }
+
   std::unique_ptr<draco::PointCloud> pc;
   draco::Mesh *mesh = nullptr;
   if (!options.is_point_cloud) {
@@ -289,65 +639,10 @@ int main(int argc, char **argv) {
 
   // Delete attributes if needed. This needs to happen before we set any
   // quantization settings.
-  if (options.tex_coords_quantization_bits < 0) {
-    if (pc->NumNamedAttributes(draco::GeometryAttribute::TEX_COORD) > 0) {
-      options.tex_coords_deleted = true;
-    }
-    while (pc->NumNamedAttributes(draco::GeometryAttribute::TEX_COORD) > 0) {
-      pc->DeleteAttribute(
-          pc->GetNamedAttributeId(draco::GeometryAttribute::TEX_COORD, 0));
-    }
-  }
-  if (options.normals_quantization_bits < 0) {
-    if (pc->NumNamedAttributes(draco::GeometryAttribute::NORMAL) > 0) {
-      options.normals_deleted = true;
-    }
-    while (pc->NumNamedAttributes(draco::GeometryAttribute::NORMAL) > 0) {
-      pc->DeleteAttribute(
-          pc->GetNamedAttributeId(draco::GeometryAttribute::NORMAL, 0));
-    }
-  }
-  if (options.generic_quantization_bits < 0) {
-    if (pc->NumNamedAttributes(draco::GeometryAttribute::GENERIC) > 0) {
-      options.generic_deleted = true;
-    }
-    while (pc->NumNamedAttributes(draco::GeometryAttribute::GENERIC) > 0) {
-      pc->DeleteAttribute(
-          pc->GetNamedAttributeId(draco::GeometryAttribute::GENERIC, 0));
-    }
-  }
-#ifdef DRACO_ATTRIBUTE_INDICES_DEDUPLICATION_SUPPORTED
-  // If any attribute has been deleted, run deduplication of point indices again
-  // as some points can be possibly combined.
-  if (options.tex_coords_deleted || options.normals_deleted ||
-      options.generic_deleted) {
-    pc->DeduplicatePointIds();
-  }
-#endif
-
-  // Convert compression level to speed (that 0 = slowest, 10 = fastest).
-  const int speed = 10 - options.compression_level;
+  DeleteSkippedAttributes(pc.get(), &options);
 
   draco::Encoder encoder;
-
-  // Setup encoder options.
-  if (options.pos_quantization_bits > 0) {
-    encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION,
-                                     options.pos_quantization_bits);
-  }
-  if (options.tex_coords_quantization_bits > 0) {
-    encoder.SetAttributeQuantization(draco::GeometryAttribute::TEX_COORD,
-                                     options.tex_coords_quantization_bits);
-  }
-  if (options.normals_quantization_bits > 0) {
-    encoder.SetAttributeQuantization(draco::GeometryAttribute::NORMAL,
-                                     options.normals_quantization_bits);
-  }
-  if (options.generic_quantization_bits > 0) {
-    encoder.SetAttributeQuantization(draco::GeometryAttribute::GENERIC,
-                                     options.generic_quantization_bits);
-  }
-  encoder.SetSpeedOptions(speed, speed);
+  SetupEncoder(options, &encoder);
 
   if (options.output.empty()) {
     // Create a default output file by attaching .drc to the input file name.